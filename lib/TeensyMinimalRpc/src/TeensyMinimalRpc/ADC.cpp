@@ -1,7 +1,57 @@
+#include <stddef.h>  // offsetof
 #include "ADC.h"
 
 namespace teensy {
 namespace adc {
+  /* Register field tables (see `codec::Field`), in order of Protocol Buffer
+   * field tags. */
+  // Status and control registers 1 (`SC1A`, `SC1B`)
+  constexpr codec::Field SC1_FIELDS[] = {
+    PB_REGISTER_BIT(teensy__3_1_adc_R_SC1, ADC_SC1, COCO),
+    PB_REGISTER_BIT(teensy__3_1_adc_R_SC1, ADC_SC1, AIEN),
+    PB_REGISTER_BIT(teensy__3_1_adc_R_SC1, ADC_SC1, DIFF),
+    PB_REGISTER_BITS(teensy__3_1_adc_R_SC1, 5, 0, ADCH),
+  };
+  // Configuration register 1
+  constexpr codec::Field CFG1_FIELDS[] = {
+    PB_REGISTER_BIT(teensy__3_1_adc_R_CFG1, ADC_CFG1, ADLPC),
+    PB_REGISTER_BITS(teensy__3_1_adc_R_CFG1, 2, 5, ADIV),
+    PB_REGISTER_BIT(teensy__3_1_adc_R_CFG1, ADC_CFG1, ADLSMP),
+    PB_REGISTER_BITS(teensy__3_1_adc_R_CFG1, 2, 2, MODE),
+    PB_REGISTER_BITS(teensy__3_1_adc_R_CFG1, 2, 0, ADICLK),
+  };
+  // Configuration register 2
+  constexpr codec::Field CFG2_FIELDS[] = {
+    PB_REGISTER_BIT(teensy__3_1_adc_R_CFG2, ADC_CFG2, MUXSEL),
+    PB_REGISTER_BIT(teensy__3_1_adc_R_CFG2, ADC_CFG2, ADACKEN),
+    PB_REGISTER_BIT(teensy__3_1_adc_R_CFG2, ADC_CFG2, ADHSC),
+    PB_REGISTER_BITS(teensy__3_1_adc_R_CFG2, 2, 0, ADLSTS),
+  };
+  // Status and control register 2
+  constexpr codec::Field SC2_FIELDS[] = {
+    PB_REGISTER_BIT(teensy__3_1_adc_R_SC2, ADC_SC2, ADACT),
+    PB_REGISTER_BIT(teensy__3_1_adc_R_SC2, ADC_SC2, ADTRG),
+    PB_REGISTER_BIT(teensy__3_1_adc_R_SC2, ADC_SC2, ACFE),
+    PB_REGISTER_BIT(teensy__3_1_adc_R_SC2, ADC_SC2, ACFGT),
+    PB_REGISTER_BIT(teensy__3_1_adc_R_SC2, ADC_SC2, ACREN),
+    PB_REGISTER_BIT(teensy__3_1_adc_R_SC2, ADC_SC2, DMAEN),
+    PB_REGISTER_BITS(teensy__3_1_adc_R_SC2, 2, 0, REFSEL),
+  };
+  // Status and control register 3
+  constexpr codec::Field SC3_FIELDS[] = {
+    PB_REGISTER_BIT(teensy__3_1_adc_R_SC3, ADC_SC3, CAL),
+    PB_REGISTER_BIT(teensy__3_1_adc_R_SC3, ADC_SC3, CALF),
+    PB_REGISTER_BIT(teensy__3_1_adc_R_SC3, ADC_SC3, ADCO),
+    PB_REGISTER_BIT(teensy__3_1_adc_R_SC3, ADC_SC3, AVGE),
+    PB_REGISTER_BITS(teensy__3_1_adc_R_SC3, 2, 0, AVGS),
+  };
+  // Programmable gain amplifier register
+  constexpr codec::Field PGA_FIELDS[] = {
+    PB_REGISTER_BIT(teensy__3_1_adc_R_PGA, ADC_PGA, PGAEN),
+    PB_REGISTER_BIT(teensy__3_1_adc_R_PGA, ADC_PGA, PGALPB),
+    PB_REGISTER_BITS(teensy__3_1_adc_R_PGA, 4, 16, PGAG),
+  };
+
   UInt8Array serialize_registers(uint8_t adc_num, UInt8Array buffer) {
     volatile AdcRegister_t &adc =
       *(reinterpret_cast<volatile AdcRegister_t *>(&ADC0_SC1A) + adc_num);
@@ -9,37 +59,13 @@ namespace adc {
     teensy__3_1_adc_Registers result;
 
     result.has_SC1A = true;
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.SC1A, ADC_SC1, AIEN, adc.SC1A)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.SC1A, ADC_SC1, COCO, adc.SC1A)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.SC1A, ADC_SC1, DIFF, adc.SC1A)
-    result.SC1A.has_ADCH = true;
-    result.SC1A.ADCH = adc.SC1A & 0x1F;
-
+    codec::decode(adc.SC1A, SC1_FIELDS, result.SC1A);
     result.has_SC1B = true;
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.SC1B, ADC_SC1, AIEN, adc.SC1B)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.SC1B, ADC_SC1, COCO, adc.SC1B)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.SC1B, ADC_SC1, DIFF, adc.SC1B)
-    result.SC1B.has_ADCH = true;
-    result.SC1B.ADCH = adc.SC1B & 0x1F;
-
+    codec::decode(adc.SC1B, SC1_FIELDS, result.SC1B);
     result.has_CFG1 = true;
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.CFG1, ADC_CFG1, ADLPC, adc.CFG1)
-    result.CFG1.has_ADICLK = true;
-    result.CFG1.ADICLK = (teensy__3_1_adc_R_CFG1_E_ADICLK)(adc.CFG1 & 0x3);
-    result.CFG1.has_ADIV = true;
-    result.CFG1.ADIV = (teensy__3_1_adc_R_CFG1_E_ADIV)((adc.CFG1 >> 5) & 0x3);
-    result.CFG1.has_ADLSMP = true;
-    result.CFG1.ADLSMP = (teensy__3_1_adc_R_CFG1_E_ADLSMP)(adc.CFG1 & ADC_CFG1_ADLSMP);
-    result.CFG1.has_MODE = true;
-    result.CFG1.MODE = (teensy__3_1_adc_R_CFG1_E_MODE)((adc.CFG1 >> 2) & 0x3);
-
+    codec::decode(adc.CFG1, CFG1_FIELDS, result.CFG1);
     result.has_CFG2 = true;
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.CFG2, ADC_CFG2, ADACKEN, adc.CFG2)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.CFG2, ADC_CFG2, ADHSC, adc.CFG2)
-    result.CFG2.has_ADLSTS = true;
-    result.CFG2.ADLSTS = (teensy__3_1_adc_R_CFG2_E_ADLSTS)(adc.CFG2 & 0x3);
-    result.CFG2.has_MUXSEL = true;
-    result.CFG2.MUXSEL = (teensy__3_1_adc_R_CFG2_E_MUXSEL)((adc.CFG2 >> 4) & 0x1);
+    codec::decode(adc.CFG2, CFG2_FIELDS, result.CFG2);
 
     result.has_RA = true;
     result.RA = adc.RA;
@@ -52,33 +78,15 @@ namespace adc {
     result.CV2 = adc.CV2;
 
     result.has_SC2 = true;
+    codec::decode(adc.SC2, SC2_FIELDS, result.SC2);
     result.has_SC3 = true;
-
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.SC2, ADC_SC2, ACFE, adc.SC2)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.SC2, ADC_SC2, ACFGT, adc.SC2)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.SC2, ADC_SC2, ACREN, adc.SC2)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.SC2, ADC_SC2, ADACT, adc.SC2)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.SC2, ADC_SC2, DMAEN, adc.SC2)
-    result.SC2.has_ADTRG = true;
-    result.SC2.ADTRG = (teensy__3_1_adc_R_SC2_E_ADTRG)(adc.SC2 & ADC_SC2_ADTRG);
-    result.SC2.has_REFSEL = true;
-    result.SC2.REFSEL = (teensy__3_1_adc_R_SC2_E_REFSEL)(adc.SC2 & 0x3);
-
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.SC3, ADC_SC3, ADCO, adc.SC3)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.SC3, ADC_SC3, AVGE, adc.SC3)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.SC3, ADC_SC3, CAL, adc.SC3)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.SC3, ADC_SC3, CALF, adc.SC3)
-    result.SC3.has_AVGS = true;
-    result.SC3.AVGS = (teensy__3_1_adc_R_SC3_E_AVGS)(adc.SC3 & 0x3);
+    codec::decode(adc.SC3, SC3_FIELDS, result.SC3);
 
     result.has_OFS = true;
     result.OFS = adc.OFS;
 
     result.has_PGA = true;
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.PGA, ADC_PGA, PGAEN, adc.PGA)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.PGA, ADC_PGA, PGALPB, adc.PGA)
-    result.PGA.has_PGAG = true;
-    result.PGA.PGAG = (teensy__3_1_adc_R_PGA_E_PGAG)((adc.PGA >> 16) & 0xF);
+    codec::decode(adc.PGA, PGA_FIELDS, result.PGA);
 
     result.has_CLM0 = true;
     result.CLM0 = adc.CLM0;
@@ -134,36 +142,15 @@ namespace adc {
     // Cast buffer as ADC_REGISTERS Protocol Buffer message.
 
     if (adc_msg.has_SC1B) {
-      uint32_t SC1B = adc.SC1B;
-
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.SC1B, ADC_SC1, AIEN, SC1B)
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.SC1B, ADC_SC1, COCO, SC1B)
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.SC1B, ADC_SC1, DIFF, SC1B)
-      PB_UPDATE_TEENSY_REG_BITS(adc_msg.SC1B, 5, 0, ADCH, SC1B)
-      adc.SC1B = SC1B;
+      adc.SC1B = codec::encode(adc_msg.SC1B, SC1_FIELDS, adc.SC1B);
     }
 
     if (adc_msg.has_CFG1) {
-      uint32_t CFG1 = adc.CFG1;
-
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.CFG1, ADC_CFG1, ADLPC, CFG1)
-      PB_UPDATE_TEENSY_REG_BITS(adc_msg.CFG1, 2, 5, ADIV, CFG1)
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.CFG1, ADC_CFG1, ADLSMP, CFG1)
-      PB_UPDATE_TEENSY_REG_BITS(adc_msg.CFG1, 2, 2, MODE, CFG1)
-      PB_UPDATE_TEENSY_REG_BITS(adc_msg.CFG1, 2, 0, ADICLK, CFG1)
-
-      adc.CFG1 = CFG1;
+      adc.CFG1 = codec::encode(adc_msg.CFG1, CFG1_FIELDS, adc.CFG1);
     }
 
     if (adc_msg.has_CFG2) {
-      uint32_t CFG2 = adc.CFG2;
-
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.CFG2, ADC_CFG2, MUXSEL, CFG2)
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.CFG2, ADC_CFG2, ADACKEN, CFG2)
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.CFG2, ADC_CFG2, ADHSC, CFG2)
-      PB_UPDATE_TEENSY_REG_BITS(adc_msg.CFG2, 2, 0, ADLSTS, CFG2)
-
-      adc.CFG2 = CFG2;
+      adc.CFG2 = codec::encode(adc_msg.CFG2, CFG2_FIELDS, adc.CFG2);
     }
 
     if (adc_msg.has_RA) { adc.RA = adc_msg.RA; }
@@ -172,42 +159,17 @@ namespace adc {
     if (adc_msg.has_CV2) { adc.CV2 = adc_msg.CV2; }
 
     if (adc_msg.has_SC2) {
-      uint32_t SC2 = adc.SC2;
-
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.SC2, ADC_SC2, ADACT, SC2)
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.SC2, ADC_SC2, ADTRG, SC2)
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.SC2, ADC_SC2, ACFE, SC2)
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.SC2, ADC_SC2, ACFGT, SC2)
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.SC2, ADC_SC2, ACREN, SC2)
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.SC2, ADC_SC2, DMAEN, SC2)
-      PB_UPDATE_TEENSY_REG_BITS(adc_msg.SC2, 2, 0, REFSEL, SC2)
-
-      adc.SC2 = SC2;
+      adc.SC2 = codec::encode(adc_msg.SC2, SC2_FIELDS, adc.SC2);
     }
 
     if (adc_msg.has_SC3) {
-      uint32_t SC3 = adc.SC3;
-
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.SC3, ADC_SC3, CAL, SC3)
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.SC3, ADC_SC3, CALF, SC3)
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.SC3, ADC_SC3, ADCO, SC3)
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.SC3, ADC_SC3, AVGE, SC3)
-      PB_UPDATE_TEENSY_REG_BITS(adc_msg.SC3, 2, 0, AVGS, SC3)
-
-      adc.SC3 = SC3;
+      adc.SC3 = codec::encode(adc_msg.SC3, SC3_FIELDS, adc.SC3);
     }
 
     if (adc_msg.has_OFS) { adc.OFS = adc_msg.OFS; }
 
-    adc_msg.has_PGA = true;
     if (adc_msg.has_PGA) {
-      uint32_t PGA = adc.PGA;
-
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.PGA, ADC_PGA, PGAEN, PGA)
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.PGA, ADC_PGA, PGALPB, PGA)
-      PB_UPDATE_TEENSY_REG_BITS(adc_msg.PGA, 4, 16, PGAG, PGA)
-
-      adc.PGA = PGA;
+      adc.PGA = codec::encode(adc_msg.PGA, PGA_FIELDS, adc.PGA);
     }
 
     if (adc_msg.has_CLM0) { adc.CLM0 = adc_msg.CLM0; }
@@ -228,12 +190,7 @@ namespace adc {
     if (adc_msg.has_PG) { adc.PG = adc_msg.PG; }
 
     if (adc_msg.has_SC1A) {
-      uint32_t SC1A = adc.SC1A;
-
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.SC1A, ADC_SC1, AIEN, SC1A)
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.SC1A, ADC_SC1, COCO, SC1A)
-      PB_UPDATE_TEENSY_REG_BIT(adc_msg.SC1A, ADC_SC1, DIFF, SC1A)
-      PB_UPDATE_TEENSY_REG_BITS(adc_msg.SC1A, 5, 0, ADCH, SC1A)
+      const uint32_t SC1A = codec::encode(adc_msg.SC1A, SC1_FIELDS, adc.SC1A);
 
       __disable_irq();
       adc.SC1A = SC1A;
@@ -242,5 +199,21 @@ namespace adc {
 
     return 0;
   }
+
+  UInt8Array snapshot_registers(uint8_t adc_num, UInt8Array buffer) {
+    const volatile uint32_t *registers = (adc_num ? &ADC1_SC1A : &ADC0_SC1A);
+    const uint8_t count = sizeof(AdcRegister_t) / sizeof(uint32_t);
+    const uint8_t RA_INDEX = offsetof(AdcRegister_t, RA) / sizeof(uint32_t);
+    UInt8Array output = buffer;
+    output.length = 0;
+    if (buffer.length < sizeof(AdcRegister_t)) { return output; }
+
+    uint32_t *words = (uint32_t *)buffer.data;
+    for (uint8_t i = 0; i < count; i++) {
+      words[i] = ((i == RA_INDEX) || (i == RA_INDEX + 1)) ? 0 : registers[i];
+    }
+    output.length = sizeof(AdcRegister_t);
+    return output;
+  }
 }  // namespace adc
 }  // namespace teensy
@@ -5,7 +5,7 @@
 #include <CArrayDefs.h>  // UInt8Array
 #include <pb_cpp_api.h>  // nanopb::serialize_to_array
 #include <TeensyMinimalRpc/ADC_pb.h>
-#include <TeensyMinimalRpc/RegisterMacros.h>
+#include <TeensyMinimalRpc/RegisterCodec.h>
 
 
 namespace teensy {
@@ -42,6 +42,16 @@ namespace adc {
   };
 
   UInt8Array serialize_registers(uint8_t adc_num, UInt8Array buffer);
+  /* Copy raw `AdcRegister_t` register file of ADC \a adc_num to \a buffer,
+   * without decoding any field (see `serialize_registers`).
+   *
+   * `RA` and `RB` are reported as 0, since reading a result register clears
+   * its conversion complete flag (i.e., the DMA request of a running
+   * acquisition).
+   *
+   * Returns view of \a buffer holding the registers (empty if \a buffer is
+   * too small). */
+  UInt8Array snapshot_registers(uint8_t adc_num, UInt8Array buffer);
   int8_t update_registers(uint8_t adc_num, UInt8Array serialized_registers);
 }  // namespace adc
 }  // namespace teensy
@@ -0,0 +1,366 @@
+#include <string.h>
+#include "AdcSampler.h"
+#include "DMA.h"
+
+namespace teensy {
+namespace adc {
+  bool pdb_divide_settings(uint32_t sample_rate_hz, uint32_t &pdb_config,
+                           uint16_t &pdb_mod) {
+    // Multiplication factors selected by `PDB_SC_MULT(0..3)` (35.3.1/751).
+    static const uint8_t MULTS[] = {1, 10, 20, 40};
+
+    if (sample_rate_hz == 0) { return false; }
+    // Number of bus clock ticks per sample.
+    const uint32_t ticks = F_BUS / sample_rate_hz;
+    if (ticks == 0) { return false; }
+
+    uint32_t best_divide = 0;
+    for (uint8_t mult = 0; mult < sizeof(MULTS); mult++) {
+      for (uint8_t prescaler = 0; prescaler < 8; prescaler++) {
+        const uint32_t divide = MULTS[mult] << prescaler;
+        const uint32_t mod = (ticks + divide / 2) / divide;
+        if ((mod < 1) || (mod > 0x10000)) { continue; }
+        if (best_divide && (divide >= best_divide)) { continue; }
+        best_divide = divide;
+        // Counter runs from 0 to `PDB0_MOD` (inclusive).
+        pdb_mod = mod - 1;
+        pdb_config = (PDB_SC_TRGSEL(15)  // Software trigger
+                      | PDB_SC_PDBEN  // Enable PDB
+                      | PDB_SC_CONT  // Continuous
+                      | PDB_SC_LDMOD(0)
+                      | PDB_SC_PRESCALER(prescaler)
+                      | PDB_SC_MULT(mult)
+                      | PDB_SC_DMAEN  // Enable DMA
+                      | PDB_SC_LDOK);  // Load all new values
+      }
+    }
+    return best_divide > 0;
+  }
+
+
+  bool minor_loop_scatter_layout(uint16_t channel_count,
+                                 uint16_t block_samples,
+                                 ScatterLayout &layout) {
+    if ((channel_count == 0) || (block_samples == 0)) { return false; }
+    // Smallest power of two that is greater or equal to `channel_count`.
+    uint16_t width = 1;
+    uint8_t log2_width = 0;
+    while (width < channel_count) { width <<= 1; log2_width++; }
+
+    uint32_t stride = block_samples;
+    if ((channel_count > 1) && (channel_count & 0x1)) {
+      /* Find stride such that `channel_count * stride` is congruent to
+       * `channel_count + 1` modulo `width`, i.e., the combined offset
+       * returns the source to the start of the circular scan buffer.  A
+       * solution always exists, since `channel_count` is odd and `width` is a
+       * power of two. */
+      uint32_t stride0 = 0;
+      while ((channel_count * stride0) % width !=
+             (channel_count + 1u) % width) { stride0++; }
+      stride = stride0;
+      if (stride < block_samples) {
+        stride += width * ((block_samples - stride + width - 1) / width);
+      }
+      layout.scan_width = channel_count;
+      layout.source_offset = true;
+    } else {
+      layout.scan_width = width;
+      layout.source_offset = false;
+    }
+    // Scan buffer is twice the width (in bytes) of the power-of-two width.
+    layout.scan_modulo = log2_width + 1;
+
+    const uint32_t minor_bytes = layout.scan_width * sizeof(uint16_t);
+    const uint32_t channel_bytes = stride * sizeof(uint16_t);
+    // `NBYTES` is 10 bits, `DOFF` is signed 16 bits, `MLOFF` is signed 20
+    // bits, and `CITER` is 15 bits (21.3.22/418).
+    if ((minor_bytes > 0x3FF) || (channel_bytes > INT16_MAX) ||
+        (layout.scan_width * channel_bytes > (1UL << 19)) ||
+        (block_samples > 0x7FFF)) {
+      return false;
+    }
+    layout.channel_stride = stride;
+    return true;
+  }
+
+
+  AdcSampler::AdcSampler()
+    : adc_number_(0), dma_scatter_(0), dma_channel_configs_(1),
+      dma_conversion_(2), sample_count_(0), continuous_(false),
+      pdb_config_(0), pdb_mod_(0) {
+    scan_result_ = UInt16Array_init_default();
+    channel_sc1as_ = UInt32Array_init_default();
+    samples_ = UInt16Array_init_default();
+    tcds_ = UInt8Array_init_default();
+  }
+
+  int8_t AdcSampler::configure(UInt8Array channel_sc1as, uint16_t sample_count,
+                               uint32_t sample_rate_hz, uint8_t adc_number,
+                               UInt8Array dma_channels, bool continuous) {
+    // Major loop count of conversion DMA channel is limited to 9 bits when
+    // channel linking is enabled (21.3.26/421).
+    if ((channel_sc1as.length == 0) || (channel_sc1as.length > 0x1FF) ||
+        (sample_count == 0) || (adc_number > 1) ||
+        (continuous && (sample_count & 0x1))) {
+      return -1;
+    }
+    ScatterLayout layout;
+    if (!minor_loop_scatter_layout(channel_sc1as.length,
+                                   continuous ? sample_count / 2
+                                   : sample_count, layout)) {
+      return -1;
+    }
+
+    uint8_t channels[3] = {0, 1, 2};
+    if (dma_channels.length == 3) {
+      memcpy(channels, dma_channels.data, sizeof(channels));
+    } else if (dma_channels.length != 0) {
+      return -1;
+    }
+    for (uint8_t i = 0; i < 3; i++) {
+      if ((channels[i] >= DMA_NUM_CHANNELS) ||
+          (channels[i] == channels[(i + 1) % 3])) {
+        return -1;
+      }
+    }
+
+    uint32_t pdb_config;
+    uint16_t pdb_mod;
+    if (!pdb_divide_settings(sample_rate_hz, pdb_config, pdb_mod)) {
+      return -2;
+    }
+
+    deallocate();
+    adc_number_ = adc_number;
+    dma_scatter_ = channels[0];
+    dma_channel_configs_ = channels[1];
+    dma_conversion_ = channels[2];
+    sample_count_ = sample_count;
+    continuous_ = continuous;
+    layout_ = layout;
+    pdb_config_ = pdb_config;
+    pdb_mod_ = pdb_mod;
+
+    if (!allocate(channel_sc1as.length)) {
+      deallocate();
+      return -3;
+    }
+    for (uint16_t i = 0; i < channel_sc1as.length; i++) {
+      channel_sc1as_.data[i] = channel_sc1as.data[i];
+    }
+    reset();
+
+    // Enable PDB clock (DMA and ADC clocks should already be enabled).
+    SIM_SCGC6 |= SIM_SCGC6_PDB;
+    // Enable minor loop mapping, required for scatter minor loop offsets.
+    DMA_CR |= DMA_CR_EMLM;
+
+    configure_adc();
+    configure_timer();
+    configure_dma_channel_scatter();
+    configure_dma_channel_adc_channel_configs();
+    configure_dma_channel_adc_conversion();
+    configure_dma_mux();
+    return 0;
+  }
+
+  int8_t AdcSampler::set_sample_rate(uint32_t sample_rate_hz) {
+    if (!pdb_divide_settings(sample_rate_hz, pdb_config_, pdb_mod_)) {
+      return -2;
+    }
+    configure_timer();
+    return 0;
+  }
+
+  bool AdcSampler::allocate(uint16_t channel_count) {
+    const uint32_t scan_bytes = 1UL << layout_.scan_modulo;
+    const uint32_t sample_count = ((uint32_t)block_count() *
+                                   layout_.scan_width *
+                                   layout_.channel_stride);
+
+    // Results from single ADC scan.
+    // __N.B.,__ Scan results are read as a circular buffer (i.e., source
+    // address modulo), so must be aligned to a 0-modulo-size address.
+    scan_result_ = UInt16Array_init(channel_count,
+                                    (uint16_t *)aligned_malloc(scan_bytes,
+                                                               scan_bytes));
+    // Padding entries (see `ScatterLayout::scan_width`) must read as zero.
+    if (scan_result_.data != NULL) {
+      memset(scan_result_.data, 0, scan_bytes);
+    }
+    // __N.B.,__ Channel `SC1A` configurations are copied by DMA using 32-bit
+    // transfers, so must be aligned to 0-modulo-4 address.
+    channel_sc1as_ =
+      UInt32Array_init(channel_count,
+                       (uint32_t *)aligned_malloc(sizeof(uint32_t),
+                                                  channel_count *
+                                                  sizeof(uint32_t)));
+    // Sample buffer for each ADC channel (see `ScatterLayout`).
+    samples_ = UInt16Array_init(sample_count,
+                                (uint16_t *)calloc(sample_count,
+                                                   sizeof(uint16_t)));
+    // One scatter transfer control descriptor per block.
+    // __N.B.,__ Transfer control descriptors are 32 bytes each and MUST be
+    // aligned to 0-modulo-32 address.
+    tcds_ = UInt8Array_init(block_count() * sizeof(tcd_t),
+                            (uint8_t *)aligned_malloc(32, block_count() *
+                                                      sizeof(tcd_t)));
+    return (scan_result_.data != NULL) && (channel_sc1as_.data != NULL) &&
+      (samples_.data != NULL) && (tcds_.data != NULL);
+  }
+
+  void AdcSampler::deallocate() {
+    if (configured()) {
+      // Disable DMA requests before releasing memory used by the channels.
+      DMA_CERQ = dma_channel_configs_;
+      DMA_CERQ = dma_conversion_;
+    }
+    aligned_free(scan_result_.data);
+    free(samples_.data);
+    aligned_free(channel_sc1as_.data);
+    aligned_free(tcds_.data);
+    scan_result_ = UInt16Array_init_default();
+    channel_sc1as_ = UInt32Array_init_default();
+    samples_ = UInt16Array_init_default();
+    tcds_ = UInt8Array_init_default();
+  }
+
+  void AdcSampler::reset() {
+    mem_fill(scan_result_.data, (uint16_t)0, scan_result_.length);
+    mem_fill(samples_.data, (uint16_t)0, samples_.length);
+  }
+
+  void AdcSampler::rewind() {
+    if (!configured()) { return; }
+    configure_dma_channel_adc_channel_configs();
+    configure_dma_channel_adc_conversion();
+    memcpy((void *)&dma::TCD(dma_scatter_), tcds_.data, sizeof(tcd_t));
+  }
+
+  void AdcSampler::configure_adc() {
+    // Select `b` input for ADC MUX (31.3.3/658).
+    volatile uint32_t &CFG2 = adc_number_ ? ADC1_CFG2 : ADC0_CFG2;
+    // Assert ADC DMA request on each conversion complete (31.3.6/661).
+    volatile uint32_t &SC2 = adc_number_ ? ADC1_SC2 : ADC0_SC2;
+
+    CFG2 |= ADC_CFG2_MUXSEL;
+    SC2 |= ADC_SC2_DMAEN;
+  }
+
+  void AdcSampler::configure_timer() {
+    // Set PDB DMA request to occur when IDLY is equal to CNT + 1.
+    PDB0_IDLY = 1;
+    // __N.B.,__ Loaded on next write of `PDB_SC_LDOK` (i.e., on start).
+    PDB0_MOD = pdb_mod_;
+  }
+
+  void AdcSampler::configure_dma_channel_scatter() {
+    const uint16_t block_samples = block_sample_count();
+    // Number of bytes copied from scan result buffer by each minor loop.
+    const int32_t N = layout_.scan_width * sizeof(uint16_t);
+    const int32_t DOFF = layout_.channel_stride * sizeof(uint16_t);
+    /* After each scan, move destination from the end of the last channel
+     * array back to the next sample of the first channel array (see
+     * `minor_loop_scatter_layout`). */
+    const int32_t MLOFF = sizeof(uint16_t) - layout_.scan_width * DOFF;
+    tcd_t *tcds = reinterpret_cast<tcd_t *>(tcds_.data);
+
+    for (uint8_t i = 0; i < block_count(); i++) {
+      tcd_t &tcd = tcds[i];
+
+      memset((void *)&tcd, 0, sizeof(tcd_t));
+      // Copy from `scan_result` circular buffer.
+      tcd.SADDR = scan_result_.data;
+      tcd.SOFF = sizeof(uint16_t);
+      tcd.ATTR = (DMA_TCD_ATTR_SMOD(layout_.scan_modulo) |
+                  DMA_TCD_ATTR_SSIZE(DMA_TCD_ATTR_SIZE_16BIT) |
+                  DMA_TCD_ATTR_DSIZE(DMA_TCD_ATTR_SIZE_16BIT));
+      tcd.NBYTES_MLOFFYES = ((layout_.source_offset ? DMA_TCD_NBYTES_SMLOE
+                              : 0)
+                             | DMA_TCD_NBYTES_DMLOE
+                             | DMA_TCD_NBYTES_MLOFFYES_MLOFF(MLOFF)
+                             | DMA_TCD_NBYTES_MLOFFYES_NBYTES(N));
+      tcd.SLAST = 0;
+      // Strided copy to next `samples` location of each analog input channel
+      // (within the current block).
+      tcd.DADDR = (samples_.data + i * layout_.scan_width *
+                   layout_.channel_stride);
+      tcd.DOFF = DOFF;
+      tcd.CITER = block_samples;
+      tcd.BITER = block_samples;
+      /* After block is filled, load TCD for next block (addresses are
+       * reloaded from the next TCD, so `SLAST` is not used). */
+      tcd.DLASTSGA = (int32_t)&tcds[(i + 1) % block_count()];
+      // Trigger major loop interrupt each time a block is filled.
+      tcd.CSR = DMA_TCD_CSR_ESG | DMA_TCD_CSR_INTMAJOR;
+    }
+    // Load initial TCD to scatter DMA channel.
+    memcpy((void *)&dma::TCD(dma_scatter_), tcds_.data, sizeof(tcd_t));
+  }
+
+  void AdcSampler::configure_dma_channel_adc_channel_configs() {
+    const uint16_t channel_count = channel_sc1as_.length;
+    volatile tcd_t &tcd = dma::TCD(dma_channel_configs_);
+
+    tcd.CSR = 0;
+    tcd.SADDR = channel_sc1as_.data;
+    tcd.SOFF = sizeof(uint32_t);
+    tcd.ATTR = (DMA_TCD_ATTR_SSIZE(DMA_TCD_ATTR_SIZE_32BIT) |
+                DMA_TCD_ATTR_DSIZE(DMA_TCD_ATTR_SIZE_32BIT));
+    tcd.NBYTES = sizeof(uint32_t);  // `SC1A` register is 4 bytes (32-bit)
+    tcd.SLAST = -(int32_t)(channel_count * sizeof(uint32_t));
+    tcd.DADDR = adc_number_ ? &ADC1_SC1A : &ADC0_SC1A;
+    tcd.DOFF = 0;
+    tcd.CITER = channel_count;
+    tcd.BITER = channel_count;
+    tcd.DLASTSGA = 0;
+  }
+
+  void AdcSampler::configure_dma_channel_adc_conversion() {
+    const uint16_t channel_count = scan_result_.length;
+    volatile tcd_t &tcd = dma::TCD(dma_conversion_);
+    /* Link to channel configs DMA channel after each conversion (i.e., minor
+     * loop) to start conversion of next channel in scan (21.3.26/421). */
+    const uint16_t citer = ((1 << 15)  // `ELINK`
+                            | ((dma_channel_configs_ & 0xF) << 9)  // `LINKCH`
+                            | channel_count);  // `CITER`
+
+    tcd.CSR = 0;
+    tcd.SADDR = adc_number_ ? &ADC1_RA : &ADC0_RA;
+    tcd.SOFF = 0;
+    tcd.ATTR = (DMA_TCD_ATTR_SSIZE(DMA_TCD_ATTR_SIZE_16BIT) |
+                DMA_TCD_ATTR_DSIZE(DMA_TCD_ATTR_SIZE_16BIT));
+    tcd.NBYTES = sizeof(uint16_t);
+    tcd.SLAST = 0;
+    tcd.DADDR = scan_result_.data;
+    tcd.DOFF = sizeof(uint16_t);
+    // **N.B.,** `CITER` must initially be set to the same value as `BITER`.
+    tcd.CITER = citer;
+    tcd.BITER = citer;
+    tcd.DLASTSGA = -(int32_t)(channel_count * sizeof(uint16_t));
+    // Start scatter DMA channel after completion of each scan (i.e., major
+    // loop).
+    tcd.CSR = DMA_TCD_CSR_MAJORELINK | DMA_TCD_CSR_MAJORLINKCH(dma_scatter_);
+  }
+
+  void AdcSampler::configure_dma_mux() {
+    volatile uint8_t *CHCFG = &DMAMUX0_CHCFG0;
+
+    // Scatter channel is only started through channel linking.
+    CHCFG[dma_scatter_] = 0;
+    // Route ADC conversion complete as conversion DMA channel source.
+    CHCFG[dma_conversion_] = 0;
+    CHCFG[dma_conversion_] = ((adc_number_ ? DMAMUX_SOURCE_ADC1
+                               : DMAMUX_SOURCE_ADC0) | DMAMUX_ENABLE);
+    // Route PDB as channel configs DMA channel source.
+    CHCFG[dma_channel_configs_] = 0;
+    CHCFG[dma_channel_configs_] = DMAMUX_SOURCE_PDB | DMAMUX_ENABLE;
+
+    // DMA request input signals and this enable request flag must be
+    // asserted before a channel's hardware service request is accepted
+    // (21.3.3/394).
+    DMA_SERQ = dma_conversion_;
+    DMA_SERQ = dma_channel_configs_;
+  }
+}  // namespace adc
+}  // namespace teensy
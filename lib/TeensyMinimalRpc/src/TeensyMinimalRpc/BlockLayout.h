@@ -0,0 +1,66 @@
+#ifndef ___BLOCK_LAYOUT__H___
+#define ___BLOCK_LAYOUT__H___
+
+#include <stdint.h>
+#include <CArrayDefs.h>  // UInt8Array
+
+
+namespace teensy_minimal_rpc {
+
+/*
+ * Layout of the channels of a block of `uint16_t` samples (e.g., a filled
+ * half of a continuous acquisition buffer), as read by each block
+ * processing stage (`FirDecimator`, `BlockStatistics`, `RiceEncoder`).
+ *
+ * Sample `i` of channel `c` is read from `c * channel_stride + i *
+ * sample_stride` (in samples) within the block, e.g.:
+ *
+ *  - `AdcSampler` (per-channel arrays): `channel_stride` is the sampler
+ *    channel stride and `sample_stride` is 1.
+ *  - `DualAdcSampler` (interleaved): `channel_stride` is 1 and
+ *    `sample_stride` is the number of channels.
+ */
+struct BlockLayout {
+  uint16_t channel_count;  // 0: not configured.
+  uint16_t sample_count;  // Number of samples per channel.
+  uint16_t channel_stride;
+  uint16_t sample_stride;
+
+  /* Layout of \a sample_count samples of each channel stored consecutively
+   * (e.g., `FirDecimator` output). */
+  static BlockLayout channel_major(uint16_t channel_count,
+                                   uint16_t sample_count) {
+    BlockLayout layout = {channel_count, sample_count, sample_count, 1};
+    return layout;
+  }
+
+  /* Returns `true` if there is at least one sample of one channel, and
+   * distinct samples (and channels) do not overlap, i.e., the samples of
+   * each channel all lie before those of the next channel (e.g., per-channel
+   * arrays), or the channels of each sample all lie before those of the
+   * next sample (i.e., interleaved). */
+  bool valid() const {
+    if ((channel_count == 0) || (sample_count == 0) || (sample_stride == 0)) {
+      return false;
+    }
+    return ((channel_count == 1) ||
+            (channel_stride >= (sample_count - 1) * (uint32_t)sample_stride +
+             1) ||
+            ((channel_stride > 0) &&
+             (sample_stride >= (channel_count - 1) * (uint32_t)channel_stride +
+              1)));
+  }
+  /* Number of samples a block must hold to contain every sample of every
+   * channel. */
+  uint32_t span() const {
+    return ((channel_count - 1) * (uint32_t)channel_stride +
+            (sample_count - 1) * (uint32_t)sample_stride + 1);
+  }
+  bool fits(UInt8Array block) const {
+    return block.length / sizeof(uint16_t) >= span();
+  }
+};
+
+}  // namespace teensy_minimal_rpc
+
+#endif  // #ifndef ___BLOCK_LAYOUT__H___
@@ -0,0 +1,143 @@
+#ifndef ___BLOCK_STATISTICS__H___
+#define ___BLOCK_STATISTICS__H___
+
+#include <stdint.h>
+#include <string.h>
+#include <CArrayDefs.h>  // UInt8Array
+#include <TeensyMinimalRpc/BlockLayout.h>
+#include <TeensyMinimalRpc/RootMeanSquare.hpp>
+
+
+namespace teensy_minimal_rpc {
+
+// Maximum number of channels reduced by `BlockStatistics`.
+const uint16_t BLOCK_STATISTICS_MAX_CHANNELS = 32;
+
+/*
+ * Header of record produced by `BlockStatistics::reduce`, followed by one
+ * `ChannelStatistics` entry per channel.
+ */
+struct BlockStatisticsHeader {
+  uint64_t timestamp;  // Block completion time (CPU cycles).
+  /* Number of blocks reduced since `configure` (i.e., a gap shows up as a
+   * skipped index). */
+  uint32_t block_index;
+  uint16_t channel_count;
+  uint16_t sample_count;  // Number of samples per channel.
+} __attribute__((packed));
+
+struct ChannelStatistics {
+  float mean;
+  float variance;  // Mean of squared deviations from `mean`.
+  float rms;  // Root mean square of samples (i.e., *not* mean-subtracted).
+  uint16_t min;
+  uint16_t max;
+  uint16_t peak_to_peak;  // `max - min`.
+} __attribute__((packed));
+
+
+/*
+ * Reduce each block of `uint16_t` samples (e.g., a filled half of a
+ * continuous acquisition buffer), laid out as `layout_` (see
+ * `BlockLayout`), to a compact record of per-channel statistics, to be sent
+ * instead of the raw samples.
+ *
+ * Each channel is reduced in a single pass, accumulating the sum and sum of
+ * squares in integers (see `rms::Sums`).  Mean, variance, and RMS are then
+ * derived exactly from the sums, so, unlike a running `float` mean, the
+ * result does not depend on sample order or lose precision for long blocks.
+ */
+class BlockStatistics {
+public:
+  BlockLayout layout_;
+  uint32_t block_index_;
+  uint8_t record_[sizeof(BlockStatisticsHeader) +
+                  BLOCK_STATISTICS_MAX_CHANNELS * sizeof(ChannelStatistics)];
+
+  BlockStatistics() : layout_(), block_index_(0) {}
+
+  bool enabled() const { return layout_.channel_count > 0; }
+  uint32_t record_size() const {
+    return (sizeof(BlockStatisticsHeader) +
+            layout_.channel_count * sizeof(ChannelStatistics));
+  }
+
+  /* Returns 0 on success, or -1 on invalid layout. */
+  int8_t configure(const BlockLayout &layout) {
+    if (!layout.valid() ||
+        (layout.channel_count > BLOCK_STATISTICS_MAX_CHANNELS)) {
+      return -1;
+    }
+    layout_ = layout;
+    block_index_ = 0;
+    return 0;
+  }
+  void disable() { layout_.channel_count = 0; }
+
+  static void reduce_channel(const uint16_t *data, uint16_t count,
+                             uint16_t stride, ChannelStatistics &result) {
+    // Cannot overflow, since `count < 2^16`.
+    uint32_t sum = 0;
+    uint64_t sum_squared = 0;
+    uint16_t min = 0xFFFF;
+    uint16_t max = 0;
+
+    for (uint16_t i = 0; i < count; i++, data += stride) {
+      const uint32_t data_i = *data;
+      sum += data_i;
+      sum_squared += data_i * data_i;
+      if (data_i < min) { min = data_i; }
+      if (data_i > max) { max = data_i; }
+    }
+
+    const rms::Sums sums = {sum, sum_squared, count};
+    result.mean = rms::mean(sums);
+    result.variance = rms::variance(sums);
+    result.rms = rms::rms(sums);
+    result.min = min;
+    result.max = max;
+    result.peak_to_peak = max - min;
+  }
+
+  /* Returns statistics record (see `BlockStatisticsHeader`) of \a block,
+   * which stays valid until the next call, or an empty array if the block
+   * is too small for the configured layout. */
+  UInt8Array reduce(UInt8Array block, uint64_t timestamp) {
+    return reduce(block, timestamp, layout_);
+  }
+  /* Same as above, for blocks laid out as \a layout (with the configured
+   * number of channels) instead of the configured layout (e.g.,
+   * `FirDecimator` output). */
+  UInt8Array reduce(UInt8Array block, uint64_t timestamp,
+                    const BlockLayout &layout) {
+    UInt8Array output = UInt8Array_init_default();
+    if (!enabled() || (layout.channel_count != layout_.channel_count) ||
+        !layout.valid() || !layout.fits(block)) {
+      return output;
+    }
+
+    BlockStatisticsHeader header;
+    header.timestamp = timestamp;
+    header.block_index = block_index_++;
+    header.channel_count = layout.channel_count;
+    header.sample_count = layout.sample_count;
+    memcpy(record_, &header, sizeof(header));
+
+    const uint16_t *samples = (const uint16_t *)block.data;
+    ChannelStatistics *channels =
+      (ChannelStatistics *)(record_ + sizeof(header));
+    for (uint16_t i = 0; i < layout.channel_count; i++) {
+      ChannelStatistics result;
+      reduce_channel(samples + i * (uint32_t)layout.channel_stride,
+                     layout.sample_count, layout.sample_stride, result);
+      memcpy(&channels[i], &result, sizeof(result));
+    }
+    output.data = record_;
+    output.length = record_size();
+    return output;
+  }
+};
+
+}  // namespace teensy_minimal_rpc
+
+#endif  // #ifndef ___BLOCK_STATISTICS__H___
@@ -0,0 +1,79 @@
+#ifndef ___BULK_WRITER__H___
+#define ___BULK_WRITER__H___
+
+#include <stdint.h>
+#include <string.h>
+#include <CArrayDefs.h>  // UInt8Array
+#include <TeensyMinimalRpc/Crc32.h>
+
+
+namespace teensy_minimal_rpc {
+
+/* Result of a bulk write (see `BulkWriter::finish`). */
+struct BulkWriteResult {
+  uint32_t crc;  // CRC-32 of whole region (see `crc32`).
+  uint32_t received_bytes;  // Number of bytes written.
+  uint32_t error_count;  // Number of chunks rejected.
+};
+
+
+/*
+ * Write a region of memory from numbered chunks sent back-to-back by the
+ * host (i.e., without waiting for each chunk to be acknowledged).
+ *
+ * Each chunk must have the next sequence number and must fit within the
+ * region; other chunks are rejected and counted as errors.  Once all chunks
+ * are sent, `finish` computes the CRC-32 of the whole region, so the host
+ * can check the result with a single acknowledgment.
+ */
+class BulkWriter {
+public:
+  uint8_t *address_;
+  uint32_t size_;
+  uint16_t next_sequence_;
+  bool active_;
+  BulkWriteResult result_;
+  crc32_func_t crc32_;  // Computes `BulkWriteResult::crc`.
+
+  BulkWriter()
+    : address_(NULL), size_(0), next_sequence_(0), active_(false),
+      crc32_(crc32) {
+    memset(&result_, 0, sizeof(result_));
+  }
+
+  void begin(uint8_t *address, uint32_t size) {
+    address_ = address;
+    size_ = size;
+    next_sequence_ = 0;
+    active_ = true;
+    memset(&result_, 0, sizeof(result_));
+  }
+
+  /* Write \a data at \a offset within region.
+   *
+   * Returns `false` if no bulk write is active, if \a sequence is not the
+   * next sequence number, or if the chunk does not fit within the region. */
+  bool write(uint16_t sequence, uint32_t offset, UInt8Array data) {
+    if (!active_ || (sequence != next_sequence_) || (offset > size_) ||
+        (data.length > size_ - offset)) {
+      result_.error_count++;
+      return false;
+    }
+    memcpy(address_ + offset, data.data, data.length);
+    result_.received_bytes += data.length;
+    next_sequence_++;
+    return true;
+  }
+
+  const BulkWriteResult &finish() {
+    if (active_) {
+      result_.crc = crc32_(address_, size_);
+      active_ = false;
+    }
+    return result_;
+  }
+};
+
+}  // namespace teensy_minimal_rpc
+
+#endif  // #ifndef ___BULK_WRITER__H___
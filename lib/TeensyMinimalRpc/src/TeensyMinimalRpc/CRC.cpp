@@ -0,0 +1,53 @@
+#include "CRC.h"
+
+namespace teensy {
+namespace crc {
+  static dma::MemoryEngine *dma_engine = NULL;
+
+  /* Set polynomial, control configuration, and seed. */
+  static void configure(uint32_t polynomial, uint32_t ctrl, uint32_t seed) {
+    CRC_CTRL = ctrl | CTRL_WAS;
+    CRC_GPOLY = polynomial;
+    CRC_CRC = seed;
+    CRC_CTRL = ctrl;
+  }
+
+  void begin() { SIM_SCGC6 |= SIM_SCGC6_CRC; }
+
+  void set_dma_engine(dma::MemoryEngine *engine) { dma_engine = engine; }
+
+  void start_crc32() {
+    /* Reflected input and output are implemented by transposing the bits
+     * and bytes of each write and of the result.  Each 32-bit write then
+     * processes its bytes in memory (i.e., little-endian) order. */
+    configure(0x04C11DB7, (CTRL_TOT_BITS_BYTES | CTRL_TOTR_BITS_BYTES |
+                           CTRL_FXOR | CTRL_TCRC), 0xFFFFFFFF);
+  }
+
+  void start_crc16() {
+    configure(0x8005, CTRL_TOT_BITS_BYTES | CTRL_TOTR_BITS_BYTES, 0);
+  }
+
+  void update_cpu(const uint8_t *data, uint32_t size) {
+    // 8-bit writes to the lowest byte of `CRC_CRC` process a single byte.
+    volatile uint8_t &crc_8 = *(volatile uint8_t *)&CRC_CRC;
+
+    for (; size > 0 && ((uint32_t)data & 0x3); size--) { crc_8 = *data++; }
+    const uint32_t *words = (const uint32_t *)data;
+    for (; size >= sizeof(uint32_t); size -= sizeof(uint32_t)) {
+      CRC_CRC = *words++;
+    }
+    data = (const uint8_t *)words;
+    for (; size > 0; size--) { crc_8 = *data++; }
+  }
+
+  bool update_dma(const uint8_t *data, uint32_t size) {
+    if ((dma_engine == NULL) ||
+        (dma_engine->write_register(&CRC_CRC, data, size) != 0)) {
+      return false;
+    }
+    dma_engine->wait();
+    return true;
+  }
+}  // namespace crc
+}  // namespace teensy
@@ -0,0 +1,74 @@
+#ifndef ___TEENSY__CRC__H___
+#define ___TEENSY__CRC__H___
+
+#include <stdint.h>
+#include <kinetis.h>
+#include <TeensyMinimalRpc/DmaMemory.h>
+
+// Cyclic Redundancy Check (CRC) module registers.
+#ifndef CRC_CRC
+#define CRC_CRC (*(volatile uint32_t *)0x40032000)  // CRC Data register
+#define CRC_GPOLY (*(volatile uint32_t *)0x40032004)  // CRC Polynomial
+#define CRC_CTRL (*(volatile uint32_t *)0x40032008)  // CRC Control register
+#endif  // #ifndef CRC_CRC
+
+
+namespace teensy {
+namespace crc {
+  // `CRC_CTRL` fields.
+  const uint32_t CTRL_TOT_BITS_BYTES = 2UL << 30;  // Transpose writes.
+  const uint32_t CTRL_TOTR_BITS_BYTES = 2UL << 28;  // Transpose reads.
+  const uint32_t CTRL_FXOR = 1UL << 26;  // Complement read result.
+  const uint32_t CTRL_WAS = 1UL << 25;  // Write `CRC_CRC` as seed.
+  const uint32_t CTRL_TCRC = 1UL << 24;  // 32-bit CRC (otherwise 16-bit).
+
+  /* Buffers of at least this many bytes are fed to the CRC module by DMA
+   * (see `set_dma_engine`); smaller buffers are written by the CPU. */
+  const uint32_t DMA_MIN_SIZE = 1024;
+
+  /* Enable the CRC module clock (`SIM_SCGC6_CRC`). */
+  void begin();
+  /* Feed large buffers to the CRC module using \a engine (`NULL` to always
+   * use the CPU).  If \a engine is busy, the CPU is used instead. */
+  void set_dma_engine(dma::MemoryEngine *engine);
+
+  /* Reset the CRC module for CRC-32 (IEEE 802.3, same as `zlib.crc32`). */
+  void start_crc32();
+  /* Reset the CRC module for CRC-16/ARC (polynomial `0x8005`, reflected,
+   * initial value 0). */
+  void start_crc16();
+  /* Write \a size bytes at \a data to the CRC module with the CPU, using
+   * 32-bit writes for the word-aligned part of the buffer. */
+  void update_cpu(const uint8_t *data, uint32_t size);
+  /* Write \a size bytes at \a data to the CRC module by DMA and wait for
+   * completion.
+   *
+   * Returns `false` (nothing written) if no DMA engine is available. */
+  bool update_dma(const uint8_t *data, uint32_t size);
+  /* Write \a size bytes at \a data to the CRC module, by DMA for large
+   * buffers. */
+  inline void update(const uint8_t *data, uint32_t size) {
+    if ((size < DMA_MIN_SIZE) || !update_dma(data, size)) {
+      update_cpu(data, size);
+    }
+  }
+  inline uint32_t crc32_result() { return CRC_CRC; }
+  // With transposed reads, the 16-bit result is in the upper half.
+  inline uint16_t crc16_result() { return CRC_CRC >> 16; }
+
+  /* CRC-32 of \a size bytes at \a data (same as software
+   * `teensy_minimal_rpc::crc32`). */
+  inline uint32_t crc32(const uint8_t *data, uint32_t size) {
+    start_crc32();
+    update(data, size);
+    return crc32_result();
+  }
+  inline uint16_t crc16(const uint8_t *data, uint32_t size) {
+    start_crc16();
+    update(data, size);
+    return crc16_result();
+  }
+}  // namespace crc
+}  // namespace teensy
+
+#endif  // #ifndef ___TEENSY__CRC__H___
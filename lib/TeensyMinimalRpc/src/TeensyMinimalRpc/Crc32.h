@@ -0,0 +1,26 @@
+#ifndef ___CRC32__H___
+#define ___CRC32__H___
+
+#include <stdint.h>
+
+
+namespace teensy_minimal_rpc {
+
+/*
+ * Update CRC-32 (IEEE 802.3, i.e., same as `zlib.crc32`/`binascii.crc32`)
+ * \a crc with \a size bytes at \a data.
+ *
+ * Use 0 as initial \a crc.
+ */
+uint32_t crc32_update(uint32_t crc, const uint8_t *data, uint32_t size);
+
+inline uint32_t crc32(const uint8_t *data, uint32_t size) {
+  return crc32_update(0, data, size);
+}
+
+/* CRC-32 function, e.g., `crc32` or hardware `teensy::crc::crc32`. */
+typedef uint32_t (*crc32_func_t)(const uint8_t *data, uint32_t size);
+
+}  // namespace teensy_minimal_rpc
+
+#endif  // #ifndef ___CRC32__H___
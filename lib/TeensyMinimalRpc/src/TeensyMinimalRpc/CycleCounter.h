@@ -0,0 +1,46 @@
+#ifndef ___CYCLE_COUNTER__H___
+#define ___CYCLE_COUNTER__H___
+
+#include <stdint.h>
+#include <kinetis.h>  // ARM_DEMCR, ARM_DWT_CTRL, ARM_DWT_CYCCNT
+
+
+namespace teensy_minimal_rpc {
+
+/*
+ * CPU cycle counter (DWT `CYCCNT`), extended to 64 bits.
+ *
+ * The 32-bit hardware counter wraps every `2^32 / F_CPU` seconds (e.g., ~60 s
+ * at 72 MHz), so `read` must be called at least once per wrap period (e.g.,
+ * from the main loop) to keep track of the upper 32 bits.
+ *
+ * `read` may be called from both interrupt and main loop contexts.
+ */
+class CycleCounter {
+public:
+  uint32_t last_;
+  uint32_t high_;
+
+  CycleCounter() : last_(0), high_(0) {}
+
+  void begin() {
+    ARM_DEMCR |= ARM_DEMCR_TRCENA;  // Enable trace (required for DWT).
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+  }
+
+  uint64_t read() {
+    uint32_t primask;
+    __asm__ volatile("mrs %0, primask" : "=r" (primask));
+    __disable_irq();
+    const uint32_t now = ARM_DWT_CYCCNT;
+    if (now < last_) { high_++; }  // Counter wrapped since last read.
+    last_ = now;
+    const uint64_t result = ((uint64_t)high_ << 32) | now;
+    if (!primask) { __enable_irq(); }
+    return result;
+  }
+};
+
+}  // namespace teensy_minimal_rpc
+
+#endif  // #ifndef ___CYCLE_COUNTER__H___
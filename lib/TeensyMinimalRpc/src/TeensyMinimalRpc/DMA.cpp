@@ -2,107 +2,167 @@
 
 namespace teensy {
 namespace dma {
+  /* Register field tables (see `codec::Field`), in order of Protocol Buffer
+   * field tags. */
+  // (16 bits) TCD Transfer Attributes 21.3.19/416, source byte (`ATTR_SRC`)
+  constexpr codec::Field TCD_ATTR_SRC_FIELDS[] = {
+    PB_REGISTER_BITS(teensy__3_1_dma_R_TCD_ATTR, 5, 3, SMOD),
+    PB_REGISTER_BITS(teensy__3_1_dma_R_TCD_ATTR, 3, 0, SSIZE),
+  };
+  // ... and destination byte (`ATTR_DST`)
+  constexpr codec::Field TCD_ATTR_DST_FIELDS[] = {
+    PB_REGISTER_BITS(teensy__3_1_dma_R_TCD_ATTR, 5, 3, DMOD),
+    PB_REGISTER_BITS(teensy__3_1_dma_R_TCD_ATTR, 3, 0, DSIZE),
+  };
+  // (32 bits) TCD Signed Minor Loop Offset (Minor Loop Enabled and Offset Disabled) 21.3.21/417
+  constexpr codec::Field TCD_NBYTES_MLOFFNO_FIELDS[] = {
+    PB_REGISTER_BIT(teensy__3_1_dma_R_TCD_NBYTES_MLOFFNO, DMA_TCD_NBYTES, SMLOE),
+    PB_REGISTER_BIT(teensy__3_1_dma_R_TCD_NBYTES_MLOFFNO, DMA_TCD_NBYTES, DMLOE),
+    PB_REGISTER_BITS(teensy__3_1_dma_R_TCD_NBYTES_MLOFFNO, 30, 0, NBYTES),
+  };
+  // (32 bits) TCD Signed Minor Loop Offset (Minor Loop and Offset Enabled) 21.3.22/418
+  constexpr codec::Field TCD_NBYTES_MLOFFYES_FIELDS[] = {
+    PB_REGISTER_BIT(teensy__3_1_dma_R_TCD_NBYTES_MLOFFYES, DMA_TCD_NBYTES, SMLOE),
+    PB_REGISTER_BIT(teensy__3_1_dma_R_TCD_NBYTES_MLOFFYES, DMA_TCD_NBYTES, DMLOE),
+    PB_REGISTER_BITS(teensy__3_1_dma_R_TCD_NBYTES_MLOFFYES, 20, 10, MLOFF),
+    PB_REGISTER_BITS(teensy__3_1_dma_R_TCD_NBYTES_MLOFFYES, 10, 0, NBYTES),
+  };
+  // (16 bits) TCD Current/Beginning Minor Loop Link, Major Loop Count (Channel Linking Enabled) 21.3.26/421
+  constexpr codec::Field TCD_ITER_ELINKYES_FIELDS[] = {
+    PB_REGISTER_BIT(teensy__3_1_dma_R_TCD_ITER_ELINKYES, DMA_TCD_CITER, ELINK),
+    PB_REGISTER_BITS(teensy__3_1_dma_R_TCD_ITER_ELINKYES, 4, 9, LINKCH),
+    PB_REGISTER_BITS(teensy__3_1_dma_R_TCD_ITER_ELINKYES, 9, 0, ITER),
+  };
+  // (16 bits) TCD Current/Beginning Minor Loop Link, Major Loop Count (Channel Linking Disabled) 21.3.27/422
+  constexpr codec::Field TCD_ITER_ELINKNO_FIELDS[] = {
+    PB_REGISTER_BIT(teensy__3_1_dma_R_TCD_ITER_ELINKNO, DMA_TCD_CITER, ELINK),
+    PB_REGISTER_BITS(teensy__3_1_dma_R_TCD_ITER_ELINKNO, 15, 0, ITER),
+  };
+  // (16 bits) TCD Control and Status 21.3.29/424
+  constexpr codec::Field TCD_CSR_FIELDS[] = {
+    PB_REGISTER_BITS(teensy__3_1_dma_R_TCD_CSR, 2, 14, BWC),
+    PB_REGISTER_BITS(teensy__3_1_dma_R_TCD_CSR, 4, 8, MAJORLINKCH),
+    PB_REGISTER_BIT(teensy__3_1_dma_R_TCD_CSR, DMA_TCD_CSR, DONE),
+    PB_REGISTER_BIT(teensy__3_1_dma_R_TCD_CSR, DMA_TCD_CSR, ACTIVE),
+    PB_REGISTER_BIT(teensy__3_1_dma_R_TCD_CSR, DMA_TCD_CSR, MAJORELINK),
+    PB_REGISTER_BIT(teensy__3_1_dma_R_TCD_CSR, DMA_TCD_CSR, ESG),
+    PB_REGISTER_BIT(teensy__3_1_dma_R_TCD_CSR, DMA_TCD_CSR, DREQ),
+    PB_REGISTER_BIT(teensy__3_1_dma_R_TCD_CSR, DMA_TCD_CSR, INTHALF),
+    PB_REGISTER_BIT(teensy__3_1_dma_R_TCD_CSR, DMA_TCD_CSR, INTMAJOR),
+  };
+  /* `START` must be written after every other `CSR` field (see
+   * `update_TCD`). */
+  constexpr codec::Field TCD_CSR_START_FIELDS[] = {
+    PB_REGISTER_BIT(teensy__3_1_dma_R_TCD_CSR, DMA_TCD_CSR, START),
+  };
+  // (32 bits) Control Register 21.3.1/391
+  constexpr codec::Field CR_FIELDS[] = {
+    PB_REGISTER_BIT(teensy__3_1_dma_R_CR, DMA_CR, CX),  // Cancel Transfer
+    PB_REGISTER_BIT(teensy__3_1_dma_R_CR, DMA_CR, ECX),  // Error Cancel Transfer
+    PB_REGISTER_BIT(teensy__3_1_dma_R_CR, DMA_CR, EMLM),  // Enable Minor Loop Mapping
+    PB_REGISTER_BIT(teensy__3_1_dma_R_CR, DMA_CR, CLM),  // Continuous Link Mode
+    PB_REGISTER_BIT(teensy__3_1_dma_R_CR, DMA_CR, HALT),  // Halt DMA Operations
+    PB_REGISTER_BIT(teensy__3_1_dma_R_CR, DMA_CR, HOE),  // Halt On Error
+    PB_REGISTER_BIT(teensy__3_1_dma_R_CR, DMA_CR, ERCA),  // Enable Round Robin Channel Arbitration
+    PB_REGISTER_BIT(teensy__3_1_dma_R_CR, DMA_CR, EDBG),  // Enable Debug
+  };
+  // (32 bits) Error Status Register 21.3.2/393
+  constexpr codec::Field ES_FIELDS[] = {
+    PB_REGISTER_BITS(teensy__3_1_dma_R_ES, 1, 31, VLD),  // Logical OR of all ERR status bits
+    PB_REGISTER_BITS(teensy__3_1_dma_R_ES, 1, 16, ECX),  // Transfer Cancelled
+    PB_REGISTER_BITS(teensy__3_1_dma_R_ES, 1, 14, CPE),  // Channel Priority Error
+    PB_REGISTER_BITS(teensy__3_1_dma_R_ES, 4, 8, ERRCHN),  // Error Channel Number or Cancelled Channel Number
+    PB_REGISTER_BITS(teensy__3_1_dma_R_ES, 1, 7, SAE),  // Source Address Error
+    PB_REGISTER_BITS(teensy__3_1_dma_R_ES, 1, 6, SOE),  // Source Offset Error
+    PB_REGISTER_BITS(teensy__3_1_dma_R_ES, 1, 5, DAE),  // Destination Address Error
+    PB_REGISTER_BITS(teensy__3_1_dma_R_ES, 1, 4, DOE),  // Destination Offset Error
+    PB_REGISTER_BITS(teensy__3_1_dma_R_ES, 1, 3, NCE),  // NBYTES/CITER Configuration Error
+    PB_REGISTER_BITS(teensy__3_1_dma_R_ES, 1, 2, SGE),  // Scatter/Gather Configuration Error
+    PB_REGISTER_BITS(teensy__3_1_dma_R_ES, 1, 1, SBE),  // Source Bus Error
+    PB_REGISTER_BITS(teensy__3_1_dma_R_ES, 1, 0, DBE),  // Destination Bus Error
+  };
+  // (8 bits) Channel n Priority Register 21.3.16/414
+  constexpr codec::Field DCHPRI_FIELDS[] = {
+    PB_REGISTER_BIT(teensy__3_1_dma_DCHPRI, DMA_DCHPRI, ECP),  // Enable PreEmption
+    PB_REGISTER_BIT(teensy__3_1_dma_DCHPRI, DMA_DCHPRI, DPA),  // Disable PreEmpt Ability
+    PB_REGISTER_BITS(teensy__3_1_dma_DCHPRI, 4, 0, CHPRI),  // Channel Arbitration Priority
+  };
+  // (8 bits) Channel Configuration register (DMAMUX_CHCFGn) (20.3.1/366)
+  constexpr codec::Field MUX_CHCFG_FIELDS[] = {
+    PB_REGISTER_BITS(teensy__3_1_dma_MUX_CHCFG, 1, 7, ENBL),  // DMA Channel Enable
+    PB_REGISTER_BITS(teensy__3_1_dma_MUX_CHCFG, 1, 6, TRIG),  // DMA Channel Trigger Enable
+    PB_REGISTER_BITS(teensy__3_1_dma_MUX_CHCFG, 6, 0, SOURCE),  // DMA Channel Source (Slot)
+  };
+
   teensy__3_1_dma_TCD TCD_to_protobuf(uint8_t channel_num) {
-    // __NB__ Transfer control descriptor (TCD) range starts at address of
-    // `DMA_TCD0_SADDR`.
-    volatile DMABaseClass::TCD_t &tcd =
-      *(reinterpret_cast<volatile DMABaseClass::TCD_t *>(&DMA_TCD0_SADDR) +
-        channel_num);
+    volatile DMABaseClass::TCD_t &tcd = TCD(channel_num);
     // Create empty DMA Registers Protocol Buffer message.
     teensy__3_1_dma_TCD result = teensy__3_1_dma_TCD_init_default;
     // (32 bits) TCD Source Address 21.3.17/415
     result.has_SADDR = true;
-    result.SADDR = (uint32_t)tcd.SADDR;
+    result.SADDR = (uint32_t)(uintptr_t)tcd.SADDR;
     // (16 bits) TCD Signed Source Address Offset 21.3.18/415
     result.has_SOFF = true;
     result.SOFF = (uint32_t)tcd.SOFF;
     // (16 bits) TCD Transfer Attributes 21.3.19/416
     result.has_ATTR = true;
-    PB_SET_TEENSY_REG_BITS_FROM_VAL(result.ATTR, 5, 3, SMOD, tcd.ATTR_SRC, uint32_t)
-    PB_SET_TEENSY_REG_BITS_FROM_VAL(result.ATTR, 3, 0, SSIZE, tcd.ATTR_SRC, teensy__3_1_dma_R_TCD_ATTR_E_SIZE)
-    PB_SET_TEENSY_REG_BITS_FROM_VAL(result.ATTR, 5, 3, DMOD, tcd.ATTR_DST, uint32_t)
-    PB_SET_TEENSY_REG_BITS_FROM_VAL(result.ATTR, 3, 0, DSIZE, tcd.ATTR_DST, teensy__3_1_dma_R_TCD_ATTR_E_SIZE)
+    codec::decode(tcd.ATTR_SRC, TCD_ATTR_SRC_FIELDS, result.ATTR);
+    codec::decode(tcd.ATTR_DST, TCD_ATTR_DST_FIELDS, result.ATTR);
     if (!(DMA_CR & DMA_CR_EMLM)) {  // Enable Minor Loop Mapping
       // (32 bits) TCD Minor Byte Count (Minor Loop Disabled) 21.3.20/417
       result.has_NBYTES_MLNO = true;
       result.NBYTES_MLNO = tcd.NBYTES_MLNO;
+    } else if (!(tcd.NBYTES_MLOFFNO & (DMA_TCD_NBYTES_SMLOE |
+                                       DMA_TCD_NBYTES_DMLOE))) {
+      // (32 bits) TCD Signed Minor Loop Offset (Minor Loop Enabled and Offset Disabled) 21.3.21/417
+      result.has_NBYTES_MLOFFNO = true;
+      codec::decode(tcd.NBYTES_MLOFFNO, TCD_NBYTES_MLOFFNO_FIELDS,
+                    result.NBYTES_MLOFFNO);
     } else {
-      const bool SMLOE = (tcd.NBYTES_MLOFFNO >> 31) & 0x1;
-      const bool DMLOE = (tcd.NBYTES_MLOFFNO >> 30) & 0x1;
-
-      if (!SMLOE && !DMLOE) {
-        // (32 bits) TCD Signed Minor Loop Offset (Minor Loop Enabled and Offset Disabled) 21.3.21/417
-        result.has_NBYTES_MLOFFNO = true;
-        result.NBYTES_MLOFFNO.has_SMLOE = true;
-        result.NBYTES_MLOFFNO.SMLOE = false;
-        result.NBYTES_MLOFFNO.has_DMLOE = true;
-        result.NBYTES_MLOFFNO.DMLOE = false;
-        PB_SET_TEENSY_REG_BITS_FROM_VAL(result.NBYTES_MLOFFNO, 30, 0, NBYTES, tcd.NBYTES_MLOFFNO, uint32_t)
-      } else {
-        // (32 bits) TCD Signed Minor Loop Offset (Minor Loop and Offset Enabled) 21.3.22/418
-        result.has_NBYTES_MLOFFYES = true;
-        result.NBYTES_MLOFFYES.has_SMLOE = true;
-        result.NBYTES_MLOFFYES.SMLOE = SMLOE;
-        result.NBYTES_MLOFFYES.has_DMLOE = true;
-        result.NBYTES_MLOFFYES.DMLOE = DMLOE;
-        PB_SET_TEENSY_REG_BITS_FROM_VAL(result.NBYTES_MLOFFYES, 20, 10, MLOFF, tcd.NBYTES_MLOFFYES, uint32_t)
-        PB_SET_TEENSY_REG_BITS_FROM_VAL(result.NBYTES_MLOFFYES, 9, 0, NBYTES, tcd.NBYTES_MLOFFYES, uint32_t)
-      }
+      // (32 bits) TCD Signed Minor Loop Offset (Minor Loop and Offset Enabled) 21.3.22/418
+      result.has_NBYTES_MLOFFYES = true;
+      codec::decode(tcd.NBYTES_MLOFFYES, TCD_NBYTES_MLOFFYES_FIELDS,
+                    result.NBYTES_MLOFFYES);
     }
     // (32 bits) TCD Last Source Address Adjustment 21.3.23/420
     result.has_SLAST = true;
     result.SLAST = tcd.SLAST;
     // (32 bits) TCD Destination Address 21.3.24/420
     result.has_DADDR = true;
-    result.DADDR = (uint32_t)tcd.DADDR;
+    result.DADDR = (uint32_t)(uintptr_t)tcd.DADDR;
     // (16 bits) TCD Signed Destination Address Offset 21.3.25/421
     result.has_DOFF = true;
     result.DOFF = tcd.DOFF;
-    const bool citer_elink = (tcd.CITER_ELINKYES >> 15) & 0x01;
-    if (citer_elink) {
+    if (tcd.CITER_ELINKYES & DMA_TCD_CITER_ELINK) {
       // (16 bits) TCD Current Minor Loop Link, Major Loop Count (Channel Linking Enabled) 21.3.26/421
       result.has_CITER_ELINKYES = true;
-      result.CITER_ELINKYES.has_ELINK = true;
-      result.CITER_ELINKYES.ELINK = true;
-      PB_SET_TEENSY_REG_BITS_FROM_VAL(result.CITER_ELINKYES, 4, 9, LINKCH, tcd.CITER_ELINKYES, uint32_t)
-      PB_SET_TEENSY_REG_BITS_FROM_VAL(result.CITER_ELINKYES, 9, 0, ITER, tcd.CITER_ELINKYES, uint32_t)
+      codec::decode(tcd.CITER_ELINKYES, TCD_ITER_ELINKYES_FIELDS,
+                    result.CITER_ELINKYES);
     } else {
       // (16 bits) 21.3.27/422
       result.has_CITER_ELINKNO = true;
-      result.CITER_ELINKNO.has_ELINK = true;
-      result.CITER_ELINKNO.ELINK = false;
-      PB_SET_TEENSY_REG_BITS_FROM_VAL(result.CITER_ELINKNO, 15, 0, ITER, tcd.CITER_ELINKNO, uint32_t)
+      codec::decode(tcd.CITER_ELINKNO, TCD_ITER_ELINKNO_FIELDS,
+                    result.CITER_ELINKNO);
     }
     // (32 bits) TCD Last Destination Address Adjustment/Scatter Gather Address 21.3.28/423
     result.has_DLASTSGA = true;
     result.DLASTSGA = tcd.DLASTSGA;
     // (16 bits) TCD Control and Status 21.3.29/424
     result.has_CSR = true;
-    PB_SET_TEENSY_REG_BITS_FROM_VAL(result.CSR, 2, 14, BWC, tcd.CSR, teensy__3_1_dma_R_TCD_CSR_E_BWC)
-    PB_SET_TEENSY_REG_BITS_FROM_VAL(result.CSR, 4, 8, MAJORLINKCH, tcd.CSR, uint32_t)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.CSR, DMA_TCD_CSR, DONE, tcd.CSR)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.CSR, DMA_TCD_CSR, ACTIVE, tcd.CSR)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.CSR, DMA_TCD_CSR, MAJORELINK, tcd.CSR)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.CSR, DMA_TCD_CSR, ESG, tcd.CSR)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.CSR, DMA_TCD_CSR, DREQ, tcd.CSR)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.CSR, DMA_TCD_CSR, INTHALF, tcd.CSR)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.CSR, DMA_TCD_CSR, INTMAJOR, tcd.CSR)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.CSR, DMA_TCD_CSR, START, tcd.CSR)
-
-    const bool biter_elink = (tcd.BITER_ELINKYES >> 15) & 0x01;
-    if (biter_elink) {
+    const uint16_t CSR = tcd.CSR;
+    codec::decode(CSR, TCD_CSR_FIELDS, result.CSR);
+    codec::decode(CSR, TCD_CSR_START_FIELDS, result.CSR);
+
+    if (tcd.BITER_ELINKYES & DMA_TCD_BITER_ELINK) {
       // (16 bits) TCD Beginning Minor Loop Link, Major Loop Count (Channel Linking Enabled) 21.3.30/426
       result.has_BITER_ELINKYES = true;
-      result.BITER_ELINKYES.has_ELINK = true;
-      result.BITER_ELINKYES.ELINK = true;
-      PB_SET_TEENSY_REG_BITS_FROM_VAL(result.BITER_ELINKYES, 4, 9, LINKCH, tcd.BITER_ELINKYES, uint32_t)
-      PB_SET_TEENSY_REG_BITS_FROM_VAL(result.BITER_ELINKYES, 9, 0, ITER, tcd.BITER_ELINKYES, uint32_t)
+      codec::decode(tcd.BITER_ELINKYES, TCD_ITER_ELINKYES_FIELDS,
+                    result.BITER_ELINKYES);
     } else {
       // (16 bits) TCD Beginning Minor Loop Link, Major Loop Count (Channel Linking Disabled) 21.3.31/427
       result.has_BITER_ELINKNO = true;
-      result.BITER_ELINKNO.has_ELINK = true;
-      result.BITER_ELINKNO.ELINK = false;
-      PB_SET_TEENSY_REG_BITS_FROM_VAL(result.BITER_ELINKNO, 15, 0, ITER, tcd.BITER_ELINKNO, uint32_t)
+      codec::decode(tcd.BITER_ELINKNO, TCD_ITER_ELINKNO_FIELDS,
+                    result.BITER_ELINKNO);
     }
 
     return result;
@@ -117,32 +177,22 @@ namespace dma {
   }
 
   int8_t update_TCD(uint8_t channel_num, teensy__3_1_dma_TCD const &tcd_new) {
-    // __NB__ Transfer control descriptor (TCD) range starts at address of
-    // `DMA_TCD0_SADDR`.
-    volatile DMABaseClass::TCD_t &tcd =
-      *(reinterpret_cast<volatile DMABaseClass::TCD_t *>(&DMA_TCD0_SADDR) +
-        channel_num);
+    volatile DMABaseClass::TCD_t &tcd = TCD(channel_num);
 
     // (32 bits) TCD Source Address 21.3.17/415
-    if (tcd_new.has_SADDR) { tcd.SADDR = (const volatile void *)tcd_new.SADDR; }
+    if (tcd_new.has_SADDR) { tcd.SADDR = (const volatile void *)(uintptr_t)tcd_new.SADDR; }
     // (16 bits) TCD Signed Source Address Offset 21.3.18/415
     if (tcd_new.has_SOFF) { tcd.SOFF = (int16_t)tcd_new.SOFF; }
 
     // (16 bits) TCD Transfer Attributes 21.3.19/416
     if (tcd_new.has_ATTR) {
-      uint8_t ATTR = tcd.ATTR_SRC;
-
-      PB_UPDATE_TEENSY_REG_BITS(tcd_new.ATTR, 5, 3, SMOD, ATTR)
-      PB_UPDATE_TEENSY_REG_BITS(tcd_new.ATTR, 3, 0, SSIZE, ATTR)
       if (tcd_new.ATTR.has_SMOD || tcd_new.ATTR.has_SSIZE) {
-          tcd.ATTR_SRC = ATTR;
+        tcd.ATTR_SRC = codec::encode(tcd_new.ATTR, TCD_ATTR_SRC_FIELDS,
+                                     tcd.ATTR_SRC);
       }
-
-      ATTR = 0;
-      PB_UPDATE_TEENSY_REG_BITS(tcd_new.ATTR, 5, 3, DMOD, ATTR)
-      PB_UPDATE_TEENSY_REG_BITS(tcd_new.ATTR, 3, 0, DSIZE, ATTR)
       if (tcd_new.ATTR.has_DMOD || tcd_new.ATTR.has_DSIZE) {
-          tcd.ATTR_DST = ATTR;
+        tcd.ATTR_DST = codec::encode(tcd_new.ATTR, TCD_ATTR_DST_FIELDS,
+                                     tcd.ATTR_DST);
       }
     }
 
@@ -152,18 +202,12 @@ namespace dma {
              tcd_new.NBYTES_MLOFFNO.has_NBYTES) {
       // (32 bits) TCD Signed Minor Loop Offset (Minor Loop Enabled and Offset Disabled) 21.3.21/417
       tcd.NBYTES_MLOFFNO = tcd_new.NBYTES_MLOFFNO.NBYTES;
-    } else if (tcd_new.has_NBYTES_MLOFFYES) {
-      if (tcd_new.NBYTES_MLOFFYES.has_SMLOE) {
-        // (32 bits) TCD Signed Minor Loop Offset (Minor Loop and Offset Enabled) 21.3.22/418
-        uint32_t NBYTES = tcd.NBYTES_MLOFFYES;
-
-        PB_UPDATE_TEENSY_REG_BIT(tcd_new.NBYTES_MLOFFYES, DMA_TCD_NBYTES, SMLOE, NBYTES)
-        PB_UPDATE_TEENSY_REG_BIT(tcd_new.NBYTES_MLOFFYES, DMA_TCD_NBYTES, DMLOE, NBYTES)
-        PB_UPDATE_TEENSY_REG_BITS(tcd_new.NBYTES_MLOFFYES, 20, 10, MLOFF, NBYTES)
-        PB_UPDATE_TEENSY_REG_BITS(tcd_new.NBYTES_MLOFFYES, 10, 0, NBYTES, NBYTES)
-
-        tcd.NBYTES_MLOFFYES = NBYTES;
-      }
+    } else if (tcd_new.has_NBYTES_MLOFFYES &&
+               tcd_new.NBYTES_MLOFFYES.has_SMLOE) {
+      // (32 bits) TCD Signed Minor Loop Offset (Minor Loop and Offset Enabled) 21.3.22/418
+      tcd.NBYTES_MLOFFYES = codec::encode(tcd_new.NBYTES_MLOFFYES,
+                                          TCD_NBYTES_MLOFFYES_FIELDS,
+                                          tcd.NBYTES_MLOFFYES);
     }
     // (32 bits) TCD Last Source Address Adjustment 21.3.23/420
     if (tcd_new.has_SLAST) {
@@ -171,7 +215,7 @@ namespace dma {
     }
     // (32 bits) TCD Destination Address 21.3.24/420
     if (tcd_new.has_DADDR) {
-      tcd.DADDR = (volatile void *)tcd_new.DADDR;
+      tcd.DADDR = (volatile void *)(uintptr_t)tcd_new.DADDR;
     }
     // (16 bits) TCD Signed Destination Address Offset 21.3.25/421
     if (tcd_new.has_DOFF) {
@@ -180,21 +224,14 @@ namespace dma {
 
     if (tcd_new.has_CITER_ELINKYES) {
       // (16 bits) TCD Current Minor Loop Link, Major Loop Count (Channel Linking Enabled) 21.3.26/421
-      uint16_t CITER = tcd.CITER_ELINKYES;
-
-      PB_UPDATE_TEENSY_REG_BIT(tcd_new.CITER_ELINKYES, DMA_TCD_CITER, ELINK, CITER)
-      PB_UPDATE_TEENSY_REG_BITS(tcd_new.CITER_ELINKYES, 4, 9, LINKCH, CITER)
-      PB_UPDATE_TEENSY_REG_BITS(tcd_new.CITER_ELINKYES, 9, 0, ITER, CITER)
-
-      tcd.CITER_ELINKYES = CITER;  // Update hardware TCD register.
+      tcd.CITER_ELINKYES = codec::encode(tcd_new.CITER_ELINKYES,
+                                         TCD_ITER_ELINKYES_FIELDS,
+                                         tcd.CITER_ELINKYES);
     } else if (tcd_new.has_CITER_ELINKNO) {
       // (16 bits) 21.3.27/422
-      uint16_t CITER = tcd.CITER_ELINKNO;
-
-      PB_UPDATE_TEENSY_REG_BIT(tcd_new.CITER_ELINKNO, DMA_TCD_CITER, ELINK, CITER)
-      PB_UPDATE_TEENSY_REG_BITS(tcd_new.CITER_ELINKNO, 15, 0, ITER, CITER)
-
-      tcd.CITER_ELINKNO = CITER;  // Update hardware TCD register.
+      tcd.CITER_ELINKNO = codec::encode(tcd_new.CITER_ELINKNO,
+                                        TCD_ITER_ELINKNO_FIELDS,
+                                        tcd.CITER_ELINKNO);
     }
 
     // (32 bits) TCD Last Destination Address Adjustment/Scatter Gather Address 21.3.28/423
@@ -202,42 +239,27 @@ namespace dma {
 
     if (tcd_new.has_BITER_ELINKYES) {
       // (16 bits) TCD Beginning Minor Loop Link, Major Loop Count (Channel Linking Enabled) 21.3.30/426
-      uint16_t BITER = tcd.BITER_ELINKYES;
-
-      PB_UPDATE_TEENSY_REG_BIT(tcd_new.BITER_ELINKYES, DMA_TCD_BITER, ELINK, BITER)
-      PB_UPDATE_TEENSY_REG_BITS(tcd_new.BITER_ELINKYES, 4, 9, LINKCH, BITER)
-      PB_UPDATE_TEENSY_REG_BITS(tcd_new.BITER_ELINKYES, 9, 0, ITER, BITER)
-
-      tcd.BITER_ELINKYES = BITER;  // Update hardware TCD register.
+      tcd.BITER_ELINKYES = codec::encode(tcd_new.BITER_ELINKYES,
+                                         TCD_ITER_ELINKYES_FIELDS,
+                                         tcd.BITER_ELINKYES);
     } else if (tcd_new.has_BITER_ELINKNO) {
       // (16 bits) TCD Beginning Minor Loop Link, Major Loop Count (Channel Linking Disabled) 21.3.31/427
-      uint16_t BITER = tcd.BITER_ELINKNO;
-
-      PB_UPDATE_TEENSY_REG_BIT(tcd_new.BITER_ELINKNO, DMA_TCD_BITER, ELINK, BITER)
-      PB_UPDATE_TEENSY_REG_BITS(tcd_new.BITER_ELINKNO, 15, 0, ITER, BITER)
-
-      tcd.BITER_ELINKNO = BITER;  // Update hardware TCD register.
+      tcd.BITER_ELINKNO = codec::encode(tcd_new.BITER_ELINKNO,
+                                        TCD_ITER_ELINKNO_FIELDS,
+                                        tcd.BITER_ELINKNO);
     }
 
     // (16 bits) TCD Control and Status 21.3.29/424
     if (tcd_new.has_CSR) {
-      uint16_t CSR = tcd.CSR;
-
-      PB_UPDATE_TEENSY_REG_BITS(tcd_new.CSR, 2, 14, BWC, CSR)
-      PB_UPDATE_TEENSY_REG_BITS(tcd_new.CSR, 4, 8, MAJORLINKCH, CSR)
-      PB_UPDATE_TEENSY_REG_BIT(tcd_new.CSR, DMA_TCD_CSR, DONE, CSR)
-      PB_UPDATE_TEENSY_REG_BIT(tcd_new.CSR, DMA_TCD_CSR, ACTIVE, CSR)
-      PB_UPDATE_TEENSY_REG_BIT(tcd_new.CSR, DMA_TCD_CSR, MAJORELINK, CSR)
-      PB_UPDATE_TEENSY_REG_BIT(tcd_new.CSR, DMA_TCD_CSR, ESG, CSR)
-      PB_UPDATE_TEENSY_REG_BIT(tcd_new.CSR, DMA_TCD_CSR, DREQ, CSR)
-      PB_UPDATE_TEENSY_REG_BIT(tcd_new.CSR, DMA_TCD_CSR, INTHALF, CSR)
-      PB_UPDATE_TEENSY_REG_BIT(tcd_new.CSR, DMA_TCD_CSR, INTMAJOR, CSR)
+      const uint16_t CSR = codec::encode(tcd_new.CSR, TCD_CSR_FIELDS,
+                                         tcd.CSR);
       tcd.CSR = CSR;
 
       // **N.B.** Start bit *must* be set after *all other* fields are set,
       // since it will immediately trigger the transfer request.
-      PB_UPDATE_TEENSY_REG_BIT(tcd_new.CSR, DMA_TCD_CSR, START, tcd.CSR)
-      tcd.CSR = CSR;
+      if (tcd_new.CSR.has_START) {
+        tcd.CSR = codec::encode(tcd_new.CSR, TCD_CSR_START_FIELDS, CSR);
+      }
     }
     return 0;
   }
@@ -256,28 +278,9 @@ namespace dma {
     teensy__3_1_dma_Registers result = teensy__3_1_dma_Registers_init_default;
 
     result.has_CR = true;
-    PB_SET_TEENSY_REG_BIT(result.CR, DMA_CR, CX) // Cancel Transfer
-    PB_SET_TEENSY_REG_BIT(result.CR, DMA_CR, ECX) // Error Cancel Transfer
-    PB_SET_TEENSY_REG_BIT(result.CR, DMA_CR, EMLM) // Enable Minor Loop Mapping
-    PB_SET_TEENSY_REG_BIT(result.CR, DMA_CR, CLM) // Continuous Link Mode
-    PB_SET_TEENSY_REG_BIT(result.CR, DMA_CR, HALT) // Halt DMA Operations
-    PB_SET_TEENSY_REG_BIT(result.CR, DMA_CR, HOE) // Halt On Error
-    PB_SET_TEENSY_REG_BIT(result.CR, DMA_CR, ERCA) // Enable Round Robin Channel Arbitration
-    PB_SET_TEENSY_REG_BIT(result.CR, DMA_CR, EDBG) // Enable Debug
-
+    codec::decode(DMA_CR, CR_FIELDS, result.CR);
     result.has_ES = true;
-    PB_SET_TEENSY_BIT_FROM_VAL(result.ES, 31, VLD, DMA_ES) // Logical OR of all ERR status bits
-    PB_SET_TEENSY_BIT_FROM_VAL(result.ES, 16, ECX, DMA_ES) // Transfer Cancelled
-    PB_SET_TEENSY_BIT_FROM_VAL(result.ES, 14, CPE, DMA_ES) // Channel Priority Error
-    PB_SET_TEENSY_REG_BITS_FROM_VAL(result.ES, 4, 8, ERRCHN, DMA_ES, uint32_t) // Error Channel Number or Cancelled Channel Number
-    PB_SET_TEENSY_BIT_FROM_VAL(result.ES, 7, SAE, DMA_ES) // Source Address Error
-    PB_SET_TEENSY_BIT_FROM_VAL(result.ES, 6, SOE, DMA_ES) // Source Offset Error
-    PB_SET_TEENSY_BIT_FROM_VAL(result.ES, 5, DAE, DMA_ES) // Destination Address Error
-    PB_SET_TEENSY_BIT_FROM_VAL(result.ES, 4, DOE, DMA_ES) // Destination Offset Error
-    PB_SET_TEENSY_BIT_FROM_VAL(result.ES, 3, NCE, DMA_ES) // NBYTES/CITER Configuration Error
-    PB_SET_TEENSY_BIT_FROM_VAL(result.ES, 2, SGE, DMA_ES) // Scatter/Gather Configuration Error
-    PB_SET_TEENSY_BIT_FROM_VAL(result.ES, 1, SBE, DMA_ES) // Source Bus Error
-    PB_SET_TEENSY_BIT_FROM_VAL(result.ES, 0, DBE, DMA_ES) // Destination Bus Error
+    codec::decode(DMA_ES, ES_FIELDS, result.ES);
 
     result.has_ERQ = true; // (32 bits) Enable Request Register 21.3.3/394
     result.ERQ = (uint32_t)DMA_ERQ;
@@ -303,38 +306,9 @@ namespace dma {
 
   int8_t update_registers(teensy__3_1_dma_Registers const &dma_msg) {
     if (dma_msg.has_CR) {
-      uint32_t CR = DMA_CR;
-
-      PB_UPDATE_TEENSY_REG_BIT(dma_msg.CR, DMA_CR, CX, CR) // Cancel Transfer
-      PB_UPDATE_TEENSY_REG_BIT(dma_msg.CR, DMA_CR, ECX, CR) // Error Cancel Transfer
-      PB_UPDATE_TEENSY_REG_BIT(dma_msg.CR, DMA_CR, EMLM, CR) // Enable Minor Loop Mapping
-      PB_UPDATE_TEENSY_REG_BIT(dma_msg.CR, DMA_CR, CLM, CR) // Continuous Link Mode
-      PB_UPDATE_TEENSY_REG_BIT(dma_msg.CR, DMA_CR, HALT, CR) // Halt DMA Operations
-      PB_UPDATE_TEENSY_REG_BIT(dma_msg.CR, DMA_CR, HOE, CR) // Halt On Error
-      PB_UPDATE_TEENSY_REG_BIT(dma_msg.CR, DMA_CR, ERCA, CR) // Enable Round Robin Channel Arbitration
-      PB_UPDATE_TEENSY_REG_BIT(dma_msg.CR, DMA_CR, EDBG, CR) // Enable Debug
-
-      DMA_CR = CR;
-    }
-
-    if (dma_msg.has_ES) {
-      uint32_t ES = DMA_ES;
-
-      PB_UPDATE_TEENSY_BIT(dma_msg.ES, 31, VLD, ES) // Logical OR of all ERR status bits
-      PB_UPDATE_TEENSY_BIT(dma_msg.ES, 16, ECX, ES) // Transfer Cancelled
-      PB_UPDATE_TEENSY_BIT(dma_msg.ES, 14, CPE, ES) // Channel Priority Error
-      PB_UPDATE_TEENSY_REG_BITS(dma_msg.ES, 4, 8, ERRCHN, ES) // Error Channel Number or Cancelled Channel Number
-      PB_UPDATE_TEENSY_BIT(dma_msg.ES, 7, SAE, ES) // Source Address Error
-      PB_UPDATE_TEENSY_BIT(dma_msg.ES, 6, SOE, ES) // Source Offset Error
-      PB_UPDATE_TEENSY_BIT(dma_msg.ES, 5, DAE, ES) // Destination Address Error
-      PB_UPDATE_TEENSY_BIT(dma_msg.ES, 4, DOE, ES) // Destination Offset Error
-      PB_UPDATE_TEENSY_BIT(dma_msg.ES, 3, NCE, ES) // NBYTES/CITER Configuration Error
-      PB_UPDATE_TEENSY_BIT(dma_msg.ES, 2, SGE, ES) // Scatter/Gather Configuration Error
-      PB_UPDATE_TEENSY_BIT(dma_msg.ES, 1, SBE, ES) // Source Bus Error
-      PB_UPDATE_TEENSY_BIT(dma_msg.ES, 0, DBE, ES) // Destination Bus Error
-
-      DMA_CR = ES;
+      DMA_CR = codec::encode(dma_msg.CR, CR_FIELDS, DMA_CR);
     }
+    // Error Status Register (`ES`) is read-only.
 
     // (8 bits) Clear Enable Error Interrupt Register 21.3.5/399
     if (dma_msg.has_CEEI) { DMA_CEEI = (uint8_t)dma_msg.CEEI; }
@@ -378,20 +352,11 @@ namespace dma {
     return update_registers(dma_msg);
   }
 
-  inline volatile uint8_t *channel_to_dchpri_addr(uint8_t channel_num) {
-    return &DMA_DCHPRI3 + ((~channel_num) & 0x3) + (channel_num & 0xFC);
-  }
-
   teensy__3_1_dma_DCHPRI dchpri_to_protobuf(uint32_t channel_num) {
     // (8 bits) Channel n Priority Register 21.3.16/414
     teensy__3_1_dma_DCHPRI result = teensy__3_1_dma_DCHPRI_init_default;
 
-    volatile uint8_t &DCHPRI = *channel_to_dchpri_addr(channel_num);
-
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result, DMA_DCHPRI, ECP, DCHPRI)  // Enable PreEmption
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result, DMA_DCHPRI, DPA, DCHPRI)  // Disable PreEmpt Ability
-    PB_SET_TEENSY_REG_BITS_FROM_VAL(result, 4, 0, CHPRI, DCHPRI, uint32_t)  // Channel Arbitration Priority
-
+    codec::decode(*channel_to_dchpri_addr(channel_num), DCHPRI_FIELDS, result);
     return result;
   }
 
@@ -413,13 +378,7 @@ namespace dma {
     if (!ok) { return -1; }
 
     volatile uint8_t &DCHPRI = *channel_to_dchpri_addr(channel_num);
-    uint8_t dchpri = DCHPRI;
-
-    PB_UPDATE_TEENSY_REG_BIT(dchpri_msg, DMA_DCHPRI, ECP, dchpri)  // Enable PreEmption
-    PB_UPDATE_TEENSY_REG_BIT(dchpri_msg, DMA_DCHPRI, DPA, dchpri)  // Disable PreEmpt Ability
-    PB_UPDATE_TEENSY_REG_BITS(dchpri_msg, 4, 0, CHPRI, dchpri)  // Channel Arbitration Priority
-
-    DCHPRI = dchpri;
+    DCHPRI = codec::encode(dchpri_msg, DCHPRI_FIELDS, DCHPRI);
 
     return 0;
   }
@@ -430,11 +389,7 @@ namespace dma {
 
     volatile uint8_t &MUX_CHCFG = *((volatile uint8_t *)&(DMAMUX0_CHCFG0) +
                                     channel_num);
-
-    PB_SET_TEENSY_BIT_FROM_VAL(result, 7, ENBL, MUX_CHCFG)  // DMA Channel Enable (20.3.1/366)
-    PB_SET_TEENSY_BIT_FROM_VAL(result, 6, TRIG, MUX_CHCFG)  // DMA Channel Trigger Enable (20.3.1/366)
-    PB_SET_TEENSY_REG_BITS_FROM_VAL(result, 6, 0, SOURCE, MUX_CHCFG, uint32_t)  // DMA Channel Source (Slot) (20.3.1/366)
-
+    codec::decode(MUX_CHCFG, MUX_CHCFG_FIELDS, result);
     return result;
   }
 
@@ -450,14 +405,10 @@ namespace dma {
                           teensy__3_1_dma_MUX_CHCFG const &mux_chcfg_msg) {
     volatile uint8_t &MUX_CHCFG = *((volatile uint8_t *)&(DMAMUX0_CHCFG0) +
                                     channel_num);
-    uint8_t mux_chcfg = MUX_CHCFG;
+    const uint8_t mux_chcfg = codec::encode(mux_chcfg_msg, MUX_CHCFG_FIELDS,
+                                            MUX_CHCFG);
 
     MUX_CHCFG = 0;  // Disable channel during update, as required (20.3.1/366).
-
-    PB_UPDATE_TEENSY_BIT(mux_chcfg_msg, 7, ENBL, mux_chcfg)  // DMA Channel Enable (20.3.1/366)
-    PB_UPDATE_TEENSY_BIT(mux_chcfg_msg, 6, TRIG, mux_chcfg)  // DMA Channel Trigger Enable (20.3.1/366)
-    PB_UPDATE_TEENSY_REG_BITS(mux_chcfg_msg, 6, 0, SOURCE, mux_chcfg)  // DMA Channel Source (Slot) (20.3.1/366)
-
     MUX_CHCFG = mux_chcfg;
 
     return 0;
@@ -475,6 +426,43 @@ namespace dma {
     if (!ok) { return -1; }
     return update_mux_chcfg(channel_num, mux_chcfg_msg);
   }
+
+  UInt8Array snapshot_registers(UInt8Array buffer) {
+    UInt8Array output = buffer;
+    output.length = 0;
+    if (buffer.length < sizeof(RegistersSnapshot)) { return output; }
+
+    RegistersSnapshot snapshot;
+    snapshot.CR = DMA_CR;
+    snapshot.ES = DMA_ES;
+    snapshot.ERQ = DMA_ERQ;
+    snapshot.EEI = DMA_EEI;
+    snapshot.INT = DMA_INT;
+    snapshot.ERR = DMA_ERR;
+    snapshot.HRS = DMA_HRS;
+    for (uint8_t i = 0; i < DMA_NUM_CHANNELS; i++) {
+      snapshot.DCHPRI[i] = *channel_to_dchpri_addr(i);
+      snapshot.MUX_CHCFG[i] = *((volatile uint8_t *)&(DMAMUX0_CHCFG0) + i);
+    }
+    memcpy(buffer.data, &snapshot, sizeof(snapshot));
+    output.length = sizeof(snapshot);
+    return output;
+  }
+
+  UInt8Array snapshot_TCDs(uint8_t first_channel, uint8_t count,
+                           UInt8Array buffer) {
+    const size_t tcd_size = sizeof(DMABaseClass::TCD_t);
+    UInt8Array output = buffer;
+    output.length = 0;
+    if (first_channel >= DMA_NUM_CHANNELS) { return output; }
+    if (count > DMA_NUM_CHANNELS - first_channel) {
+      count = DMA_NUM_CHANNELS - first_channel;
+    }
+    if (count > buffer.length / tcd_size) { count = buffer.length / tcd_size; }
+    memcpy(buffer.data, (const void *)&TCD(first_channel), count * tcd_size);
+    output.length = count * tcd_size;
+    return output;
+  }
 }  // namespace dma
 }  // namespace teensy
 
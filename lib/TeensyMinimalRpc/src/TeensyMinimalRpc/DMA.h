@@ -5,19 +5,20 @@
 #include <CArrayDefs.h>  // UInt8Array
 #include <pb_cpp_api.h>  // nanopb::serialize_to_array
 #include <TeensyMinimalRpc/DMA_pb.h>
-#include <TeensyMinimalRpc/RegisterMacros.h>
+#include <TeensyMinimalRpc/RegisterCodec.h>
 
 
 namespace teensy {
 namespace dma {
-  inline void reset_TCD(uint8_t channel_num) {
-    const size_t tcd_size = sizeof(DMABaseClass::TCD_t);
+  inline volatile DMABaseClass::TCD_t &TCD(uint8_t channel_num) {
     // __NB__ Transfer control descriptor (TCD) range starts at address of
     // `DMA_TCD0_SADDR`.
-    volatile DMABaseClass::TCD_t &tcd =
-      *(reinterpret_cast<volatile DMABaseClass::TCD_t *>(&DMA_TCD0_SADDR) +
-        channel_num);
-    memset((void *)&tcd, 0, tcd_size);
+    return *(reinterpret_cast<volatile DMABaseClass::TCD_t *>(&DMA_TCD0_SADDR)
+             + channel_num);
+  }
+  inline void reset_TCD(uint8_t channel_num) {
+    const size_t tcd_size = sizeof(DMABaseClass::TCD_t);
+    memset((void *)&TCD(channel_num), 0, tcd_size);
   }
   teensy__3_1_dma_TCD TCD_to_protobuf(uint8_t channel_num);
   UInt8Array serialize_TCD(uint8_t channel_num, UInt8Array buffer);
@@ -36,8 +37,40 @@ namespace dma {
   int8_t update_mux_chcfg(uint32_t channel_num,
                           UInt8Array serialized_mux_chcfg);
 
+  /* `DCHPRI` registers are byte-reversed within each group of four
+   * channels (i.e., `DMA_DCHPRI3` comes first). */
+  inline volatile uint8_t *channel_to_dchpri_addr(uint8_t channel_num) {
+    return &DMA_DCHPRI3 + ((~channel_num) & 0x3) + (channel_num & 0xFC);
+  }
   teensy__3_1_dma_DCHPRI dchpri_to_protobuf(uint32_t channel_num);
   UInt8Array serialize_dchpri(uint32_t channel_num, UInt8Array buffer);
+  int8_t update_dchpri(uint32_t channel_num, UInt8Array serialized_dchpri);
+
+  /* Raw DMA controller and DMA mux registers (see `snapshot_registers`). */
+  struct RegistersSnapshot {
+    uint32_t CR;
+    uint32_t ES;
+    uint32_t ERQ;
+    uint32_t EEI;
+    uint32_t INT;
+    uint32_t ERR;
+    uint32_t HRS;
+    uint8_t DCHPRI[DMA_NUM_CHANNELS];  // Indexed by channel number.
+    uint8_t MUX_CHCFG[DMA_NUM_CHANNELS];
+  } __attribute__((packed));
+
+  /* Copy `RegistersSnapshot` of current register values to \a buffer,
+   * without decoding any field (see `serialize_registers`).
+   *
+   * Returns view of \a buffer holding the snapshot (empty if \a buffer is
+   * too small). */
+  UInt8Array snapshot_registers(UInt8Array buffer);
+  /* Copy raw transfer control descriptors of \a count channels starting at
+   * \a first_channel (as many as fit) to \a buffer.
+   *
+   * Returns view of \a buffer holding the descriptors. */
+  UInt8Array snapshot_TCDs(uint8_t first_channel, uint8_t count,
+                           UInt8Array buffer);
 }  // namespace dma
 }  // namespace teensy
 
@@ -0,0 +1,78 @@
+#ifndef ___DMA_ISR_TABLE__H___
+#define ___DMA_ISR_TABLE__H___
+
+#include <stdint.h>
+#include <kinetis.h>  // DMA_CINT
+#include <DMAChannel.h>  // DMA_NUM_CHANNELS
+
+
+namespace teensy_minimal_rpc {
+
+typedef void (*isr_t)(void);
+
+/* Actions taken by the interrupt handler of a DMA channel (bit flags, see
+ * `DmaIsrActions`). */
+enum DmaIsrAction {
+  DMA_ISR_STOP_PDB = 0x01,  // Stop PDB timer (i.e., end of capture).
+  DMA_ISR_CHAIN = 0x02,  // Enable requests of `chain_channel` (next capture).
+  DMA_ISR_PUSH_EVENT = 0x04,  // Push completion record to event ring.
+  DMA_ISR_PING_PONG = 0x08,  // Mark filled half of continuous buffer ready.
+  DMA_ISR_MEMORY = 0x10,  // Advance DMA memory transfer (`MemoryEngine`).
+  DMA_ISR_TRIGGER = 0x20,  // Advance triggered capture (`TriggeredCapture`).
+};
+
+/* Per-channel interrupt action descriptor. */
+struct DmaIsrActions {
+  uint8_t flags;  // Bitwise OR of `DmaIsrAction` values.
+  uint8_t chain_channel;  // DMA channel to enable for `DMA_ISR_CHAIN`.
+};
+
+
+template <uint8_t... Channels> struct DmaChannelSequence {};
+
+template <uint8_t N, uint8_t... Channels>
+struct MakeDmaChannelSequence
+  : MakeDmaChannelSequence<N - 1, N - 1, Channels...> {};
+
+template <uint8_t... Channels>
+struct MakeDmaChannelSequence<0, Channels...> {
+  typedef DmaChannelSequence<Channels...> type;
+};
+
+
+/*
+ * Table of DMA channel interrupt handlers, generated at compile time.
+ *
+ * `vectors[i]` is the handler for DMA channel `i`: it clears the interrupt
+ * request of the channel and calls `handler.on_dma_channel_done(i)`.  Since
+ * the channel number is a compile-time constant, `on_dma_channel_done` is
+ * inlined with a constant index into any per-channel state.
+ *
+ * Example:
+ *
+ *     Node node_obj;
+ *     const isr_t *dma_isr_vectors = DmaIsrTable<Node, node_obj>::vectors;
+ */
+template <typename Handler, Handler &handler,
+          typename Sequence =
+            typename MakeDmaChannelSequence<DMA_NUM_CHANNELS>::type>
+struct DmaIsrTable;
+
+template <typename Handler, Handler &handler, uint8_t... Channels>
+struct DmaIsrTable<Handler, handler, DmaChannelSequence<Channels...> > {
+  template <uint8_t Channel>
+  static void isr() {
+    DMA_CINT = Channel;
+    handler.on_dma_channel_done(Channel);
+  }
+
+  static const isr_t vectors[sizeof...(Channels)];
+};
+
+template <typename Handler, Handler &handler, uint8_t... Channels>
+const isr_t DmaIsrTable<Handler, handler, DmaChannelSequence<Channels...> >
+  ::vectors[sizeof...(Channels)] = {&isr<Channels>...};
+
+}  // namespace teensy_minimal_rpc
+
+#endif  // #ifndef ___DMA_ISR_TABLE__H___
@@ -0,0 +1,141 @@
+#include "DmaMemory.h"
+#include "DMA.h"
+
+namespace teensy {
+namespace dma {
+  int8_t MemoryEngine::set_channel(uint8_t channel) {
+    if (channel >= DMA_NUM_CHANNELS) { return -1; }
+    /* Enable DMA mux and DMA clocks, since this may be called (e.g., from
+     * `setup`) before any other DMA configuration; accessing a peripheral
+     * with its clock gated faults. */
+    SIM_SCGC6 |= SIM_SCGC6_DMAMUX;
+    SIM_SCGC7 |= SIM_SCGC7_DMA;
+    if (poll()) { return -2; }
+    channel_ = channel;
+    // Channel is only started by software requests (and self-linking).
+    (&DMAMUX0_CHCFG0)[channel_] = 0;
+    DMA_CERQ = channel_;
+    return 0;
+  }
+
+  int8_t MemoryEngine::copy(void *destination, const void *source,
+                            uint32_t size, bool notify) {
+    return start((uint8_t *)destination, (const uint8_t *)source, size,
+                 transfer_width((uintptr_t)destination, (uintptr_t)source,
+                                size), false, notify);
+  }
+
+  int8_t MemoryEngine::write_register(volatile void *address,
+                                      const void *source, uint32_t size) {
+    return start((uint8_t *)address, (const uint8_t *)source, size,
+                 transfer_width(0, (uintptr_t)source, size), true, false);
+  }
+
+  int8_t MemoryEngine::fill(void *destination, uint32_t value,
+                            uint8_t value_size, uint32_t count,
+                            bool notify) {
+    switch (value_size) {
+      case 1: value = (value & 0xFF) * 0x01010101; break;
+      case 2: value = (value & 0xFFFF) * 0x00010001; break;
+      case 4: break;
+      default: return -1;
+    }
+    if (poll()) { return -2; }
+    fill_value_ = value;
+    /* The source walks through the bytes of `fill_value_` as a 4-byte
+     * circular buffer (see `start_pass`), so any width lays the bytes of the
+     * value out in order. */
+    const uint32_t size = count * value_size;
+    return start((uint8_t *)destination, NULL, size,
+                 transfer_width((uintptr_t)destination, 0, size), false,
+                 notify);
+  }
+
+  int8_t MemoryEngine::start(uint8_t *destination, const uint8_t *source,
+                             uint32_t size, uint8_t width,
+                             bool fixed_destination, bool notify) {
+    if (!configured()) { return -1; }
+    if (poll()) { return -2; }
+    if (size == 0) { return 0; }
+    destination_ = destination;
+    source_ = source;
+    fixed_destination_ = fixed_destination;
+    notify_ = notify;
+    remaining_ = size;
+    width_ = width;
+    DMA_CERR = channel_;
+    busy_ = true;
+    start_pass();
+    return 0;
+  }
+
+  void MemoryEngine::start_pass() {
+    volatile tcd_t &tcd = TCD(channel_);
+    uint32_t nbytes = MINOR_LOOP_BYTES;
+    uint16_t iterations = 1;
+
+    if (remaining_ < MINOR_LOOP_BYTES) {
+      nbytes = remaining_;
+    } else {
+      const uint32_t minor_loops = remaining_ / MINOR_LOOP_BYTES;
+      iterations = ((minor_loops < MAX_LINKED_ITERATIONS) ? minor_loops
+                    : MAX_LINKED_ITERATIONS);
+    }
+    pass_size_ = nbytes * iterations;
+
+    /* Link to this channel after each minor loop, so the rest of the pass
+     * runs without further software requests (21.3.26/421). */
+    const uint16_t citer = ((1 << 15)  // `ELINK`
+                            | ((channel_ & 0xF) << 9)  // `LINKCH`
+                            | iterations);  // `CITER`
+    // `SSIZE`/`DSIZE` encoding: 0: 8-bit, 1: 16-bit, 2: 32-bit.
+    const uint8_t size_code = width_ >> 1;
+
+    tcd.CSR = 0;
+    if (source_ != NULL) {
+      tcd.SADDR = source_;
+      tcd.ATTR = (DMA_TCD_ATTR_SSIZE(size_code) |
+                  DMA_TCD_ATTR_DSIZE(size_code));
+    } else {
+      tcd.SADDR = &fill_value_;
+      // Wrap source address within the 4 bytes of `fill_value_`.
+      tcd.ATTR = (DMA_TCD_ATTR_SMOD(2) | DMA_TCD_ATTR_SSIZE(size_code) |
+                  DMA_TCD_ATTR_DSIZE(size_code));
+    }
+    tcd.SOFF = width_;
+    tcd.NBYTES = nbytes;
+    tcd.SLAST = 0;
+    tcd.DADDR = destination_;
+    tcd.DOFF = fixed_destination_ ? 0 : width_;
+    // **N.B.,** `CITER` must initially be set to the same value as `BITER`.
+    tcd.CITER = citer;
+    tcd.BITER = citer;
+    tcd.DLASTSGA = 0;
+    tcd.CSR = DMA_TCD_CSR_INTMAJOR | DMA_TCD_CSR_DREQ;
+    DMA_SSRT = channel_;
+  }
+
+  bool MemoryEngine::on_major_loop_done() {
+    if (!busy_) { return true; }
+    if (!fixed_destination_) { destination_ += pass_size_; }
+    if (source_ != NULL) { source_ += pass_size_; }
+    remaining_ -= pass_size_;
+    if (remaining_ > 0) {
+      start_pass();
+      return false;
+    }
+    transfer_count_++;
+    busy_ = false;
+    return true;
+  }
+
+  bool MemoryEngine::poll() {
+    if (busy_ && (DMA_ERR & (1 << channel_))) {
+      // The channel stops on error, so no major loop interrupt will follow.
+      busy_ = false;
+      error_count_++;
+    }
+    return busy_;
+  }
+}  // namespace dma
+}  // namespace teensy
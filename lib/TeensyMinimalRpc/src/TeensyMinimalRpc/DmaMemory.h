@@ -0,0 +1,111 @@
+#ifndef ___TEENSY__DMA_MEMORY__H___
+#define ___TEENSY__DMA_MEMORY__H___
+
+#include <stdint.h>
+#include <kinetis.h>
+#include <DMAChannel.h>
+
+
+namespace teensy {
+namespace dma {
+  /* Widest transfer size (4, 2, or 1 bytes) dividing \a destination,
+   * \a source, and \a size. */
+  inline uint8_t transfer_width(uintptr_t destination, uintptr_t source,
+                                uint32_t size) {
+    const uintptr_t bits = destination | source | size;
+    return (bits & 0x3) ? ((bits & 0x1) ? 1 : 2) : 4;
+  }
+
+  /*
+   * Memory copies and fills performed by a spare DMA channel, using the
+   * widest transfers allowed by the alignment of the buffers (i.e., 32-bit
+   * transfers for word-aligned buffers).
+   *
+   * A transfer is split into passes of at most `MAX_LINKED_ITERATIONS` minor
+   * loops of `MINOR_LOOP_BYTES` bytes.  Each minor loop links to the channel
+   * itself, so a single software request runs a whole pass, while other
+   * (e.g., ADC) DMA channels are still serviced between minor loops.  The
+   * major loop interrupt of the channel must call `on_major_loop_done`,
+   * which starts the next pass until the transfer is complete.
+   *
+   * `copy`, `fill`, and `write_register` return as soon as the first pass
+   * is started; `wait` blocks until the transfer is complete.  If `notify`
+   * is set, the caller of `on_major_loop_done` should report completion
+   * (e.g., as a `DmaEvent`, see `notify_`).
+   */
+  class MemoryEngine {
+  public:
+    typedef DMABaseClass::TCD_t tcd_t;
+
+    static const uint16_t MINOR_LOOP_BYTES = 64;
+    // `CITER` is 9 bits wide when minor loop channel linking is enabled.
+    static const uint16_t MAX_LINKED_ITERATIONS = 511;
+
+    uint8_t channel_;  // `DMA_NUM_CHANNELS` if not configured.
+    volatile bool busy_;
+    // Source of fills, i.e., value repeated to fill 32 bits.
+    uint32_t fill_value_ __attribute__((aligned(4)));
+    uint8_t *destination_;
+    const uint8_t *source_;  // `NULL` for fills.
+    bool fixed_destination_;  // Write every element to `destination_`.
+    bool notify_;  // Completion of current transfer should be reported.
+    uint32_t remaining_;  // Bytes not yet transferred (including this pass).
+    uint32_t pass_size_;
+    uint8_t width_;
+    uint32_t transfer_count_;  // Number of completed transfers.
+    uint32_t error_count_;  // Number of transfers aborted by a DMA error.
+
+    MemoryEngine()
+      : channel_(DMA_NUM_CHANNELS), busy_(false), fill_value_(0),
+        destination_(NULL), source_(NULL), fixed_destination_(false),
+        notify_(false), remaining_(0), pass_size_(0),
+        width_(1), transfer_count_(0), error_count_(0) {}
+
+    bool configured() const { return channel_ < DMA_NUM_CHANNELS; }
+
+    /* Use DMA channel \a channel for subsequent transfers.
+     *
+     * Returns 0 on success, -1 if \a channel is invalid, or -2 if a
+     * transfer is in progress. */
+    int8_t set_channel(uint8_t channel);
+    /* Start copying \a size bytes from \a source to \a destination.
+     *
+     * Returns 0 on success, -1 if no channel is configured, or -2 if a
+     * transfer is in progress. */
+    int8_t copy(void *destination, const void *source, uint32_t size,
+                bool notify=false);
+    /* Start filling \a count elements of \a value_size (1, 2, or 4) bytes
+     * starting at \a destination with \a value.
+     *
+     * Returns 0 on success, -1 if no channel is configured or \a value_size
+     * is invalid, or -2 if a transfer is in progress. */
+    int8_t fill(void *destination, uint32_t value, uint8_t value_size,
+                uint32_t count, bool notify=false);
+    /* Start writing \a size bytes from \a source, one element at a time, to
+     * the (peripheral) register at \a address, e.g., to feed a data
+     * register.
+     *
+     * Returns 0 on success, -1 if no channel is configured, or -2 if a
+     * transfer is in progress. */
+    int8_t write_register(volatile void *address, const void *source,
+                          uint32_t size);
+    /* Call from major loop interrupt handler of channel.
+     *
+     * Returns `true` if the transfer is complete, or `false` if the next
+     * pass was started. */
+    bool on_major_loop_done();
+    /* Returns `true` while a transfer is in progress.
+     *
+     * A transfer stopped by a DMA error (e.g., invalid address) is aborted
+     * and counted in `error_count_`. */
+    bool poll();
+    void wait() { while (poll()) {} }
+  protected:
+    int8_t start(uint8_t *destination, const uint8_t *source, uint32_t size,
+                 uint8_t width, bool fixed_destination, bool notify);
+    void start_pass();
+  };
+}  // namespace dma
+}  // namespace teensy
+
+#endif  // #ifndef ___TEENSY__DMA_MEMORY__H___
@@ -0,0 +1,251 @@
+#include <string.h>
+#include "DualAdcSampler.h"
+#include "DMA.h"
+
+namespace teensy {
+namespace adc {
+  DualAdcSampler::DualAdcSampler()
+    : channel_count_(0), sample_count_(0), continuous_(false),
+      pdb_config_(0), pdb_mod_(0) {
+    for (uint8_t i = 0; i < 2; i++) {
+      dma_conversion_[i] = i;
+      dma_channel_configs_[i] = 2 + i;
+      channel_sc1as_[i] = UInt32Array_init_default();
+    }
+    samples_ = UInt16Array_init_default();
+  }
+
+  int8_t DualAdcSampler::configure(UInt8Array adc0_sc1as,
+                                   UInt8Array adc1_sc1as,
+                                   uint16_t sample_count,
+                                   uint32_t sample_rate_hz,
+                                   UInt8Array dma_channels, bool continuous) {
+    const uint16_t channel_count = adc0_sc1as.length;
+    // Number of conversions per ADC, i.e., conversion DMA major loop count
+    // (15 bits with channel linking disabled, 21.3.27/422).
+    const uint32_t conversion_count = (uint32_t)sample_count * channel_count;
+    // Channel configs DMA major loop count is limited to 9 bits when channel
+    // linking is enabled (21.3.26/421).
+    if ((channel_count == 0) || (channel_count > 0x1FF) ||
+        (adc1_sc1as.length != channel_count) || (sample_count == 0) ||
+        (conversion_count > 0x7FFF) ||
+        (continuous && (sample_count & 0x1))) {
+      return -1;
+    }
+
+    uint8_t channels[4] = {0, 1, 2, 3};
+    if (dma_channels.length == 4) {
+      memcpy(channels, dma_channels.data, sizeof(channels));
+    } else if (dma_channels.length != 0) {
+      return -1;
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+      if (channels[i] >= DMA_NUM_CHANNELS) { return -1; }
+      for (uint8_t j = i + 1; j < 4; j++) {
+        if (channels[i] == channels[j]) { return -1; }
+      }
+    }
+
+    // Each PDB period converts one channel pair.
+    uint32_t pdb_config;
+    uint16_t pdb_mod;
+    if (!pdb_divide_settings(sample_rate_hz * channel_count, pdb_config,
+                             pdb_mod)) {
+      return -2;
+    }
+
+    deallocate();
+    for (uint8_t i = 0; i < 2; i++) {
+      dma_conversion_[i] = channels[i];
+      dma_channel_configs_[i] = channels[2 + i];
+    }
+    channel_count_ = channel_count;
+    sample_count_ = sample_count;
+    continuous_ = continuous;
+    if (channel_count == 1) {
+      // Channel is selected once, so no PDB DMA request is required.
+      pdb_config &= ~PDB_SC_DMAEN;
+    }
+    pdb_config_ = pdb_config;
+    pdb_mod_ = pdb_mod;
+
+    // Interleaved results of both ADCs.
+    samples_ = UInt16Array_init(2 * conversion_count,
+                                (uint16_t *)calloc(2 * conversion_count,
+                                                   sizeof(uint16_t)));
+    bool ok = (samples_.data != NULL);
+    UInt8Array sc1as[2] = {adc0_sc1as, adc1_sc1as};
+    for (uint8_t i = 0; ok && (i < 2); i++) {
+      // __N.B.,__ Channel `SC1A` configurations are copied by DMA using
+      // 32-bit transfers, so must be aligned to 0-modulo-4 address.
+      channel_sc1as_[i] =
+        UInt32Array_init(channel_count,
+                         (uint32_t *)aligned_malloc(sizeof(uint32_t),
+                                                    channel_count *
+                                                    sizeof(uint32_t)));
+      ok = (channel_sc1as_[i].data != NULL);
+      /* Store configurations rotated by one, since the configuration of the
+       * first pair is loaded by `rewind` and each PDB DMA request loads the
+       * configuration of the *next* pair. */
+      for (uint16_t j = 0; ok && (j < channel_count); j++) {
+        channel_sc1as_[i].data[j] = sc1as[i].data[(j + 1) % channel_count];
+      }
+    }
+    if (!ok) {
+      deallocate();
+      return -3;
+    }
+
+    // Enable PDB clock (DMA and ADC clocks should already be enabled).
+    SIM_SCGC6 |= SIM_SCGC6_PDB;
+
+    configure_timer();
+    configure_adcs();
+    rewind();
+    configure_dma_mux();
+    return 0;
+  }
+
+  void DualAdcSampler::rewind() {
+    if (!configured()) { return; }
+    for (uint8_t i = 0; i < 2; i++) {
+      configure_dma_channel_adc_conversion(i);
+      if (channel_count_ > 1) { configure_dma_channel_adc_channel_configs(i); }
+    }
+    /* Select first channel of each ADC.  With hardware triggering enabled,
+     * writing `SC1A` does not start a conversion (31.3.1/653). */
+    ADC0_SC1A = channel_sc1as_[0].data[channel_count_ - 1];
+    ADC1_SC1A = channel_sc1as_[1].data[channel_count_ - 1];
+  }
+
+  void DualAdcSampler::deallocate() {
+    if (configured()) {
+      // Restore software triggering and disable pre-triggers.
+      ADC0_SC2 &= ~(ADC_SC2_ADTRG | ADC_SC2_DMAEN);
+      ADC1_SC2 &= ~(ADC_SC2_ADTRG | ADC_SC2_DMAEN);
+      PDB0_CH0C1 = 0;
+      PDB0_CH1C1 = 0;
+      // Disable DMA requests before releasing memory used by the channels.
+      for (uint8_t i = 0; i < 2; i++) {
+        DMA_CERQ = dma_conversion_[i];
+        DMA_CERQ = dma_channel_configs_[i];
+      }
+    }
+    free(samples_.data);
+    samples_ = UInt16Array_init_default();
+    for (uint8_t i = 0; i < 2; i++) {
+      aligned_free(channel_sc1as_[i].data);
+      channel_sc1as_[i] = UInt32Array_init_default();
+    }
+  }
+
+  void DualAdcSampler::configure_adcs() {
+    /* Select `b` input for ADC MUX (31.3.3/658), and enable hardware
+     * triggering (i.e., PDB pre-triggers) and DMA request on each conversion
+     * complete (31.3.6/661). */
+    ADC0_CFG2 |= ADC_CFG2_MUXSEL;
+    ADC1_CFG2 |= ADC_CFG2_MUXSEL;
+    ADC0_SC2 |= ADC_SC2_ADTRG | ADC_SC2_DMAEN;
+    ADC1_SC2 |= ADC_SC2_ADTRG | ADC_SC2_DMAEN;
+  }
+
+  void DualAdcSampler::configure_timer() {
+    // __N.B.,__ Loaded on next write of `PDB_SC_LDOK` (i.e., on start).
+    PDB0_MOD = pdb_mod_;
+    /* Request DMA (i.e., select the next channel pair) after conversions
+     * started at the beginning of the period have completed, and leave time
+     * for the channel configs DMA channels before the next period. */
+    PDB0_IDLY = ((uint32_t)pdb_mod_ + 1) * 3 / 4;
+    // Pre-trigger A of PDB channel 0 (ADC0) and 1 (ADC1) at the same counter
+    // value (35.3.6/757).
+    PDB0_CH0DLY0 = 0;
+    PDB0_CH1DLY0 = 0;
+    PDB0_CH0C1 = PDB_CHnC1_TOS(1) | PDB_CHnC1_EN(1);
+    PDB0_CH1C1 = PDB_CHnC1_TOS(1) | PDB_CHnC1_EN(1);
+  }
+
+  void DualAdcSampler::configure_dma_channel_adc_conversion(uint8_t
+                                                            adc_number) {
+    volatile tcd_t &tcd = dma::TCD(dma_conversion_[adc_number]);
+    const uint16_t conversion_count = sample_count_ * channel_count_;
+
+    tcd.CSR = 0;
+    tcd.SADDR = adc_number ? &ADC1_RA : &ADC0_RA;
+    tcd.SOFF = 0;
+    tcd.ATTR = (DMA_TCD_ATTR_SSIZE(DMA_TCD_ATTR_SIZE_16BIT) |
+                DMA_TCD_ATTR_DSIZE(DMA_TCD_ATTR_SIZE_16BIT));
+    tcd.NBYTES = sizeof(uint16_t);
+    tcd.SLAST = 0;
+    // Interleave results of both ADCs.
+    tcd.DADDR = samples_.data + adc_number;
+    tcd.DOFF = 2 * sizeof(uint16_t);
+    tcd.CITER = conversion_count;
+    tcd.BITER = conversion_count;
+    // Return to start of samples array after major loop.
+    tcd.DLASTSGA = -(int32_t)samples_size();
+    if (adc_number == 1) {
+      /* ADC1 results are stored after ADC0 results, so raise interrupt on
+       * ADC1 conversion DMA channel once each block is complete. */
+      tcd.CSR = DMA_TCD_CSR_INTMAJOR | (continuous_ ? DMA_TCD_CSR_INTHALF
+                                        : 0);
+    }
+  }
+
+  void DualAdcSampler::configure_dma_channel_adc_channel_configs(uint8_t
+                                                                 adc_number) {
+    volatile tcd_t &tcd = dma::TCD(dma_channel_configs_[adc_number]);
+    uint16_t citer = channel_count_;
+
+    tcd.CSR = 0;
+    tcd.SADDR = channel_sc1as_[adc_number].data;
+    tcd.SOFF = sizeof(uint32_t);
+    tcd.ATTR = (DMA_TCD_ATTR_SSIZE(DMA_TCD_ATTR_SIZE_32BIT) |
+                DMA_TCD_ATTR_DSIZE(DMA_TCD_ATTR_SIZE_32BIT));
+    tcd.NBYTES = sizeof(uint32_t);  // `SC1A` register is 4 bytes (32-bit)
+    tcd.SLAST = -(int32_t)(channel_count_ * sizeof(uint32_t));
+    tcd.DADDR = adc_number ? &ADC1_SC1A : &ADC0_SC1A;
+    tcd.DOFF = 0;
+    if (adc_number == 0) {
+      /* Only ADC0 channel configs DMA channel is triggered by the PDB, so
+       * link to ADC1 channel configs DMA channel after each minor loop
+       * (21.3.26/421)...  */
+      citer |= ((1 << 15)  // `ELINK`
+                | ((dma_channel_configs_[1] & 0xF) << 9));  // `LINKCH`
+    }
+    tcd.CITER = citer;
+    tcd.BITER = citer;
+    tcd.DLASTSGA = 0;
+    if (adc_number == 0) {
+      // ... and after the major loop (minor loop link is suppressed on the
+      // last minor loop).
+      tcd.CSR = (DMA_TCD_CSR_MAJORELINK |
+                 DMA_TCD_CSR_MAJORLINKCH(dma_channel_configs_[1]));
+    }
+  }
+
+  void DualAdcSampler::configure_dma_mux() {
+    volatile uint8_t *CHCFG = &DMAMUX0_CHCFG0;
+
+    // Route ADC conversion complete as conversion DMA channel sources.
+    CHCFG[dma_conversion_[0]] = 0;
+    CHCFG[dma_conversion_[0]] = DMAMUX_SOURCE_ADC0 | DMAMUX_ENABLE;
+    CHCFG[dma_conversion_[1]] = 0;
+    CHCFG[dma_conversion_[1]] = DMAMUX_SOURCE_ADC1 | DMAMUX_ENABLE;
+    // ADC1 channel configs DMA channel is only started through channel
+    // linking.
+    CHCFG[dma_channel_configs_[1]] = 0;
+    CHCFG[dma_channel_configs_[0]] = 0;
+    if (channel_count_ > 1) {
+      // Route PDB as ADC0 channel configs DMA channel source.
+      CHCFG[dma_channel_configs_[0]] = DMAMUX_SOURCE_PDB | DMAMUX_ENABLE;
+      DMA_SERQ = dma_channel_configs_[0];
+    }
+
+    // DMA request input signals and this enable request flag must be
+    // asserted before a channel's hardware service request is accepted
+    // (21.3.3/394).
+    DMA_SERQ = dma_conversion_[0];
+    DMA_SERQ = dma_conversion_[1];
+  }
+}  // namespace adc
+}  // namespace teensy
@@ -0,0 +1,111 @@
+#ifndef ___TEENSY__DUAL_ADC_SAMPLER__H___
+#define ___TEENSY__DUAL_ADC_SAMPLER__H___
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <kinetis.h>
+#include <DMAChannel.h>
+#include <CArrayDefs.h>  // UInt8Array, UInt16Array, UInt32Array
+#include <TeensyMinimalRpc/AdcSampler.h>  // pdb_divide_settings
+#include <TeensyMinimalRpc/aligned_alloc.h>
+
+
+namespace teensy {
+namespace adc {
+  /*
+   * Sample pairs of analog input channels simultaneously using ADC0 and ADC1.
+   *
+   * PDB channel 0 and PDB channel 1 pre-triggers fire at the same PDB counter
+   * value, starting a hardware-triggered conversion on ADC0 and ADC1 at the
+   * same instant.  Each PDB period converts one channel pair:
+   *
+   *  - `dma_conversion_[i]`: triggered by each ADC `i` conversion; copies the
+   *    result to the samples array.  Results of both ADCs are interleaved,
+   *    i.e., each conversion of ADC0 is immediately followed by the
+   *    simultaneous conversion of ADC1.
+   *  - `dma_channel_configs_[i]` (only used with more than one channel pair):
+   *    triggered by the PDB DMA request (after conversions complete, see
+   *    `pdb_idly_`); copies the `SC1A` configuration of the next channel to
+   *    ADC `i`, so the next pre-trigger converts the next pair.
+   *
+   * Samples array layout (one `uint16_t` per entry):
+   *
+   *     [sample 0: adc0[0], adc1[0], adc0[1], adc1[1], ..., adc1[C - 1]]
+   *     [sample 1: ...]
+   *
+   * In continuous mode, the conversion DMA channel of ADC1 raises an
+   * interrupt each time one half of the samples array is filled (`INTHALF`
+   * and `INTMAJOR`).
+   */
+  class DualAdcSampler {
+  public:
+    typedef DMABaseClass::TCD_t tcd_t;
+
+    uint8_t dma_conversion_[2];
+    uint8_t dma_channel_configs_[2];
+    uint16_t channel_count_;  // Number of channel pairs.
+    uint16_t sample_count_;  // Number of samples to record for each channel.
+    bool continuous_;
+    uint32_t pdb_config_;
+    uint16_t pdb_mod_;
+    UInt32Array channel_sc1as_[2];
+    UInt16Array samples_;
+
+    DualAdcSampler();
+    ~DualAdcSampler() { deallocate(); }
+
+    /*
+     * Allocate buffers and configure ADCs, PDB, DMA mux, and DMA transfer
+     * control descriptors.
+     *
+     * Args:
+     *
+     *     adc0_sc1as: `ADC0_SC1A` channel configuration for each pair.
+     *     adc1_sc1as: `ADC1_SC1A` channel configuration for each pair.
+     *     sample_count: Number of samples to record for each channel (must be
+     *         even in continuous mode).
+     *     sample_rate_hz: Sample rate (per channel pair).
+     *     dma_channels: ADC0 conversion, ADC1 conversion, ADC0 channel
+     *         configs, and ADC1 channel configs DMA channels, in that order.
+     *         If empty, use DMA channels 0, 1, 2, and 3.
+     *     continuous: Split samples array into two halves for gap-free
+     *         streaming.
+     *
+     * Returns:
+     *
+     *     0: success.
+     *     -1: invalid arguments.
+     *     -2: sample rate out of range.
+     *     -3: memory allocation failed.
+     *
+     * **N.B.,** Each conversion must complete within 3/4 of a PDB period
+     * (i.e., `1 / (sample_rate_hz * channel count)`).
+     */
+    int8_t configure(UInt8Array adc0_sc1as, UInt8Array adc1_sc1as,
+                     uint16_t sample_count, uint32_t sample_rate_hz,
+                     UInt8Array dma_channels, bool continuous);
+    /* Reload the transfer control descriptor of each DMA channel and the
+     * first channel configuration of each ADC, so the next read starts at the
+     * beginning of the samples array. */
+    void rewind();
+    /* Disable hardware triggering, PDB pre-triggers and DMA requests, and
+     * free buffers. */
+    void deallocate();
+
+    bool configured() const { return samples_.data != NULL; }
+    /* PDB status and control configuration to start sampling. */
+    uint32_t pdb_start_config() const { return pdb_config_ | PDB_SC_SWTRIG; }
+    uint32_t samples_size() const {
+      return samples_.length * sizeof(uint16_t);
+    }
+  protected:
+    void configure_adcs();
+    void configure_timer();
+    void configure_dma_channel_adc_conversion(uint8_t adc_number);
+    void configure_dma_channel_adc_channel_configs(uint8_t adc_number);
+    void configure_dma_mux();
+  };
+}  // namespace adc
+}  // namespace teensy
+
+#endif  // #ifndef ___TEENSY__DUAL_ADC_SAMPLER__H___
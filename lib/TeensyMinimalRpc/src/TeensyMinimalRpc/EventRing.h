@@ -0,0 +1,69 @@
+#ifndef ___EVENT_RING__H___
+#define ___EVENT_RING__H___
+
+#include <stdint.h>
+
+
+namespace teensy_minimal_rpc {
+
+/*
+ * Bounded single-producer/single-consumer ring of event records.
+ *
+ * The producer (e.g., an interrupt handler) calls `push`; the consumer (e.g.,
+ * the main loop) calls `pop`.  Neither side disables interrupts: the producer
+ * only writes `head_` and the consumer only writes `tail_`, and a record is
+ * copied before (after) the index that publishes (releases) it is updated.
+ *
+ * If the ring is full, the new record is dropped and `drop_count_` is
+ * incremented.
+ *
+ * **N.B.,** Several interrupt handlers may share one ring as long as they
+ * cannot preempt each other (i.e., they have the same NVIC priority).
+ *
+ * `N` must be a power of two.
+ */
+template <typename T, uint16_t N>
+class EventRing {
+public:
+  T records_[N];
+  volatile uint16_t head_;  // Free-running count of records pushed.
+  volatile uint16_t tail_;  // Free-running count of records popped.
+  volatile uint32_t drop_count_;
+
+  EventRing() : head_(0), tail_(0), drop_count_(0) {
+    static_assert(N && !(N & (N - 1)), "Ring size must be a power of two.");
+  }
+
+  uint16_t capacity() const { return N; }
+  uint16_t size() const { return (uint16_t)(head_ - tail_); }
+  bool empty() const { return head_ == tail_; }
+
+  bool push(const T &record) {
+    const uint16_t head = head_;
+    if ((uint16_t)(head - tail_) >= N) {
+      drop_count_++;
+      return false;
+    }
+    records_[head & (N - 1)] = record;
+    __sync_synchronize();  // Record must be written before it is published.
+    head_ = head + 1;
+    return true;
+  }
+
+  bool pop(T &record) {
+    const uint16_t tail = tail_;
+    if (tail == head_) { return false; }
+    __sync_synchronize();
+    record = records_[tail & (N - 1)];
+    __sync_synchronize();  // Record must be read before slot is released.
+    tail_ = tail + 1;
+    return true;
+  }
+
+  /* Discard all queued records (consumer side). */
+  void clear() { tail_ = head_; }
+};
+
+}  // namespace teensy_minimal_rpc
+
+#endif  // #ifndef ___EVENT_RING__H___
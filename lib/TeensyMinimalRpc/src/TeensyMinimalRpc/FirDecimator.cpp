@@ -0,0 +1,151 @@
+#include <string.h>
+#include "FirDecimator.h"
+
+
+namespace teensy_minimal_rpc {
+  static inline int16_t round_saturate_q15(int64_t sum) {
+    const int64_t value = (sum + (1 << 14)) >> 15;
+    if (value > INT16_MAX) { return INT16_MAX; }
+    if (value < INT16_MIN) { return INT16_MIN; }
+    return value;
+  }
+
+#if defined(__ARM_FEATURE_DSP)
+  /* Window words may be at odd halfword addresses (e.g., odd `factor`),
+   * which `LDR` handles on the Cortex-M4. */
+  typedef uint32_t __attribute__((__may_alias__, __aligned__(2)))
+    unaligned_word_t;
+  typedef uint32_t __attribute__((__may_alias__)) aligned_word_t;
+
+  static inline __attribute__((always_inline))
+  uint64_t smlald(uint32_t x, uint32_t y, uint64_t acc) {
+    uint32_t low = (uint32_t)acc;
+    uint32_t high = (uint32_t)(acc >> 32);
+    __asm__ ("smlald %0, %1, %2, %3"
+             : "+r" (low), "+r" (high) : "r" (x), "r" (y));
+    return ((uint64_t)high << 32) | low;
+  }
+
+  /* Multiply two taps per `SMLALD`, i.e., one cycle per tap pair. */
+  static inline int64_t dot_product(const int16_t *x, const int16_t *taps,
+                                    uint16_t tap_count) {
+    const unaligned_word_t *x_words = (const unaligned_word_t *)x;
+    const aligned_word_t *tap_words = (const aligned_word_t *)taps;
+    uint64_t sum = 0;
+    uint16_t word_count = tap_count >> 1;
+
+    for (; word_count >= 2; word_count -= 2) {
+      sum = smlald(*x_words++, *tap_words++, sum);
+      sum = smlald(*x_words++, *tap_words++, sum);
+    }
+    if (word_count) { sum = smlald(*x_words, *tap_words, sum); }
+    return (int64_t)sum;
+  }
+#else
+  static inline int64_t dot_product(const int16_t *x, const int16_t *taps,
+                                    uint16_t tap_count) {
+    int64_t sum = 0;
+
+    for (uint16_t i = 0; i < tap_count; i++) {
+      sum += (int32_t)x[i] * taps[i];
+    }
+    return sum;
+  }
+#endif  // #if defined(__ARM_FEATURE_DSP)
+
+  void FirDecimator::decimate(const int16_t *window, const int16_t *taps,
+                              uint16_t tap_count, uint8_t factor,
+                              uint16_t output_count, uint16_t *output) {
+    /* Output `j` is the dot product of the (reversed) taps with the
+     * `tap_count` samples ending at new sample `j * factor`. */
+    for (uint16_t j = 0; j < output_count; j++, window += factor) {
+      output[j] = (uint16_t)round_saturate_q15(dot_product(window, taps,
+                                                           tap_count)) ^
+        0x8000;
+    }
+  }
+
+  int8_t FirDecimator::configure(UInt16Array coefficients, uint8_t factor,
+                                 const BlockLayout &layout) {
+    if ((coefficients.length == 0) ||
+        (coefficients.length > FIR_DECIMATOR_MAX_TAPS) ||
+        (factor < FIR_DECIMATOR_MIN_FACTOR) ||
+        (factor > FIR_DECIMATOR_MAX_FACTOR) || !layout.valid() ||
+        (layout.sample_count % factor)) { return -1; }
+    deallocate();
+
+    // Pad to an even number of taps, i.e., whole tap pairs.
+    tap_count_ = (coefficients.length + 1) & ~0x1;
+    const uint16_t history_count = tap_count_ - 1;
+    taps_ = (int16_t *)calloc(tap_count_, sizeof(int16_t));
+    history_ = (int16_t *)calloc((uint32_t)layout.channel_count *
+                                 history_count, sizeof(int16_t));
+    window_ = (int16_t *)malloc((history_count +
+                                 (uint32_t)layout.sample_count) *
+                                sizeof(int16_t));
+    const uint32_t output_count = ((uint32_t)layout.channel_count *
+                                   layout.sample_count / factor);
+    output_ = UInt16Array_init(output_count,
+                               (uint16_t *)malloc(output_count *
+                                                  sizeof(uint16_t)));
+    if ((taps_ == NULL) || (history_ == NULL) || (window_ == NULL) ||
+        (output_.data == NULL)) {
+      deallocate();
+      return -3;
+    }
+
+    for (uint16_t i = 0; i < coefficients.length; i++) {
+      taps_[tap_count_ - 1 - i] = (int16_t)coefficients.data[i];
+    }
+    layout_ = layout;
+    factor_ = factor;
+    return 0;
+  }
+
+  void FirDecimator::deallocate() {
+    free(taps_);
+    free(history_);
+    free(window_);
+    free(output_.data);
+    taps_ = NULL;
+    history_ = NULL;
+    window_ = NULL;
+    output_ = UInt16Array_init_default();
+    tap_count_ = 0;
+    layout_.channel_count = 0;
+  }
+
+  void FirDecimator::reset() {
+    if (history_ == NULL) { return; }
+    memset(history_, 0, (uint32_t)layout_.channel_count * (tap_count_ - 1) *
+           sizeof(int16_t));
+  }
+
+  UInt8Array FirDecimator::process(UInt8Array block) {
+    UInt8Array output = UInt8Array_init_default();
+    if (!enabled() || !layout_.fits(block)) { return output; }
+
+    const uint16_t history_count = tap_count_ - 1;
+    const uint16_t output_count = output_sample_count();
+    const uint16_t *samples = (const uint16_t *)block.data;
+
+    for (uint16_t c = 0; c < layout_.channel_count; c++) {
+      int16_t *history = history_ + (uint32_t)c * history_count;
+      const uint16_t *input = samples + (uint32_t)c * layout_.channel_stride;
+      int16_t *window_input = window_ + history_count;
+
+      memcpy(window_, history, history_count * sizeof(int16_t));
+      for (uint16_t i = 0; i < layout_.sample_count;
+           i++, input += layout_.sample_stride) {
+        window_input[i] = (int16_t)(*input ^ 0x8000);
+      }
+      decimate(window_, taps_, tap_count_, factor_, output_count,
+               output_.data + (uint32_t)c * output_count);
+      memcpy(history, window_ + layout_.sample_count,
+             history_count * sizeof(int16_t));
+    }
+    output.data = (uint8_t *)output_.data;
+    output.length = output_.length * sizeof(uint16_t);
+    return output;
+  }
+}  // namespace teensy_minimal_rpc
@@ -0,0 +1,109 @@
+#ifndef ___FIR_DECIMATOR__H___
+#define ___FIR_DECIMATOR__H___
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <CArrayDefs.h>  // UInt8Array, UInt16Array
+#include <TeensyMinimalRpc/BlockLayout.h>
+
+
+namespace teensy_minimal_rpc {
+
+const uint16_t FIR_DECIMATOR_MAX_TAPS = 256;
+const uint8_t FIR_DECIMATOR_MIN_FACTOR = 2;
+const uint8_t FIR_DECIMATOR_MAX_FACTOR = 64;
+
+/*
+ * Q15 fixed-point FIR low-pass filter and decimator for blocks of `uint16_t`
+ * samples (e.g., ADC results), applied to each channel independently.
+ *
+ * Output sample `j` of each channel is
+ *
+ *     y[j] = sum(h[k] * x[j * factor - k], k=0..tap_count - 1) >> 15
+ *
+ * i.e., only every `factor`-th filter output is computed (equivalent to the
+ * sum of polyphase sub-filters, each run at the output rate).  Samples are
+ * centered (i.e., `x = sample - 0x8000`) before filtering, and outputs are
+ * rounded, saturated, and shifted back to the same (unsigned) scale.
+ *
+ * The last `tap_count - 1` samples of each channel are kept between blocks,
+ * so consecutive blocks (e.g., halves of a continuous acquisition buffer)
+ * are filtered without gaps.  `reset` clears this history (e.g., before a
+ * new acquisition).
+ *
+ * Input blocks are laid out as `layout_` (see `BlockLayout`).  Output
+ * blocks hold the `layout_.sample_count / factor_` samples of each channel
+ * consecutively (see `output_layout`).
+ */
+class FirDecimator {
+public:
+  BlockLayout layout_;  // Layout of input blocks.
+  uint8_t factor_;
+  /* Coefficients, zero-padded to an even number of taps, in *reverse*
+   * order (i.e., oldest sample first). */
+  int16_t *taps_;
+  uint16_t tap_count_;
+  int16_t *history_;  // `tap_count_ - 1` samples per channel.
+  /* History of one channel, followed by the input samples of the channel
+   * being filtered. */
+  int16_t *window_;
+  UInt16Array output_;
+
+  FirDecimator()
+    : layout_(), factor_(0), taps_(NULL), tap_count_(0), history_(NULL),
+      window_(NULL) {
+    output_ = UInt16Array_init_default();
+  }
+  ~FirDecimator() { deallocate(); }
+
+  /*
+   * Allocate buffers for the specified filter and block layout.
+   *
+   * Args:
+   *
+   *     coefficients: Q15 filter coefficients (i.e., `int16_t` values),
+   *         `h[0]` first.  For unity DC gain, coefficients must sum to
+   *         `0x8000`.
+   *     factor: Decimation factor (2 to 64); must divide the number of
+   *         samples per channel.
+   *     layout: Layout of input blocks.
+   *
+   * Returns:
+   *
+   *     0: success.
+   *     -1: invalid arguments.
+   *     -3: memory allocation failed.
+   */
+  int8_t configure(UInt16Array coefficients, uint8_t factor,
+                   const BlockLayout &layout);
+  void deallocate();
+  /* Clear history of each channel (i.e., as if preceded by silence). */
+  void reset();
+
+  bool enabled() const { return output_.data != NULL; }
+  uint16_t output_sample_count() const {
+    return layout_.sample_count / factor_;
+  }
+  /* Layout of output blocks, i.e., channel-major. */
+  BlockLayout output_layout() const {
+    return BlockLayout::channel_major(layout_.channel_count,
+                                      output_sample_count());
+  }
+
+  /* Returns filtered and decimated \a block (in `output_`, valid until the
+   * next call), or an empty array if the block is too small for the
+   * configured layout. */
+  UInt8Array process(UInt8Array block);
+
+  /* Filter \a output_count outputs from \a window, which holds `tap_count -
+   * 1` history samples followed by `output_count * factor` new samples.
+   *
+   * \a tap_count must be even, and \a taps must be word-aligned. */
+  static void decimate(const int16_t *window, const int16_t *taps,
+                       uint16_t tap_count, uint8_t factor,
+                       uint16_t output_count, uint16_t *output);
+};
+
+}  // namespace teensy_minimal_rpc
+
+#endif  // #ifndef ___FIR_DECIMATOR__H___
@@ -0,0 +1,103 @@
+#ifndef ___ISR_PROFILER__H___
+#define ___ISR_PROFILER__H___
+
+#include <stdint.h>
+#include <string.h>
+#include <kinetis.h>  // ARM_DWT_CYCCNT
+
+
+namespace teensy_minimal_rpc {
+
+const uint8_t ISR_HISTOGRAM_BUCKETS = 32;
+
+/* Log2 histogram bucket of \a cycles: bucket 0 holds 0 cycles, bucket `b`
+ * holds `[2^(b - 1), 2^b)` cycles (the last bucket also holds everything
+ * larger). */
+inline uint8_t log2_bucket(uint32_t cycles) {
+  if (cycles == 0) { return 0; }
+  const uint8_t bucket = 32 - __builtin_clz(cycles);
+  return (bucket < ISR_HISTOGRAM_BUCKETS) ? bucket
+    : (ISR_HISTOGRAM_BUCKETS - 1);
+}
+
+
+/*
+ * Timing statistics of one interrupt handler, in CPU cycles.
+ *
+ * `interval_` holds the time between consecutive handler entries.  The eDMA
+ * and ADC do not timestamp their requests, so the latency of a handler
+ * cannot be measured directly; for a periodic source, a late handler shows up
+ * as an interval longer than the period (followed by a shorter one).
+ */
+struct IsrHistogram {
+  uint32_t interval_[ISR_HISTOGRAM_BUCKETS];
+  uint32_t duration_[ISR_HISTOGRAM_BUCKETS];
+  uint32_t count_;
+  uint32_t max_duration_;
+  uint32_t last_entry_;
+};
+
+
+/*
+ * Opt-in entry/exit timing of up to `N` interrupt handlers using the DWT
+ * cycle counter (see `CycleCounter::begin`).
+ *
+ * While disabled, `Scope` costs one load and one branch on entry and exit.
+ *
+ * Example:
+ *
+ *     void on_adc_done() {
+ *       IsrProfiler<N>::Scope scope(profiler_, ADC0_PROFILE_INDEX);
+ *       ...
+ *     }
+ */
+template <uint8_t N>
+class IsrProfiler {
+public:
+  volatile bool enabled_;
+  IsrHistogram histograms_[N];
+
+  IsrProfiler() : enabled_(false) { reset(); }
+
+  /* **N.B.,** Must not be interrupted by a profiled handler. */
+  void reset() { memset(histograms_, 0, sizeof(histograms_)); }
+
+  uint8_t size() const { return N; }
+
+  void record(uint8_t index, uint32_t entry, uint32_t exit) {
+    IsrHistogram &histogram = histograms_[index];
+    const uint32_t duration = exit - entry;
+
+    if (histogram.count_ > 0) {
+      histogram.interval_[log2_bucket(entry - histogram.last_entry_)]++;
+    }
+    histogram.duration_[log2_bucket(duration)]++;
+    if (duration > histogram.max_duration_) {
+      histogram.max_duration_ = duration;
+    }
+    histogram.last_entry_ = entry;
+    histogram.count_++;
+  }
+
+  /* Record handler entry on construction and exit on destruction. */
+  class Scope {
+  public:
+    IsrProfiler &profiler_;
+    const uint8_t index_;
+    const bool enabled_;
+    const uint32_t entry_;
+
+    Scope(IsrProfiler &profiler, uint8_t index)
+      : profiler_(profiler), index_(index), enabled_(profiler.enabled_),
+        entry_(enabled_ ? ARM_DWT_CYCCNT : 0) {}
+    ~Scope() {
+      if (enabled_) {
+        profiler_.record(index_, entry_, ARM_DWT_CYCCNT);
+      }
+    }
+  };
+};
+
+}  // namespace teensy_minimal_rpc
+
+#endif  // #ifndef ___ISR_PROFILER__H___
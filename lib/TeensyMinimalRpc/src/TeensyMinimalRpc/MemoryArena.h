@@ -0,0 +1,275 @@
+#ifndef ___MEMORY_ARENA__H___
+#define ___MEMORY_ARENA__H___
+
+#include <stdint.h>
+#include <string.h>
+
+
+namespace teensy_minimal_rpc {
+
+/* Statistics of a `MemoryArena` (see `MemoryArena::stats_`). */
+struct MemoryArenaStats {
+  uint32_t capacity;  // Slab region plus pool size in bytes.
+  uint32_t in_use_bytes;  // Bytes in allocated slabs and pool blocks.
+  uint32_t high_water_bytes;  // Maximum of `in_use_bytes` since reset.
+  uint32_t bump_bytes;  // Bytes ever carved from the arena since reset.
+  uint32_t free_list_bytes;  // Bytes in freed slabs and blocks.
+  /* Bytes of allocated pool blocks not available to the caller (block
+   * headers, alignment padding, and rounding to `POOL_UNIT`). */
+  uint32_t overhead_bytes;
+  uint32_t allocation_count;  // Number of allocated slabs and blocks.
+  uint32_t failed_count;  // Number of failed allocation requests.
+};
+
+
+/*
+ * Fixed-size arena, split into two regions:
+ *
+ *  - `SlabCount` slabs of `SLAB_SIZE` (32) bytes, each starting at a
+ *    0-modulo-32 address, for requests of at most one slab (e.g., DMA
+ *    transfer control descriptors).  Freed slabs are kept on a free list
+ *    and handed out again in constant time.
+ *  - A pool of `PoolSize` bytes for everything else (e.g., sample buffers).
+ *    Blocks are rounded up to `POOL_UNIT` bytes (not to a power of two) and
+ *    prefixed with a `PoolBlockHeader`.  Freed blocks are pushed on a free
+ *    list; each request takes the first free block that fits at the
+ *    requested alignment (unused space before and after the request is
+ *    split off as new free blocks), or else is carved from the end of the
+ *    used part of the pool (i.e., bump allocation).  Repeatedly allocating
+ *    and freeing the same buffers (e.g., for each ADC read) reuses the same
+ *    blocks.
+ *
+ * `free` takes constant time: allocated slabs and pool blocks are marked in
+ * a bitmap (so invalid addresses are rejected), and the size of each pool
+ * block is read from its header.  Adjacent free blocks are not merged.
+ *
+ * `reset` releases every slab and block at once.
+ */
+template <uint16_t SlabCount, uint32_t PoolSize>
+class MemoryArena {
+public:
+  static const uint32_t SLAB_SIZE = 32;
+  static const uint32_t POOL_UNIT = 8;
+  static const uint32_t POOL_UNIT_COUNT = PoolSize / POOL_UNIT;
+
+  /* Stored immediately before each allocated pool block payload. */
+  struct PoolBlockHeader {
+    uint32_t offset;  // Block start, from the start of the pool.
+    uint16_t unit_count;  // Block size (in `POOL_UNIT`s).
+    uint16_t overhead;  // Bytes of block not requested (see `stats_`).
+  };
+  /* Stored at the start of each free pool block. */
+  struct FreeBlock {
+    FreeBlock *next;
+    uint32_t size;
+  };
+  // Smallest block split off as a free block (i.e., header and one unit).
+  static const uint32_t MIN_BLOCK_SIZE = sizeof(PoolBlockHeader) + POOL_UNIT;
+
+  uint8_t slabs_[SlabCount * SLAB_SIZE] __attribute__((aligned(32)));
+  uint8_t pool_[PoolSize] __attribute__((aligned(32)));
+  // Allocated slabs, and allocated pool block payloads (by pool unit).
+  uint8_t slab_allocated_[(SlabCount + 7) / 8];
+  uint8_t pool_allocated_[(POOL_UNIT_COUNT + 7) / 8];
+  void *slab_free_list_;
+  FreeBlock *pool_free_list_;
+  uint16_t slab_bump_;  // Number of slabs carved.
+  uint32_t pool_bump_;
+  MemoryArenaStats stats_;
+
+  MemoryArena() {
+    static_assert(SlabCount > 0, "Arena must hold at least one slab.");
+    static_assert(PoolSize && !(PoolSize % SLAB_SIZE) &&
+                  (POOL_UNIT_COUNT <= 0xFFFF),
+                  "Pool size must be a multiple of the slab size, and at "
+                  "most 65535 units.");
+    stats_.failed_count = 0;
+    reset();
+  }
+
+  void reset() {
+    memset(slab_allocated_, 0, sizeof(slab_allocated_));
+    memset(pool_allocated_, 0, sizeof(pool_allocated_));
+    slab_free_list_ = NULL;
+    pool_free_list_ = NULL;
+    slab_bump_ = 0;
+    pool_bump_ = 0;
+    const uint32_t failed_count = stats_.failed_count;
+    memset(&stats_, 0, sizeof(stats_));
+    stats_.capacity = sizeof(slabs_) + PoolSize;
+    stats_.failed_count = failed_count;
+  }
+
+  bool contains_slab(const void *address) const {
+    return ((const uint8_t *)address >= slabs_) &&
+      ((const uint8_t *)address < slabs_ + sizeof(slabs_));
+  }
+  bool contains_pool(const void *address) const {
+    return ((const uint8_t *)address >= pool_) &&
+      ((const uint8_t *)address < pool_ + PoolSize);
+  }
+  bool contains(const void *address) const {
+    return contains_slab(address) || contains_pool(address);
+  }
+
+  /*
+   * Allocate \a size bytes aligned to \a alignment (power of two).
+   *
+   * Requests of at most one slab (with at most slab alignment) are served
+   * from the slab region, or from the pool once no slab is left.
+   *
+   * Returns `NULL` if \a size is zero or if no memory is available.
+   */
+  void *allocate(uint32_t size, uint32_t alignment=SLAB_SIZE) {
+    if ((size == 0) || (alignment & (alignment - 1))) {
+      stats_.failed_count++;
+      return NULL;
+    }
+    void *address = NULL;
+    if ((size <= SLAB_SIZE) && (alignment <= SLAB_SIZE)) {
+      address = allocate_slab();
+    }
+    if (address == NULL) { address = allocate_block(size, alignment); }
+    if (address == NULL) {
+      stats_.failed_count++;
+      return NULL;
+    }
+    if (stats_.in_use_bytes > stats_.high_water_bytes) {
+      stats_.high_water_bytes = stats_.in_use_bytes;
+    }
+    stats_.allocation_count++;
+    return address;
+  }
+
+  /*
+   * Release slab or pool block starting at \a address.
+   *
+   * Returns `false` if \a address is not the start of an allocation.
+   */
+  bool free(void *address) {
+    if (contains_slab(address)) {
+      const uint32_t offset = (uint8_t *)address - slabs_;
+      if ((offset % SLAB_SIZE) ||
+          !test_and_clear(slab_allocated_, offset / SLAB_SIZE)) {
+        return false;
+      }
+      *(void **)address = slab_free_list_;
+      slab_free_list_ = address;
+      stats_.in_use_bytes -= SLAB_SIZE;
+      stats_.free_list_bytes += SLAB_SIZE;
+    } else if (contains_pool(address)) {
+      const uint32_t offset = (uint8_t *)address - pool_;
+      if ((offset % POOL_UNIT) ||
+          !test_and_clear(pool_allocated_, offset / POOL_UNIT)) {
+        return false;
+      }
+      const PoolBlockHeader &header = ((PoolBlockHeader *)address)[-1];
+      const uint32_t size = header.unit_count * POOL_UNIT;
+      stats_.in_use_bytes -= size;
+      stats_.overhead_bytes -= header.overhead;
+      push_block(header.offset, size);
+    } else {
+      return false;
+    }
+    stats_.allocation_count--;
+    return true;
+  }
+
+protected:
+  static bool test_and_clear(uint8_t *bitmap, uint32_t index) {
+    const uint8_t mask = 1 << (index & 0x7);
+    if (!(bitmap[index >> 3] & mask)) { return false; }
+    bitmap[index >> 3] &= ~mask;
+    return true;
+  }
+  static void set(uint8_t *bitmap, uint32_t index) {
+    bitmap[index >> 3] |= 1 << (index & 0x7);
+  }
+
+  void *allocate_slab() {
+    uint8_t *slab = (uint8_t *)slab_free_list_;
+    if (slab != NULL) {
+      slab_free_list_ = *(void **)slab;
+      stats_.free_list_bytes -= SLAB_SIZE;
+    } else if (slab_bump_ < SlabCount) {
+      slab = slabs_ + SLAB_SIZE * slab_bump_++;
+      stats_.bump_bytes += SLAB_SIZE;
+    } else {
+      return NULL;
+    }
+    set(slab_allocated_, (slab - slabs_) / SLAB_SIZE);
+    stats_.in_use_bytes += SLAB_SIZE;
+    return slab;
+  }
+
+  void push_block(uint32_t offset, uint32_t size) {
+    FreeBlock *block = (FreeBlock *)(pool_ + offset);
+    block->next = pool_free_list_;
+    block->size = size;
+    pool_free_list_ = block;
+    stats_.free_list_bytes += size;
+  }
+
+  /* Offset of first payload at or after \a offset (plus header) aligned to
+   * \a alignment. */
+  uint32_t payload_offset(uint32_t offset, uint32_t alignment) const {
+    const uintptr_t address = (uintptr_t)pool_ + offset +
+      sizeof(PoolBlockHeader);
+    return (((address + alignment - 1) & ~(uintptr_t)(alignment - 1)) -
+            (uintptr_t)pool_);
+  }
+
+  void *allocate_block(uint32_t size, uint32_t alignment) {
+    if (size > PoolSize) { return NULL; }
+    if (alignment < POOL_UNIT) { alignment = POOL_UNIT; }
+    size = (size + POOL_UNIT - 1) & ~(POOL_UNIT - 1);
+
+    // First free block the request fits in at the requested alignment.
+    uint32_t start = 0;
+    uint32_t end = 0;
+    uint32_t payload = 0;
+    FreeBlock **link = &pool_free_list_;
+    for (; *link != NULL; link = &(*link)->next) {
+      start = (uint8_t *)*link - pool_;
+      end = start + (*link)->size;
+      payload = payload_offset(start, alignment);
+      if (payload + size <= end) { break; }
+    }
+    if (*link != NULL) {
+      stats_.free_list_bytes -= end - start;
+      *link = (*link)->next;
+    } else {
+      // Carve new block from the end of the used part of the pool.
+      start = pool_bump_;
+      payload = payload_offset(start, alignment);
+      if (payload + size > PoolSize) { return NULL; }
+      end = payload + size;
+      stats_.bump_bytes += end - pool_bump_;
+      pool_bump_ = end;
+    }
+
+    // Split off unused space before and after the payload, if large enough.
+    const uint32_t header_start = payload - sizeof(PoolBlockHeader);
+    if (header_start - start >= MIN_BLOCK_SIZE) {
+      push_block(start, header_start - start);
+      start = header_start;
+    }
+    if (end - (payload + size) >= MIN_BLOCK_SIZE) {
+      push_block(payload + size, end - (payload + size));
+      end = payload + size;
+    }
+
+    PoolBlockHeader &header = *(PoolBlockHeader *)(pool_ + header_start);
+    header.offset = start;
+    header.unit_count = (end - start) / POOL_UNIT;
+    header.overhead = end - start - size;
+    set(pool_allocated_, payload / POOL_UNIT);
+    stats_.in_use_bytes += end - start;
+    stats_.overhead_bytes += end - start - size;
+    return pool_ + payload;
+  }
+};
+
+}  // namespace teensy_minimal_rpc
+
+#endif  // #ifndef ___MEMORY_ARENA__H___
@@ -2,6 +2,23 @@
 
 namespace teensy {
 namespace pit {
+  /* Register field tables (see `codec::Field`), in order of Protocol Buffer
+   * field tags. */
+  // PIT Module Control Register (37.3.1/903)
+  constexpr codec::Field MCR_FIELDS[] = {
+    PB_REGISTER_BIT(teensy__3_1_pit_R_MCR, PIT_MCR, MDIS),  // Module Disable
+    PB_REGISTER_BIT(teensy__3_1_pit_R_MCR, PIT_MCR, FRZ),  // Freeze
+  };
+  // Timer Control Register (37.3.4/905)
+  constexpr codec::Field TCTRL_FIELDS[] = {
+    PB_REGISTER_BIT(teensy__3_1_pit_R_TCTRL, PIT_TCTRL, CHN),  // Chain Mode
+    PB_REGISTER_BIT(teensy__3_1_pit_R_TCTRL, PIT_TCTRL, TIE),  // Timer Interrupt Enable
+    PB_REGISTER_BIT(teensy__3_1_pit_R_TCTRL, PIT_TCTRL, TEN),  // Timer Enable
+  };
+  // Timer Flag Register (37.3.5/906)
+  constexpr codec::Field TFLG_FIELDS[] = {
+    PB_REGISTER_BIT(teensy__3_1_pit_R_TFLG, PIT_TFLG, TIF),  // Timer Interrupt Flag
+  };
 
   UInt8Array serialize_timer_config(uint8_t index, UInt8Array buffer) {
     teensy__3_1_pit_TimerConfig result =
@@ -26,13 +43,10 @@ namespace pit {
     result.CVAL = CVAL;
 
     result.has_TCTRL = true;
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.TCTRL, PIT_TCTRL, CHN, TCTRL) // Chain Mode (37.3.4/905)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.TCTRL, PIT_TCTRL, TIE, TCTRL) // Timer Interrupt Enable (37.3.4/905)
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.TCTRL, PIT_TCTRL, TEN, TCTRL) // Timer Enable (37.3.4/905)
+    codec::decode(TCTRL, TCTRL_FIELDS, result.TCTRL);
 
     result.has_TFLG = true;
-
-    PB_SET_TEENSY_REG_BIT_FROM_VAL(result.TFLG, PIT_TFLG, TIF, TFLG) // Timer Interrupt Flag (37.3.5/906)
+    codec::decode(TFLG, TFLG_FIELDS, result.TFLG);
 
     UInt8Array output =
       nanopb::serialize_to_array(result, teensy__3_1_pit_TimerConfig_fields,
@@ -63,13 +77,11 @@ namespace pit {
     if (pit_msg.has_LDVAL) { LDVAL = pit_msg.LDVAL; } // Timer Load Value Register (37.3.2/904)
     if (pit_msg.has_CVAL) { CVAL = pit_msg.CVAL; }    // Current Timer Value Register (37.3.3/905)
     if (pit_msg.has_TCTRL)  {
-      uint32_t tctrl = TCTRL;
-      PB_UPDATE_TEENSY_REG_BIT(pit_msg.TCTRL, PIT_TCTRL, CHN, tctrl) // Chain Mode (37.3.4/905)
-      PB_UPDATE_TEENSY_REG_BIT(pit_msg.TCTRL, PIT_TCTRL, TIE, tctrl) // Timer Interrupt Enable (37.3.4/905)
-      PB_UPDATE_TEENSY_REG_BIT(pit_msg.TCTRL, PIT_TCTRL, TEN, tctrl) // Timer Enable (37.3.4/905)
-      TCTRL = tctrl;
+      TCTRL = codec::encode(pit_msg.TCTRL, TCTRL_FIELDS, TCTRL);
+    }
+    if (pit_msg.has_TFLG) {
+      TFLG = codec::encode(pit_msg.TFLG, TFLG_FIELDS, TFLG);
     }
-    PB_UPDATE_TEENSY_REG_BIT(pit_msg.TFLG, PIT_TFLG, TIF, TFLG) // Timer Interrupt Flag (37.3.5/906)
 
     return 0;
   }
@@ -79,8 +91,7 @@ namespace pit {
       teensy__3_1_pit_Registers_init_default;
 
     result.has_MCR = true;
-    PB_SET_TEENSY_REG_BIT(result.MCR, PIT_MCR, MDIS) // Module Disable (37.3.1/903)
-    PB_SET_TEENSY_REG_BIT(result.MCR, PIT_MCR, FRZ) // Freeze (37.3.1/903)
+    codec::decode(PIT_MCR, MCR_FIELDS, result.MCR);
 
     UInt8Array output =
       nanopb::serialize_to_array(result, teensy__3_1_pit_Registers_fields,
@@ -99,14 +110,26 @@ namespace pit {
 
 
     if (pit_msg.has_MCR)  {
-      uint32_t pit_mcr = PIT_MCR;
-      PB_UPDATE_TEENSY_REG_BIT(pit_msg.MCR, PIT_MCR, MDIS, pit_mcr) // Module Disable (37.3.1/903)
-      PB_UPDATE_TEENSY_REG_BIT(pit_msg.MCR, PIT_MCR, FRZ, pit_mcr) // Freeze (37.3.1/903)
-      PIT_MCR = pit_mcr;
+      PIT_MCR = codec::encode(pit_msg.MCR, MCR_FIELDS, PIT_MCR);
     }
 
     return 0;
   }
+
+  UInt8Array snapshot_registers(UInt8Array buffer) {
+    const uint8_t timer_count = 4;
+    const uint8_t count = 1 + 4 * timer_count;
+    UInt8Array output = buffer;
+    output.length = 0;
+    if (buffer.length < count * sizeof(uint32_t)) { return output; }
+
+    uint32_t *words = (uint32_t *)buffer.data;
+    words[0] = PIT_MCR;
+    const volatile uint32_t *timers = timer_index_to_registers_addr(0);
+    for (uint8_t i = 0; i < 4 * timer_count; i++) { words[1 + i] = timers[i]; }
+    output.length = count * sizeof(uint32_t);
+    return output;
+  }
 }  // namespace pit
 }  // namespace teensy
 
@@ -5,7 +5,7 @@
 #include <CArrayDefs.h>  // UInt8Array
 #include <pb_cpp_api.h>  // nanopb::serialize_to_array
 #include <TeensyMinimalRpc/PIT_pb.h>
-#include <TeensyMinimalRpc/RegisterMacros.h>
+#include <TeensyMinimalRpc/RegisterCodec.h>
 
 
 namespace teensy {
@@ -17,6 +17,13 @@ namespace pit {
   }
 
   UInt8Array serialize_registers(UInt8Array buffer);
+  /* Copy raw `PIT_MCR` followed by `LDVAL`, `CVAL`, `TCTRL`, and `TFLG` of
+   * each of the four timers to \a buffer, without decoding any field (see
+   * `serialize_registers`).
+   *
+   * Returns view of \a buffer holding the registers (empty if \a buffer is
+   * too small). */
+  UInt8Array snapshot_registers(UInt8Array buffer);
   int8_t update_registers(UInt8Array serialized_registers);
 
   UInt8Array serialize_timer_config(uint8_t index, UInt8Array buffer);
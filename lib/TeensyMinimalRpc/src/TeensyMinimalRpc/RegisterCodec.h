@@ -0,0 +1,137 @@
+#ifndef ___TEENSY__REGISTER_CODEC__H___
+#define ___TEENSY__REGISTER_CODEC__H___
+
+#include <stddef.h>  // offsetof
+#include <stdint.h>
+
+
+namespace teensy {
+namespace codec {
+  /*
+   * Bit field of a register, mapped to an `optional` field of the
+   * corresponding Protocol Buffer message.
+   *
+   * Each register is described once as a `constexpr` table of fields (see
+   * `PB_REGISTER_BIT` and `PB_REGISTER_BITS`), which `decode` and `encode`
+   * expand into one statement per field at compile time.  Since the table
+   * is constant, each statement folds to fixed offsets, shifts, and masks,
+   * and the register is only read once per table.
+   */
+  struct Field {
+    uint8_t has_offset;  // Offset of `has_<FIELD>` flag in message.
+    uint8_t offset;  // Offset of `<FIELD>` value in message.
+    uint8_t size;  // Size of `<FIELD>` value (1: `bool`, 4: enum or integer).
+    uint8_t shift;  // Position of least-significant bit within register.
+    uint8_t width;  // Bit-width of field within register.
+  };
+
+  /* Position of least-significant set bit of \a mask, e.g., to look up the
+   * shift of a single-bit register mask (e.g., `DMA_TCD_CSR_START`). */
+  constexpr uint8_t mask_shift(uint32_t mask, uint8_t shift=0) {
+    return (mask & 0x1) ? shift : mask_shift(mask >> 1, shift + 1);
+  }
+
+  /* Compile-time list of table indices. */
+  template <size_t... I> struct Indices {};
+  template <size_t N, size_t... I>
+  struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+  template <size_t... I>
+  struct MakeIndices<0, I...> { typedef Indices<I...> type; };
+
+  inline __attribute__((always_inline))
+  uint32_t field_mask(const Field &field) {
+    return 0xFFFFFFFF >> (32 - field.width);
+  }
+
+  inline __attribute__((always_inline))
+  int decode_field(uint32_t value, const Field &field, uint8_t *message) {
+    const uint32_t field_value = (value >> field.shift) & field_mask(field);
+
+    message[field.has_offset] = true;
+    if (field.size == 1) {
+      message[field.offset] = field_value;
+    } else {
+      *reinterpret_cast<uint32_t *>(message + field.offset) = field_value;
+    }
+    return 0;
+  }
+
+  inline __attribute__((always_inline))
+  uint32_t encode_field(uint32_t value, const Field &field,
+                        const uint8_t *message) {
+    if (!message[field.has_offset]) { return value; }
+
+    const uint32_t field_value =
+      ((field.size == 1) ? message[field.offset]
+       : *reinterpret_cast<const uint32_t *>(message + field.offset));
+    const uint32_t mask = field_mask(field) << field.shift;
+    if (field.width == 1) {
+      // Any non-zero value sets a single-bit field.
+      return field_value ? (value | mask) : (value & ~mask);
+    }
+    return (value & ~mask) | ((field_value << field.shift) & mask);
+  }
+
+  template <size_t N, size_t... I>
+  inline __attribute__((always_inline))
+  void decode(uint32_t value, const Field (&fields)[N], uint8_t *message,
+              Indices<I...>) {
+    // Braced initializers are evaluated in order, one per field.
+    int expand[] = {decode_field(value, fields[I], message)...};
+    (void)expand;
+  }
+
+  template <size_t N, size_t... I>
+  inline __attribute__((always_inline))
+  uint32_t encode(uint32_t value, const Field (&fields)[N],
+                  const uint8_t *message, Indices<I...>) {
+    int expand[] = {(value = encode_field(value, fields[I], message), 0)...};
+    (void)expand;
+    return value;
+  }
+
+  /* Set each message field in \a fields (and its `has_` flag) from the
+   * corresponding bits of register value \a value. */
+  template <typename Message, size_t N>
+  inline __attribute__((always_inline))
+  void decode(uint32_t value, const Field (&fields)[N], Message &message) {
+    decode(value, fields, reinterpret_cast<uint8_t *>(&message),
+           typename MakeIndices<N>::type());
+  }
+
+  /* Return \a value with the bits of each field in \a fields that is set
+   * (i.e., has `has_` flag) in \a message replaced by the message value.
+   *
+   * Values are masked to the field width (i.e., never spill into
+   * neighbouring fields), and any non-zero value sets a single-bit field. */
+  template <typename Message, size_t N>
+  inline __attribute__((always_inline))
+  uint32_t encode(const Message &message, const Field (&fields)[N],
+                  uint32_t value) {
+    return encode(value, fields, reinterpret_cast<const uint8_t *>(&message),
+                  typename MakeIndices<N>::type());
+  }
+}  // namespace codec
+}  // namespace teensy
+
+
+/*
+ * Register field table entries (see `teensy::codec::Field`).
+ *  - `MSG`: Protocol Buffer message type (e.g., `teensy__3_1_dma_R_TCD_CSR`).
+ *  - `REG`: Name of Teensy register (e.g., `DMA_TCD_CSR`).
+ *  - `FIELD`: Name of field (e.g., `INTMAJOR`).
+ *  - `width`: Bit-width of register field.
+ *  - `shift`: Position of least-significant bit of field within register.
+ */
+#define PB_REGISTER_FIELD_OFFSETS(MSG, FIELD) \
+  offsetof(MSG, has_##FIELD), offsetof(MSG, FIELD), \
+  sizeof(static_cast<MSG *>(0)->FIELD)
+
+#define PB_REGISTER_BIT(MSG, REG, FIELD) \
+  {PB_REGISTER_FIELD_OFFSETS(MSG, FIELD), \
+   teensy::codec::mask_shift(REG##_##FIELD), 1}
+
+#define PB_REGISTER_BITS(MSG, width, shift, FIELD) \
+  {PB_REGISTER_FIELD_OFFSETS(MSG, FIELD), shift, width}
+
+#endif  // #ifndef ___TEENSY__REGISTER_CODEC__H___
@@ -0,0 +1,240 @@
+#include <stddef.h>
+#include <string.h>
+#include "RegisterTransaction.h"
+#include "DMA.h"
+#include "ADC.h"
+#include "PIT.h"
+
+namespace teensy {
+namespace registers {
+  const uint16_t HEADER_SIZE = sizeof(OpHeader);
+  const uint16_t TCD_SIZE = sizeof(DMABaseClass::TCD_t);
+  const uint16_t REGISTER_PAYLOAD_SIZE = 2 * sizeof(uint32_t);  // Mask, value
+  const uint16_t POKE_PAYLOAD_SIZE = 3 * sizeof(uint32_t);  // Address, ...
+  const uint16_t TOKEN_PAYLOAD_SIZE = 2 * sizeof(uint32_t);  // Expected, new
+
+  static uint32_t token_ = 0;
+
+  /* Register written by an operation. */
+  struct Register {
+    volatile void *address;
+    uint8_t width;  // 1 or 4 bytes.
+    bool full_mask_only;  // Write-only or write-1-to-clear.
+  };
+
+  static inline uint32_t read_u32(const uint8_t *data) {
+    // Operations are packed, so payload words may be unaligned.
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+  }
+
+  static bool dma_register(uint16_t index, Register &reg) {
+    reg.width = 4;
+    reg.full_mask_only = false;
+    if (index >= DMA_DCHPRI_INDEX) {
+      const uint16_t channel = index - DMA_DCHPRI_INDEX;
+      if (channel >= DMA_NUM_CHANNELS) { return false; }
+      reg.address = dma::channel_to_dchpri_addr(channel);
+      reg.width = 1;
+      return true;
+    }
+    reg.address = (volatile uint8_t *)&DMA_CR + index;
+    switch (index) {
+      case 0x00: case 0x0C: case 0x14:  // `CR`, `ERQ`, `EEI`
+        return true;
+      case 0x24: case 0x2C:  // `INT`, `ERR`
+        reg.full_mask_only = true;
+        return true;
+      default:
+        // `CEEI`, `SEEI`, `CERQ`, `SERQ`, `CDNE`, `SSRT`, `CERR`, `CINT`
+        reg.width = 1;
+        reg.full_mask_only = true;
+        return (index >= 0x18) && (index <= 0x1F);
+    }
+  }
+
+  /* Resolve register written by `OP_MUX` ... `OP_SIM` operation. */
+  static bool resolve_register(const OpHeader &header, Register &reg) {
+    const uint32_t adc_count = 2;
+    const uint16_t adc_ra_index = (offsetof(adc::AdcRegister_t, RA) /
+                                   sizeof(uint32_t));
+    reg.width = 4;
+    reg.full_mask_only = false;
+
+    switch (header.type) {
+      case OP_MUX:
+        if (header.target >= DMA_NUM_CHANNELS) { return false; }
+        reg.address = (volatile uint8_t *)&DMAMUX0_CHCFG0 + header.target;
+        reg.width = 1;
+        return true;
+      case OP_DMA:
+        return dma_register(header.index, reg);
+      case OP_ADC:
+        if ((header.target >= adc_count) ||
+            (header.index >= (sizeof(adc::AdcRegister_t) /
+                              sizeof(uint32_t))) ||
+            (header.index == adc_ra_index) ||
+            (header.index == adc_ra_index + 1)) { return false; }
+        reg.address = ((header.target ? &ADC1_SC1A : &ADC0_SC1A) +
+                       header.index);
+        return true;
+      case OP_PIT:
+        if (header.index == 0) {
+          reg.address = &PIT_MCR;
+          return true;
+        }
+        // Four timers of `LDVAL`, `CVAL`, `TCTRL`, `TFLG`.
+        if ((header.index > 16) || ((header.index - 1) % 4 == 1)) {
+          return false;
+        }
+        reg.address = pit::timer_index_to_registers_addr(0) + header.index - 1;
+        reg.full_mask_only = ((header.index - 1) % 4 == 3);  // `TFLG`
+        return true;
+      case OP_SIM:
+        if ((header.index < 4) || (header.index > 7)) { return false; }
+        // `SIM_SCGC4` to `SIM_SCGC7` are contiguous.
+        reg.address = &SIM_SCGC4 + (header.index - 4);
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  static inline void write_masked(const Register &reg, uint32_t mask,
+                                  uint32_t value) {
+    if (reg.width == 1) {
+      volatile uint8_t &target = *(volatile uint8_t *)reg.address;
+      target = (mask == FULL_MASK) ? value : ((target & ~mask) |
+                                              (value & mask));
+    } else {
+      volatile uint32_t &target = *(volatile uint32_t *)reg.address;
+      target = (mask == FULL_MASK) ? value : ((target & ~mask) |
+                                              (value & mask));
+    }
+  }
+
+  uint32_t token() { return token_; }
+  void invalidate_token() { token_ = 0; }
+
+  /* Size of operation of type \a type (header and payload). */
+  static inline uint16_t op_size(uint8_t type) {
+    switch (type) {
+      case OP_TCD: return HEADER_SIZE + TCD_SIZE;
+      case OP_POKE: return HEADER_SIZE + POKE_PAYLOAD_SIZE;
+      case OP_TOKEN: return HEADER_SIZE + TOKEN_PAYLOAD_SIZE;
+      default: return HEADER_SIZE + REGISTER_PAYLOAD_SIZE;
+    }
+  }
+
+  uint16_t validate_op(const uint8_t *data, uint32_t size) {
+    if (size < HEADER_SIZE) { return 0; }
+    OpHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (size < op_size(header.type)) { return 0; }
+
+    switch (header.type) {
+      case OP_TCD:
+        if (header.target >= DMA_NUM_CHANNELS) { return 0; }
+        break;
+      case OP_POKE:
+        if (read_u32(data + HEADER_SIZE) & 0x3) { return 0; }
+        break;
+      case OP_TOKEN:
+        if ((header.target & 0x1) &&
+            (read_u32(data + HEADER_SIZE) != token_)) { return 0; }
+        break;
+      default:
+        Register reg;
+        if (!resolve_register(header, reg) ||
+            (reg.full_mask_only &&
+             (read_u32(data + HEADER_SIZE) != FULL_MASK))) { return 0; }
+        break;
+    }
+    return op_size(header.type);
+  }
+
+  void apply_op(const uint8_t *data) {
+    OpHeader header;
+    memcpy(&header, data, sizeof(header));
+    const uint8_t *payload = data + HEADER_SIZE;
+
+    switch (header.type) {
+      case OP_TCD: {
+        /* Copy descriptor as 32-bit words, with `CSR` (and `BITER`) in the
+         * last word, written after every other field. */
+        volatile uint32_t *tcd = (volatile uint32_t *)&dma::TCD(header.target);
+        const uint8_t word_count = TCD_SIZE / sizeof(uint32_t);
+        dma::TCD(header.target).CSR = 0;
+        for (uint8_t i = 0; i < word_count; i++) {
+          tcd[i] = read_u32(payload + i * sizeof(uint32_t));
+        }
+        break;
+      }
+      case OP_POKE: {
+        Register reg;
+        reg.address = (volatile uint32_t *)(uintptr_t)read_u32(payload);
+        reg.width = 4;
+        write_masked(reg, read_u32(payload + 4), read_u32(payload + 8));
+        break;
+      }
+      case OP_TOKEN:
+        token_ = read_u32(payload + 4);
+        break;
+      default: {
+        Register reg;
+        resolve_register(header, reg);
+        const uint32_t mask = read_u32(payload);
+        const uint32_t value = read_u32(payload + 4);
+        if (header.type == OP_MUX) {
+          // Channel source must be disabled while it is changed.
+          volatile uint8_t &chcfg = *(volatile uint8_t *)reg.address;
+          const uint8_t previous = chcfg;
+          chcfg = 0;
+          chcfg = (mask == FULL_MASK) ? value : ((previous & ~mask) |
+                                                 (value & mask));
+        } else {
+          write_masked(reg, mask, value);
+        }
+        break;
+      }
+    }
+  }
+
+  TransactionResult apply_transaction(UInt8Array ops) {
+    TransactionResult result;
+    result.op_count = 0;
+    result.failed_index = 0xFFFFFFFF;
+
+    // Validate all operations before writing any register.
+    bool token_seen = false;
+    for (uint32_t offset = 0; offset < ops.length; result.op_count++) {
+      const uint16_t op_size = validate_op(&ops.data[offset],
+                                           ops.length - offset);
+      const bool is_token = (op_size > 0) && (ops.data[offset] == OP_TOKEN);
+      if ((op_size == 0) || (is_token && token_seen)) {
+        result.failed_index = result.op_count;
+        result.dma_es = DMA_ES;
+        return result;
+      }
+      token_seen |= is_token;
+      offset += op_size;
+    }
+
+    /* Operations are known to be complete and valid, so each size follows
+     * from the operation type alone.  (Validating again would compare an
+     * `OP_TOKEN` against the token already written by this transaction.) */
+    __disable_irq();
+    for (uint32_t offset = 0; offset < ops.length;
+         offset += op_size(ops.data[offset])) {
+      apply_op(&ops.data[offset]);
+    }
+    // Registers were written without checking the token.
+    if (!token_seen) { invalidate_token(); }
+    __enable_irq();
+    result.failed_index = result.op_count;
+    result.dma_es = DMA_ES;
+    return result;
+  }
+}  // namespace registers
+}  // namespace teensy
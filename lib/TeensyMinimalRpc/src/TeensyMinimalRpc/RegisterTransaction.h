@@ -0,0 +1,99 @@
+#ifndef ___TEENSY__REGISTER_TRANSACTION__H___
+#define ___TEENSY__REGISTER_TRANSACTION__H___
+
+#include <stdint.h>
+#include <kinetis.h>
+#include <CArrayDefs.h>  // UInt8Array
+
+
+namespace teensy {
+namespace registers {
+  /*
+   * Ordered list of typed register writes, applied as a single transaction
+   * (see `apply_transaction`).
+   *
+   * Each operation is a 4-byte `OpHeader` followed by its payload (all
+   * fields little-endian, no padding):
+   *
+   *  - `OP_TCD`: raw 32-byte transfer control descriptor of DMA channel
+   *    `target`.  `CSR` is cleared first and written last, so the channel
+   *    is never started with a partially written descriptor.
+   *  - `OP_POKE`: 32-bit word-aligned address, followed by mask and value.
+   *  - `OP_TOKEN`: expected token, followed by new token (see `token`).  If
+   *    bit 0 of `target` is set, the transaction is invalid unless the
+   *    current token equals the expected token.  A transaction holds at
+   *    most one `OP_TOKEN`.
+   *  - Otherwise: mask and value (32 bits each) of register `index` of
+   *    `target`:
+   *     * `OP_MUX`: `DMAMUX0_CHCFG` of channel `target`.  The channel source
+   *       is disabled before the new value is written.
+   *     * `OP_DMA`: DMA controller register at byte offset `index` from
+   *       `DMA_CR` (i.e., `CR`, `ERQ`, `EEI`, `CEEI`...`CINT`, `INT`, or
+   *       `ERR`), or `DCHPRI` of channel `index - DMA_DCHPRI_INDEX`.
+   *     * `OP_ADC`: word `index` of `adc::AdcRegister_t` of ADC `target`
+   *       (`RA` and `RB` are read-only).
+   *     * `OP_PIT`: `PIT_MCR` (`index` 0) or word `index - 1` of the
+   *       `LDVAL`, `CVAL`, `TCTRL`, `TFLG` timer registers (`CVAL` is
+   *       read-only).
+   *     * `OP_SIM`: `SIM_SCGC<index>` (4 to 7).
+   *
+   * A mask of `0xFFFFFFFF` writes the value as-is; any other mask
+   * read-modify-writes only the masked bits.  Write-only and
+   * write-1-to-clear registers (e.g., `DMA_SERQ`, `DMA_INT`, `PIT_TFLG`)
+   * only accept a full mask.
+   */
+  enum OpType {
+    OP_TCD = 1,
+    OP_MUX = 2,
+    OP_DMA = 3,
+    OP_ADC = 4,
+    OP_PIT = 5,
+    OP_SIM = 6,
+    OP_POKE = 7,
+    OP_TOKEN = 8,
+  };
+
+  struct __attribute__((packed)) OpHeader {
+    uint8_t type;
+    uint8_t target;
+    uint16_t index;
+  };
+
+  const uint32_t FULL_MASK = 0xFFFFFFFF;
+  // `OP_DMA` index of `DCHPRI` of channel 0.
+  const uint16_t DMA_DCHPRI_INDEX = 0x100;
+
+  struct TransactionResult {
+    uint32_t op_count;  // Number of operations parsed.
+    /* Index of first malformed or invalid operation, or `op_count` if all
+     * operations were applied. */
+    uint32_t failed_index;
+    uint32_t dma_es;  // `DMA_ES` after the transaction.
+  };
+
+  /* Token identifying the register state last written by a transaction,
+   * e.g., to validate a host copy of the registers before skipping writes
+   * of unchanged values.
+   *
+   * The token is 0 (i.e., unknown state) after reset, and is cleared by
+   * `invalidate_token` whenever registers are written by other means
+   * (including transactions without an `OP_TOKEN` operation). */
+  uint32_t token();
+  void invalidate_token();
+
+  /* Returns size of operation (header and payload) starting at \a data, or
+   * 0 if the operation is truncated, of unknown type, or refers to an
+   * invalid register. */
+  uint16_t validate_op(const uint8_t *data, uint32_t size);
+  /* Apply operation at \a data, which must have passed `validate_op`. */
+  void apply_op(const uint8_t *data);
+
+  /* Validate every operation in \a ops; if all operations are valid, apply
+   * them in order with interrupts disabled.  Nothing is written if any
+   * operation is invalid, or if \a ops holds more than one `OP_TOKEN`
+   * (`failed_index` is the index of the second `OP_TOKEN`). */
+  TransactionResult apply_transaction(UInt8Array ops);
+}  // namespace registers
+}  // namespace teensy
+
+#endif  // #ifndef ___TEENSY__REGISTER_TRANSACTION__H___
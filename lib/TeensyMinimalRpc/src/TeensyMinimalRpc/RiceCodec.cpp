@@ -0,0 +1,158 @@
+#include <string.h>
+#include "RiceCodec.h"
+
+
+namespace teensy_minimal_rpc {
+  /* Little-endian bit stream, stored a whole word at a time.  `put` fails
+   * once the stream would run past `end_`. */
+  class BitWriter {
+  public:
+    typedef uint32_t __attribute__((__may_alias__)) word_t;
+
+    word_t *words_;
+    word_t *end_;
+    uint64_t stream_;
+    uint8_t stream_bits_;
+
+    BitWriter(uint8_t *data, uint32_t size)
+      : words_((word_t *)data), end_((word_t *)(data + size)), stream_(0),
+        stream_bits_(0) {}
+
+    /* Append the low \a length (at most 32) bits of \a value. */
+    inline bool put(uint32_t value, uint8_t length) {
+      stream_ |= (uint64_t)value << stream_bits_;
+      stream_bits_ += length;
+      if (stream_bits_ >= 32) {
+        if (words_ >= end_) { return false; }
+        *words_++ = (uint32_t)stream_;
+        stream_ >>= 32;
+        stream_bits_ -= 32;
+      }
+      return true;
+    }
+
+    /* Write remaining (partial) word.  Returns end of stream, or `NULL` if
+     * it would run past `end_`. */
+    uint8_t *flush() {
+      uint8_t *bytes = (uint8_t *)words_;
+      if (bytes + (stream_bits_ + 7) / 8 > (uint8_t *)end_) { return NULL; }
+      for (; stream_bits_ > 0;
+           stream_bits_ -= (stream_bits_ < 8) ? stream_bits_ : 8) {
+        *bytes++ = (uint8_t)stream_;
+        stream_ >>= 8;
+      }
+      return bytes;
+    }
+  };
+
+  static inline bool put_residual(BitWriter &writer, uint32_t residual,
+                                  uint8_t k) {
+    const uint32_t quotient = residual >> k;
+    if (quotient >= RICE_ESCAPE_QUOTIENT) {
+      return (writer.put((1UL << RICE_ESCAPE_QUOTIENT) - 1,
+                         RICE_ESCAPE_QUOTIENT) &&
+              writer.put(residual, RICE_RESIDUAL_BITS));
+    }
+    // Unary quotient, terminating `0`, and remainder in a single code.
+    const uint32_t remainder = residual & ((1UL << k) - 1);
+    return writer.put(((1UL << quotient) - 1) | (remainder << (quotient + 1)),
+                      quotient + 1 + k);
+  }
+
+  int8_t RiceEncoder::configure(const BlockLayout &layout,
+                                uint16_t partition_size) {
+    if (!layout.valid() || (partition_size == 0) ||
+        (partition_size > RICE_MAX_PARTITION_SIZE)) { return -1; }
+    deallocate();
+
+    layout_ = layout;
+    partition_size_ = partition_size;
+    // Raw samples in whole words, i.e., the largest block ever sent.
+    const uint32_t size = (sizeof(RiceBlockHeader) +
+                           (raw_size() + 3) / 4 * 4);
+    buffer_ = UInt8Array_init(size, (uint8_t *)malloc(size));
+    if (buffer_.data == NULL) {
+      deallocate();
+      return -3;
+    }
+    return 0;
+  }
+
+  void RiceEncoder::deallocate() {
+    free(buffer_.data);
+    buffer_ = UInt8Array_init_default();
+    layout_.channel_count = 0;
+  }
+
+  UInt8Array RiceEncoder::encode(UInt8Array block,
+                                 const BlockLayout &layout) {
+    UInt8Array output = UInt8Array_init_default();
+    // Coding buffer holds the configured (raw) block size.
+    if (!enabled() || (layout.channel_count != layout_.channel_count) ||
+        (layout.sample_count > layout_.sample_count) || !layout.valid() ||
+        !layout.fits(block)) {
+      return output;
+    }
+
+    const uint16_t *samples = (const uint16_t *)block.data;
+    RiceBlockHeader header;
+    header.channel_count = layout.channel_count;
+    header.sample_count = layout.sample_count;
+    header.partition_size = partition_size_;
+    header.coded = 1;
+    header.reserved = 0;
+
+    // Payload must be smaller than the raw samples.
+    uint8_t *payload = buffer_.data + sizeof(header);
+    BitWriter writer(payload, raw_size(layout) & ~0x3);
+    bool ok = true;
+
+    for (uint16_t c = 0; ok && (c < layout.channel_count); c++) {
+      const uint16_t *input = samples + c * (uint32_t)layout.channel_stride;
+      uint16_t previous = *input;
+      ok = writer.put(previous, 16);
+
+      for (uint16_t i = 1; ok && (i < layout.sample_count); ) {
+        const uint16_t count = (((layout.sample_count - i) < partition_size_)
+                                ? layout.sample_count - i : partition_size_);
+        uint32_t sum = 0;
+        for (uint16_t j = 0; j < count; j++) {
+          input += layout.sample_stride;
+          const int32_t difference = (int32_t)*input - previous;
+          // Zig-zag map, i.e., `2 * d` for `d >= 0`, `-2 * d - 1` otherwise.
+          const uint32_t residual = (((uint32_t)difference << 1) ^
+                                     (uint32_t)(difference >> 31));
+          residuals_[j] = residual;
+          sum += residual;
+          previous = *input;
+        }
+        // Smallest `k` such that `2^k` is at least about the mean residual.
+        uint8_t k = 0;
+        while ((k < RICE_MAX_PARAMETER) &&
+               (((uint32_t)count << (k + 1)) <= sum)) { k++; }
+        ok = writer.put(k, RICE_PARAMETER_BITS);
+        for (uint16_t j = 0; ok && (j < count); j++) {
+          ok = put_residual(writer, residuals_[j], k);
+        }
+        i += count;
+      }
+    }
+    uint8_t *end = ok ? writer.flush() : NULL;
+
+    if (end == NULL) {
+      // Send raw samples (channel-major) instead.
+      header.coded = 0;
+      uint16_t *raw = (uint16_t *)payload;
+      for (uint16_t c = 0; c < layout.channel_count; c++) {
+        const uint16_t *input = samples + c * (uint32_t)layout.channel_stride;
+        for (uint16_t i = 0; i < layout.sample_count;
+             i++, input += layout.sample_stride) { *raw++ = *input; }
+      }
+      end = (uint8_t *)raw;
+    }
+    memcpy(buffer_.data, &header, sizeof(header));
+    output.data = buffer_.data;
+    output.length = end - buffer_.data;
+    return output;
+  }
+}  // namespace teensy_minimal_rpc
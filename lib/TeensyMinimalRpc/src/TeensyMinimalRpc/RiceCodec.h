@@ -0,0 +1,96 @@
+#ifndef ___RICE_CODEC__H___
+#define ___RICE_CODEC__H___
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <CArrayDefs.h>  // UInt8Array
+#include <TeensyMinimalRpc/BlockLayout.h>
+
+
+namespace teensy_minimal_rpc {
+
+const uint16_t RICE_MAX_PARTITION_SIZE = 256;
+// Bits used to store the Rice parameter `k` of each partition.
+const uint8_t RICE_PARAMETER_BITS = 5;
+const uint8_t RICE_MAX_PARAMETER = 16;
+/* Quotients of at least this value are escaped, i.e., written as this many
+ * `1` bits followed by the raw residual. */
+const uint8_t RICE_ESCAPE_QUOTIENT = 16;
+const uint8_t RICE_RESIDUAL_BITS = 17;  // Zig-zag coded 16-bit difference.
+
+/*
+ * Header of block produced by `RiceEncoder::encode`.
+ */
+struct RiceBlockHeader {
+  uint16_t channel_count;
+  uint16_t sample_count;  // Number of samples per channel.
+  uint16_t partition_size;
+  /* 1: Rice coded payload.  0: payload is raw `uint16_t` samples,
+   * channel-major (i.e., coding would not have made the block smaller). */
+  uint8_t coded;
+  uint8_t reserved;
+} __attribute__((packed));
+
+
+/*
+ * Lossless coder for blocks of `uint16_t` samples, for slowly varying
+ * signals (e.g., oversampled ADC channels).
+ *
+ * Each channel is coded as its first sample (16 bits), followed by the
+ * differences between consecutive samples (i.e., first-order prediction),
+ * zig-zag mapped to unsigned residuals (`0, -1, 1, -2, ...` to `0, 1, 2, 3,
+ * ...`).  Residuals are split into partitions of `partition_size_`, and each
+ * partition is Golomb-Rice coded with its own parameter `k` (i.e., adapted
+ * to the local signal slope), chosen from the mean residual:
+ *
+ *     k (5 bits), then for each residual `u`:
+ *         (u >> k) `1` bits, a `0` bit, and the low `k` bits of `u`
+ *
+ * A quotient of `RICE_ESCAPE_QUOTIENT` or more is written as that many `1`
+ * bits followed by the 17-bit residual instead.
+ *
+ * All fields are written to a single little-endian bit stream (see
+ * `SamplePacker`), channel after channel, following a `RiceBlockHeader`.
+ * If the coded block would be at least as large as the raw samples, the
+ * raw samples are sent instead.
+ *
+ * Samples are read from each block as laid out by `layout_` (see
+ * `BlockLayout`).
+ */
+class RiceEncoder {
+public:
+  BlockLayout layout_;
+  uint16_t partition_size_;
+  uint32_t residuals_[RICE_MAX_PARTITION_SIZE];
+  UInt8Array buffer_;
+
+  RiceEncoder()
+    : layout_(), partition_size_(0) {
+    buffer_ = UInt8Array_init_default();
+  }
+  ~RiceEncoder() { deallocate(); }
+
+  /* Returns 0 on success, -1 on invalid arguments, or -3 if memory
+   * allocation failed. */
+  int8_t configure(const BlockLayout &layout, uint16_t partition_size);
+  void deallocate();
+
+  bool enabled() const { return buffer_.data != NULL; }
+  uint32_t raw_size() const { return raw_size(layout_); }
+  static uint32_t raw_size(const BlockLayout &layout) {
+    return ((uint32_t)layout.channel_count * layout.sample_count *
+            sizeof(uint16_t));
+  }
+
+  /* Returns coded \a block (in `buffer_`, valid until the next call), or an
+   * empty array if the block is too small for the configured layout. */
+  UInt8Array encode(UInt8Array block) { return encode(block, layout_); }
+  /* Same as above, for blocks laid out as \a layout (with the configured
+   * number of channels, and at most the configured number of samples)
+   * instead of the configured layout (e.g., `FirDecimator` output). */
+  UInt8Array encode(UInt8Array block, const BlockLayout &layout);
+};
+
+}  // namespace teensy_minimal_rpc
+
+#endif  // #ifndef ___RICE_CODEC__H___
@@ -1,6 +1,7 @@
 #ifndef ___ROOT_MEAN_SQUARE__HPP___
 #define ___ROOT_MEAN_SQUARE__HPP___
 
+#include <stdint.h>
 #include <cmath>
 
 namespace teensy_minimal_rpc {
@@ -46,5 +47,255 @@ float compute_rms(const T *data, S size) {
   return sqrt(sum_squared / float(size));
 }
 
+
+namespace rms {
+
+/*
+ * Sum and sum of squares of a block of 16-bit samples, accumulated exactly
+ * (in 64-bit integers) in a single pass.
+ *
+ * Mean, biased RMS, and mean-subtracted RMS are all derived from the two
+ * sums (see `mean`, `sub_rms`), so none of them needs a second pass over
+ * the samples.
+ */
+struct Sums {
+  int64_t sum;
+  uint64_t sum_squared;
+  uint32_t count;
+};
+
+
+/* Portable kernels (plain C, 32-bit products into 64-bit sums). */
+inline Sums sum_portable(const int16_t *data, uint32_t size) {
+  Sums sums = {0, 0, size};
+  int32_t sum = 0;  // Cannot overflow within `2^16` samples.
+
+  for (uint32_t i = 0; i < size; i++) {
+    const int32_t data_i = data[i];
+    sum += data_i;
+    sums.sum_squared += (uint32_t)(data_i * data_i);
+    if ((i & 0xFFFF) == 0xFFFF) { sums.sum += sum; sum = 0; }
+  }
+  sums.sum += sum;
+  return sums;
+}
+
+
+inline Sums sum_portable(const uint16_t *data, uint32_t size) {
+  Sums sums = {0, 0, size};
+  uint32_t sum = 0;  // Cannot overflow within `2^16` samples.
+
+  for (uint32_t i = 0; i < size; i++) {
+    const uint32_t data_i = data[i];
+    sum += data_i;
+    sums.sum_squared += data_i * data_i;
+    if ((i & 0xFFFF) == 0xFFFF) { sums.sum += sum; sum = 0; }
+  }
+  sums.sum += sum;
+  return sums;
+}
+
+
+#if defined(__ARM_FEATURE_DSP) || defined(RMS_EMULATE_DSP)
+/*
+ * Cortex-M4 kernels.
+ *
+ * Samples are loaded two at a time as 32-bit words.  `SMLALD` multiplies
+ * both signed halfwords of two words and adds both products to a 64-bit
+ * accumulator in a single cycle, so each word costs one `SMLALD` against
+ * itself (sum of squares) and one against `0x00010001` (sum).
+ *
+ * Define `RMS_EMULATE_DSP` to build these kernels without the DSP
+ * extension, with `SMLALD` emulated in C (e.g., to test them on the host).
+ * `sum` only uses them on the device.
+ */
+typedef uint32_t __attribute__((__may_alias__)) aliased_word_t;
+
+inline __attribute__((always_inline))
+uint64_t smlald(uint32_t x, uint32_t y, uint64_t acc) {
+#if defined(__ARM_FEATURE_DSP)
+  uint32_t low = (uint32_t)acc;
+  uint32_t high = (uint32_t)(acc >> 32);
+  __asm__ ("smlald %0, %1, %2, %3"
+           : "+r" (low), "+r" (high) : "r" (x), "r" (y));
+  return ((uint64_t)high << 32) | low;
+#else
+  const int32_t low = (int32_t)(int16_t)x * (int16_t)y;
+  const int32_t high = (int32_t)(int16_t)(x >> 16) * (int16_t)(y >> 16);
+  return acc + (uint64_t)((int64_t)low + high);
+#endif  // #if defined(__ARM_FEATURE_DSP)
+}
+
+
+/* Accumulate signed sums of \a size samples, each XOR-ed with \a flip
+ * (i.e., `0x8000` to map `uint16_t` samples onto `int16_t`). */
+inline void sum_dsp(const int16_t *data, uint32_t size, uint16_t flip,
+                    int64_t &sum, int64_t &sum_squared) {
+  const uint32_t flip_word = ((uint32_t)flip << 16) | flip;
+  const uint32_t ones = 0x00010001;
+  uint64_t sum_ = 0;
+  uint64_t sum_squared_ = 0;
+
+  // Leading sample, if data is not word-aligned.
+  if (size && ((uintptr_t)data & 0x2)) {
+    const int32_t data_i = (int16_t)(*data++ ^ flip);
+    sum_ += data_i;
+    sum_squared_ += (uint32_t)(data_i * data_i);
+    size--;
+  }
+
+  const aliased_word_t *words = (const aliased_word_t *)data;
+  uint32_t word_count = size >> 1;
+
+  for (; word_count >= 2; word_count -= 2) {
+    const uint32_t a = *words++ ^ flip_word;
+    const uint32_t b = *words++ ^ flip_word;
+    sum_ = smlald(a, ones, sum_);
+    sum_squared_ = smlald(a, a, sum_squared_);
+    sum_ = smlald(b, ones, sum_);
+    sum_squared_ = smlald(b, b, sum_squared_);
+  }
+  if (word_count) {
+    const uint32_t a = *words++ ^ flip_word;
+    sum_ = smlald(a, ones, sum_);
+    sum_squared_ = smlald(a, a, sum_squared_);
+  }
+  // Trailing sample.
+  if (size & 0x1) {
+    const int32_t data_i = (int16_t)(*(const int16_t *)words ^ flip);
+    sum_ += data_i;
+    sum_squared_ += (uint32_t)(data_i * data_i);
+  }
+  sum = (int64_t)sum_;
+  sum_squared = (int64_t)sum_squared_;
+}
+
+
+inline Sums sum_dsp(const int16_t *data, uint32_t size) {
+  int64_t sum, sum_squared;
+  sum_dsp(data, size, 0, sum, sum_squared);
+
+  Sums sums = {sum, (uint64_t)sum_squared, size};
+  return sums;
+}
+
+
+inline Sums sum_dsp(const uint16_t *data, uint32_t size) {
+  /* With `y = x - 2^15` (i.e., `x ^ 0x8000` as `int16_t`):
+   *
+   *     sum(x) = sum(y) + n * 2^15
+   *     sum(x^2) = sum(y^2) + 2^16 * sum(y) + n * 2^30 */
+  int64_t sum, sum_squared;
+  sum_dsp((const int16_t *)data, size, 0x8000, sum, sum_squared);
+
+  Sums sums = {sum + ((int64_t)size << 15),
+               (uint64_t)(sum_squared + sum * (1 << 16) +
+                          ((int64_t)size << 30)), size};
+  return sums;
+}
+#endif  // #if defined(__ARM_FEATURE_DSP) || defined(RMS_EMULATE_DSP)
+
+
+/* Sums of \a size samples, using the fastest kernel available. */
+template <typename T>
+inline Sums sum(const T *data, uint32_t size) {
+#if defined(__ARM_FEATURE_DSP)
+  return sum_dsp(data, size);
+#else
+  return sum_portable(data, size);
+#endif  // #if defined(__ARM_FEATURE_DSP)
+}
+
+
+inline float mean(const Sums &sums) {
+  return (double)sums.sum / sums.count;
+}
+
+
+/* RMS of samples after subtracting \a bias, i.e.,
+ * `sqrt(mean(x^2) - 2 * bias * mean(x) + bias^2)`.
+ *
+ * Evaluated in `double`, which represents both sums exactly for up to
+ * `2^21` samples. */
+inline float sub_rms(const Sums &sums, double bias) {
+  const double mean_ = (double)sums.sum / sums.count;
+  const double mean_squared = (double)sums.sum_squared / sums.count;
+  const double result = mean_squared - 2 * bias * mean_ + bias * bias;
+  return (result > 0) ? sqrt(result) : 0;
+}
+
+
+/* Variance of samples (i.e., mean of squared deviations from the mean).
+ *
+ * For up to `2^16` samples, `n * sum(x^2) - sum(x)^2` (i.e., `n^2` times the
+ * variance) fits in 64 bits and is computed exactly, so the result does not
+ * suffer from cancellation when the mean is large relative to the spread. */
+inline double variance(const Sums &sums) {
+  if (sums.count == 0) { return 0; }
+  if (sums.count <= (1UL << 16)) {
+    const uint64_t sum_magnitude = (sums.sum < 0) ? -sums.sum : sums.sum;
+    const uint64_t variance_n2 = (sums.count * sums.sum_squared -
+                                  sum_magnitude * sum_magnitude);
+    return (double)variance_n2 / ((double)sums.count * sums.count);
+  }
+  const double mean_ = (double)sums.sum / sums.count;
+  const double result = (double)sums.sum_squared / sums.count - mean_ * mean_;
+  return (result > 0) ? result : 0;
+}
+
+
+/* RMS of samples after subtracting their mean (see `variance`). */
+inline float mean_sub_rms(const Sums &sums) {
+  return sqrt(variance(sums));
+}
+
+
+inline float rms(const Sums &sums) {
+  return sqrt((double)sums.sum_squared / sums.count);
+}
+
+}  // namespace rms
+
+
+/* 16-bit sample overloads, computed from a single pass (see `rms::Sums`). */
+template <typename S>
+float compute_mean(const int16_t *data, S size) {
+  return rms::mean(rms::sum(data, size));
+}
+template <typename S>
+float compute_mean(const uint16_t *data, S size) {
+  return rms::mean(rms::sum(data, size));
+}
+
+
+template <typename S>
+float compute_sub_rms(const int16_t *data, S size, float bias) {
+  return rms::sub_rms(rms::sum(data, size), bias);
+}
+template <typename S>
+float compute_sub_rms(const uint16_t *data, S size, float bias) {
+  return rms::sub_rms(rms::sum(data, size), bias);
+}
+
+
+template <typename S>
+float compute_mean_sub_rms(const int16_t *data, S size) {
+  return rms::mean_sub_rms(rms::sum(data, size));
+}
+template <typename S>
+float compute_mean_sub_rms(const uint16_t *data, S size) {
+  return rms::mean_sub_rms(rms::sum(data, size));
+}
+
+
+template <typename S>
+float compute_rms(const int16_t *data, S size) {
+  return rms::rms(rms::sum(data, size));
+}
+template <typename S>
+float compute_rms(const uint16_t *data, S size) {
+  return rms::rms(rms::sum(data, size));
+}
+
 }  // namespace teensy_minimal_rpc
 #endif  // #ifndef ___ROOT_MEAN_SQUARE__HPP___
@@ -0,0 +1,163 @@
+#ifndef ___RPC_PROFILER__H___
+#define ___RPC_PROFILER__H___
+
+#include <stdint.h>
+#include <string.h>
+#include <kinetis.h>  // ARM_DWT_CYCCNT
+#include <CArrayDefs.h>  // UInt8Array
+
+
+namespace teensy_minimal_rpc {
+
+/* Statistics of one RPC command (see `RpcProfiler::record_command`). */
+struct CommandProfile {
+  uint16_t command;  // Command code (first two bytes of request).
+  uint16_t reserved;
+  uint32_t count;
+  uint64_t total_cycles;
+  uint32_t max_cycles;
+  uint32_t request_bytes;
+  uint32_t response_bytes;
+} __attribute__((packed));
+
+
+/* Main loop and serial statistics (see `RpcProfiler::serialize`). */
+struct LoopProfile {
+  uint64_t elapsed_cycles;  // Since last reset.
+  uint64_t loop_total_cycles;
+  uint32_t loop_count;
+  uint32_t loop_max_cycles;
+  uint32_t rx_bytes;  // Serial bytes received.
+  uint32_t tx_bytes;  // RPC response payload bytes sent.
+  uint32_t stream_bytes;  // `STREAM` packet payload bytes sent.
+  uint16_t command_count;  // Number of `CommandProfile` records that follow.
+  uint16_t dropped_commands;  // Calls of commands not in table (table full).
+} __attribute__((packed));
+
+
+/*
+ * Opt-in main loop and RPC dispatch statistics, in CPU cycles (DWT cycle
+ * counter, see `CycleCounter::begin`).
+ *
+ * Up to `COMMAND_CAPACITY` distinct command codes are tracked, in order of
+ * first call.
+ */
+class RpcProfiler {
+public:
+  static const uint8_t COMMAND_CAPACITY = 48;
+
+  bool enabled_;
+  uint64_t reset_time_;  // `CycleCounter::read` time of last reset.
+  uint32_t last_loop_;  // `ARM_DWT_CYCCNT` at start of last loop iteration.
+  LoopProfile loop_;
+  CommandProfile commands_[COMMAND_CAPACITY];
+
+  RpcProfiler() : enabled_(false) { reset(0); }
+
+  void reset(uint64_t now) {
+    reset_time_ = now;
+    last_loop_ = 0;
+    memset(&loop_, 0, sizeof(loop_));
+    memset(commands_, 0, sizeof(commands_));
+  }
+
+  /* Call at the start of each main loop iteration. */
+  void record_loop() {
+    if (!enabled_) { return; }
+    const uint32_t now = ARM_DWT_CYCCNT;
+    if (loop_.loop_count > 0) {
+      const uint32_t cycles = now - last_loop_;
+      loop_.loop_total_cycles += cycles;
+      if (cycles > loop_.loop_max_cycles) { loop_.loop_max_cycles = cycles; }
+    }
+    loop_.loop_count++;
+    last_loop_ = now;
+  }
+
+  void record_rx(uint32_t size) { if (enabled_) { loop_.rx_bytes += size; } }
+  void record_stream(uint32_t size) {
+    if (enabled_) { loop_.stream_bytes += size; }
+  }
+
+  void record_command(uint16_t command, uint32_t cycles,
+                      uint32_t request_bytes, uint32_t response_bytes) {
+    loop_.tx_bytes += response_bytes;
+    CommandProfile *profile = NULL;
+    for (uint16_t i = 0; i < loop_.command_count; i++) {
+      if (commands_[i].command == command) {
+        profile = &commands_[i];
+        break;
+      }
+    }
+    if (profile == NULL) {
+      if (loop_.command_count >= COMMAND_CAPACITY) {
+        loop_.dropped_commands++;
+        return;
+      }
+      profile = &commands_[loop_.command_count++];
+      profile->command = command;
+    }
+    profile->count++;
+    profile->total_cycles += cycles;
+    if (cycles > profile->max_cycles) { profile->max_cycles = cycles; }
+    profile->request_bytes += request_bytes;
+    profile->response_bytes += response_bytes;
+  }
+
+  /*
+   * Copy a `LoopProfile` header followed by one `CommandProfile` record per
+   * command (as many as fit) to \a buffer.
+   *
+   * Returns view of \a buffer holding the table.
+   */
+  UInt8Array serialize(uint64_t now, UInt8Array buffer) {
+    UInt8Array result = buffer;
+    result.length = 0;
+    if (buffer.length < sizeof(LoopProfile)) { return result; }
+
+    LoopProfile header = loop_;
+    header.elapsed_cycles = now - reset_time_;
+    uint16_t count = (buffer.length - sizeof(header)) / sizeof(CommandProfile);
+    if (count > header.command_count) { count = header.command_count; }
+    header.command_count = count;
+    memcpy(buffer.data, &header, sizeof(header));
+    memcpy(buffer.data + sizeof(header), commands_,
+           count * sizeof(CommandProfile));
+    result.length = sizeof(header) + count * sizeof(CommandProfile);
+    return result;
+  }
+};
+
+
+/*
+ * Command processor wrapper recording the duration, request size, and
+ * response size of each command dispatched by \a Processor (e.g., the
+ * generated `CommandProcessor`).
+ */
+template <typename Processor>
+class ProfiledCommandProcessor {
+public:
+  Processor &processor_;
+  RpcProfiler &profiler_;
+
+  ProfiledCommandProcessor(Processor &processor, RpcProfiler &profiler)
+    : processor_(processor), profiler_(profiler) {}
+
+  UInt8Array process_command(UInt8Array request_arr, UInt8Array buffer) {
+    if (!profiler_.enabled_ || (request_arr.length < sizeof(uint16_t))) {
+      return processor_.process_command(request_arr, buffer);
+    }
+    uint16_t command;
+    memcpy(&command, request_arr.data, sizeof(command));
+    const uint32_t request_bytes = request_arr.length;
+    const uint32_t start = ARM_DWT_CYCCNT;
+    UInt8Array result = processor_.process_command(request_arr, buffer);
+    profiler_.record_command(command, ARM_DWT_CYCCNT - start, request_bytes,
+                             (result.data != NULL) ? result.length : 0);
+    return result;
+  }
+};
+
+}  // namespace teensy_minimal_rpc
+
+#endif  // #ifndef ___RPC_PROFILER__H___
@@ -0,0 +1,130 @@
+#ifndef ___SAMPLE_PACKER__H___
+#define ___SAMPLE_PACKER__H___
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <CArrayDefs.h>  // UInt8Array
+
+
+namespace teensy_minimal_rpc {
+
+/*
+ * Pack blocks of right-justified `uint16_t` samples (e.g., 8, 10, or 12-bit
+ * ADC results) into a dense little-endian bit stream of `bits_` bits per
+ * sample, i.e., sample `i` occupies stream bits `i * bits_` to `(i + 1) *
+ * bits_ - 1`, where stream bit `b` is bit `b % 8` of byte `b / 8`.
+ *
+ * For example, two 12-bit samples `a` and `b` are packed into three bytes
+ * as `a[7:0]`, `b[3:0] a[11:8]`, `b[11:4]`.
+ *
+ * The packed block is `ceil(sample_count * bits_ / 8)` bytes long.  Upper
+ * bits of samples that do not fit in `bits_` bits are discarded.
+ */
+class SamplePacker {
+public:
+  uint8_t bits_;  // 16: disabled.
+  UInt8Array buffer_;
+
+  SamplePacker() : bits_(16) { buffer_ = UInt8Array_init_default(); }
+  ~SamplePacker() { deallocate(); }
+
+  bool enabled() const { return bits_ < 16; }
+
+  /* Pack samples to \a bits bits (8, 10, or 12; 16 disables packing), in
+   * blocks of up to \a block_size bytes of samples.
+   *
+   * Returns 0 on success, -1 on invalid arguments, or -3 if memory
+   * allocation failed. */
+  int8_t configure(uint8_t bits, uint32_t block_size) {
+    if ((bits != 8) && (bits != 10) && (bits != 12) && (bits != 16)) {
+      return -1;
+    }
+    deallocate();
+    if (bits == 16) { return 0; }
+    // Whole words, since packed samples are stored a word at a time.
+    const uint32_t size = ((block_size / sizeof(uint16_t) * bits + 31) /
+                           32 * sizeof(uint32_t));
+    buffer_ = UInt8Array_init(size, (uint8_t *)malloc(size));
+    if (buffer_.data == NULL) {
+      buffer_ = UInt8Array_init_default();
+      return -3;
+    }
+    bits_ = bits;
+    return 0;
+  }
+  void deallocate() {
+    free(buffer_.data);
+    buffer_ = UInt8Array_init_default();
+    bits_ = 16;
+  }
+
+  /* Pack \a count samples from \a input to word-aligned \a output.
+   *
+   * Each pair of samples is loaded as one 32-bit word and squeezed into
+   * `2 * BITS` bits with two masks and a shift, then appended to a 64-bit
+   * bit accumulator, which is stored a whole word at a time.
+   *
+   * Returns number of bytes written. */
+  template <uint8_t BITS>
+  static uint32_t pack(const uint16_t *input, uint32_t count,
+                       uint8_t *output) {
+    // Block halves may start at odd halfword addresses.
+    typedef uint32_t __attribute__((__may_alias__, __aligned__(2)))
+      input_word_t;
+    typedef uint32_t __attribute__((__may_alias__)) output_word_t;
+    const uint32_t mask = (1UL << BITS) - 1;
+    const input_word_t *words = (const input_word_t *)input;
+    output_word_t *output_words = (output_word_t *)output;
+    uint64_t stream = 0;
+    uint8_t stream_bits = 0;
+
+    for (uint32_t i = 0; i < count / 2; i++) {
+      const uint32_t word = words[i];
+      const uint32_t pair = ((word & mask) |
+                             ((word >> (16 - BITS)) & (mask << BITS)));
+      stream |= (uint64_t)pair << stream_bits;
+      stream_bits += 2 * BITS;
+      if (stream_bits >= 32) {
+        *output_words++ = (uint32_t)stream;
+        stream >>= 32;
+        stream_bits -= 32;
+      }
+    }
+    if (count & 0x1) {
+      stream |= (uint64_t)(input[count - 1] & mask) << stream_bits;
+      stream_bits += BITS;
+    }
+    // Remaining (partial) word.
+    uint8_t *bytes = (uint8_t *)output_words;
+    for (; stream_bits > 0; stream_bits -= (stream_bits < 8) ? stream_bits
+                                                           : 8) {
+      *bytes++ = (uint8_t)stream;
+      stream >>= 8;
+    }
+    return bytes - output;
+  }
+
+  /* Returns packed \a block (in `buffer_`, valid until the next call), or an
+   * empty array if the block is larger than configured. */
+  UInt8Array process(UInt8Array block) {
+    UInt8Array output = UInt8Array_init_default();
+    const uint32_t count = block.length / sizeof(uint16_t);
+    if (!enabled() || ((count * bits_ + 7) / 8 > buffer_.length)) {
+      return output;
+    }
+
+    const uint16_t *samples = (const uint16_t *)block.data;
+    switch (bits_) {
+      case 8: output.length = pack<8>(samples, count, buffer_.data); break;
+      case 10: output.length = pack<10>(samples, count, buffer_.data); break;
+      default: output.length = pack<12>(samples, count, buffer_.data); break;
+    }
+    output.data = buffer_.data;
+    return output;
+  }
+};
+
+}  // namespace teensy_minimal_rpc
+
+#endif  // #ifndef ___SAMPLE_PACKER__H___
@@ -0,0 +1,118 @@
+#ifndef ___STREAM_CHUNKER__H___
+#define ___STREAM_CHUNKER__H___
+
+#include <stdint.h>
+#include <string.h>
+#include <CArrayDefs.h>  // UInt8Array
+#include <TeensyMinimalRpc/Crc32.h>
+
+
+namespace teensy_minimal_rpc {
+
+/*
+ * Header prepended to the payload of each `STREAM` packet chunk.
+ *
+ * The host reassembles a block by copying each chunk payload to `offset`
+ * within a buffer of `block_size` bytes.  `sequence` increments by one for
+ * every chunk sent (across all blocks), so a lost chunk shows up as a gap in
+ * the sequence numbers.
+ *
+ * `timestamp` is the device time the block was completed (e.g., captured
+ * from the DMA completion interrupt), in CPU cycles (see `CycleCounter`).
+ *
+ * `crc` is the CRC-32 (see `crc32`) of the chunk payload.
+ */
+struct StreamChunkHeader {
+  uint32_t sequence;  // Chunk sequence number.
+  uint32_t offset;  // Byte offset of chunk payload within block.
+  uint32_t block_size;  // Total number of bytes in block.
+  uint64_t timestamp;  // Block completion time (CPU cycles).
+  uint32_t crc;  // CRC-32 of chunk payload.
+} __attribute__((packed));
+
+
+/*
+ * Split a block of memory into fixed-size chunks, each prefixed with a
+ * `StreamChunkHeader`.
+ *
+ * Only one block is in progress at a time.  Each call to `next_chunk` copies
+ * the next chunk to the provided buffer, so the caller controls the pace of
+ * the transfer (e.g., one chunk per main loop iteration).
+ */
+class StreamChunker {
+public:
+  UInt8Array block_;
+  uint64_t timestamp_;
+  uint32_t offset_;
+  uint32_t sequence_;
+  crc32_func_t crc32_;  // Computes `StreamChunkHeader::crc`.
+
+  StreamChunker()
+    : timestamp_(0), offset_(0), sequence_(0), crc32_(crc32) {
+    block_ = UInt8Array_init_default();
+  }
+
+  /* Returns `true` if a block has been started and not all of its chunks
+   * have been produced yet. */
+  bool pending() const {
+    return (block_.data != NULL) && (offset_ < block_.length);
+  }
+
+  /* Returns `true` if the pending block (if any) starts within \a data of
+   * \a size bytes, i.e., `data` must not be freed or overwritten yet. */
+  bool pending_in(const void *data, uint32_t size) const {
+    const uint8_t *start = (const uint8_t *)data;
+    return (pending() && (start != NULL) && (block_.data >= start) &&
+            (block_.data < start + size));
+  }
+
+  void start(UInt8Array block, uint64_t timestamp=0) {
+    block_ = block;
+    timestamp_ = timestamp;
+    offset_ = 0;
+  }
+
+  /* Discard the rest of the current block (sequence numbers keep counting). */
+  void cancel() { block_ = UInt8Array_init_default(); offset_ = 0; }
+  /* Discard the chunk last returned by `next_chunk` (i.e., it is not sent,
+   * so its sequence number is used by the next chunk) along with the rest
+   * of the current block. */
+  void cancel_chunk() { sequence_--; cancel(); }
+
+  /*
+   * Copy the header and payload of the next chunk of the current block to
+   * `buffer`.
+   *
+   * Returns the chunk (a view into `buffer`), or an empty array if no chunk
+   * is pending or if `buffer` cannot hold a header and at least one byte of
+   * payload.
+   */
+  UInt8Array next_chunk(UInt8Array buffer) {
+    UInt8Array chunk = buffer;
+    chunk.length = 0;
+    if (!pending() || (buffer.length <= sizeof(StreamChunkHeader))) {
+      return chunk;
+    }
+    uint32_t payload_size = buffer.length - sizeof(StreamChunkHeader);
+    if (payload_size > block_.length - offset_) {
+      payload_size = block_.length - offset_;
+    }
+
+    StreamChunkHeader header;
+    header.sequence = sequence_++;
+    header.offset = offset_;
+    header.block_size = block_.length;
+    header.timestamp = timestamp_;
+    header.crc = crc32_(block_.data + offset_, payload_size);
+    memcpy(buffer.data, &header, sizeof(header));
+    memcpy(buffer.data + sizeof(header), block_.data + offset_, payload_size);
+
+    offset_ += payload_size;
+    chunk.length = sizeof(header) + payload_size;
+    return chunk;
+  }
+};
+
+}  // namespace teensy_minimal_rpc
+
+#endif  // #ifndef ___STREAM_CHUNKER__H___
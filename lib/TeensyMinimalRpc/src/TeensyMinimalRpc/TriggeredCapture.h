@@ -0,0 +1,302 @@
+#ifndef ___TRIGGERED_CAPTURE__H___
+#define ___TRIGGERED_CAPTURE__H___
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <CArrayDefs.h>  // UInt8Array
+
+
+namespace teensy_minimal_rpc {
+
+/* Trigger conditions, for sample `x`.  Edges must first see the signal on
+ * the other side of `level` by at least `hysteresis` (i.e., armed) before
+ * the trigger fires. */
+enum TriggerMode {
+  TRIGGER_LEVEL_ABOVE = 0,  // x >= level
+  TRIGGER_LEVEL_BELOW = 1,  // x < level
+  TRIGGER_RISING = 2,  // Armed by x < level - hysteresis; then x >= level
+  TRIGGER_FALLING = 3,  // Armed by x >= level + hysteresis; then x < level
+};
+
+/* Bit flags returned by `TriggeredCapture::on_samples_written`. */
+enum TriggeredCaptureEvent {
+  TRIGGER_CAPTURE_FROZEN = 0x01,  // Window copied to `window_`.
+  TRIGGER_CAPTURE_REARM = 0x02,  // Holdoff elapsed; accepting triggers again.
+  TRIGGER_CAPTURE_DONE = 0x04,  // Single capture complete; stop sampling.
+};
+
+/*
+ * Header of each window streamed by a triggered capture, followed by
+ * `pre_count + post_count` samples, the first `pre_count` of which precede
+ * the trigger sample.
+ *
+ * Sample indexes count samples since sampling started (modulo 2^32).
+ */
+struct TriggerCaptureHeader {
+  /* Time the window was frozen (CPU cycles, see `CycleCounter`), i.e., time
+   * sample `frozen_sample - 1` was written. */
+  uint64_t timestamp;
+  uint32_t trigger_sample;
+  uint32_t frozen_sample;  // Number of samples written when frozen.
+  uint32_t capture_index;
+  uint32_t missed_count;  // Triggers dropped so far (window busy).
+  uint16_t pre_count;
+  uint16_t post_count;
+} __attribute__((packed));
+
+
+/*
+ * Oscilloscope-style trigger and capture window over a circular buffer of
+ * `uint16_t` samples written continuously (e.g., by DMA), independent of the
+ * sampling hardware.
+ *
+ * The owner reports progress through the circular buffer (e.g., from the DMA
+ * half/major loop interrupt) with `on_samples_written`, which:
+ *
+ *  1. In software trigger mode, scans the newly written samples for the
+ *     trigger condition (see `TriggerMode`).  In hardware mode, trigger
+ *     samples are reported instead with `on_trigger` (e.g., from an ADC
+ *     compare interrupt).
+ *  2. Once `post_count_` samples following the trigger have been written,
+ *     copies `pre_count_` samples before the trigger and `post_count_`
+ *     samples from the trigger on to `window_` (after a
+ *     `TriggerCaptureHeader`), unless the previous window is still being
+ *     streamed (see `release`).
+ *  3. Accepts triggers again once `holdoff_` samples following the trigger
+ *     have been written (or stops after a single capture, unless
+ *     `auto_rearm_` is set).
+ *
+ * The window must be copied before the buffer wraps around onto it, so
+ * `pre_count_ + post_count_` must be at most half the buffer size, when
+ * progress is reported at least every half buffer.
+ */
+class TriggeredCapture {
+public:
+  uint8_t mode_;
+  bool hardware_;  // Triggers reported by `on_trigger` (no scanning).
+  bool auto_rearm_;
+  uint16_t level_;
+  uint16_t hysteresis_;
+  uint16_t pre_count_;
+  uint16_t post_count_;
+  uint32_t holdoff_;  // Samples from trigger until next trigger accepted.
+  const volatile uint16_t *ring_;
+  uint32_t ring_mask_;  // Circular buffer size (in samples) - 1.
+  UInt8Array window_;
+
+  // Trigger state.
+  bool running_;
+  bool armed_;  // Edge modes: other side of level seen.
+  bool pending_;  // Trigger found; waiting for post-trigger samples.
+  bool rearm_pending_;  // Holdoff not elapsed yet.
+  volatile bool window_ready_;  // `window_` is waiting to be streamed.
+  volatile bool window_busy_;  // `window_` is waiting or being streamed.
+  uint32_t trigger_sample_;
+  uint32_t scanned_;  // Next sample to scan.
+  uint32_t rearm_sample_;  // First sample accepted as trigger.
+  uint32_t capture_count_;
+  uint32_t missed_count_;
+
+  TriggeredCapture()
+    : mode_(TRIGGER_LEVEL_ABOVE), hardware_(false), auto_rearm_(true),
+      level_(0), hysteresis_(0), pre_count_(0), post_count_(0), holdoff_(0),
+      ring_(NULL), ring_mask_(0), running_(false), armed_(false),
+      pending_(false), rearm_pending_(false), window_ready_(false),
+      window_busy_(false),
+      trigger_sample_(0), scanned_(0), rearm_sample_(0), capture_count_(0),
+      missed_count_(0) {
+    window_ = UInt8Array_init_default();
+  }
+  ~TriggeredCapture() { deallocate(); }
+
+  /* Returns 0 on success, -1 on invalid arguments (e.g., window larger than
+   * half of \a ring_sample_count, or an edge threshold out of range), or -3
+   * if memory allocation failed. */
+  int8_t configure(uint8_t mode, uint16_t level, uint16_t hysteresis,
+                   uint16_t pre_count, uint16_t post_count, uint32_t holdoff,
+                   bool auto_rearm, bool hardware,
+                   uint32_t ring_sample_count) {
+    if ((mode > TRIGGER_FALLING) || (post_count == 0) ||
+        (ring_sample_count < 2) ||
+        (ring_sample_count & (ring_sample_count - 1)) ||
+        ((uint32_t)pre_count + post_count > ring_sample_count / 2) ||
+        ((mode == TRIGGER_RISING) && (hysteresis >= level)) ||
+        ((mode == TRIGGER_FALLING) &&
+         ((uint32_t)level + hysteresis > 0xFFFF))) {
+      return -1;
+    }
+    stop();
+    deallocate();
+    const uint32_t size = (sizeof(TriggerCaptureHeader) +
+                           ((uint32_t)pre_count + post_count) *
+                           sizeof(uint16_t));
+    window_ = UInt8Array_init(size, (uint8_t *)malloc(size));
+    if (window_.data == NULL) {
+      window_ = UInt8Array_init_default();
+      return -3;
+    }
+    mode_ = mode;
+    level_ = level;
+    hysteresis_ = hysteresis;
+    pre_count_ = pre_count;
+    post_count_ = post_count;
+    holdoff_ = holdoff;
+    auto_rearm_ = auto_rearm;
+    hardware_ = hardware;
+    ring_mask_ = ring_sample_count - 1;
+    return 0;
+  }
+  /* Caller must make sure the window is not being streamed (e.g., cancel
+   * the stream first). */
+  void deallocate() {
+    running_ = false;
+    window_ready_ = false;
+    window_busy_ = false;
+    free(window_.data);
+    window_ = UInt8Array_init_default();
+  }
+  bool configured() const { return window_.data != NULL; }
+
+  /* Start accepting triggers in circular buffer \a ring, once `pre_count_`
+   * samples have been written (in hardware mode, signalled by the first
+   * `TRIGGER_CAPTURE_REARM` event). */
+  void start(const volatile uint16_t *ring) {
+    ring_ = ring;
+    armed_ = false;
+    pending_ = false;
+    rearm_pending_ = hardware_;
+    window_ready_ = false;
+    window_busy_ = false;
+    scanned_ = 0;
+    rearm_sample_ = pre_count_;
+    capture_count_ = 0;
+    missed_count_ = 0;
+    running_ = configured();
+  }
+  void stop() { running_ = false; }
+  /* Returns frozen window to stream (see `release`), or an empty array if
+   * no window is waiting to be streamed. */
+  UInt8Array take_window() {
+    UInt8Array window = UInt8Array_init_default();
+    if (window_ready_) {
+      window_ready_ = false;
+      window = window_;
+    }
+    return window;
+  }
+  /* Window returned by `take_window` has been streamed, so may be
+   * overwritten by the next capture. */
+  void release() { if (!window_ready_) { window_busy_ = false; } }
+
+  /* Edge modes: update armed state.  Returns `true` if \a x fires the
+   * trigger. */
+  inline bool check(uint16_t x) {
+    switch (mode_) {
+      case TRIGGER_LEVEL_ABOVE: return x >= level_;
+      case TRIGGER_LEVEL_BELOW: return x < level_;
+      case TRIGGER_RISING:
+        if (armed_) { return x >= level_; }
+        armed_ = (x < level_ - hysteresis_);
+        return false;
+      default:
+        if (armed_) { return x < level_; }
+        armed_ = (x >= (uint32_t)level_ + hysteresis_);
+        return false;
+    }
+  }
+
+  /* Report trigger at \a sample (e.g., from a hardware comparator).
+   *
+   * Returns `true` if the trigger was accepted, i.e., not during holdoff or
+   * while a window is pending. */
+  bool on_trigger(uint32_t sample) {
+    if (!running_ || pending_ || rearm_pending_ ||
+        ((int32_t)(sample - rearm_sample_) < 0)) { return false; }
+    pending_ = true;
+    trigger_sample_ = sample;
+    return true;
+  }
+
+  /* Report that \a written samples have been written to the circular
+   * buffer since `start`, with \a timestamp the time the last one was.
+   *
+   * Returns bitwise OR of `TriggeredCaptureEvent` flags. */
+  uint8_t on_samples_written(uint32_t written, uint64_t timestamp) {
+    uint8_t events = 0;
+    if (!running_) { return events; }
+
+    /* Handle every trigger up to \a written, so triggers never fall behind
+     * the buffer (windows completed while `window_` is busy are missed). */
+    while (true) {
+      if (rearm_pending_ && ((int32_t)(written - rearm_sample_) >= 0)) {
+        rearm_pending_ = false;
+        armed_ = false;
+        events |= TRIGGER_CAPTURE_REARM;
+      }
+      if (!hardware_ && !pending_ && !rearm_pending_) {
+        // Samples before holdoff elapsed are not scanned.
+        uint32_t i = (((int32_t)(rearm_sample_ - scanned_) > 0)
+                      ? rearm_sample_ : scanned_);
+        for (; (int32_t)(written - i) > 0; i++) {
+          if (check(ring_[i & ring_mask_])) {
+            on_trigger(i);
+            i++;
+            break;
+          }
+        }
+        scanned_ = i;
+      }
+      if (!pending_ ||
+          ((int32_t)(written - (trigger_sample_ + post_count_)) < 0)) {
+        return events;
+      }
+
+      pending_ = false;
+      if (window_busy_) {
+        missed_count_++;
+      } else {
+        freeze(written, timestamp);
+        events |= TRIGGER_CAPTURE_FROZEN;
+      }
+      if (!auto_rearm_) {
+        running_ = false;
+        return events | TRIGGER_CAPTURE_DONE;
+      }
+      // Holdoff is at least the window, since one trigger is pending at a
+      // time.
+      rearm_sample_ = trigger_sample_ + ((holdoff_ > post_count_) ? holdoff_
+                                         : post_count_);
+      rearm_pending_ = true;
+    }
+  }
+
+protected:
+  void freeze(uint32_t written, uint64_t timestamp) {
+    TriggerCaptureHeader header;
+    header.timestamp = timestamp;
+    header.trigger_sample = trigger_sample_;
+    header.frozen_sample = written;
+    header.capture_index = capture_count_++;
+    header.missed_count = missed_count_;
+    header.pre_count = pre_count_;
+    header.post_count = post_count_;
+    memcpy(window_.data, &header, sizeof(header));
+
+    // Copy window out of circular buffer, in up to two parts.
+    uint16_t *output = (uint16_t *)(window_.data + sizeof(header));
+    const uint32_t count = (uint32_t)pre_count_ + post_count_;
+    const uint32_t start = (trigger_sample_ - pre_count_) & ring_mask_;
+    const uint32_t first = ((start + count > ring_mask_ + 1)
+                            ? ring_mask_ + 1 - start : count);
+    memcpy(output, (const void *)(ring_ + start), first * sizeof(uint16_t));
+    memcpy(output + first, (const void *)ring_,
+           (count - first) * sizeof(uint16_t));
+    window_busy_ = true;
+    window_ready_ = true;
+  }
+};
+
+}  // namespace teensy_minimal_rpc
+
+#endif  // #ifndef ___TRIGGERED_CAPTURE__H___
@@ -0,0 +1,217 @@
+#include <string.h>
+#include "TriggeredSampler.h"
+#include "DMA.h"
+
+namespace teensy {
+namespace adc {
+  TriggeredSampler::TriggeredSampler()
+    : dma_channel_(0), capture_sc1a_(0),
+      compare_sc1a_(TRIGGER_COMPARE_NONE), pdb_config_(0), pdb_mod_(0),
+      compare_first_phase_(1), compare_phase_(1) {
+    ring_ = UInt16Array_init_default();
+    for (uint8_t i = 0; i < 2; i++) {
+      compare_values_[i] = 0;
+      compare_sc2s_[i] = 0;
+    }
+  }
+
+  int8_t TriggeredSampler::configure(uint8_t capture_sc1a,
+                                     uint8_t compare_sc1a,
+                                     uint16_t ring_sample_count,
+                                     uint32_t sample_rate_hz,
+                                     uint8_t dma_channel) {
+    // Conversion DMA major loop count is 15 bits with channel linking
+    // disabled (21.3.27/422).
+    if ((ring_sample_count < 2) || (ring_sample_count > 0x4000) ||
+        (ring_sample_count & (ring_sample_count - 1)) ||
+        (dma_channel >= DMA_NUM_CHANNELS)) {
+      return -1;
+    }
+    uint32_t pdb_config;
+    uint16_t pdb_mod;
+    if (!pdb_divide_settings(sample_rate_hz, pdb_config, pdb_mod)) {
+      return -2;
+    }
+
+    deallocate();
+    dma_channel_ = dma_channel;
+    capture_sc1a_ = capture_sc1a;
+    compare_sc1a_ = compare_sc1a;
+    // Channel is selected once, so no PDB DMA request is required.
+    pdb_config_ = pdb_config & ~PDB_SC_DMAEN;
+    pdb_mod_ = pdb_mod;
+
+    /* __N.B.,__ Circular buffer is written using destination address modulo,
+     * so must be aligned to a 0-modulo-size address. */
+    const uint32_t ring_bytes = ring_sample_count * sizeof(uint16_t);
+    ring_ = UInt16Array_init(ring_sample_count,
+                             (uint16_t *)aligned_malloc(ring_bytes,
+                                                        ring_bytes));
+    if (ring_.data == NULL) {
+      deallocate();
+      return -3;
+    }
+    mem_fill(ring_.data, (uint16_t)0, ring_.length);
+
+    // Enable PDB clock (DMA and ADC clocks should already be enabled).
+    SIM_SCGC6 |= SIM_SCGC6_PDB;
+
+    configure_timer();
+    configure_adcs();
+    rewind();
+    configure_dma_mux();
+    if (hardware_compare()) { NVIC_ENABLE_IRQ(IRQ_ADC1); }
+    return 0;
+  }
+
+  void TriggeredSampler::rewind() {
+    if (!configured()) { return; }
+    configure_dma_channel_adc_conversion();
+    disarm_compare();
+  }
+
+  void TriggeredSampler::deallocate() {
+    if (configured()) {
+      // Restore software triggering and disable pre-triggers.
+      ADC0_SC2 &= ~(ADC_SC2_ADTRG | ADC_SC2_DMAEN);
+      PDB0_CH0C1 = 0;
+      if (hardware_compare()) {
+        ADC1_SC1A = ADC_SC1_ADCH(31);  // Disable interrupt (and module).
+        ADC1_SC2 &= ~(ADC_SC2_ADTRG | ADC_SC2_ACFE | ADC_SC2_ACFGT |
+                      ADC_SC2_ACREN);
+        PDB0_CH1C1 = 0;
+      }
+      // Disable DMA requests before releasing memory used by the channel.
+      DMA_CERQ = dma_channel_;
+    }
+    aligned_free(ring_.data);
+    ring_ = UInt16Array_init_default();
+  }
+
+  uint32_t TriggeredSampler::position() const {
+    // Major loop counts down from `BITER` (i.e., the size of the buffer).
+    return ring_.length - (dma::TCD(dma_channel_).CITER & 0x7FFF);
+  }
+
+  void TriggeredSampler::set_compare(uint8_t mode, uint16_t level,
+                                     uint16_t hysteresis) {
+    /* With `ACFGT`, a conversion completes if the result is greater than or
+     * equal to `CV1`; otherwise, if it is less than `CV1`. */
+    switch (mode) {
+      case teensy_minimal_rpc::TRIGGER_RISING:
+        compare_values_[0] = level - hysteresis;
+        compare_sc2s_[0] = ADC_SC2_ACFE;
+        // Fall through.
+      case teensy_minimal_rpc::TRIGGER_LEVEL_ABOVE:
+        compare_values_[1] = level;
+        compare_sc2s_[1] = ADC_SC2_ACFE | ADC_SC2_ACFGT;
+        break;
+      case teensy_minimal_rpc::TRIGGER_FALLING:
+        compare_values_[0] = level + hysteresis;
+        compare_sc2s_[0] = ADC_SC2_ACFE | ADC_SC2_ACFGT;
+        // Fall through.
+      default:
+        compare_values_[1] = level;
+        compare_sc2s_[1] = ADC_SC2_ACFE;
+        break;
+    }
+    compare_first_phase_ = ((mode == teensy_minimal_rpc::TRIGGER_RISING) ||
+                            (mode == teensy_minimal_rpc::TRIGGER_FALLING))
+      ? 0 : 1;
+  }
+
+  void TriggeredSampler::load_compare_phase(uint8_t phase) {
+    compare_phase_ = phase;
+    ADC1_CV1 = compare_values_[phase];
+    ADC1_SC2 = ((ADC1_SC2 & ~(ADC_SC2_ACFE | ADC_SC2_ACFGT | ADC_SC2_ACREN))
+                | compare_sc2s_[phase]);
+  }
+
+  void TriggeredSampler::arm_compare() {
+    if (!hardware_compare()) { return; }
+    load_compare_phase(compare_first_phase_);
+    /* With hardware triggering enabled, writing `SC1A` does not start a
+     * conversion (31.3.1/653). */
+    ADC1_SC1A = compare_sc1a_ | ADC_SC1_AIEN;
+  }
+
+  void TriggeredSampler::disarm_compare() {
+    if (!hardware_compare()) { return; }
+    ADC1_SC1A = compare_sc1a_;
+  }
+
+  bool TriggeredSampler::on_compare() {
+    // Reading the result clears the conversion complete flag.
+    (void)ADC1_RA;
+    if (compare_phase_ == 0) {
+      // Signal crossed the hysteresis threshold; wait for the level.
+      load_compare_phase(1);
+      return false;
+    }
+    disarm_compare();
+    return true;
+  }
+
+  void TriggeredSampler::configure_adcs() {
+    /* Select `b` input for ADC MUX (31.3.3/658), and enable hardware
+     * triggering (i.e., PDB pre-triggers) and DMA request on each conversion
+     * complete (31.3.6/661). */
+    ADC0_CFG2 |= ADC_CFG2_MUXSEL;
+    ADC0_SC2 |= ADC_SC2_ADTRG | ADC_SC2_DMAEN;
+    ADC0_SC1A = capture_sc1a_;
+    if (hardware_compare()) {
+      // Compare results are only used to raise the ADC1 interrupt.
+      ADC1_CFG2 |= ADC_CFG2_MUXSEL;
+      ADC1_SC2 = (ADC1_SC2 & ~ADC_SC2_DMAEN) | ADC_SC2_ADTRG;
+    }
+  }
+
+  void TriggeredSampler::configure_timer() {
+    // __N.B.,__ Loaded on next write of `PDB_SC_LDOK` (i.e., on start).
+    PDB0_MOD = pdb_mod_;
+    // Pre-trigger A of PDB channel 0 (ADC0) and, for hardware compare, of
+    // channel 1 (ADC1) at the same counter value (35.3.6/757).
+    PDB0_CH0DLY0 = 0;
+    PDB0_CH0C1 = PDB_CHnC1_TOS(1) | PDB_CHnC1_EN(1);
+    PDB0_CH1DLY0 = 0;
+    PDB0_CH1C1 = (hardware_compare() ? PDB_CHnC1_TOS(1) | PDB_CHnC1_EN(1)
+                  : 0);
+  }
+
+  void TriggeredSampler::configure_dma_channel_adc_conversion() {
+    volatile tcd_t &tcd = dma::TCD(dma_channel_);
+    // Destination address modulo, i.e., log2 of circular buffer size.
+    uint8_t modulo = 0;
+    while ((1UL << modulo) < ring_.length * sizeof(uint16_t)) { modulo++; }
+
+    tcd.CSR = 0;
+    tcd.SADDR = &ADC0_RA;
+    tcd.SOFF = 0;
+    tcd.ATTR = (DMA_TCD_ATTR_SSIZE(DMA_TCD_ATTR_SIZE_16BIT) |
+                DMA_TCD_ATTR_DMOD(modulo) |
+                DMA_TCD_ATTR_DSIZE(DMA_TCD_ATTR_SIZE_16BIT));
+    tcd.NBYTES = sizeof(uint16_t);
+    tcd.SLAST = 0;
+    tcd.DADDR = ring_.data;
+    tcd.DOFF = sizeof(uint16_t);
+    tcd.CITER = ring_.length;
+    tcd.BITER = ring_.length;
+    // Destination already wrapped to the start of the circular buffer.
+    tcd.DLASTSGA = 0;
+    // Raise interrupt each time one half of the buffer is filled.
+    tcd.CSR = DMA_TCD_CSR_INTHALF | DMA_TCD_CSR_INTMAJOR;
+  }
+
+  void TriggeredSampler::configure_dma_mux() {
+    volatile uint8_t *CHCFG = &DMAMUX0_CHCFG0;
+
+    // Route ADC0 conversion complete as conversion DMA channel source.
+    CHCFG[dma_channel_] = 0;
+    CHCFG[dma_channel_] = DMAMUX_SOURCE_ADC0 | DMAMUX_ENABLE;
+    // DMA request input signals and this enable request flag must be
+    // asserted before a channel's hardware service request is accepted
+    // (21.3.3/394).
+    DMA_SERQ = dma_channel_;
+  }
+}  // namespace adc
+}  // namespace teensy
@@ -0,0 +1,124 @@
+#ifndef ___TEENSY__TRIGGERED_SAMPLER__H___
+#define ___TEENSY__TRIGGERED_SAMPLER__H___
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <kinetis.h>
+#include <DMAChannel.h>
+#include <CArrayDefs.h>  // UInt16Array
+#include <TeensyMinimalRpc/AdcSampler.h>  // pdb_divide_settings
+#include <TeensyMinimalRpc/TriggeredCapture.h>  // TriggerMode
+#include <TeensyMinimalRpc/aligned_alloc.h>
+
+
+namespace teensy {
+namespace adc {
+  // `compare_sc1a` of `TriggeredSampler::configure`: no hardware compare.
+  const uint8_t TRIGGER_COMPARE_NONE = 0xFF;
+
+  /*
+   * Sample one analog input channel continuously into a circular buffer, for
+   * triggered captures (see `teensy_minimal_rpc::TriggeredCapture`).
+   *
+   *  - PDB channel 0 pre-trigger starts each ADC0 conversion (hardware
+   *    triggering), so no CPU or DMA time is spent selecting channels.
+   *  - `dma_channel_`: triggered by each ADC0 conversion; copies the result
+   *    to the next position of `ring_`.  The destination address wraps at
+   *    the (power-of-two) size of `ring_` (`DMOD`), so the channel runs
+   *    forever without being reloaded, and raises an interrupt each time one
+   *    half of `ring_` is filled (`INTHALF` and `INTMAJOR`).
+   *
+   * Optionally, ADC1 converts `compare_sc1a` (e.g., the same pin) at the same
+   * instant (PDB channel 1 pre-trigger) with the compare function enabled
+   * (`ACFE`), so a conversion only completes (and raises the ADC1 interrupt)
+   * once the trigger condition is met.  ADC0 cannot compare itself, since
+   * results failing the comparison are not stored, i.e., the pre-trigger
+   * history would have gaps.
+   *
+   * Edge triggers use two compare phases: the first waits for the signal on
+   * the other side of the level (by the hysteresis), and the second for the
+   * level itself (see `teensy_minimal_rpc::TriggerMode`).
+   */
+  class TriggeredSampler {
+  public:
+    typedef DMABaseClass::TCD_t tcd_t;
+
+    uint8_t dma_channel_;
+    uint8_t capture_sc1a_;
+    uint8_t compare_sc1a_;  // `TRIGGER_COMPARE_NONE`: software trigger.
+    uint32_t pdb_config_;
+    uint16_t pdb_mod_;
+    UInt16Array ring_;
+    // Compare thresholds (`ADC1_CV1`) and `ADC1_SC2` compare bits of each
+    // phase.
+    uint16_t compare_values_[2];
+    uint32_t compare_sc2s_[2];
+    uint8_t compare_first_phase_;  // 0: edge, 1: level.
+    uint8_t compare_phase_;  // Phase 1 fires the trigger.
+
+    TriggeredSampler();
+    ~TriggeredSampler() { deallocate(); }
+
+    /*
+     * Allocate circular buffer and configure ADCs, PDB, DMA mux, and DMA
+     * transfer control descriptor.
+     *
+     * Args:
+     *
+     *     capture_sc1a: `ADC0_SC1A` channel configuration.
+     *     compare_sc1a: `ADC1_SC1A` channel configuration of hardware
+     *         compare, or `TRIGGER_COMPARE_NONE`.
+     *     ring_sample_count: Size of circular buffer (in samples); must be a
+     *         power of two, at most 16384.
+     *     sample_rate_hz: Sample rate.
+     *     dma_channel: Conversion DMA channel.
+     *
+     * Returns:
+     *
+     *     0: success.
+     *     -1: invalid arguments.
+     *     -2: sample rate out of range.
+     *     -3: memory allocation failed.
+     */
+    int8_t configure(uint8_t capture_sc1a, uint8_t compare_sc1a,
+                     uint16_t ring_sample_count, uint32_t sample_rate_hz,
+                     uint8_t dma_channel);
+    /* Reload the transfer control descriptor, so the next read starts at the
+     * beginning of the circular buffer. */
+    void rewind();
+    /* Disable hardware triggering, compare, PDB pre-triggers, and DMA
+     * requests, and free buffers. */
+    void deallocate();
+
+    bool configured() const { return ring_.data != NULL; }
+    bool hardware_compare() const {
+      return compare_sc1a_ != TRIGGER_COMPARE_NONE;
+    }
+    /* PDB status and control configuration to start sampling. */
+    uint32_t pdb_start_config() const { return pdb_config_ | PDB_SC_SWTRIG; }
+    uint32_t half_sample_count() const { return ring_.length / 2; }
+    /* Position (in samples) the next result will be written to. */
+    uint32_t position() const;
+
+    /* Set compare phases for \a mode (see
+     * `teensy_minimal_rpc::TriggerMode`). */
+    void set_compare(uint8_t mode, uint16_t level, uint16_t hysteresis);
+    /* Start waiting for trigger condition (first phase), i.e., enable ADC1
+     * conversion complete interrupt. */
+    void arm_compare();
+    void disarm_compare();
+    /* Handle ADC1 conversion complete interrupt.  Returns `true` if the
+     * trigger fired, i.e., the last compare phase completed (compare is then
+     * disarmed until the next call to `arm_compare`). */
+    bool on_compare();
+  protected:
+    void configure_adcs();
+    void configure_timer();
+    void configure_dma_channel_adc_conversion();
+    void configure_dma_mux();
+    void load_compare_phase(uint8_t phase);
+  };
+}  // namespace adc
+}  // namespace teensy
+
+#endif  // #ifndef ___TEENSY__TRIGGERED_SAMPLER__H___
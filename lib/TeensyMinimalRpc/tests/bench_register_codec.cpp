@@ -0,0 +1,100 @@
+/*
+ * Host benchmark of the DMA, ADC, and PIT register codecs (i.e., converting
+ * between registers and Protocol Buffer messages), e.g., to compare the
+ * codec tables with the register macros they replaced (see `make bench`).
+ *
+ * Registers are backed by host memory (see `mock/kinetis.h`), so timings
+ * only compare the amount of work per call; they are not device timings.
+ *
+ *     bench_register_codec [call count]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <TeensyMinimalRpc/DMA.h>
+#include <TeensyMinimalRpc/ADC.h>
+#include <TeensyMinimalRpc/PIT.h>
+
+using namespace teensy;
+
+static uint8_t buffer_data[1024];
+static uint32_t sink = 0;
+
+static UInt8Array buffer() {
+  UInt8Array result = {sizeof(buffer_data), buffer_data};
+  return result;
+}
+
+static void randomize_registers() {
+  uint8_t *bytes = (uint8_t *)&mock_registers();
+  for (size_t i = 0; i < sizeof(MockRegisters); i++) { bytes[i] = rand(); }
+  DMA_CR |= DMA_CR_EMLM;
+}
+
+static void tcd_to_protobuf(int i) {
+  const teensy__3_1_dma_TCD tcd = dma::TCD_to_protobuf(i & 0xF);
+  sink += tcd.CSR.MAJORLINKCH + tcd.ATTR.SMOD;
+}
+
+static void update_tcd(int i) {
+  static teensy__3_1_dma_TCD tcd = dma::TCD_to_protobuf(0);
+  tcd.CSR.has_START = false;
+  dma::update_TCD(i & 0xF, tcd);
+}
+
+static void dma_registers_to_protobuf(int) {
+  sink += dma::registers_to_protobuf().CR.EMLM;
+}
+
+static void adc_serialize_registers(int i) {
+  sink += adc::serialize_registers(i & 0x1, buffer()).length;
+}
+
+static void adc_update_registers(int i) {
+  static uint8_t message[sizeof(teensy__3_1_adc_Registers)];
+  static UInt8Array registers = {0, message};
+  if (registers.length == 0) {
+    UInt8Array output = adc::serialize_registers(0, buffer());
+    memcpy(message, output.data, output.length);
+    registers.length = output.length;
+  }
+  adc::update_registers(i & 0x1, registers);
+}
+
+static void pit_serialize_timer_config(int i) {
+  sink += pit::serialize_timer_config(i & 0x3, buffer()).length;
+}
+
+struct Benchmark {
+  const char *name;
+  void (*call)(int);
+};
+
+int main(int argc, char **argv) {
+  const int call_count = (argc > 1) ? atoi(argv[1]) : 1000000;
+  const int repeat_count = 20;
+  const Benchmark benchmarks[] = {
+    {"dma::TCD_to_protobuf", tcd_to_protobuf},
+    {"dma::update_TCD", update_tcd},
+    {"dma::registers_to_protobuf", dma_registers_to_protobuf},
+    {"adc::serialize_registers", adc_serialize_registers},
+    {"adc::update_registers", adc_update_registers},
+    {"pit::serialize_timer_config", pit_serialize_timer_config},
+  };
+
+  srand(1);
+  randomize_registers();
+  for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+    // Best of several runs, to reduce the effect of other processes.
+    double best_ns = 1e9;
+    for (int j = 0; j < repeat_count; j++) {
+      const clock_t start = clock();
+      for (int k = 0; k < call_count; k++) { benchmarks[i].call(k); }
+      const double ns = (1e9 * (clock() - start) / CLOCKS_PER_SEC /
+                         call_count);
+      if (ns < best_ns) { best_ns = ns; }
+    }
+    printf("%-30s %6.1f ns/call\n", benchmarks[i].name, best_ns);
+  }
+  return (sink == 1);
+}
@@ -0,0 +1,73 @@
+'''
+Generate host stand-ins for the nanopb message headers (e.g.,
+`TeensyMinimalRpc/DMA_pb.h`) of the firmware build from the `.proto` files in
+`src/`.
+
+Only the message structs and enums are generated (fields ordered by tag, with
+a `has_<FIELD>` flag per `optional` field, as laid out by nanopb).  The
+`<MESSAGE>_fields` descriptors are placeholders, since the host stand-in of
+`pb_cpp_api.h` copies messages as-is.
+
+Usage:
+
+    python gen_mock_pb.py <output directory> <.proto file>...
+'''
+from __future__ import absolute_import, print_function
+import os
+import re
+import sys
+
+
+TYPES = {'bool': 'bool', 'uint32': 'uint32_t', 'fixed32': 'uint32_t',
+         'int32': 'int32_t', 'sint32': 'int32_t', 'sfixed32': 'int32_t'}
+
+
+def message_header(proto_source, name):
+    # Strip comments.
+    source = re.sub(r'/\*.*?\*/', '', proto_source, flags=re.S)
+    source = re.sub(r'//.*', '', source)
+    package = re.search(r'package\s+([\w.]+)\s*;', source).group(1)
+    prefix = package.replace('.', '_') + '_'
+
+    guard = '___MOCK__%s_PB__H___' % name.upper()
+    lines = ['/* Generated by `gen_mock_pb.py`; do not edit. */',
+             '#ifndef %s' % guard, '#define %s' % guard, '',
+             '#include <stdint.h>', '']
+    for message in re.finditer(r'message\s+(\w+)\s*\{(.*?)\n\}', source,
+                               flags=re.S):
+        message_name, body = message.groups()
+        enum_types = {}
+        for enum in re.finditer(r'enum\s+(\w+)\s*\{(.*?)\}', body,
+                                flags=re.S):
+            enum_type = prefix + message_name + '_' + enum.group(1)
+            enum_types[enum.group(1)] = enum_type
+            values = re.findall(r'(\w+)\s*=\s*(\d+)\s*;', enum.group(2))
+            lines.append('typedef enum _%s {' % enum_type)
+            lines += ['  %s_%s = %s,' % (enum_type, value_name, value)
+                      for value_name, value in values]
+            lines += ['} %s;' % enum_type, '']
+        body = re.sub(r'enum\s+\w+\s*\{.*?\}', '', body, flags=re.S)
+        fields = re.findall(r'optional\s+(\w+)\s+(\w+)\s*=\s*(\d+)', body)
+        message_type = prefix + message_name
+        lines.append('typedef struct _%s {' % message_type)
+        for field_type, field_name, tag in sorted(fields,
+                                                  key=lambda f: int(f[2])):
+            c_type = (TYPES.get(field_type) or enum_types.get(field_type) or
+                      prefix + field_type)
+            lines.append('  bool has_%s;' % field_name)
+            lines.append('  %s %s;' % (c_type, field_name))
+        lines += ['} %s;' % message_type, '',
+                  '#define %s_init_default {}' % message_type,
+                  'static const int %s_fields[1] = {0};' % message_type, '']
+    lines.append('#endif  // #ifndef %s' % guard)
+    return '\n'.join(lines) + '\n'
+
+
+if __name__ == '__main__':
+    output_dir = sys.argv[1]
+    for proto_path in sys.argv[2:]:
+        name = os.path.splitext(os.path.basename(proto_path))[0]
+        with open(proto_path) as input_:
+            header = message_header(input_.read(), name)
+        with open(os.path.join(output_dir, '%s_pb.h' % name), 'w') as output:
+            output.write(header)
@@ -0,0 +1,26 @@
+#ifndef ___C_ARRAY_DEFS__H___
+#define ___C_ARRAY_DEFS__H___
+
+/* Host stand-in for the `CArrayDefs.h` of the firmware build. */
+#include <stdint.h>
+#include <stddef.h>
+
+#define C_ARRAY_TYPE(name, type) \
+  struct name { uint32_t length; type *data; }; \
+  inline name name##_init_default() { name a = {0, NULL}; return a; } \
+  inline name name##_init(uint32_t length, type *data) { \
+    name a = {length, data}; \
+    return a; \
+  }
+
+C_ARRAY_TYPE(UInt8Array, uint8_t)
+C_ARRAY_TYPE(UInt16Array, uint16_t)
+C_ARRAY_TYPE(UInt32Array, uint32_t)
+C_ARRAY_TYPE(Int8Array, int8_t)
+C_ARRAY_TYPE(Int16Array, int16_t)
+C_ARRAY_TYPE(Int32Array, int32_t)
+C_ARRAY_TYPE(FloatArray, float)
+
+#undef C_ARRAY_TYPE
+
+#endif  // #ifndef ___C_ARRAY_DEFS__H___
@@ -0,0 +1,32 @@
+#ifndef ___DMA_CHANNEL__H___
+#define ___DMA_CHANNEL__H___
+
+/* Host stand-in for the `DMAChannel.h` of the Teensy 3 core (transfer
+ * control descriptor layout only).  Addresses are host pointers, so the
+ * descriptor is larger than the 32 bytes of the device. */
+#include <kinetis.h>
+
+#define DMA_NUM_CHANNELS 16
+
+class DMABaseClass {
+public:
+  typedef struct __attribute__((packed, aligned(4))) {
+    volatile const void * volatile SADDR;
+    int16_t SOFF;
+    union { uint16_t ATTR;
+      struct { uint8_t ATTR_DST; uint8_t ATTR_SRC; }; };
+    union { uint32_t NBYTES; uint32_t NBYTES_MLNO;
+      uint32_t NBYTES_MLOFFNO; uint32_t NBYTES_MLOFFYES; };
+    int32_t SLAST;
+    volatile void * volatile DADDR;
+    int16_t DOFF;
+    union { volatile uint16_t CITER;
+      volatile uint16_t CITER_ELINKYES; volatile uint16_t CITER_ELINKNO; };
+    int32_t DLASTSGA;
+    volatile uint16_t CSR;
+    union { volatile uint16_t BITER;
+      volatile uint16_t BITER_ELINKYES; volatile uint16_t BITER_ELINKNO; };
+  } TCD_t;
+};
+
+#endif  // #ifndef ___DMA_CHANNEL__H___
@@ -0,0 +1,124 @@
+#ifndef ___KINETIS__H___
+#define ___KINETIS__H___
+
+/* Host stand-in for the `kinetis.h` of the Teensy 3 core.
+ *
+ * Each peripheral register is backed by host memory (see `MockRegisters`),
+ * laid out as on the device wherever the library relies on the relative
+ * position of registers (e.g., `DMA_CR`...`DMA_DCHPRI3`, the `ADC0_SC1A`
+ * register file, the `PIT_LDVAL0` timer registers, and `SIM_SCGC4`...
+ * `SIM_SCGC7`).  Register side effects (e.g., write-1-to-clear) are not
+ * simulated. */
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+struct MockRegisters {
+  uint32_t dma[0x110 / 4];  // `DMA_CR` to `DMA_DCHPRI12`.
+  uint8_t dmamux[16];
+  // Transfer control descriptors (at most 64 bytes each on the host).
+  uint8_t tcd[16 * 64] __attribute__((aligned(8)));
+  uint32_t adc0[28];
+  uint32_t adc1[28];
+  uint32_t pit_mcr;
+  uint32_t pit_timers[16];  // `LDVAL`, `CVAL`, `TCTRL`, `TFLG` per timer.
+  uint32_t sim_scgc[4];  // `SIM_SCGC4` to `SIM_SCGC7`.
+};
+
+inline MockRegisters &mock_registers() {
+  static MockRegisters registers;
+  return registers;
+}
+
+inline void mock_registers_reset() {
+  memset(&mock_registers(), 0, sizeof(MockRegisters));
+}
+
+#define MOCK_REGISTER(type, member, offset) \
+  (*(volatile type *)((uint8_t *)&mock_registers().member + (offset)))
+
+#define DMA_CR MOCK_REGISTER(uint32_t, dma, 0x00)
+#define DMA_ES MOCK_REGISTER(uint32_t, dma, 0x04)
+#define DMA_ERQ MOCK_REGISTER(uint32_t, dma, 0x0C)
+#define DMA_EEI MOCK_REGISTER(uint32_t, dma, 0x14)
+#define DMA_CEEI MOCK_REGISTER(uint8_t, dma, 0x18)
+#define DMA_SEEI MOCK_REGISTER(uint8_t, dma, 0x19)
+#define DMA_CERQ MOCK_REGISTER(uint8_t, dma, 0x1A)
+#define DMA_SERQ MOCK_REGISTER(uint8_t, dma, 0x1B)
+#define DMA_CDNE MOCK_REGISTER(uint8_t, dma, 0x1C)
+#define DMA_SSRT MOCK_REGISTER(uint8_t, dma, 0x1D)
+#define DMA_CERR MOCK_REGISTER(uint8_t, dma, 0x1E)
+#define DMA_CINT MOCK_REGISTER(uint8_t, dma, 0x1F)
+#define DMA_INT MOCK_REGISTER(uint32_t, dma, 0x24)
+#define DMA_ERR MOCK_REGISTER(uint32_t, dma, 0x2C)
+#define DMA_HRS MOCK_REGISTER(uint32_t, dma, 0x34)
+#define DMA_DCHPRI3 MOCK_REGISTER(uint8_t, dma, 0x100)
+#define DMA_TCD0_SADDR \
+  MOCK_REGISTER(const void * volatile, tcd, 0)
+#define DMAMUX0_CHCFG0 MOCK_REGISTER(uint8_t, dmamux, 0)
+#define ADC0_SC1A MOCK_REGISTER(uint32_t, adc0, 0x00)
+#define ADC0_RA MOCK_REGISTER(uint32_t, adc0, 0x10)
+#define ADC1_SC1A MOCK_REGISTER(uint32_t, adc1, 0x00)
+#define ADC1_RA MOCK_REGISTER(uint32_t, adc1, 0x10)
+#define PIT_MCR MOCK_REGISTER(uint32_t, pit_mcr, 0)
+#define PIT_LDVAL0 MOCK_REGISTER(uint32_t, pit_timers, 0)
+#define SIM_SCGC4 MOCK_REGISTER(uint32_t, sim_scgc, 0x0)
+#define SIM_SCGC5 MOCK_REGISTER(uint32_t, sim_scgc, 0x4)
+#define SIM_SCGC6 MOCK_REGISTER(uint32_t, sim_scgc, 0x8)
+#define SIM_SCGC7 MOCK_REGISTER(uint32_t, sim_scgc, 0xC)
+
+#define __disable_irq()
+#define __enable_irq()
+
+#define SIM_SCGC6_DMAMUX ((uint32_t)0x00000002)
+#define SIM_SCGC7_DMA ((uint32_t)0x00000002)
+#define DMA_CR_CX ((uint32_t)(1 << 17))
+#define DMA_CR_ECX ((uint32_t)(1 << 16))
+#define DMA_CR_EMLM ((uint32_t)0x80)
+#define DMA_CR_CLM ((uint32_t)0x40)
+#define DMA_CR_HALT ((uint32_t)0x20)
+#define DMA_CR_HOE ((uint32_t)0x10)
+#define DMA_CR_ERCA ((uint32_t)0x04)
+#define DMA_CR_EDBG ((uint32_t)0x02)
+#define DMA_TCD_CSR_DONE 0x0080
+#define DMA_TCD_CSR_ACTIVE 0x0040
+#define DMA_TCD_CSR_MAJORELINK 0x0020
+#define DMA_TCD_CSR_ESG 0x0010
+#define DMA_TCD_CSR_DREQ 0x0008
+#define DMA_TCD_CSR_INTHALF 0x0004
+#define DMA_TCD_CSR_INTMAJOR 0x0002
+#define DMA_TCD_CSR_START 0x0001
+#define DMA_TCD_NBYTES_SMLOE ((uint32_t)1 << 31)
+#define DMA_TCD_NBYTES_DMLOE ((uint32_t)1 << 30)
+#define DMA_TCD_CITER_ELINK ((uint16_t)1 << 15)
+#define DMA_TCD_BITER_ELINK ((uint16_t)1 << 15)
+#define DMA_DCHPRI_ECP ((uint8_t)0x80)
+#define DMA_DCHPRI_DPA ((uint8_t)0x40)
+#define ADC_SC1_COCO ((uint32_t)0x80)
+#define ADC_SC1_AIEN ((uint32_t)0x40)
+#define ADC_SC1_DIFF ((uint32_t)0x20)
+#define ADC_CFG1_ADLPC ((uint32_t)0x80)
+#define ADC_CFG1_ADLSMP ((uint32_t)0x10)
+#define ADC_CFG2_MUXSEL ((uint32_t)0x10)
+#define ADC_CFG2_ADACKEN ((uint32_t)0x08)
+#define ADC_CFG2_ADHSC ((uint32_t)0x04)
+#define ADC_SC2_ADACT ((uint32_t)0x80)
+#define ADC_SC2_ADTRG ((uint32_t)0x40)
+#define ADC_SC2_ACFE ((uint32_t)0x20)
+#define ADC_SC2_ACFGT ((uint32_t)0x10)
+#define ADC_SC2_ACREN ((uint32_t)0x08)
+#define ADC_SC2_DMAEN ((uint32_t)0x04)
+#define ADC_SC3_CAL ((uint32_t)0x80)
+#define ADC_SC3_CALF ((uint32_t)0x40)
+#define ADC_SC3_ADCO ((uint32_t)0x08)
+#define ADC_SC3_AVGE ((uint32_t)0x04)
+#define ADC_PGA_PGAEN ((uint32_t)0x00800000)
+#define ADC_PGA_PGALPB ((uint32_t)0x00100000)
+#define PIT_MCR_MDIS ((uint32_t)0x02)
+#define PIT_MCR_FRZ ((uint32_t)0x01)
+#define PIT_TCTRL_CHN ((uint32_t)0x04)
+#define PIT_TCTRL_TIE ((uint32_t)0x02)
+#define PIT_TCTRL_TEN ((uint32_t)0x01)
+#define PIT_TFLG_TIF ((uint32_t)0x01)
+
+#endif  // #ifndef ___KINETIS__H___
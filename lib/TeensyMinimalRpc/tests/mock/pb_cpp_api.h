@@ -0,0 +1,31 @@
+#ifndef ___PB_CPP_API__H___
+#define ___PB_CPP_API__H___
+
+/* Host stand-in for the nanopb C++ API of the firmware build: messages are
+ * copied as-is (not encoded), so decoded fields can be compared directly. */
+#include <string.h>
+#include <CArrayDefs.h>
+
+namespace nanopb {
+  template <typename Message, typename Fields>
+  inline UInt8Array serialize_to_array(Message &message, Fields const &,
+                                       UInt8Array buffer) {
+    if (buffer.length < sizeof(message)) {
+      buffer.length = 0;
+      return buffer;
+    }
+    memcpy(buffer.data, &message, sizeof(message));
+    buffer.length = sizeof(message);
+    return buffer;
+  }
+
+  template <typename Message, typename Fields>
+  inline bool decode_from_array(UInt8Array buffer, Fields const &,
+                                Message &message) {
+    if (buffer.length != sizeof(message)) { return false; }
+    memcpy(&message, buffer.data, sizeof(message));
+    return true;
+  }
+}  // namespace nanopb
+
+#endif  // #ifndef ___PB_CPP_API__H___
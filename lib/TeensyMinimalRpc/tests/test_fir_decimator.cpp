@@ -0,0 +1,225 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <TeensyMinimalRpc/FirDecimator.h>
+#include <TeensyMinimalRpc/BlockStatistics.h>
+#include <TeensyMinimalRpc/RiceCodec.h>
+#include "unit_test.h"
+
+using namespace teensy_minimal_rpc;
+
+/* Blocks of `uint16_t` samples in the layout of a `FirDecimator`, and the
+ * (centered) samples of each channel since the first block. */
+struct Signal {
+  BlockLayout layout;
+  std::vector<uint16_t> block;
+  std::vector<std::vector<int16_t> > history;
+
+  Signal(uint16_t channel_count, uint16_t sample_count, bool interleaved)
+    : history(channel_count) {
+    layout.channel_count = channel_count;
+    layout.sample_count = sample_count;
+    // Per-channel arrays are padded, so strides are not implied.
+    layout.channel_stride = interleaved ? 1 : sample_count + 3;
+    layout.sample_stride = interleaved ? channel_count : 1;
+    block.resize(interleaved ? channel_count * sample_count
+                 : channel_count * layout.channel_stride);
+  }
+
+  UInt8Array next_block() {
+    for (size_t i = 0; i < block.size(); i++) { block[i] = rand(); }
+    for (uint16_t c = 0; c < layout.channel_count; c++) {
+      for (uint16_t i = 0; i < layout.sample_count; i++) {
+        const uint16_t sample = block[c * layout.channel_stride +
+                                      i * layout.sample_stride];
+        history[c].push_back((int16_t)(sample ^ 0x8000));
+      }
+    }
+    return UInt8Array_init(block.size() * sizeof(uint16_t),
+                           (uint8_t *)block.data());
+  }
+};
+
+/* Direct convolution of channel \a c at sample \a n (since the first
+ * block), i.e., `y = sum(h[k] * x[n - k])`, rounded and saturated. */
+static uint16_t convolve(const std::vector<int16_t> &taps,
+                         const std::vector<int16_t> &x, int64_t n) {
+  int64_t sum = 0;
+  for (int64_t k = 0; (k < (int64_t)taps.size()) && (k <= n); k++) {
+    sum += (int32_t)taps[k] * x[n - k];
+  }
+  int64_t value = (sum + (1 << 14)) >> 15;
+  if (value > INT16_MAX) { value = INT16_MAX; }
+  if (value < INT16_MIN) { value = INT16_MIN; }
+  return (uint16_t)value ^ 0x8000;
+}
+
+/* Compare each output of consecutive blocks against direct convolution,
+ * i.e., filter history is carried across blocks. */
+static void check_process(uint16_t tap_count, uint8_t factor,
+                          uint16_t channel_count, bool interleaved,
+                          bool saturate, int block_count=4) {
+  std::vector<int16_t> taps(tap_count);
+  for (uint16_t i = 0; i < tap_count; i++) {
+    taps[i] = saturate ? (int16_t)rand() : (int16_t)(rand() % 8001 - 4000);
+  }
+  const uint16_t sample_count = factor * (1 + rand() % 8);
+  Signal signal(channel_count, sample_count, interleaved);
+  FirDecimator decimator;
+  CHECK(decimator.configure(UInt16Array_init(tap_count,
+                                             (uint16_t *)taps.data()),
+                            factor, signal.layout) == 0);
+  CHECK(decimator.layout_.span() ==
+        signal.block.size() - (interleaved ? 0 : 3));
+
+  const uint16_t output_count = sample_count / factor;
+  uint32_t mismatch_count = 0;
+  for (int b = 0; b < block_count; b++) {
+    const UInt8Array output = decimator.process(signal.next_block());
+    CHECK(output.length == channel_count * output_count * sizeof(uint16_t));
+    if (output.length == 0) { return; }
+    const uint16_t *samples = (const uint16_t *)output.data;
+    // Channel-major output.
+    for (uint16_t c = 0; c < channel_count; c++) {
+      for (uint16_t j = 0; j < output_count; j++) {
+        const int64_t n = (int64_t)b * sample_count + j * factor;
+        if (samples[c * output_count + j] !=
+            convolve(taps, signal.history[c], n)) { mismatch_count++; }
+      }
+    }
+  }
+  CHECK(mismatch_count == 0);
+  if (mismatch_count) {
+    fprintf(stderr, "  %u taps, factor %u, %u channel(s), %s\n", tap_count,
+            factor, channel_count, interleaved ? "interleaved" : "arrays");
+  }
+
+  // Too small for the layout.
+  UInt8Array block = signal.next_block();
+  block.length = (decimator.layout_.span() - 1) * sizeof(uint16_t);
+  CHECK(decimator.process(block).length == 0);
+}
+
+static void test_process() {
+  const uint16_t tap_counts[] = {1, 2, 3, 7, 16, 31, 64, 255, 256};
+  const uint8_t factors[] = {2, 3, 5, 7, 8, 64};
+  for (size_t i = 0; i < sizeof(tap_counts) / sizeof(tap_counts[0]); i++) {
+    for (size_t j = 0; j < sizeof(factors) / sizeof(factors[0]); j++) {
+      for (int interleaved = 0; interleaved < 2; interleaved++) {
+        check_process(tap_counts[i], factors[j], 1 + rand() % 4,
+                      interleaved, (i % 3) == 0);
+      }
+    }
+  }
+}
+
+static void test_reset() {
+  uint16_t taps[] = {0x4000, 0x4000};  // Mean of two samples.
+  FirDecimator decimator;
+  CHECK(decimator.configure(UInt16Array_init(2, taps), 2,
+                            BlockLayout::channel_major(1, 4)) == 0);
+  uint16_t block[] = {0x9000, 0x9000, 0x9000, 0x9000};
+  UInt8Array input = UInt8Array_init(sizeof(block), (uint8_t *)block);
+  // First output averages the first sample with silence (i.e., `0x8000`).
+  CHECK(((uint16_t *)decimator.process(input).data)[0] == 0x8800);
+  CHECK(((uint16_t *)decimator.process(input).data)[0] == 0x9000);
+  decimator.reset();
+  CHECK(((uint16_t *)decimator.process(input).data)[0] == 0x8800);
+}
+
+static void test_configure() {
+  uint16_t taps[FIR_DECIMATOR_MAX_TAPS + 1] = {1, 2};
+  const BlockLayout layout = {1, 4, 0, 1};
+  const BlockLayout overlapping = {2, 4, 0, 1};
+  FirDecimator decimator;
+  CHECK(decimator.configure(UInt16Array_init(2, taps), 1, layout) == -1);
+  CHECK(decimator.configure(UInt16Array_init(2, taps), 65,
+                            BlockLayout::channel_major(1, 130)) == -1);
+  // Factor must divide the sample count.
+  CHECK(decimator.configure(UInt16Array_init(2, taps), 4,
+                            BlockLayout::channel_major(1, 6)) == -1);
+  CHECK(decimator.configure(UInt16Array_init(2, taps), 2, overlapping) ==
+        -1);
+  // Channels overlap, in either order.
+  const BlockLayout arrays = {2, 4, 3, 1};
+  const BlockLayout interleaved = {3, 4, 1, 2};
+  CHECK(!arrays.valid() && !interleaved.valid());
+  CHECK(decimator.configure(UInt16Array_init(2, taps), 2, arrays) == -1);
+  CHECK(decimator.configure(UInt16Array_init(2, taps), 2, interleaved) ==
+        -1);
+  CHECK(decimator.configure(UInt16Array_init(0, taps), 2, layout) == -1);
+  CHECK(decimator.configure(UInt16Array_init(FIR_DECIMATOR_MAX_TAPS + 1,
+                                             taps), 2, layout) == -1);
+  CHECK(!decimator.enabled());
+  CHECK(decimator.process(UInt8Array_init(sizeof(taps), (uint8_t *)taps))
+        .length == 0);
+}
+
+/* Stages after the decimator read its channel-major output (as in
+ * `process_block` of the firmware), not the layout of the raw blocks. */
+static void test_downstream_layout() {
+  const uint16_t channel_count = 3;
+  const uint16_t sample_count = 64;
+  const uint8_t factor = 4;
+  const uint16_t output_count = sample_count / factor;
+  uint16_t taps[] = {0x2000, 0x2000, 0x2000, 0x2000};
+  Signal signal(channel_count, sample_count, true);
+  FirDecimator decimator;
+  CHECK(decimator.configure(UInt16Array_init(4, taps), factor,
+                            signal.layout) == 0);
+  BlockStatistics statistics;
+  CHECK(statistics.configure(signal.layout) == 0);
+  RiceEncoder encoder;
+  CHECK(encoder.configure(signal.layout, 16) == 0);
+  const BlockLayout layout = decimator.output_layout();
+  CHECK(layout.channel_count == channel_count);
+  CHECK(layout.sample_count == output_count);
+  CHECK(layout.span() == channel_count * output_count);
+
+  const UInt8Array output = decimator.process(signal.next_block());
+  CHECK(output.length == channel_count * output_count * sizeof(uint16_t));
+  // Output is too small for the layout of the raw blocks.
+  CHECK(statistics.reduce(output, 0).length == 0);
+  CHECK(encoder.encode(output).length == 0);
+
+  const UInt8Array record = statistics.reduce(output, 0, layout);
+  CHECK(record.length == statistics.record_size());
+  BlockStatisticsHeader header;
+  memcpy(&header, record.data, sizeof(header));
+  CHECK(header.channel_count == channel_count);
+  CHECK(header.sample_count == output_count);
+  for (uint16_t c = 0; c < channel_count; c++) {
+    ChannelStatistics expected, result;
+    BlockStatistics::reduce_channel((uint16_t *)output.data +
+                                    c * output_count, output_count, 1,
+                                    expected);
+    memcpy(&result, record.data + sizeof(header) + c * sizeof(result),
+           sizeof(result));
+    CHECK(memcmp(&result, &expected, sizeof(result)) == 0);
+  }
+
+  const UInt8Array coded = encoder.encode(output, layout);
+  CHECK(coded.length > sizeof(RiceBlockHeader));
+  RiceBlockHeader rice_header;
+  memcpy(&rice_header, coded.data, sizeof(rice_header));
+  CHECK(rice_header.channel_count == channel_count);
+  CHECK(rice_header.sample_count == output_count);
+  if (!rice_header.coded) {
+    CHECK(memcmp(coded.data + sizeof(rice_header), output.data,
+                 output.length) == 0);
+  }
+  // At most the configured number of samples per channel.
+  BlockLayout longer = signal.layout;
+  longer.sample_count++;
+  CHECK(encoder.encode(signal.next_block(), longer).length == 0);
+}
+
+int main() {
+  srand(1);
+  test_process();
+  test_reset();
+  test_configure();
+  test_downstream_layout();
+  return TEST_RESULT();
+}
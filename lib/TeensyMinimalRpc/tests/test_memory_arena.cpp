@@ -0,0 +1,164 @@
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <TeensyMinimalRpc/MemoryArena.h>
+#include "unit_test.h"
+
+using namespace teensy_minimal_rpc;
+
+typedef MemoryArena<8, 4096> arena_t;
+
+static bool aligned(const void *address, uint32_t alignment) {
+  return !((uintptr_t)address & (alignment - 1));
+}
+
+/* Every byte carved from the arena is either allocated or free. */
+static void check_stats(const arena_t &arena) {
+  CHECK(arena.stats_.in_use_bytes + arena.stats_.free_list_bytes ==
+        arena.stats_.bump_bytes);
+  CHECK(arena.stats_.bump_bytes <= arena.stats_.capacity);
+  CHECK(arena.stats_.high_water_bytes >= arena.stats_.in_use_bytes);
+}
+
+static void test_slabs() {
+  static arena_t arena;
+  void *slabs[8];
+  for (int i = 0; i < 8; i++) {
+    slabs[i] = arena.allocate(32);
+    CHECK(arena.contains_slab(slabs[i]));
+    CHECK(aligned(slabs[i], 32));
+  }
+  // Slab region is full, so the next small request comes from the pool.
+  void *block = arena.allocate(20);
+  CHECK(arena.contains_pool(block));
+  CHECK(arena.free(slabs[3]));
+  CHECK(!arena.free(slabs[3]));  // Double free.
+  CHECK(arena.allocate(32) == slabs[3]);  // Freed slab is reused.
+  // Larger or more strictly aligned requests come from the pool.
+  CHECK(arena.contains_pool(arena.allocate(33)));
+  CHECK(arena.contains_pool(arena.allocate(8, 64)));
+  check_stats(arena);
+}
+
+static void test_pool_sizes() {
+  static arena_t arena;
+  // Sample buffers are not rounded up to a power of two.
+  void *buffer = arena.allocate(1000, 8);
+  CHECK(buffer != NULL);
+  CHECK(arena.stats_.in_use_bytes <
+        1000 + sizeof(arena_t::PoolBlockHeader) + arena_t::POOL_UNIT);
+  CHECK(arena.stats_.overhead_bytes ==
+        arena.stats_.in_use_bytes - 1000);
+  // Three buffers of 1200 bytes fit in a 4 KB pool.
+  CHECK(arena.free(buffer));
+  arena.reset();
+  void *buffers[3];
+  for (int i = 0; i < 3; i++) {
+    buffers[i] = arena.allocate(1200, 8);
+    CHECK(buffers[i] != NULL);
+  }
+  // Freed block is split (first fit), rest is kept on the free list.
+  const uint32_t bump_bytes = arena.stats_.bump_bytes;
+  CHECK(arena.free(buffers[1]));
+  void *small = arena.allocate(100, 8);
+  CHECK(small == buffers[1]);
+  CHECK(arena.allocate(1000, 8) != NULL);
+  CHECK(arena.stats_.bump_bytes == bump_bytes);
+  CHECK(arena.allocate(4096) == NULL);
+  CHECK(arena.stats_.failed_count == 1);
+  check_stats(arena);
+}
+
+static void test_aligned_reuse() {
+  static arena_t arena;
+  // Free list: a block that cannot hold a 256-byte aligned request at its
+  // head, followed by one that can.
+  void *large = arena.allocate(600, 8);
+  void *spacer = arena.allocate(40, 8);
+  void *unaligned = arena.allocate(64, 8);
+  CHECK(arena.free(large));
+  CHECK(arena.free(unaligned));
+  CHECK(arena.pool_free_list_ == (void *)((uint8_t *)unaligned -
+                                          sizeof(arena_t::PoolBlockHeader)));
+  const uint32_t bump_bytes = arena.stats_.bump_bytes;
+  void *buffer = arena.allocate(256, 256);
+  CHECK(aligned(buffer, 256));
+  CHECK((uint8_t *)buffer >= (uint8_t *)large);
+  CHECK((uint8_t *)buffer + 256 <= (uint8_t *)spacer);
+  CHECK(arena.stats_.bump_bytes == bump_bytes);
+  check_stats(arena);
+}
+
+static void test_invalid_free() {
+  static arena_t arena;
+  uint8_t *slab = (uint8_t *)arena.allocate(16);
+  uint8_t *block = (uint8_t *)arena.allocate(100);
+  int outside;
+  CHECK(!arena.free(&outside));
+  CHECK(!arena.free(slab + 4));
+  CHECK(!arena.free(block + 8));
+  CHECK(!arena.free(arena.slabs_ + arena_t::SLAB_SIZE));
+  CHECK(arena.free(block));
+  CHECK(!arena.free(block));
+  CHECK(arena.allocate(0) == NULL);
+  CHECK(arena.allocate(8, 24) == NULL);  // Not a power of two.
+  arena.reset();
+  CHECK(!arena.free(slab));
+  CHECK(arena.stats_.in_use_bytes == 0);
+  CHECK(arena.stats_.failed_count == 2);
+}
+
+struct Allocation {
+  uint8_t *data;
+  uint32_t size;
+  uint8_t fill;
+};
+
+/* Random allocations and frees: allocations are aligned, never overlap
+ * (each keeps its fill pattern), and statistics stay consistent. */
+static void test_random() {
+  static arena_t arena;
+  std::vector<Allocation> allocations;
+  srand(1);
+  for (int i = 0; i < 20000; i++) {
+    if (allocations.size() && ((rand() % 3) == 0)) {
+      const size_t index = rand() % allocations.size();
+      Allocation allocation = allocations[index];
+      for (uint32_t j = 0; j < allocation.size; j++) {
+        if (allocation.data[j] != allocation.fill) {
+          CHECK(allocation.data[j] == allocation.fill);
+          break;
+        }
+      }
+      CHECK(arena.free(allocation.data));
+      allocations.erase(allocations.begin() + index);
+    } else {
+      const uint32_t size = 1 + rand() % ((rand() & 1) ? 32 : 700);
+      const uint32_t alignment = 1 << (rand() % 9);
+      Allocation allocation;
+      allocation.data = (uint8_t *)arena.allocate(size, alignment);
+      if (allocation.data == NULL) {
+        // Free blocks are not merged, so start over once the pool is full.
+        allocations.clear();
+        arena.reset();
+        continue;
+      }
+      CHECK(aligned(allocation.data, alignment));
+      allocation.size = size;
+      allocation.fill = rand();
+      memset(allocation.data, allocation.fill, size);
+      allocations.push_back(allocation);
+    }
+    check_stats(arena);
+    CHECK(arena.stats_.allocation_count == allocations.size());
+  }
+}
+
+int main() {
+  test_slabs();
+  test_pool_sizes();
+  test_aligned_reuse();
+  test_invalid_free();
+  test_random();
+  return TEST_RESULT();
+}
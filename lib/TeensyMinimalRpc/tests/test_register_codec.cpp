@@ -0,0 +1,125 @@
+#include <stdint.h>
+#include <string.h>
+#include <TeensyMinimalRpc/DMA.h>
+#include <TeensyMinimalRpc/ADC.h>
+#include <TeensyMinimalRpc/PIT.h>
+#include "unit_test.h"
+
+using namespace teensy;
+
+static uint8_t buffer_data[1024];
+
+static UInt8Array buffer() {
+  UInt8Array result = {sizeof(buffer_data), buffer_data};
+  return result;
+}
+
+/* Message as serialized by the host (see `mock/pb_cpp_api.h`). */
+template <typename Message>
+static UInt8Array serialized(Message &message) {
+  UInt8Array result = {sizeof(message), (uint8_t *)&message};
+  return result;
+}
+
+static void test_tcd() {
+  mock_registers_reset();
+  volatile DMABaseClass::TCD_t &tcd = dma::TCD(2);
+
+  // All 10 bits of `NBYTES` are decoded when the minor loop offset is on.
+  DMA_CR = DMA_CR_EMLM;
+  tcd.NBYTES_MLOFFYES = DMA_TCD_NBYTES_SMLOE | (5 << 10) | 0x3FF;
+  teensy__3_1_dma_TCD result = dma::TCD_to_protobuf(2);
+  CHECK(result.has_NBYTES_MLOFFYES);
+  CHECK(result.NBYTES_MLOFFYES.NBYTES == 0x3FF);
+  CHECK(result.NBYTES_MLOFFYES.MLOFF == 5);
+
+  // A negative offset is masked to its 20-bit field (i.e., does not set
+  // `DMLOE`).
+  teensy__3_1_dma_TCD tcd_new = teensy__3_1_dma_TCD_init_default;
+  tcd_new.has_NBYTES_MLOFFYES = true;
+  tcd_new.NBYTES_MLOFFYES.has_SMLOE = true;
+  tcd_new.NBYTES_MLOFFYES.SMLOE = true;
+  tcd_new.NBYTES_MLOFFYES.has_MLOFF = true;
+  tcd_new.NBYTES_MLOFFYES.MLOFF = (uint32_t)-4;
+  tcd_new.NBYTES_MLOFFYES.has_NBYTES = true;
+  tcd_new.NBYTES_MLOFFYES.NBYTES = 4;
+  CHECK(dma::update_TCD(2, tcd_new) == 0);
+  CHECK(tcd.NBYTES_MLOFFYES == (DMA_TCD_NBYTES_SMLOE |
+                                (((uint32_t)-4 & 0xFFFFF) << 10) | 4));
+
+  // Fields of either attribute byte missing from the message are kept.
+  tcd.ATTR_SRC = (2 << 3) | 1;
+  tcd.ATTR_DST = (3 << 3) | 1;
+  tcd_new = teensy__3_1_dma_TCD_init_default;
+  tcd_new.has_ATTR = true;
+  tcd_new.ATTR.has_DSIZE = true;
+  tcd_new.ATTR.DSIZE = teensy__3_1_dma_R_TCD_ATTR_E_SIZE__32_BIT;
+  CHECK(dma::update_TCD(2, tcd_new) == 0);
+  CHECK(tcd.ATTR_SRC == ((2 << 3) | 1));
+  CHECK(tcd.ATTR_DST == ((3 << 3) | 2));
+
+  // `START` is written (last) along with the other `CSR` fields.
+  tcd_new = teensy__3_1_dma_TCD_init_default;
+  tcd_new.has_CSR = true;
+  tcd_new.CSR.has_INTMAJOR = true;
+  tcd_new.CSR.INTMAJOR = true;
+  tcd_new.CSR.has_START = true;
+  tcd_new.CSR.START = true;
+  CHECK(dma::update_TCD(2, tcd_new) == 0);
+  CHECK(tcd.CSR == (DMA_TCD_CSR_INTMAJOR | DMA_TCD_CSR_START));
+}
+
+static void test_dma_registers() {
+  mock_registers_reset();
+  // Error status is read-only, and is not written to any register.
+  DMA_CR = DMA_CR_EMLM;
+  DMA_ES = 0x80000001;
+  teensy__3_1_dma_Registers registers = dma::registers_to_protobuf();
+  CHECK(registers.has_ES && registers.ES.VLD && registers.ES.DBE);
+  CHECK(dma::update_registers(registers) == 0);
+  CHECK(DMA_CR == DMA_CR_EMLM);
+  CHECK(DMA_ES == 0x80000001);
+
+  // Priority wider than its field does not spill into `DPA`.
+  teensy__3_1_dma_DCHPRI dchpri = teensy__3_1_dma_DCHPRI_init_default;
+  dchpri.has_CHPRI = true;
+  dchpri.CHPRI = 0x4F;
+  CHECK(dma::update_dchpri(1, serialized(dchpri)) == 0);
+  CHECK(*dma::channel_to_dchpri_addr(1) == 0xF);
+}
+
+static void test_adc() {
+  mock_registers_reset();
+  // Enumerated single-bit fields decode to 0 or 1 (not to the bit mask).
+  mock_registers().adc1[2] = ADC_CFG1_ADLSMP;  // `CFG1`
+  mock_registers().adc1[8] = ADC_SC2_ADTRG;  // `SC2`
+  const UInt8Array output = adc::serialize_registers(1, buffer());
+  teensy__3_1_adc_Registers registers;
+  CHECK(output.length == sizeof(registers));
+  memcpy(&registers, output.data, sizeof(registers));
+  CHECK(registers.CFG1.ADLSMP == teensy__3_1_adc_R_CFG1_E_ADLSMP_LONG);
+  CHECK(registers.SC2.ADTRG == teensy__3_1_adc_R_SC2_E_ADTRG_HARDWARE);
+}
+
+static void test_pit() {
+  mock_registers_reset();
+  volatile uint32_t &TFLG = mock_registers().pit_timers[4 + 3];
+  // Flag register is only written if present in the message.
+  teensy__3_1_pit_TimerConfig config =
+    teensy__3_1_pit_TimerConfig_init_default;
+  config.TFLG.has_TIF = true;
+  config.TFLG.TIF = true;
+  CHECK(pit::update_timer_config(1, serialized(config)) == 0);
+  CHECK(TFLG == 0);
+  config.has_TFLG = true;
+  CHECK(pit::update_timer_config(1, serialized(config)) == 0);
+  CHECK(TFLG == PIT_TFLG_TIF);
+}
+
+int main() {
+  test_tcd();
+  test_dma_registers();
+  test_adc();
+  test_pit();
+  return TEST_RESULT();
+}
@@ -0,0 +1,135 @@
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <TeensyMinimalRpc/RegisterTransaction.h>
+#include <TeensyMinimalRpc/DMA.h>
+#include "unit_test.h"
+
+using namespace teensy::registers;
+
+/* Operations of a transaction, packed as sent by the host. */
+class Ops {
+public:
+  std::vector<uint8_t> data;
+
+  Ops &op(uint8_t type, uint8_t target, uint16_t index) {
+    data.push_back(type);
+    data.push_back(target);
+    data.push_back(index & 0xFF);
+    data.push_back(index >> 8);
+    return *this;
+  }
+  Ops &u32(uint32_t value) {
+    for (int i = 0; i < 4; i++) { data.push_back(value >> (8 * i)); }
+    return *this;
+  }
+  Ops &reg(uint8_t type, uint8_t target, uint16_t index, uint32_t mask,
+           uint32_t value) {
+    return op(type, target, index).u32(mask).u32(value);
+  }
+  Ops &token(bool check, uint32_t expected, uint32_t new_token) {
+    return op(OP_TOKEN, check, 0).u32(expected).u32(new_token);
+  }
+  TransactionResult apply() {
+    UInt8Array ops = {(uint32_t)data.size(), data.data()};
+    return apply_transaction(ops);
+  }
+};
+
+static volatile uint8_t &dma_byte(uint16_t offset) {
+  return *((volatile uint8_t *)&DMA_CR + offset);
+}
+
+static void test_apply() {
+  mock_registers_reset();
+  Ops ops;
+  ops.op(OP_TCD, 3, 0);
+  const uint8_t tcd_words = sizeof(DMABaseClass::TCD_t) / sizeof(uint32_t);
+  for (uint8_t i = 0; i < tcd_words; i++) { ops.u32(0x11111111u * (i + 1)); }
+  ops.reg(OP_MUX, 2, 0, FULL_MASK, 0x85)
+    .reg(OP_DMA, 0, 0x1B, FULL_MASK, 2)  // `DMA_SERQ`
+    .reg(OP_DMA, 0, DMA_DCHPRI_INDEX + 1, FULL_MASK, 7)
+    .reg(OP_ADC, 1, 8, 0x4, 0x4)  // `SC2`
+    .reg(OP_PIT, 0, 3, FULL_MASK, 3)  // `TCTRL0`
+    .reg(OP_SIM, 0, 6, 1 << 27, 1 << 27);
+  mock_registers().adc1[8] = 0x10;
+  const TransactionResult result = ops.apply();
+  CHECK(result.op_count == 7);
+  CHECK(result.failed_index == 7);
+  volatile uint32_t *tcd = (volatile uint32_t *)&teensy::dma::TCD(3);
+  CHECK(tcd[0] == 0x11111111);
+  CHECK(tcd[tcd_words - 1] == 0x11111111u * tcd_words);
+  CHECK(mock_registers().dmamux[2] == 0x85);
+  CHECK(dma_byte(0x1B) == 2);
+  // `DCHPRI` registers are byte-reversed in groups of four.
+  CHECK(dma_byte(0x100 + 2) == 7);
+  CHECK(mock_registers().adc1[8] == 0x14);
+  CHECK(mock_registers().pit_timers[2] == 3);
+  CHECK(SIM_SCGC6 == (1u << 27));
+}
+
+static void test_invalid() {
+  mock_registers_reset();
+  // Nothing is written if any operation is invalid.
+  Ops ops;
+  ops.reg(OP_SIM, 0, 6, FULL_MASK, 1).reg(OP_ADC, 0, 4, FULL_MASK, 1);
+  TransactionResult result = ops.apply();
+  CHECK(result.failed_index == 1);
+  CHECK(SIM_SCGC6 == 0);
+
+  // Partial mask of write-only register, read-only `CVAL`, unaligned poke,
+  // truncated operation, and unknown type.
+  CHECK(Ops().reg(OP_DMA, 0, 0x1B, 1, 1).apply().failed_index == 0);
+  CHECK(Ops().reg(OP_PIT, 0, 2, FULL_MASK, 1).apply().failed_index == 0);
+  CHECK(Ops().op(OP_POKE, 0, 0).u32(0x40000001).u32(1).u32(1).apply()
+        .failed_index == 0);
+  CHECK(Ops().op(OP_MUX, 0, 0).u32(1).apply().failed_index == 0);
+  CHECK(Ops().reg(9, 0, 0, 1, 1).apply().failed_index == 0);
+  result = Ops().apply();
+  CHECK((result.op_count == 0) && (result.failed_index == 0));
+}
+
+static void test_token() {
+  mock_registers_reset();
+  invalidate_token();
+  CHECK(Ops().token(true, 5, 7).apply().failed_index == 0);
+  CHECK(token() == 0);
+  CHECK(Ops().token(false, 5, 7).apply().failed_index == 1);
+  CHECK(token() == 7);
+  TransactionResult result = (Ops().token(true, 7, 9)
+                              .reg(OP_SIM, 0, 4, FULL_MASK, 3).apply());
+  CHECK(result.failed_index == 2);
+  CHECK(token() == 9);
+  CHECK(SIM_SCGC4 == 3);
+
+  /* A second token operation is rejected, even if both expect the current
+   * token (applying the second used to validate it again, against the
+   * token just written by the first). */
+  result = (Ops().token(true, 9, 11).reg(OP_SIM, 0, 5, FULL_MASK, 1)
+            .token(true, 9, 12).apply());
+  CHECK(result.op_count == 2);
+  CHECK(result.failed_index == 2);
+  CHECK(token() == 9);
+  CHECK(SIM_SCGC5 == 0);
+  CHECK(Ops().token(false, 0, 1).token(false, 0, 2).apply()
+        .failed_index == 1);
+  CHECK(token() == 9);
+
+  // Registers written without a token operation clear the token.
+  result = Ops().reg(OP_SIM, 0, 5, FULL_MASK, 1).apply();
+  CHECK(result.failed_index == 1);
+  CHECK(token() == 0);
+  CHECK(SIM_SCGC5 == 1);
+  CHECK(Ops().token(false, 0, 13).apply().failed_index == 1);
+  CHECK(token() == 13);
+
+  invalidate_token();
+  CHECK(token() == 0);
+}
+
+int main() {
+  test_apply();
+  test_invalid();
+  test_token();
+  return TEST_RESULT();
+}
@@ -0,0 +1,118 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+// Build the `SMLALD` kernels with the instruction emulated in C.
+#define RMS_EMULATE_DSP
+#include <TeensyMinimalRpc/RootMeanSquare.hpp>
+#include "unit_test.h"
+
+using namespace teensy_minimal_rpc;
+
+enum Pattern { RANDOM, MINIMUM, MAXIMUM, ALTERNATING, LARGE_MEAN };
+
+template <typename T> T minimum();
+template <typename T> T maximum();
+template <> int16_t minimum<int16_t>() { return INT16_MIN; }
+template <> int16_t maximum<int16_t>() { return INT16_MAX; }
+template <> uint16_t minimum<uint16_t>() { return 0; }
+template <> uint16_t maximum<uint16_t>() { return UINT16_MAX; }
+
+template <typename T>
+static T sample(Pattern pattern, uint32_t i) {
+  switch (pattern) {
+    case RANDOM: return (T)rand();
+    case MINIMUM: return minimum<T>();
+    case MAXIMUM: return maximum<T>();
+    case ALTERNATING: return (i & 1) ? maximum<T>() : minimum<T>();
+    // Spread of one count around a mean near full scale.
+    default: return (T)(maximum<T>() - 1 - (rand() & 1));
+  }
+}
+
+static bool close(double value, double expected) {
+  return fabs(value - expected) <= 1e-5 * fabs(expected) + 1e-3;
+}
+
+/* Compare kernels and statistics of \a size samples against sums and a
+ * two-pass variance computed directly. */
+template <typename T>
+static void check_block(const T *data, uint32_t size, Pattern pattern) {
+  int64_t sum = 0;
+  uint64_t sum_squared = 0;
+  for (uint32_t i = 0; i < size; i++) {
+    sum += data[i];
+    sum_squared += (uint64_t)((int64_t)data[i] * data[i]);
+  }
+  const long double mean = (long double)sum / size;
+  long double deviations = 0;
+  for (uint32_t i = 0; i < size; i++) {
+    deviations += (data[i] - mean) * (data[i] - mean);
+  }
+  const double variance = deviations / size;
+
+  const rms::Sums sums = rms::sum_portable(data, size);
+  CHECK(sums.count == size);
+  CHECK(sums.sum == sum);
+  CHECK(sums.sum_squared == sum_squared);
+  const rms::Sums sums_dsp = rms::sum_dsp(data, size);
+  CHECK(sums_dsp.count == size);
+  CHECK(sums_dsp.sum == sum);
+  CHECK(sums_dsp.sum_squared == sum_squared);
+
+  if ((pattern == MINIMUM) || (pattern == MAXIMUM)) {
+    CHECK(rms::variance(sums) == 0);
+  } else if ((pattern == ALTERNATING) && !(size & 1)) {
+    const double half_range = (maximum<T>() - (double)minimum<T>()) / 2;
+    CHECK(rms::variance(sums) == half_range * half_range);
+  } else if (size <= (1 << 16)) {
+    // Computed exactly (only rounded once), even for `LARGE_MEAN`.
+    CHECK(fabs(rms::variance(sums) - variance) <= 1e-12 * variance);
+  } else {
+    CHECK(close(rms::variance(sums), variance));
+  }
+  CHECK(close(rms::mean(sums), mean));
+  CHECK(close(rms::mean_sub_rms(sums), sqrt(variance)));
+  CHECK(close(rms::sub_rms(sums, (double)mean), sqrt(variance)));
+  CHECK(close(rms::sub_rms(sums, 0), sqrt((double)sum_squared / size)));
+  CHECK(close(rms::sub_rms(sums, 1000),
+              sqrt(variance + (mean - 1000) * (mean - 1000))));
+  CHECK(rms::sub_rms(sums, 0) == rms::rms(sums));
+}
+
+/* Word-aligned and unaligned blocks of each size, up to above `2^16`
+ * samples (i.e., across the flush of the 32-bit running sum of
+ * `sum_portable`). */
+template <typename T>
+static void test_blocks() {
+  const uint32_t sizes[] = {1, 2, 3, 4, 5, 16, 17, 1023, 65535, 65536, 65537,
+                            70001};
+  std::vector<T> samples(70001 + 1);
+  for (int pattern = RANDOM; pattern <= LARGE_MEAN; pattern++) {
+    for (uint32_t i = 0; i < samples.size(); i++) {
+      samples[i] = sample<T>((Pattern)pattern, i);
+    }
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+      for (uint32_t offset = 0; offset < 2; offset++) {
+        check_block(samples.data() + offset, sizes[i], (Pattern)pattern);
+      }
+    }
+  }
+}
+
+static void test_smlald() {
+  // Both signed halfword products are added to the 64-bit accumulator.
+  CHECK(rms::smlald(0x80008000, 0x80008000, 0) == (1ULL << 31));
+  CHECK(rms::smlald(0x7FFF8000, 0x00010001, 0) == (uint64_t)-1);
+  CHECK(rms::smlald(0x00020003, 0x00040005, 0xFFFFFFFF) ==
+        0xFFFFFFFFULL + 2 * 4 + 3 * 5);
+  CHECK(rms::smlald(0xFFFF0001, 0x00010001, 5) == 5);
+}
+
+int main() {
+  srand(1);
+  test_smlald();
+  test_blocks<int16_t>();
+  test_blocks<uint16_t>();
+  return TEST_RESULT();
+}
@@ -0,0 +1,23 @@
+#ifndef ___UNIT_TEST__H___
+#define ___UNIT_TEST__H___
+
+#include <stdio.h>
+
+/* Minimal test helpers: each failed `CHECK` is reported (with its location)
+ * and counted, and `TEST_RESULT` is the process exit status. */
+static int unit_test_failures = 0;
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+              #condition); \
+      unit_test_failures++; \
+    } \
+  } while (0)
+
+#define TEST_RESULT() \
+  (fprintf(stderr, "%s: %d failure(s)\n", __FILE__, unit_test_failures), \
+   (unit_test_failures > 0))
+
+#endif  // #ifndef ___UNIT_TEST__H___
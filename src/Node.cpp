@@ -15,6 +15,13 @@ void Node::begin() {
   Serial.begin(115200);
 #endif  // #ifndef DISABLE_SERIAL
   adc_ = new ADC();
+  cycle_counter_.begin();
+  dma_memory_set_channel(DMA_MEMORY_CHANNEL);
+  // Compute stream chunk and bulk write CRCs with the CRC module.
+  teensy::crc::begin();
+  teensy::crc::set_dma_engine(&dma_memory_);
+  stream_chunker_.crc32_ = teensy::crc::crc32;
+  bulk_writer_.crc32_ = teensy::crc::crc32;
   if (config_._.i2c_address > 0) { Wire.setClock(400000); }
 }
 
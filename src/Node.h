@@ -24,7 +24,26 @@
 #include <TeensyMinimalRpc/DMA.h>  // Direct Memory Access
 #include <TeensyMinimalRpc/SIM.h>  // System integration module (clock gating)
 #include <TeensyMinimalRpc/PIT.h>  // Programmable interrupt timer
+#include <TeensyMinimalRpc/AdcSampler.h>  // On-device multi-channel ADC sampling
+#include <TeensyMinimalRpc/DualAdcSampler.h>  // Simultaneous ADC0/ADC1 sampling
+#include <TeensyMinimalRpc/TriggeredSampler.h>  // Triggered captures
 #include <TeensyMinimalRpc/aligned_alloc.h>
+#include <TeensyMinimalRpc/StreamChunker.h>
+#include <TeensyMinimalRpc/CycleCounter.h>
+#include <TeensyMinimalRpc/EventRing.h>
+#include <TeensyMinimalRpc/DmaIsrTable.h>
+#include <TeensyMinimalRpc/IsrProfiler.h>
+#include <TeensyMinimalRpc/RpcProfiler.h>
+#include <TeensyMinimalRpc/MemoryArena.h>
+#include <TeensyMinimalRpc/BulkWriter.h>
+#include <TeensyMinimalRpc/DmaMemory.h>  // DMA memory copy/fill engine
+#include <TeensyMinimalRpc/CRC.h>  // Cyclic redundancy check module
+#include <TeensyMinimalRpc/RegisterTransaction.h>  // Batched register writes
+#include <TeensyMinimalRpc/RootMeanSquare.hpp>
+#include <TeensyMinimalRpc/BlockStatistics.h>  // On-device block reduction
+#include <TeensyMinimalRpc/FirDecimator.h>  // On-device decimation
+#include <TeensyMinimalRpc/SamplePacker.h>  // Packed stream samples
+#include <TeensyMinimalRpc/RiceCodec.h>  // Lossless stream coding
 #include <pb_eeprom.h>
 #include <pb_validate.h>
 #include <pb_cpp_api.h>
@@ -35,23 +54,24 @@
 #include "TeensyMinimalRpc/state_pb.h"
 
 const uint32_t ADC_BUFFER_SIZE = 4096;
-
-extern void dma_ch0_isr(void);
-extern void dma_ch1_isr(void);
-extern void dma_ch2_isr(void);
-extern void dma_ch3_isr(void);
-extern void dma_ch4_isr(void);
-extern void dma_ch5_isr(void);
-extern void dma_ch6_isr(void);
-extern void dma_ch7_isr(void);
-extern void dma_ch8_isr(void);
-extern void dma_ch9_isr(void);
-extern void dma_ch10_isr(void);
-extern void dma_ch11_isr(void);
-extern void dma_ch12_isr(void);
-extern void dma_ch13_isr(void);
-extern void dma_ch14_isr(void);
-extern void dma_ch15_isr(void);
+/* Arena used by `mem_alloc`/`mem_aligned_alloc` (see `MemoryArena`): number
+ * of 32-byte slabs (e.g., DMA transfer control descriptors), and size of
+ * pool for larger buffers.  Requests that do not fit fall back to the heap.
+ * Override with build flags (e.g., `-DMEMORY_ARENA_POOL_SIZE=8192`). */
+#ifndef MEMORY_ARENA_SLAB_COUNT
+#define MEMORY_ARENA_SLAB_COUNT 32
+#endif
+#ifndef MEMORY_ARENA_POOL_SIZE
+#define MEMORY_ARENA_POOL_SIZE 4096
+#endif
+// Default DMA channel of `Node::dma_memory_` (see `dma_memory_set_channel`).
+const uint8_t DMA_MEMORY_CHANNEL = DMA_NUM_CHANNELS - 1;
+/* Smaller `mem_fill_...` requests are filled by the CPU, since configuring
+ * the DMA channel would take longer. */
+const uint32_t DMA_MEMORY_MIN_SIZE = 64;
+/* Maximum number of `STREAM` chunks sent back-to-back per main loop
+ * iteration (see `Node::stream_next_chunk`). */
+const uint8_t STREAM_CHUNKS_PER_LOOP = 4;
 
 namespace teensy_minimal_rpc {
 
@@ -67,6 +87,81 @@ const size_t FRAME_SIZE = (3 * sizeof(uint8_t)  // Frame boundary
                            - sizeof(uint16_t)  // Payload length
                            - sizeof(uint16_t));  // CRC
 
+/*
+ * DMA channel interrupt record, pushed to `Node::dma_events_` by
+ * `Node::on_dma_channel_done` and drained by `Node::loop`.
+ */
+struct DmaEvent {
+  uint64_t timestamp;  // Interrupt time (CPU cycles, see `CycleCounter`).
+  uint16_t citer;  // Raw `CITER` of channel TCD at interrupt time.
+  uint8_t channel;
+  /* `DMA_ES` error bits (`DBE` to `SAE`) if error flag of channel was set
+   * (i.e., `DMA_ERR`), otherwise 0. */
+  uint8_t errors;
+};
+
+const uint16_t DMA_EVENT_RING_SIZE = 16;
+
+/* DMA channel interrupt handlers, i.e., `DmaIsrTable<Node, ...>::vectors`
+ * (defined in sketch, where the `Node` instance is defined). */
+extern const isr_t * const dma_isr_vectors;
+
+/* Interrupt handlers timed by `Node::isr_profiler_`: one per DMA channel
+ * (indexed by channel number), followed by `adc0_isr` and `adc1_isr`. */
+const uint8_t ISR_PROFILE_ADC0 = DMA_NUM_CHANNELS;
+const uint8_t ISR_PROFILE_ADC1 = DMA_NUM_CHANNELS + 1;
+typedef IsrProfiler<DMA_NUM_CHANNELS + 2> isr_profiler_t;
+
+/* Number of `uint32_t` words written by `benchmark_rms`. */
+const uint8_t RMS_BENCHMARK_SIZE = 12;
+
+/*
+ * Time mean-subtracted RMS and RMS of \a size samples with the scalar
+ * `float` loops, the portable single-pass kernel, and (if available) the
+ * Cortex-M4 `SMLALD` single-pass kernel (see `rms::Sums`).
+ *
+ * Writes `[mean_sub_rms, cycles, rms, cycles]` for each variant to \a result
+ * (results as `float` bits).  The `SMLALD` results and cycles are 0 if the
+ * DSP instructions are not available.
+ */
+template <typename T>
+void benchmark_rms(const T *data, uint32_t size, uint32_t *result) {
+  float value;
+  uint32_t start;
+
+  memset(result, 0, RMS_BENCHMARK_SIZE * sizeof(uint32_t));
+
+  start = ARM_DWT_CYCCNT;
+  value = compute_sub_rms<T, uint32_t>(data, size,
+                                       compute_mean<T, uint32_t>(data, size));
+  result[1] = ARM_DWT_CYCCNT - start;
+  memcpy(&result[0], &value, sizeof(value));
+  start = ARM_DWT_CYCCNT;
+  value = compute_rms<T, uint32_t>(data, size);
+  result[3] = ARM_DWT_CYCCNT - start;
+  memcpy(&result[2], &value, sizeof(value));
+
+  start = ARM_DWT_CYCCNT;
+  value = rms::mean_sub_rms(rms::sum_portable(data, size));
+  result[5] = ARM_DWT_CYCCNT - start;
+  memcpy(&result[4], &value, sizeof(value));
+  start = ARM_DWT_CYCCNT;
+  value = rms::rms(rms::sum_portable(data, size));
+  result[7] = ARM_DWT_CYCCNT - start;
+  memcpy(&result[6], &value, sizeof(value));
+
+#if defined(__ARM_FEATURE_DSP)
+  start = ARM_DWT_CYCCNT;
+  value = rms::mean_sub_rms(rms::sum_dsp(data, size));
+  result[9] = ARM_DWT_CYCCNT - start;
+  memcpy(&result[8], &value, sizeof(value));
+  start = ARM_DWT_CYCCNT;
+  value = rms::rms(rms::sum_dsp(data, size));
+  result[11] = ARM_DWT_CYCCNT - start;
+  memcpy(&result[10], &value, sizeof(value));
+#endif  // #if defined(__ARM_FEATURE_DSP)
+}
+
 class Node;
 
 typedef nanopb::EepromMessage<teensy_minimal_rpc_Config,
@@ -102,13 +197,57 @@ public:
   uint32_t adc_millis_prev_;
   uint32_t adc_SYST_CVR_prev_;
   uint32_t adc_count_;
-  int8_t dma_channel_done_;
+  // DMA channel interrupts not yet handled by `loop`.
+  EventRing<DmaEvent, DMA_EVENT_RING_SIZE> dma_events_;
+  // Interrupt actions of each DMA channel (see `on_dma_channel_done`).
+  DmaIsrActions dma_isr_actions_[DMA_NUM_CHANNELS];
+  isr_profiler_t isr_profiler_;
+  RpcProfiler rpc_profiler_;
   int8_t last_dma_channel_done_;
+  uint8_t last_dma_errors_;
   bool adc_read_active_;
+  /* Device memory RPC allocations are served from `memory_arena_`; the heap
+   * allocations in these lists are only used once the arena is full. */
+  MemoryArena<MEMORY_ARENA_SLAB_COUNT, MEMORY_ARENA_POOL_SIZE> memory_arena_;
   LinkedList<uint32_t> allocations_;
   LinkedList<uint32_t> aligned_allocations_;
   UInt8Array dma_data_;
   uint16_t dma_stream_id_;
+  // Single acquisition waiting for the block being streamed to be sent.
+  UInt8Array dma_block_;
+  uint64_t dma_block_timestamp_;
+  // Continuous (ping-pong) acquisition state (see `start_dma_adc_continuous`).
+  bool dma_continuous_;
+  uint8_t dma_half_next_;
+  volatile uint8_t dma_halves_ready_;
+  volatile uint8_t dma_half_sending_;
+  volatile uint32_t dma_overrun_count_;
+  // Completion time of each half, in CPU cycles.
+  volatile uint64_t dma_block_timestamps_[2];
+  CycleCounter cycle_counter_;
+  uint32_t cycle_count_[2];  // See `cycle_count`.
+  // Chunked `STREAM` packet output (see `stream_next_chunk`).
+  StreamChunker stream_chunker_;
+  uint8_t stream_buffer_[STREAM_CHUNK_SIZE];
+  int32_t stream_credits_;  // Negative: flow control disabled.
+  uint16_t stream_id_;  // Identifier of block being streamed.
+  // Block being streamed is a half of the continuous acquisition buffer.
+  bool stream_dma_half_;
+  BulkWriter bulk_writer_;
+  teensy::dma::MemoryEngine dma_memory_;
+  teensy::adc::AdcSampler adc_sampler_;
+  teensy::adc::DualAdcSampler dual_adc_sampler_;
+  // Triggered capture state (see `triggered_sampler_start`).
+  teensy::adc::TriggeredSampler triggered_sampler_;
+  TriggeredCapture triggered_capture_;
+  volatile bool trigger_running_;
+  // Samples written to the circular buffer as of the last half interrupt.
+  volatile uint32_t trigger_written_;
+  // Applied to acquisition blocks before streaming, if enabled.
+  FirDecimator fir_decimator_;
+  BlockStatistics block_statistics_;
+  SamplePacker sample_packer_;
+  RiceEncoder rice_encoder_;
 
   Node()
     : BaseNode(),
@@ -119,12 +258,27 @@ public:
       adc_timestamp_us_(0),
       adc_tick_tock_(false),
       adc_count_(0),
-      dma_channel_done_(-1),
       last_dma_channel_done_(-1),
+      last_dma_errors_(0),
       adc_read_active_(false),
-      dma_stream_id_(0) {
+      dma_stream_id_(0),
+      dma_block_timestamp_(0),
+      dma_continuous_(false),
+      dma_half_next_(0),
+      dma_halves_ready_(0),
+      dma_half_sending_(0),
+      dma_overrun_count_(0),
+      trigger_running_(false),
+      trigger_written_(0),
+      stream_credits_(-1),
+      stream_id_(0),
+      stream_dma_half_(false) {
     pinMode(LED_BUILTIN, OUTPUT);
     dma_data_ = UInt8Array_init_default();
+    dma_block_ = UInt8Array_init_default();
+    dma_block_timestamps_[0] = 0;
+    dma_block_timestamps_[1] = 0;
+    memset(dma_isr_actions_, 0, sizeof(dma_isr_actions_));
   }
 
   void begin();
@@ -166,6 +320,7 @@ public:
     adc_->startSingleRead(channel, ADC_0);
   }
   void on_adc_done() {
+    isr_profiler_t::Scope profile(isr_profiler_, ISR_PROFILE_ADC0);
     if (adc_read_active_) return;
     adc_count_++;
     //adc_tick_tock_ = !adc_tick_tock_;
@@ -174,6 +329,18 @@ public:
     //adc_millis_ = millis();
     //adc_SYST_CVR_ = SYST_CVR;
   }
+  /** Called by `adc1_isr`, i.e., when a triggered capture hardware compare
+   * conversion completes (see #triggered_sampler_configure). */
+  void on_adc1_done() {
+    isr_profiler_t::Scope profile(isr_profiler_, ISR_PROFILE_ADC1);
+    if (!trigger_running_) {
+      (void)ADC1_RA;  // Clear conversion complete flag.
+      return;
+    }
+    if (triggered_sampler_.on_compare()) {
+      triggered_capture_.on_trigger(trigger_last_sample());
+    }
+  }
   /** Start ADC DMA transfers and copy the result as a stream packet to the
    * serial port when transfer has completed.
    *
@@ -190,24 +357,880 @@ public:
                      uint16_t stream_id) {
     dma_data_ = UInt8Array_init(size, reinterpret_cast<uint8_t*>(addr));
     dma_stream_id_ = stream_id;
+    fir_decimator_.reset();
     /*
      * Load configuration to Programmable Delay Block to start periodic ADC
      * reads.
      */
     PDB0_SC = pdb_config;
   }
+  /** Start continuous ADC DMA transfers into a two-half (i.e., ping-pong)
+   * sample buffer.
+   *
+   * The scatter DMA channel must raise an interrupt each time one half of the
+   * buffer has been filled (e.g., `INTMAJOR` on the last TCD of each half of
+   * a scatter/gather chain, or `INTHALF`/`INTMAJOR` on a single TCD).  The
+   * PDB timer is **not** stopped by the DMA interrupt handler, so sampling
+   * continues without gaps until #stop_dma_adc is called.  Each time a half
+   * is filled, it is copied to the serial port as a `STREAM` packet from
+   * #loop while the DMA engine fills the other half.
+   *
+   * \param pdb_config Programmable delay block status and control register
+   *                   configuration.
+   * \param addr Address of sample buffer.
+   * \param size Size of sample buffer in bytes (both halves).
+   * \param stream_id Identifier for stream packets.
+   *
+   * \return `false` if an acquisition is already running or if \a size does
+   *     not split into two halves of whole 16-bit samples.
+   *
+   * \see #dma_overrun_count
+   */
+  bool start_dma_adc_continuous(uint32_t pdb_config, uint32_t addr,
+                                uint32_t size, uint16_t stream_id) {
+    if (dma_continuous_ || (size == 0) || (size & 0x3)) { return false; }
+    dma_data_ = UInt8Array_init(size, reinterpret_cast<uint8_t*>(addr));
+    dma_stream_id_ = stream_id;
+    dma_half_next_ = 0;
+    dma_halves_ready_ = 0;
+    dma_half_sending_ = 0;
+    dma_continuous_ = true;
+    fir_decimator_.reset();
+    PDB0_SC = pdb_config;
+    return true;
+  }
+  /** Configure on-device multi-channel ADC sampler (ADC, PDB, DMA mux, and
+   * DMA transfer control descriptors) in a single call.
+   *
+   * \param channel_sc1as `ADCx_SC1A` channel configuration for each analog
+   *                      input channel.
+   * \param sample_count Number of samples to record for each channel.
+   * \param sample_rate_hz Sample rate (per channel).
+   * \param adc_number ADC to use.
+   * \param dma_channels Scatter, channel configs, and conversion DMA
+   *                     channels (empty to use channels 0, 1, and 2).
+   * \param continuous If `true`, configure samples array as ping-pong buffer
+   *                   for #adc_sampler_start continuous streaming.
+   *
+   * \return 0 on success, -1 on invalid arguments, -2 if sample rate is out
+   *     of range, -3 if memory allocation failed, or -4 if a continuous
+   *     acquisition is running.
+   */
+  int8_t adc_sampler_configure(UInt8Array channel_sc1as, uint16_t sample_count,
+                               uint32_t sample_rate_hz, uint8_t adc_number,
+                               UInt8Array dma_channels, bool continuous) {
+    if (dma_continuous_) { return -4; }
+    // Sampler writes TCD, mux, and ADC registers directly.
+    teensy::registers::invalidate_token();
+    const int8_t result = adc_sampler_.configure(channel_sc1as, sample_count,
+                                                 sample_rate_hz, adc_number,
+                                                 dma_channels, continuous);
+    if (result == 0) { attach_dma_interrupt(adc_sampler_.dma_scatter_); }
+    return result;
+  }
+  int8_t adc_sampler_set_sample_rate(uint32_t sample_rate_hz) {
+    if (dma_continuous_) { return -4; }
+    return adc_sampler_.set_sample_rate(sample_rate_hz);
+  }
+  /** Start reading using the sampler configured by #adc_sampler_configure.
+   *
+   * Samples are streamed to the serial port once the samples array is full
+   * or, in continuous mode, each time one half of the samples array is full
+   * (until #adc_sampler_stop is called).
+   *
+   * \return `false` if the sampler is not configured or if an acquisition is
+   *     already running.
+   */
+  bool adc_sampler_start(uint16_t stream_id) {
+    if (!adc_sampler_.configured()) { return false; }
+    const uint32_t addr = reinterpret_cast<uint32_t>(adc_sampler_.samples_
+                                                     .data);
+    if (adc_sampler_.continuous_) {
+      if (dma_continuous_) { return false; }
+      set_dma_isr_actions(adc_sampler_.dma_scatter_,
+                          DMA_ISR_PING_PONG | DMA_ISR_PUSH_EVENT, 0);
+      return start_dma_adc_continuous(adc_sampler_.pdb_start_config(), addr,
+                                      adc_sampler_.samples_size(), stream_id);
+    } else if (dma_continuous_) {
+      return false;
+    }
+    set_dma_isr_actions(adc_sampler_.dma_scatter_,
+                        DMA_ISR_STOP_PDB | DMA_ISR_PUSH_EVENT, 0);
+    start_dma_adc(adc_sampler_.pdb_start_config(), addr,
+                  adc_sampler_.samples_size(), stream_id);
+    return true;
+  }
+  /** Stop sampling and rewind DMA channels, so the next read starts at the
+   * beginning of the samples array. */
+  void adc_sampler_stop() {
+    stop_dma_adc();
+    adc_sampler_.rewind();
+  }
+  /** Address of sampler samples array, e.g., to read the most recent result
+   * with `mem_cpy_device_to_host`. */
+  uint32_t adc_sampler_samples_addr() const {
+    return reinterpret_cast<uint32_t>(adc_sampler_.samples_.data);
+  }
+  /** Number of channel arrays in each block of sampler samples array
+   * (including padding channels). */
+  uint16_t adc_sampler_scan_width() const {
+    return adc_sampler_.layout_.scan_width;
+  }
+  /** Distance (in samples) between sampler samples arrays of consecutive
+   * channels. */
+  uint16_t adc_sampler_channel_stride() const {
+    return adc_sampler_.layout_.channel_stride;
+  }
+  void adc_sampler_free() {
+    if (dma_continuous_) { stop_dma_adc(); }
+    adc_sampler_.deallocate();
+  }
+  /** Configure simultaneous sampling of channel pairs using ADC0 and ADC1
+   * (both triggered by the PDB at the same instant).
+   *
+   * Results are streamed interleaved, i.e., for each sample, `adc0[0],
+   * adc1[0], adc0[1], adc1[1], ...`.
+   *
+   * \param adc0_sc1as `ADC0_SC1A` channel configuration for each pair.
+   * \param adc1_sc1as `ADC1_SC1A` channel configuration for each pair.
+   * \param sample_count Number of samples to record for each channel.
+   * \param sample_rate_hz Sample rate (per channel pair).
+   * \param dma_channels ADC0 conversion, ADC1 conversion, ADC0 channel
+   *                     configs, and ADC1 channel configs DMA channels (empty
+   *                     to use channels 0, 1, 2, and 3).
+   * \param continuous If `true`, configure samples array as ping-pong buffer
+   *                   for continuous streaming.
+   *
+   * \return Same as #adc_sampler_configure.
+   */
+  int8_t dual_adc_sampler_configure(UInt8Array adc0_sc1as,
+                                    UInt8Array adc1_sc1as,
+                                    uint16_t sample_count,
+                                    uint32_t sample_rate_hz,
+                                    UInt8Array dma_channels,
+                                    bool continuous) {
+    if (dma_continuous_) { return -4; }
+    teensy::registers::invalidate_token();
+    const int8_t result = dual_adc_sampler_.configure(adc0_sc1as, adc1_sc1as,
+                                                      sample_count,
+                                                      sample_rate_hz,
+                                                      dma_channels,
+                                                      continuous);
+    if (result == 0) {
+      attach_dma_interrupt(dual_adc_sampler_.dma_conversion_[1]);
+    }
+    return result;
+  }
+  /** Start reading using the sampler configured by
+   * #dual_adc_sampler_configure (see #adc_sampler_start). */
+  bool dual_adc_sampler_start(uint16_t stream_id) {
+    if (!dual_adc_sampler_.configured()) { return false; }
+    const uint32_t addr =
+      reinterpret_cast<uint32_t>(dual_adc_sampler_.samples_.data);
+    const uint8_t dma_channel = dual_adc_sampler_.dma_conversion_[1];
+    if (dual_adc_sampler_.continuous_) {
+      if (dma_continuous_) { return false; }
+      set_dma_isr_actions(dma_channel, DMA_ISR_PING_PONG | DMA_ISR_PUSH_EVENT,
+                          0);
+      return start_dma_adc_continuous(dual_adc_sampler_.pdb_start_config(),
+                                      addr, dual_adc_sampler_.samples_size(),
+                                      stream_id);
+    } else if (dma_continuous_) {
+      return false;
+    }
+    set_dma_isr_actions(dma_channel, DMA_ISR_STOP_PDB | DMA_ISR_PUSH_EVENT, 0);
+    start_dma_adc(dual_adc_sampler_.pdb_start_config(), addr,
+                  dual_adc_sampler_.samples_size(), stream_id);
+    return true;
+  }
+  void dual_adc_sampler_stop() {
+    stop_dma_adc();
+    dual_adc_sampler_.rewind();
+  }
+  uint32_t dual_adc_sampler_samples_addr() const {
+    return reinterpret_cast<uint32_t>(dual_adc_sampler_.samples_.data);
+  }
+  void dual_adc_sampler_free() {
+    if (dma_continuous_) { stop_dma_adc(); }
+    dual_adc_sampler_.deallocate();
+  }
+  /** Configure sampling of one ADC0 channel continuously into a circular
+   * buffer for triggered captures (see `teensy::adc::TriggeredSampler` and
+   * #trigger_configure).
+   *
+   * \param capture_sc1a `ADC0_SC1A` configuration of captured channel.
+   * \param compare_sc1a `ADC1_SC1A` configuration of channel watched by the
+   *                     ADC1 hardware compare (e.g., the same pin), or
+   *                     `0xFF` to scan captured samples for the trigger in
+   *                     software instead.
+   * \param ring_sample_count Size of circular buffer (in samples); must be a
+   *                          power of two, at most 16384.
+   * \param sample_rate_hz Sample rate.
+   * \param dma_channel Conversion DMA channel.
+   *
+   * \return Same as #adc_sampler_configure, or -4 if a triggered capture is
+   *     running or its window is still being streamed.
+   */
+  int8_t triggered_sampler_configure(uint8_t capture_sc1a,
+                                     uint8_t compare_sc1a,
+                                     uint16_t ring_sample_count,
+                                     uint32_t sample_rate_hz,
+                                     uint8_t dma_channel) {
+    if (dma_continuous_ || trigger_running_ ||
+        triggered_capture_.window_busy_) {
+      return -4;
+    }
+    teensy::registers::invalidate_token();
+    // Window layout depends on the circular buffer (see #trigger_configure).
+    triggered_capture_.deallocate();
+    const int8_t result = triggered_sampler_.configure(capture_sc1a,
+                                                       compare_sc1a,
+                                                       ring_sample_count,
+                                                       sample_rate_hz,
+                                                       dma_channel);
+    if (result == 0) { attach_dma_interrupt(dma_channel); }
+    return result;
+  }
+  /** Configure trigger condition and capture window of triggered captures
+   * (see #triggered_sampler_configure).
+   *
+   * \param mode Trigger condition (see `teensy_minimal_rpc::TriggerMode`):
+   *             0: level above, 1: level below, 2: rising edge, 3: falling
+   *             edge.
+   * \param level Trigger level (ADC counts).
+   * \param hysteresis Edge modes: distance from \a level the signal must
+   *                   first reach on the other side.
+   * \param pre_count Samples preceding the trigger sample in each window.
+   * \param post_count Samples from the trigger sample on in each window.
+   * \param holdoff Samples from a trigger until the next one is accepted
+   *                (at least \a post_count).
+   * \param auto_rearm If `false`, stop after the first window.
+   *
+   * \return 0 on success, -1 on invalid arguments (e.g., sampler not
+   *     configured, or window larger than half of the circular buffer), -3
+   *     if memory allocation failed, or -4 if a triggered capture is running
+   *     or its window is still being streamed.
+   */
+  int8_t trigger_configure(uint8_t mode, uint16_t level, uint16_t hysteresis,
+                           uint16_t pre_count, uint16_t post_count,
+                           uint32_t holdoff, bool auto_rearm) {
+    if (trigger_running_ || triggered_capture_.window_busy_) { return -4; }
+    if (!triggered_sampler_.configured()) { return -1; }
+    const int8_t result =
+      triggered_capture_.configure(mode, level, hysteresis, pre_count,
+                                   post_count, holdoff, auto_rearm,
+                                   triggered_sampler_.hardware_compare(),
+                                   triggered_sampler_.ring_.length);
+    if (result == 0) {
+      triggered_sampler_.set_compare(mode, level, hysteresis);
+    }
+    return result;
+  }
+  /** Start triggered captures configured by #triggered_sampler_configure and
+   * #trigger_configure.
+   *
+   * Each captured window is streamed (unprocessed, see #process_block) as a
+   * block with identifier \a stream_id: a `TriggerCaptureHeader` followed by
+   * the `pre_count + post_count` samples of the window.  Triggers completing
+   * while the previous window is still being streamed are dropped (see
+   * #trigger_stats).
+   *
+   * \return `true` if started, or `false` if not configured, if a
+   *     continuous acquisition or triggered capture is already running, or
+   *     if the previous window is still being streamed.
+   */
+  bool triggered_sampler_start(uint16_t stream_id) {
+    if (!triggered_capture_.configured() || dma_continuous_ ||
+        trigger_running_ || triggered_capture_.window_busy_) {
+      return false;
+    }
+    triggered_sampler_.rewind();
+    set_dma_isr_actions(triggered_sampler_.dma_channel_, DMA_ISR_TRIGGER, 0);
+    dma_stream_id_ = stream_id;
+    trigger_written_ = 0;
+    triggered_capture_.start(triggered_sampler_.ring_.data);
+    trigger_running_ = true;
+    // Start the PDB timer, i.e., continuous sampling.
+    PDB0_SC = triggered_sampler_.pdb_start_config();
+    return true;
+  }
+  void triggered_sampler_stop() {
+    stop_dma_adc();
+    triggered_sampler_.rewind();
+  }
+  /** Stop triggered captures and free their buffers, cancelling the stream
+   * of a captured window (if any). */
+  void triggered_sampler_free() {
+    stop_dma_adc();
+    if (stream_chunker_.pending_in(triggered_capture_.window_.data,
+                                   triggered_capture_.window_.length)) {
+      stream_chunker_.cancel();
+    }
+    triggered_capture_.deallocate();
+    triggered_sampler_.deallocate();
+  }
+  /** \return Triggered capture counters: `[captured window count, missed
+   *     trigger count, running]` (see #triggered_sampler_start). */
+  UInt32Array trigger_stats() {
+    UInt32Array result = UInt32Array_init(3, (uint32_t *)get_buffer().data);
+    noInterrupts();
+    result.data[0] = triggered_capture_.capture_count_;
+    result.data[1] = triggered_capture_.missed_count_;
+    result.data[2] = trigger_running_;
+    interrupts();
+    return result;
+  }
+  /** Low-pass filter and decimate each acquisition block (see
+   * #start_dma_adc and #start_dma_adc_continuous) on the device, and stream
+   * the decimated samples of each channel (channel-major, i.e., `sample_count
+   * / factor` samples per channel) instead of the raw block.
+   *
+   * Filter history is kept between consecutive blocks of a continuous
+   * acquisition, and cleared when an acquisition is started.
+   *
+   * \param coefficients Q15 filter coefficients (`int16_t` bits), at most
+   *     `FIR_DECIMATOR_MAX_TAPS`.
+   * \param factor Decimation factor (2 to 64); must divide \a sample_count.
+   * \param channel_count Number of channels in each block.
+   * \param sample_count Number of samples per channel in each block.
+   * \param channel_stride Distance (in samples) between the first samples
+   *     of consecutive channels.
+   * \param sample_stride Distance (in samples) between consecutive samples
+   *     of a channel.
+   *
+   * \return 0 on success, -1 on invalid arguments (including a channel or
+   *     sample count other than that of enabled block statistics or Rice
+   *     coding), -3 if memory allocation failed, or -4 if a continuous
+   *     acquisition is running or decimated samples are being streamed.
+   *
+   * \see #fir_decimate
+   */
+  int8_t fir_decimator_configure(UInt16Array coefficients, uint8_t factor,
+                                 uint16_t channel_count,
+                                 uint16_t sample_count,
+                                 uint16_t channel_stride,
+                                 uint16_t sample_stride) {
+    if (dma_continuous_ || fir_output_streaming()) { return -4; }
+    // Later stages must be configured for the same acquisition blocks.
+    if ((block_statistics_.enabled() &&
+         ((block_statistics_.layout_.channel_count != channel_count) ||
+          (block_statistics_.layout_.sample_count != sample_count))) ||
+        (rice_encoder_.enabled() &&
+         ((rice_encoder_.layout_.channel_count != channel_count) ||
+          (rice_encoder_.layout_.sample_count != sample_count)))) {
+      return -1;
+    }
+    const BlockLayout layout = {channel_count, sample_count, channel_stride,
+                                sample_stride};
+    return fir_decimator_.configure(coefficients, factor, layout);
+  }
+  /** Stream raw acquisition blocks again, and release filter buffers. */
+  void fir_decimator_free() {
+    if (dma_continuous_) { stop_dma_adc(); }
+    // Host discards the incomplete block.
+    if (fir_output_streaming()) { stream_chunker_.cancel(); }
+    fir_decimator_.deallocate();
+  }
+  /** Clear filter history (see #fir_decimator_configure). */
+  void fir_decimator_reset() { fir_decimator_.reset(); }
+  /** Filter and decimate \a size bytes of samples starting at \a address
+   * (laid out as configured by #fir_decimator_configure), continuing from
+   * the current filter history.
+   *
+   * \return Decimated samples, or empty array if the decimator is not
+   *     configured, the block is too small, a continuous acquisition is
+   *     running, or decimated samples are being streamed.
+   */
+  UInt16Array fir_decimate(uint32_t address, uint32_t size) {
+    /* Filter history and output buffer are those of the acquisition
+     * blocks. */
+    if (dma_continuous_ || fir_output_streaming()) {
+      return UInt16Array_init_default();
+    }
+    const UInt8Array output =
+      fir_decimator_.process(UInt8Array_init(size, (uint8_t *)address));
+    return UInt16Array_init(output.length / sizeof(uint16_t),
+                            (uint16_t *)output.data);
+  }
+  /** \return `true` if the FIR decimator output is being streamed, i.e.,
+   * it must not be freed or overwritten yet. */
+  bool fir_output_streaming() const {
+    return stream_chunker_.pending_in(fir_decimator_.output_.data,
+                                      fir_decimator_.output_.length *
+                                      sizeof(uint16_t));
+  }
+  /** Stream acquisition blocks (see #start_dma_adc and
+   * #start_dma_adc_continuous) with \a bits bits per sample, packed into a
+   * little-endian bit stream (see `SamplePacker`), instead of 16 bits per
+   * sample.
+   *
+   * Samples must be right-justified and fit in \a bits bits (e.g., ADC
+   * results at \a bits or lower resolution).  Packing is applied after the
+   * FIR decimator (if enabled), and not at all while block statistics or
+   * Rice coding (see #rice_coding_configure) are enabled.
+   *
+   * \param bits Bits per sample: 8, 10, 12, or 16 (i.e., disable packing).
+   * \param block_size Size (in bytes) of the largest block to pack.
+   *
+   * \return 0 on success, -1 on invalid arguments, -3 if memory allocation
+   *     failed, or -4 if a continuous acquisition is running or packed
+   *     samples are being streamed.
+   */
+  int8_t stream_packing_configure(uint8_t bits, uint32_t block_size) {
+    if (dma_continuous_ ||
+        stream_chunker_.pending_in(sample_packer_.buffer_.data,
+                                   sample_packer_.buffer_.length)) {
+      return -4;
+    }
+    return sample_packer_.configure(bits, block_size);
+  }
+  /** Stream acquisition blocks (see #start_dma_adc and
+   * #start_dma_adc_continuous) losslessly compressed with per-channel delta
+   * prediction and partitioned Golomb-Rice coding (see `RiceEncoder` and
+   * `RiceBlockHeader`), falling back to raw (channel-major) samples for
+   * blocks that do not compress.
+   *
+   * Sample `i` of channel `c` is read from sample `c * channel_stride + i *
+   * sample_stride` of each block (see #block_statistics_configure).  Coding
+   * is applied after the FIR decimator (if enabled, to its output; see
+   * #block_statistics_configure), and not at all while block statistics are
+   * enabled.  While enabled, sample packing (see #stream_packing_configure)
+   * is not applied.
+   *
+   * \param partition_size Number of residuals coded with the same Rice
+   *     parameter (at most `RICE_MAX_PARTITION_SIZE`).
+   *
+   * \return 0 on success, -1 on invalid arguments (including a layout the
+   *     FIR decimator is not configured for), -3 if memory allocation
+   *     failed, or -4 if a continuous acquisition is running or a coded
+   *     block is being streamed.
+   *
+   * \see #rice_benchmark
+   */
+  int8_t rice_coding_configure(uint16_t channel_count, uint16_t sample_count,
+                               uint16_t channel_stride,
+                               uint16_t sample_stride,
+                               uint16_t partition_size) {
+    if (dma_continuous_ || rice_output_streaming()) { return -4; }
+    if (!fir_layout_matches(channel_count, sample_count)) { return -1; }
+    const BlockLayout layout = {channel_count, sample_count, channel_stride,
+                                sample_stride};
+    return rice_encoder_.configure(layout, partition_size);
+  }
+  /** Stop coding acquisition blocks, and release coding buffer. */
+  void rice_coding_free() {
+    if (dma_continuous_) { stop_dma_adc(); }
+    // Host discards the incomplete block.
+    if (rice_output_streaming()) { stream_chunker_.cancel(); }
+    rice_encoder_.deallocate();
+  }
+  /** Code \a size bytes of samples starting at \a address (laid out as
+   * configured by #rice_coding_configure), and time it, e.g., to check the
+   * encoder keeps up with a sampling rate.
+   *
+   * The coded block stays in the coding buffer (e.g., to be read with
+   * #mem_stream_device_to_host) until the next block is coded.
+   *
+   * \return Raw sample size (in bytes), coded block size (in bytes,
+   *     including `RiceBlockHeader`; 0 if coding is not configured or the
+   *     block is too small), CPU cycles taken, and coded block address, or
+   *     empty array if a continuous acquisition is running or a coded
+   *     block is being streamed.
+   */
+  UInt32Array rice_benchmark(uint32_t address, uint32_t size) {
+    UInt32Array result = UInt32Array_init(4, (uint32_t *)get_buffer().data);
+    // Coding buffer holds the block being streamed.
+    if (dma_continuous_ || rice_output_streaming()) {
+      result.length = 0;
+      return result;
+    }
+    const uint32_t start = ARM_DWT_CYCCNT;
+    const UInt8Array output =
+      rice_encoder_.encode(UInt8Array_init(size, (uint8_t *)address));
+    result.data[2] = ARM_DWT_CYCCNT - start;
+    result.data[0] = rice_encoder_.raw_size();
+    result.data[1] = output.length;
+    result.data[3] = (uint32_t)output.data;
+    return result;
+  }
+  /** \return `true` if a coded block is being streamed from the coding
+   * buffer, i.e., it must not be freed or overwritten yet. */
+  bool rice_output_streaming() const {
+    return stream_chunker_.pending_in(rice_encoder_.buffer_.data,
+                                      rice_encoder_.buffer_.length);
+  }
+  /** Reduce each acquisition block (see #start_dma_adc and
+   * #start_dma_adc_continuous) to per-channel statistics (mean, variance,
+   * RMS, min, max, and peak-to-peak) on the device, and stream the
+   * statistics record (see `BlockStatisticsHeader`) instead of the raw
+   * samples.
+   *
+   * Sample `i` of channel `c` is read from sample `c * channel_stride + i *
+   * sample_stride` of each block.  If the FIR decimator is enabled (see
+   * #fir_decimator_configure), \a channel_count and \a sample_count must be
+   * those of the decimator, and statistics are computed from its output
+   * instead, i.e., `sample_count / factor` samples per channel,
+   * channel-major (see #fir_layout_matches).
+   *
+   * \return 0 on success, -1 on invalid layout (e.g., more than
+   *     `BLOCK_STATISTICS_MAX_CHANNELS` channels), or -4 if a continuous
+   *     acquisition is running or a statistics record is being streamed.
+   *
+   * \see #adc_sampler_statistics_configure,
+   *     #dual_adc_sampler_statistics_configure
+   */
+  int8_t block_statistics_configure(uint16_t channel_count,
+                                    uint16_t sample_count,
+                                    uint16_t channel_stride,
+                                    uint16_t sample_stride) {
+    if (dma_continuous_ ||
+        stream_chunker_.pending_in(block_statistics_.record_,
+                                   sizeof(block_statistics_.record_))) {
+      return -4;
+    }
+    if (!fir_layout_matches(channel_count, sample_count)) { return -1; }
+    const BlockLayout layout = {channel_count, sample_count, channel_stride,
+                                sample_stride};
+    return block_statistics_.configure(layout);
+  }
+  /** Stream raw acquisition blocks again. */
+  void block_statistics_disable() { block_statistics_.disable(); }
+  /** Configure block statistics (see #block_statistics_configure) for the
+   * layout of the sampler configured by #adc_sampler_configure.
+   *
+   * \return 0 on success, -1 if the sampler is not configured or has too
+   *     many channels, or -4 (see #block_statistics_configure).
+   */
+  int8_t adc_sampler_statistics_configure() {
+    if (!adc_sampler_.configured()) { return -1; }
+    return block_statistics_configure(adc_sampler_.channel_sc1as_.length,
+                                      adc_sampler_.block_sample_count(),
+                                      adc_sampler_.layout_.channel_stride, 1);
+  }
+  /** Configure block statistics (see #block_statistics_configure) for the
+   * interleaved layout of the sampler configured by
+   * #dual_adc_sampler_configure, i.e., ADC0 and ADC1 channels of each pair
+   * as consecutive channels.
+   *
+   * \return Same as #adc_sampler_statistics_configure.
+   */
+  int8_t dual_adc_sampler_statistics_configure() {
+    if (!dual_adc_sampler_.configured()) { return -1; }
+    const uint16_t channel_count = 2 * dual_adc_sampler_.channel_count_;
+    const uint16_t sample_count = (dual_adc_sampler_.continuous_
+                                   ? dual_adc_sampler_.sample_count_ / 2
+                                   : dual_adc_sampler_.sample_count_);
+    return block_statistics_configure(channel_count, sample_count, 1,
+                                      channel_count);
+  }
+  /** Stop ADC DMA transfers started by #start_dma_adc or
+   * #start_dma_adc_continuous.
+   *
+   * Any half of a continuous acquisition buffer that has not been streamed
+   * yet is discarded.
+   */
+  void stop_dma_adc() {
+    PDB0_SC = 0;  // Stop PDB timer.
+    dma_continuous_ = false;
+    dma_halves_ready_ = 0;
+    if (trigger_running_) {
+      trigger_running_ = false;
+      triggered_capture_.stop();
+      triggered_sampler_.disarm_compare();
+    }
+  }
+  /** Called by the DMA interrupt handler of each channel with an attached
+   * interrupt (see #attach_dma_interrupt), with the actions set by
+   * #set_dma_isr_actions:
+   *
+   *  - `DMA_ISR_STOP_PDB`: stop the PDB timer (e.g., end of single-block
+   *    capture started by #start_dma_adc).
+   *  - `DMA_ISR_CHAIN`: enable DMA requests of the chained channel (e.g., to
+   *    arm the next capture).
+   *  - `DMA_ISR_PING_PONG`: if a continuous acquisition is running (see
+   *    #start_dma_adc_continuous), mark the half that was just filled as
+   *    ready to stream.
+   *  - `DMA_ISR_PUSH_EVENT`: push a #DmaEvent record to be handled by #loop.
+   *    If the event ring is full, the record is dropped (see
+   *    #dma_event_drop_count).
+   *  - `DMA_ISR_MEMORY`: start the next pass of the DMA memory transfer (see
+   *    #mem_cpy_dma); the other actions are only taken once the transfer is
+   *    complete, and only if completion must be reported (i.e., transfers
+   *    started without waiting).
+   *  - `DMA_ISR_TRIGGER`: if a triggered capture is running (see
+   *    #triggered_sampler_start), advance it by the half of the circular
+   *    buffer that was just filled (see #on_trigger_half_done).
+   */
+  void on_dma_channel_done(uint8_t dma_channel) {
+    isr_profiler_t::Scope profile(isr_profiler_, dma_channel);
+    const DmaIsrActions &actions = dma_isr_actions_[dma_channel];
+    if ((actions.flags & DMA_ISR_MEMORY) &&
+        (!dma_memory_.on_major_loop_done() || !dma_memory_.notify_)) {
+      return;
+    }
+    DmaEvent event;
+    event.timestamp = cycle_counter_.read();
+    if (actions.flags & DMA_ISR_STOP_PDB) { PDB0_SC = 0; }
+    if (actions.flags & DMA_ISR_CHAIN) { DMA_SERQ = actions.chain_channel; }
+    if ((actions.flags & DMA_ISR_PING_PONG) && dma_continuous_) {
+      const uint8_t half = dma_half_next_;
+      const uint8_t other = 1 << (half ^ 1);
+      dma_half_next_ ^= 1;
+      /* The DMA engine is now filling the other half of the buffer.  If the
+       * other half is still waiting to be streamed (or is being streamed
+       * right now), its samples are lost. */
+      if ((dma_halves_ready_ | dma_half_sending_) & other) {
+        dma_halves_ready_ &= ~other;
+        dma_half_sending_ &= ~other;
+        dma_overrun_count_ += dma_data_.length / (2 * sizeof(uint16_t));
+      }
+      dma_halves_ready_ |= 1 << half;
+      dma_block_timestamps_[half] = event.timestamp;
+    }
+    if ((actions.flags & DMA_ISR_TRIGGER) && trigger_running_) {
+      on_trigger_half_done(event.timestamp);
+    }
+    if (actions.flags & DMA_ISR_PUSH_EVENT) {
+      event.citer = teensy::dma::TCD(dma_channel).CITER;
+      event.channel = dma_channel;
+      event.errors = (DMA_ERR & (1 << dma_channel)) ? (DMA_ES & 0xFF) : 0;
+      dma_events_.push(event);
+    }
+  }
   /** Called periodically from the main program loop. */
   void loop() {
-    if (dma_channel_done_ >= 0) {
-      // DMA channel has completed.
-      last_dma_channel_done_ = dma_channel_done_;
-      dma_channel_done_ = -1;
-
-      // Copy DMA ADC data to serial port as a `STREAM` packet.
-      if (dma_data_.length > 0) {
-        serial_handler_.receiver_.write_f_(dma_data_,
-                                           Packet::packet_type::STREAM,
-                                           dma_stream_id_);
+    // Keep track of cycle counter wraps.
+    cycle_counter_.read();
+    rpc_profiler_.record_loop();
+    /* Handle all DMA channel interrupts recorded since last iteration (at
+     * most one ring's worth, so commands are still processed if interrupts
+     * keep firing). */
+    DmaEvent event;
+    for (uint16_t i = 0; (i < dma_events_.capacity() &&
+                          dma_events_.pop(event)); i++) {
+      last_dma_channel_done_ = event.channel;
+      last_dma_errors_ |= event.errors;
+
+      // Queue DMA ADC data to be streamed to the serial port.
+      if ((event.channel != dma_memory_.channel_) && !dma_continuous_ &&
+          dma_data_.length > 0) {
+        /* Held until the block being streamed (if any) has been sent.  A
+         * held block that has not been streamed yet is replaced, so its
+         * samples are dropped. */
+        if (dma_block_.length > 0) {
+          dma_overrun_count_ += dma_block_.length / sizeof(uint16_t);
+        }
+        dma_block_ = dma_data_;
+        dma_block_timestamp_ = event.timestamp;
+      }
+    }
+    if (dma_continuous_) { queue_dma_half(); }
+    if (!stream_chunker_.pending()) { queue_dma_block(); }
+    if (!stream_chunker_.pending()) { queue_trigger_window(); }
+    stream_next_chunk();
+  }
+  /** Queue the oldest filled half of the continuous acquisition buffer (if
+   * any) to be streamed once the previous half has been sent. */
+  void queue_dma_half() {
+    if (stream_chunker_.pending()) {
+      /* If the half being streamed has been overwritten by the DMA engine
+       * (see #on_dma_channel_done), drop the rest of it.  Processed blocks
+       * (see #process_block) are not part of the buffer, so they are always
+       * sent in full. */
+      if (stream_dma_half_ && !dma_half_sending_) {
+        stream_chunker_.cancel();
+      } else { return; }
+    }
+    noInterrupts();
+    const uint8_t ready = dma_halves_ready_;
+    // If both halves are ready, the older half is the next one to be filled.
+    const uint8_t half = ((ready == 0x03) ? dma_half_next_
+                          : ((ready & 0x01) ? 0 : 1));
+    dma_half_sending_ = ready ? (1 << half) : 0;
+    dma_halves_ready_ &= ~dma_half_sending_;
+    interrupts();
+    if (!ready) { return; }
+
+    const uint32_t half_size = dma_data_.length / 2;
+    UInt8Array block = UInt8Array_init(half_size,
+                                       dma_data_.data + half * half_size);
+    if (processing_enabled()) {
+      block = process_block(block, dma_block_timestamps_[half]);
+      noInterrupts();
+      // Half was overwritten by the DMA engine while it was being processed.
+      const bool overrun = !dma_half_sending_;
+      dma_half_sending_ = 0;
+      interrupts();
+      if (overrun || (block.length == 0)) { return; }
+      start_stream(block, dma_stream_id_, dma_block_timestamps_[half]);
+      return;
+    }
+    start_stream(block, dma_stream_id_, dma_block_timestamps_[half]);
+    stream_dma_half_ = true;
+  }
+  /** Called by #on_dma_channel_done each time one half of the triggered
+   * capture circular buffer has been filled (see #triggered_sampler_start),
+   * with \a timestamp the time the last sample was written. */
+  void on_trigger_half_done(uint64_t timestamp) {
+    trigger_written_ += triggered_sampler_.half_sample_count();
+    const uint8_t events =
+      triggered_capture_.on_samples_written(trigger_written_, timestamp);
+    if (events & TRIGGER_CAPTURE_DONE) {
+      PDB0_SC = 0;  // Stop PDB timer.
+      trigger_running_ = false;
+    } else if (events & TRIGGER_CAPTURE_REARM) {
+      triggered_sampler_.arm_compare();
+    }
+  }
+  /** \return Index (since #triggered_sampler_start) of the last sample
+   * written to the triggered capture circular buffer, i.e., the sample
+   * converted at the same instant as the hardware compare that fired.
+   *
+   * __N.B.,__ Must be called with DMA interrupts masked (e.g., from
+   * `adc1_isr`, which has the same priority), so #trigger_written_ is not
+   * advanced concurrently.
+   */
+  uint32_t trigger_last_sample() const {
+    const uint32_t written = trigger_written_;
+    const uint32_t mask = triggered_sampler_.ring_.length - 1;
+    return written + ((triggered_sampler_.position() - written) & mask) - 1;
+  }
+  /** Start streaming the window frozen by the triggered capture (if any). */
+  void queue_trigger_window() {
+    UInt8Array window = triggered_capture_.take_window();
+    if (window.length == 0) { return; }
+    TriggerCaptureHeader header;
+    memcpy(&header, window.data, sizeof(header));
+    start_stream(window, dma_stream_id_, header.timestamp);
+  }
+  /** Start streaming the single acquisition block held by #loop (if any),
+   * or the result of #process_block if enabled. */
+  void queue_dma_block() {
+    UInt8Array block = dma_block_;
+    if (block.length == 0) { return; }
+    dma_block_ = UInt8Array_init_default();
+    if (processing_enabled()) {
+      block = process_block(block, dma_block_timestamp_);
+      if (block.length == 0) { return; }
+    }
+    start_stream(block, dma_stream_id_, dma_block_timestamp_);
+  }
+  bool processing_enabled() const {
+    return (fir_decimator_.enabled() || block_statistics_.enabled() ||
+            rice_encoder_.enabled() || sample_packer_.enabled());
+  }
+  /** \return `true` if stages after the FIR decimator (see #process_block)
+   * may be configured for blocks of \a channel_count channels of \a
+   * sample_count samples, i.e., the decimator is disabled or configured for
+   * the same blocks.
+   *
+   * The layout of the decimator output (rather than the configured layout)
+   * is then passed to these stages. */
+  bool fir_layout_matches(uint16_t channel_count,
+                          uint16_t sample_count) const {
+    return (!fir_decimator_.enabled() ||
+            ((fir_decimator_.layout_.channel_count == channel_count) &&
+             (fir_decimator_.layout_.sample_count == sample_count)));
+  }
+  /** Apply the FIR decimator (see #fir_decimator_configure), then one of
+   * block statistics (see #block_statistics_configure), Rice coding (see
+   * #rice_coding_configure), or sample packing (see
+   * #stream_packing_configure), if enabled, to acquisition \a block.
+   *
+   * Stages after the decimator read its (channel-major) output, i.e.,
+   * `sample_count / factor` samples per channel, rather than their
+   * configured layout (see #fir_layout_matches).
+   *
+   * \return Processed block (in a buffer owned by the last stage), or an
+   *     empty array if the block is too small for a configured layout.
+   */
+  UInt8Array process_block(UInt8Array block, uint64_t timestamp) {
+    if (fir_decimator_.enabled()) {
+      block = fir_decimator_.process(block);
+      if (block.length == 0) { return block; }
+      const BlockLayout layout = fir_decimator_.output_layout();
+      if (block_statistics_.enabled()) {
+        return block_statistics_.reduce(block, timestamp, layout);
+      } else if (rice_encoder_.enabled()) {
+        return rice_encoder_.encode(block, layout);
+      }
+    } else if (block_statistics_.enabled()) {
+      return block_statistics_.reduce(block, timestamp);
+    } else if (rice_encoder_.enabled()) {
+      return rice_encoder_.encode(block);
+    }
+    if (sample_packer_.enabled()) { block = sample_packer_.process(block); }
+    return block;
+  }
+  /** Start streaming \a block as chunked `STREAM` packets with identifier
+   * \a stream_id (see #stream_next_chunk). */
+  void start_stream(UInt8Array block, uint16_t stream_id,
+                    uint64_t timestamp) {
+    stream_id_ = stream_id;
+    stream_dma_half_ = false;
+    stream_chunker_.start(block, timestamp);
+  }
+  /** Stream \a size bytes of device memory starting at \a address to the
+   * host as chunked `STREAM` packets with identifier \a stream_id.
+   *
+   * Chunks are sent back-to-back from #loop without further requests from
+   * the host.  Each chunk header holds the chunk offset within the range and
+   * the CRC-32 of the chunk payload (see `StreamChunkHeader`).
+   *
+   * \return 0 on success, or -1 if another block is being streamed or a
+   *     continuous acquisition is running.
+   *
+   * \see #mem_cpy_device_to_host
+   */
+  int8_t mem_stream_device_to_host(uint32_t address, uint32_t size,
+                                   uint16_t stream_id) {
+    if (stream_chunker_.pending() || dma_continuous_) { return -1; }
+    start_stream(UInt8Array_init(size, (uint8_t *)address), stream_id,
+                 cycle_counter_.read());
+    return 0;
+  }
+  /** Send the next chunk(s) of the block being streamed (if any) to the
+   * serial port as `STREAM` packets.
+   *
+   * Each chunk holds at most `STREAM_CHUNK_SIZE` bytes, starting with a
+   * `StreamChunkHeader` (sequence number, block offset, block size,
+   * timestamp, and payload CRC).  Up to `STREAM_CHUNKS_PER_LOOP` chunks are
+   * sent back-to-back per call, so the USB serial transmit buffers stay full
+   * while the main loop still processes commands between calls while a large
+   * block is being streamed.
+   *
+   * If flow control is enabled (see #grant_stream_credits), each chunk uses
+   * up one credit and no chunk is sent while no credits are left.
+   */
+  void stream_next_chunk() {
+    /* __N.B.,__ `Serial.availableForWrite()` reports at most one USB packet
+     * (64 bytes) free, i.e., never a whole chunk, so it cannot be used to
+     * pace chunks. */
+    for (uint8_t i = 0; i < STREAM_CHUNKS_PER_LOOP; i++) {
+      if (!stream_chunker_.pending() || (stream_credits_ == 0)) { return; }
+      /* The DMA engine started overwriting the half being streamed (see
+       * #on_dma_channel_done), so do not send the rest of it.  The host
+       * discards the incomplete block. */
+      if (stream_dma_half_ && !dma_half_sending_) {
+        stream_chunker_.cancel();
+        return;
+      }
+      UInt8Array chunk =
+        stream_chunker_.next_chunk(UInt8Array_init(sizeof(stream_buffer_),
+                                                   stream_buffer_));
+      // Overwriting started while the chunk was being copied.
+      if (stream_dma_half_ && !dma_half_sending_) {
+        stream_chunker_.cancel_chunk();
+        return;
+      }
+      serial_handler_.receiver_.write_f_(chunk, Packet::packet_type::STREAM,
+                                         stream_id_);
+      rpc_profiler_.record_stream(chunk.length);
+      if (stream_credits_ > 0) { stream_credits_--; }
+      if (!stream_chunker_.pending()) {
+        dma_half_sending_ = 0;
+        // Triggered capture window (if any) may be overwritten.
+        triggered_capture_.release();
       }
     }
   }
@@ -312,7 +1335,187 @@ public:
     tcd = *(dmaBuffer_->dmaChannel->TCD);
     return result;
   }
+  /** Number of samples (summed over all channels) dropped by continuous
+   * acquisitions because a half of the sample buffer was overwritten before
+   * it was completely streamed to the host, or by single acquisitions
+   * completed again before the previous block was streamed (see #loop).
+   *
+   * \see #start_dma_adc_continuous
+   */
+  uint32_t dma_overrun_count() const { return dma_overrun_count_; }
   int8_t last_dma_channel_done() const { return last_dma_channel_done_; }
+  /** `DMA_ES` error bits (`DBE` to `SAE`) of all DMA channel interrupts
+   * handled since the last call to #reset_last_dma_channel_done. */
+  uint8_t last_dma_errors() const { return last_dma_errors_; }
+  /** \return DMA channel used by #mem_cpy_dma and #mem_fill_dma, or
+   *     `DMA_NUM_CHANNELS` if none. */
+  uint8_t dma_memory_channel() const { return dma_memory_.channel_; }
+  /** \return `true` while a DMA memory transfer is in progress. */
+  bool dma_memory_busy() { return dma_memory_.poll(); }
+  /** \return Number of completed and aborted (i.e., DMA error) DMA memory
+   *     transfers. */
+  UInt32Array dma_memory_stats() {
+    UInt32Array result = UInt32Array_init(2, (uint32_t *)get_buffer().data);
+    result.data[0] = dma_memory_.transfer_count_;
+    result.data[1] = dma_memory_.error_count_;
+    return result;
+  }
+  /** Number of DMA channel interrupt records dropped because the event ring
+   * was full (i.e., #loop did not keep up with DMA interrupts). */
+  uint32_t dma_event_drop_count() const { return dma_events_.drop_count_; }
+  /** Number of DMA channel interrupt records waiting to be handled by
+   * #loop. */
+  uint16_t dma_events_pending() const { return dma_events_.size(); }
+  /** Interrupt action flags of \a dma_channel (see #set_dma_isr_actions). */
+  uint8_t dma_isr_actions(uint8_t dma_channel) const {
+    return ((dma_channel < DMA_NUM_CHANNELS)
+            ? dma_isr_actions_[dma_channel].flags : 0);
+  }
+  bool isr_profiler_enabled() const { return isr_profiler_.enabled_; }
+  bool rpc_profiler_enabled() const { return rpc_profiler_.enabled_; }
+  /** Memory arena statistics (see `MemoryArenaStats`): capacity, in use,
+   * high-water mark, carved bytes, free-list bytes, pool block overhead
+   * bytes, allocation count, and failed allocation count. */
+  UInt32Array memory_arena_stats() {
+    const MemoryArenaStats &stats = memory_arena_.stats_;
+    UInt32Array result = UInt32Array_init(8, (uint32_t *)get_buffer().data);
+    result.data[0] = stats.capacity;
+    result.data[1] = stats.in_use_bytes;
+    result.data[2] = stats.high_water_bytes;
+    result.data[3] = stats.bump_bytes;
+    result.data[4] = stats.free_list_bytes;
+    result.data[5] = stats.overhead_bytes;
+    result.data[6] = stats.allocation_count;
+    result.data[7] = stats.failed_count;
+    return result;
+  }
+  /** Main loop, serial, and per-command RPC statistics as a binary table:
+   * one `LoopProfile` header followed by `command_count` `CommandProfile`
+   * records (see `TeensyMinimalRpc/RpcProfiler.h`).
+   *
+   * \see #rpc_profiler_enable
+   */
+  UInt8Array profile_stats() {
+    return rpc_profiler_.serialize(cycle_counter_.read(), get_buffer());
+  }
+  /** Number of interrupt handlers timed by the ISR profiler (DMA channels
+   * `0..N-3`, then `adc0_isr` and `adc1_isr`). */
+  uint8_t isr_profiler_size() const { return isr_profiler_.size(); }
+  /** Log2 histogram of cycles between consecutive entries of interrupt
+   * handler \a index (see `IsrHistogram`), or empty if \a index is out of
+   * range.
+   *
+   * \see #isr_profiler_enable
+   */
+  UInt32Array isr_interval_histogram(uint8_t index) {
+    if (index >= isr_profiler_.size()) { return UInt32Array_init_default(); }
+    return UInt32Array_init(ISR_HISTOGRAM_BUCKETS,
+                            isr_profiler_.histograms_[index].interval_);
+  }
+  /** Log2 histogram of durations (in cycles) of interrupt handler \a index,
+   * or empty if \a index is out of range. */
+  UInt32Array isr_duration_histogram(uint8_t index) {
+    if (index >= isr_profiler_.size()) { return UInt32Array_init_default(); }
+    return UInt32Array_init(ISR_HISTOGRAM_BUCKETS,
+                            isr_profiler_.histograms_[index].duration_);
+  }
+  /** Number of recorded entries and maximum duration (in cycles) of
+   * interrupt handler \a index, or empty if \a index is out of range. */
+  UInt32Array isr_profile_stats(uint8_t index) {
+    if (index >= isr_profiler_.size()) { return UInt32Array_init_default(); }
+    UInt32Array result = UInt32Array_init(2, (uint32_t *)get_buffer().data);
+    result.data[0] = isr_profiler_.histograms_[index].count_;
+    result.data[1] = isr_profiler_.histograms_[index].max_duration_;
+    return result;
+  }
+  /** Number of stream chunks the device may send before the host grants
+   * more credits, or -1 if flow control is disabled. */
+  int32_t stream_credits() const { return stream_credits_; }
+  /** Maximum number of bytes in each `STREAM` packet payload, including the
+   * stream chunk header. */
+  uint32_t stream_chunk_size() const { return sizeof(stream_buffer_); }
+  /** Current device time as 64-bit CPU cycle count (`[low, high]` 32-bit
+   * words), i.e., the same time base as stream chunk timestamps.
+   *
+   * \see #cpu_frequency
+   */
+  UInt32Array cycle_count() {
+    const uint64_t now = cycle_counter_.read();
+    cycle_count_[0] = now & 0xFFFFFFFF;
+    cycle_count_[1] = now >> 32;
+    return UInt32Array_init(2, cycle_count_);
+  }
+  uint32_t cpu_frequency() const { return F_CPU; }
+  /** \return CRC-32 (same as `zlib.crc32`) of \a size bytes of device
+   * memory starting at \a address, computed by the CRC module. */
+  uint32_t mem_crc32(uint32_t address, uint32_t size) {
+    return teensy::crc::crc32((const uint8_t *)address, size);
+  }
+  /** \return CRC-16/ARC of \a size bytes of device memory starting at \a
+   * address, computed by the CRC module. */
+  uint16_t mem_crc16(uint32_t address, uint32_t size) {
+    return teensy::crc::crc16((const uint8_t *)address, size);
+  }
+  /** Compute CRC-32 of \a size bytes of device memory starting at \a address
+   * in software, with the CRC module fed by the CPU, and with the CRC module
+   * fed by DMA.
+   *
+   * \return CRC and duration (in CPU cycles) of each method, i.e.,
+   *     `[software_crc, software_cycles, cpu_crc, cpu_cycles, dma_crc,
+   *     dma_cycles]`.  The DMA CRC and cycles are 0 if the DMA memory engine
+   *     is not available.
+   */
+  UInt32Array crc_benchmark(uint32_t address, uint32_t size) {
+    const uint8_t *data = (const uint8_t *)address;
+    UInt32Array result = UInt32Array_init(6, (uint32_t *)get_buffer().data);
+
+    uint32_t start = ARM_DWT_CYCCNT;
+    result.data[0] = crc32(data, size);
+    result.data[1] = ARM_DWT_CYCCNT - start;
+
+    start = ARM_DWT_CYCCNT;
+    teensy::crc::start_crc32();
+    teensy::crc::update_cpu(data, size);
+    result.data[2] = teensy::crc::crc32_result();
+    result.data[3] = ARM_DWT_CYCCNT - start;
+
+    start = ARM_DWT_CYCCNT;
+    teensy::crc::start_crc32();
+    const bool dma = teensy::crc::update_dma(data, size);
+    result.data[4] = dma ? teensy::crc::crc32_result() : 0;
+    result.data[5] = dma ? ARM_DWT_CYCCNT - start : 0;
+    return result;
+  }
+  /** \return RMS of \a size `uint16_t` samples starting at \a address,
+   * after subtracting their mean. */
+  float compute_uint16_mean_sub_rms(uint32_t address, uint32_t size) {
+    return compute_mean_sub_rms((const uint16_t *)address, size);
+  }
+  /** \return RMS of \a size `uint16_t` samples starting at \a address,
+   * after subtracting \a bias. */
+  float compute_uint16_sub_rms(uint32_t address, uint32_t size, float bias) {
+    return compute_sub_rms((const uint16_t *)address, size, bias);
+  }
+  /** Time RMS computation over \a size samples (`int16_t` if \a is_signed,
+   * otherwise `uint16_t`) starting at \a address.
+   *
+   * \return Result (as `float` bits) and duration (in CPU cycles) of
+   *     mean-subtracted RMS and RMS for each variant, i.e., scalar `float`,
+   *     portable single-pass, and `SMLALD` single-pass (see
+   *     `benchmark_rms`).
+   */
+  UInt32Array rms_benchmark(uint32_t address, uint32_t size, bool is_signed) {
+    UInt32Array result = UInt32Array_init(RMS_BENCHMARK_SIZE,
+                                          (uint32_t *)get_buffer().data);
+    if (is_signed) {
+      benchmark_rms((const int16_t *)address, size, result.data);
+    } else {
+      benchmark_rms((const uint16_t *)address, size, result.data);
+    }
+    return result;
+  }
+  /** Sequence number of the next stream chunk to be sent. */
+  uint32_t stream_sequence() const { return stream_chunker_.sequence_; }
   UInt8Array mem_cpy_device_to_host(uint32_t address, uint32_t size) {
     UInt8Array output;
     output.length = size;
@@ -326,6 +1529,7 @@ public:
     return teensy::dma::serialize_TCD(channel_num, get_buffer());
   }
   void reset_dma_TCD(uint8_t channel_num) {
+    teensy::registers::invalidate_token();
     teensy::dma::reset_TCD(channel_num);
   }
   UInt8Array read_dma_mux_chcfg(uint8_t channel_num) {
@@ -343,6 +1547,25 @@ public:
   UInt8Array read_pit_timer_config(uint8_t timer_index) {
     return teensy::pit::serialize_timer_config(timer_index, get_buffer());
   }
+  /** Raw register snapshots, decoded on the host (see
+   * `teensy_minimal_rpc.registers`).
+   *
+   * Unlike the `read_..._registers` methods, no field is decoded or
+   * Protocol Buffer encoded on the device. */
+  UInt8Array read_dma_registers_raw() {
+    return teensy::dma::snapshot_registers(get_buffer());
+  }
+  /** \return Raw transfer control descriptors of \a count DMA channels
+   * starting at \a first_channel (32 bytes each). */
+  UInt8Array read_dma_TCDs_raw(uint8_t first_channel, uint8_t count) {
+    return teensy::dma::snapshot_TCDs(first_channel, count, get_buffer());
+  }
+  UInt8Array read_adc_registers_raw(uint8_t adc_num) {
+    return teensy::adc::snapshot_registers(adc_num, get_buffer());
+  }
+  UInt8Array read_pit_registers_raw() {
+    return teensy::pit::snapshot_registers(get_buffer());
+  }
   UInt8Array read_sim_SCGC6() { return teensy::sim::serialize_SCGC6(get_buffer()); }
   UInt8Array read_sim_SCGC7() { return teensy::sim::serialize_SCGC7(get_buffer()); }
   UInt8Array _uuid() {
@@ -355,35 +1578,100 @@ public:
 
   // ##########################################################################
   // # Mutator methods
+  /** Attach generated interrupt handler (see `DmaIsrTable`) to \a
+   * dma_channel.
+   *
+   * Unless set otherwise by #set_dma_isr_actions, the handler stops the PDB
+   * timer and pushes a completion record (i.e., `DMA_ISR_STOP_PDB |
+   * DMA_ISR_PUSH_EVENT`).
+   */
   void attach_dma_interrupt(uint8_t dma_channel) {
-    void (*isr)(void);
-    switch(dma_channel) {
-      case 0: isr = &dma_ch0_isr; break;
-      case 1: isr = &dma_ch1_isr; break;
-      case 2: isr = &dma_ch2_isr; break;
-      case 3: isr = &dma_ch3_isr; break;
-      case 4: isr = &dma_ch4_isr; break;
-      case 5: isr = &dma_ch5_isr; break;
-      case 6: isr = &dma_ch6_isr; break;
-      case 7: isr = &dma_ch7_isr; break;
-      case 8: isr = &dma_ch8_isr; break;
-      case 9: isr = &dma_ch9_isr; break;
-      case 10: isr = &dma_ch10_isr; break;
-      case 11: isr = &dma_ch11_isr; break;
-      case 12: isr = &dma_ch12_isr; break;
-      case 13: isr = &dma_ch13_isr; break;
-      case 14: isr = &dma_ch14_isr; break;
-      case 15: isr = &dma_ch15_isr; break;
-      default: return;
-    }
-    _VectorsRam[dma_channel + IRQ_DMA_CH0 + 16] = isr;
+    if (dma_channel >= DMA_NUM_CHANNELS) { return; }
+    if (!dma_isr_actions_[dma_channel].flags) {
+      dma_isr_actions_[dma_channel].flags = (DMA_ISR_STOP_PDB |
+                                             DMA_ISR_PUSH_EVENT);
+    }
+    _VectorsRam[dma_channel + IRQ_DMA_CH0 + 16] = dma_isr_vectors[dma_channel];
     NVIC_ENABLE_IRQ(IRQ_DMA_CH0 + dma_channel);
   }
+  /** Set the actions taken by the interrupt handler of \a dma_channel (see
+   * #on_dma_channel_done).
+   *
+   * \param flags Bitwise OR of `DmaIsrAction` values.
+   * \param chain_channel DMA channel to enable for `DMA_ISR_CHAIN`.
+   *
+   * \return 0 on success, or -1 if either DMA channel is invalid.
+   */
+  int8_t set_dma_isr_actions(uint8_t dma_channel, uint8_t flags,
+                             uint8_t chain_channel) {
+    if ((dma_channel >= DMA_NUM_CHANNELS) ||
+        (chain_channel >= DMA_NUM_CHANNELS)) {
+      return -1;
+    }
+    noInterrupts();
+    dma_isr_actions_[dma_channel].flags = flags;
+    dma_isr_actions_[dma_channel].chain_channel = chain_channel;
+    interrupts();
+    return 0;
+  }
+  /** Grant permission to send \a count more stream chunks.
+   *
+   * The first call enables credit-based flow control: from then on, the
+   * device only sends a stream chunk while it holds at least one credit.
+   *
+   * \see #disable_stream_flow_control
+   */
+  void grant_stream_credits(uint16_t count) {
+    if (stream_credits_ < 0) { stream_credits_ = 0; }
+    stream_credits_ += count;
+  }
+  void disable_stream_flow_control() { stream_credits_ = -1; }
+  /** Enable/disable timing of interrupt handlers with the DWT cycle counter
+   * (disabled by default).
+   *
+   * \see #isr_interval_histogram, #isr_duration_histogram
+   */
+  void isr_profiler_enable(bool enable) { isr_profiler_.enabled_ = enable; }
+  /** Enable/disable main loop and RPC dispatch statistics (disabled by
+   * default).
+   *
+   * \see #profile_stats
+   */
+  void rpc_profiler_enable(bool enable) { rpc_profiler_.enabled_ = enable; }
+  void rpc_profiler_reset() { rpc_profiler_.reset(cycle_counter_.read()); }
+  void isr_profiler_reset() {
+    noInterrupts();
+    isr_profiler_.reset();
+    interrupts();
+  }
+  /** Use \a dma_channel for DMA memory transfers (see #mem_cpy_dma).
+   *
+   * The channel interrupt is attached with `DMA_ISR_MEMORY |
+   * DMA_ISR_PUSH_EVENT` actions.  By default, `DMA_MEMORY_CHANNEL` is used.
+   *
+   * \return 0 on success, -1 if \a dma_channel is invalid, or -2 if a
+   *     transfer is in progress.
+   */
+  int8_t dma_memory_set_channel(uint8_t dma_channel) {
+    const uint8_t previous = dma_memory_.channel_;
+    const int8_t result = dma_memory_.set_channel(dma_channel);
+    if (result != 0) { return result; }
+    teensy::registers::invalidate_token();  // Mux of channel was cleared.
+    if ((previous < DMA_NUM_CHANNELS) && (previous != dma_channel)) {
+      detach_dma_interrupt(previous);
+    }
+    set_dma_isr_actions(dma_channel, DMA_ISR_MEMORY | DMA_ISR_PUSH_EVENT, 0);
+    attach_dma_interrupt(dma_channel);
+    return 0;
+  }
   void clear_dma_errors() {
     DMA_CERR = DMA_CERR_CAEI;  // Clear All Error Indicators
   }
   void detach_dma_interrupt(uint8_t dma_channel) {
       NVIC_DISABLE_IRQ(IRQ_DMA_CH0 + dma_channel);
+      if (dma_channel < DMA_NUM_CHANNELS) {
+        dma_isr_actions_[dma_channel].flags = 0;
+      }
   }
   bool dma_start(uint32_t buffer_size) {
     const bool power_of_two = (buffer_size &&
@@ -403,19 +1691,43 @@ public:
     while (aligned_allocations_.size() > 0) {
       aligned_free((void *)aligned_allocations_.shift());
     }
+    memory_arena_.reset();
   }
+  /** Allocate \a size bytes of device memory.
+   *
+   * Memory is allocated from a fixed arena of 32-byte aligned slabs (for
+   * requests of at most 32 bytes) and a pool (see `MemoryArena`), falling
+   * back to the heap once the arena is full.
+   *
+   * \return Address of allocated memory, or 0 if allocation failed.
+   */
   uint32_t mem_alloc(uint32_t size) {
-    uint32_t address = (uint32_t)malloc(size);
+    uint32_t address = (uint32_t)memory_arena_.allocate(size);
+    if (address) { return address; }
+    address = (uint32_t)malloc(size);
     // Save to list of allocations for memory management.
-    allocations_.add(address);
+    if (address) { allocations_.add(address); }
     return address;
   }
+  /** Allocate \a size bytes of device memory aligned to \a alignment (power
+   * of two).
+   *
+   * \see #mem_alloc
+   */
   uint32_t mem_aligned_alloc(uint32_t alignment, uint32_t size) {
-    uint32_t address = (uint32_t)aligned_malloc(alignment, size);
+    uint32_t address = (uint32_t)memory_arena_.allocate(size, alignment);
+    if (address) { return address; }
+    address = (uint32_t)aligned_malloc(alignment, size);
     // Save to list of allocations for memory management.
-    aligned_allocations_.add(address);
+    if (address) { aligned_allocations_.add(address); }
     return address;
   }
+  /** Release all arena allocations at once (any address returned by
+   * #mem_alloc or #mem_aligned_alloc from the arena becomes invalid).
+   *
+   * Heap allocations made after the arena was full are not affected.
+   */
+  void reset_arena() { memory_arena_.reset(); }
   uint32_t mem_aligned_alloc_and_set(uint32_t alignment, UInt8Array data) {
     // Allocate aligned memory.
     const uint32_t address = mem_aligned_alloc(alignment, data.length);
@@ -425,6 +1737,11 @@ public:
     return address;
   }
   void mem_aligned_free(uint32_t address) {
+    // Arena slabs are freed in constant time.
+    if (memory_arena_.contains((void *)address)) {
+      memory_arena_.free((void *)address);
+      return;
+    }
     for (int i = 0; i < aligned_allocations_.size(); i++) {
       if (aligned_allocations_.get(i) == address) {
         aligned_allocations_.remove(i);
@@ -433,53 +1750,178 @@ public:
     aligned_free((void *)address);
   }
   void mem_cpy_host_to_device(uint32_t address, UInt8Array data) {
+    // Destination may be a register (e.g., PDB or TCD words).
+    teensy::registers::invalidate_token();
     memcpy((uint8_t *)address, data.data, data.length);
   }
+  /** Start writing \a size bytes to device memory at \a address from
+   * chunks sent with #mem_write_bulk_chunk.
+   *
+   * The host may send all chunks without waiting for the reply to each
+   * chunk, then call #mem_write_bulk_end once to check the result.
+   */
+  void mem_write_bulk_begin(uint32_t address, uint32_t size) {
+    bulk_writer_.begin((uint8_t *)address, size);
+  }
+  /** Write chunk \a sequence (starting at 0 and incrementing by one for each
+   * chunk) of a bulk write at byte \a offset within the region.
+   *
+   * Out-of-order or out-of-range chunks are rejected and counted as errors
+   * (see #mem_write_bulk_end). */
+  void mem_write_bulk_chunk(uint16_t sequence, uint32_t offset,
+                            UInt8Array data) {
+    bulk_writer_.write(sequence, offset, data);
+  }
+  /** End bulk write started by #mem_write_bulk_begin.
+   *
+   * \return CRC-32 of whole region (same as `zlib.crc32`), number of bytes
+   *     written, and number of chunks rejected.
+   */
+  UInt32Array mem_write_bulk_end() {
+    const BulkWriteResult &finished = bulk_writer_.finish();
+    UInt32Array result = UInt32Array_init(3, (uint32_t *)get_buffer().data);
+    result.data[0] = finished.crc;
+    result.data[1] = finished.received_bytes;
+    result.data[2] = finished.error_count;
+    return result;
+  }
+  /** Copy \a size bytes from \a source to \a destination in device memory
+   * using the DMA memory engine (see #dma_memory_set_channel).
+   *
+   * \param wait If `true`, return once the copy is complete.  Otherwise,
+   *     return once the copy is started; completion is reported as a
+   *     #DmaEvent of the engine channel (see #last_dma_channel_done) and
+   *     #dma_memory_busy returns `false`.
+   *
+   * \return 0 on success, -1 if the engine has no DMA channel, or -2 if a
+   *     transfer is in progress.
+   */
+  int8_t mem_cpy_dma(uint32_t destination, uint32_t source, uint32_t size,
+                     bool wait) {
+    const int8_t result = dma_memory_.copy((void *)destination,
+                                           (const void *)source, size, !wait);
+    if ((result == 0) && wait) { dma_memory_.wait(); }
+    return result;
+  }
+  /** Fill \a count elements of \a value_size (1, 2, or 4) bytes starting at
+   * \a address with \a value using the DMA memory engine.
+   *
+   * \see #mem_cpy_dma
+   */
+  int8_t mem_fill_dma(uint32_t address, uint32_t value, uint8_t value_size,
+                      uint32_t count, bool wait) {
+    const int8_t result = dma_memory_.fill((void *)address, value,
+                                           value_size, count, !wait);
+    if ((result == 0) && wait) { dma_memory_.wait(); }
+    return result;
+  }
+  /** Fill with the DMA memory engine and wait for completion.
+   *
+   * \return `false` if the fill is too small or the engine is not
+   *     available, i.e., the caller must fill the memory itself.
+   */
+  bool dma_fill_wait(uint32_t address, uint32_t value, uint8_t value_size,
+                     uint32_t count) {
+    if ((count * value_size < DMA_MEMORY_MIN_SIZE) ||
+        (mem_fill_dma(address, value, value_size, count, true) != 0)) {
+      return false;
+    }
+    return true;
+  }
   void mem_fill_uint8(uint32_t address, uint8_t value, uint32_t size) {
-    mem_fill((uint8_t *)address, value, size);
+    if (!dma_fill_wait(address, value, sizeof(value), size)) {
+      mem_fill((uint8_t *)address, value, size);
+    }
   }
   void mem_fill_uint16(uint32_t address, uint16_t value, uint32_t size) {
-    mem_fill((uint16_t *)address, value, size);
+    if (!dma_fill_wait(address, value, sizeof(value), size)) {
+      mem_fill((uint16_t *)address, value, size);
+    }
   }
   void mem_fill_uint32(uint32_t address, uint32_t value, uint32_t size) {
-    mem_fill((uint32_t *)address, value, size);
+    if (!dma_fill_wait(address, value, sizeof(value), size)) {
+      mem_fill((uint32_t *)address, value, size);
+    }
   }
   void mem_fill_float(uint32_t address, float value, uint32_t size) {
-    mem_fill((float *)address, value, size);
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if (!dma_fill_wait(address, bits, sizeof(bits), size)) {
+      mem_fill((float *)address, value, size);
+    }
   }
   void mem_free(uint32_t address) {
+    // Arena slabs are freed in constant time.
+    if (memory_arena_.contains((void *)address)) {
+      memory_arena_.free((void *)address);
+      return;
+    }
     for (int i = 0; i < allocations_.size(); i++) {
       if (allocations_.get(i) == address) { allocations_.remove(i); }
     }
     free((void *)address);
   }
-  void reset_last_dma_channel_done() { last_dma_channel_done_ = -1; }
+  void reset_dma_overrun_count() { dma_overrun_count_ = 0; }
+  void reset_last_dma_channel_done() {
+    last_dma_channel_done_ = -1;
+    last_dma_errors_ = 0;
+  }
+  void reset_dma_event_drop_count() { dma_events_.drop_count_ = 0; }
   void set_i2c_address(uint8_t value);  // Override to validate i2c address
   int8_t update_adc_registers(uint8_t adc_num, UInt8Array serialized_adc_msg) {
+    teensy::registers::invalidate_token();
     return teensy::adc::update_registers(adc_num, serialized_adc_msg);
   }
   int8_t update_dma_mux_chcfg(uint8_t channel_num, UInt8Array serialized_mux) {
+    teensy::registers::invalidate_token();
     return teensy::dma::update_mux_chcfg(channel_num, serialized_mux);
   }
   int8_t update_dma_registers(UInt8Array serialized_dma_msg) {
+    teensy::registers::invalidate_token();
     return teensy::dma::update_registers(serialized_dma_msg);
   }
   int8_t update_dma_TCD(uint8_t channel_num, UInt8Array serialized_tcd) {
+    teensy::registers::invalidate_token();
     return teensy::dma::update_TCD(channel_num, serialized_tcd);
   }
   int8_t update_pit_registers(UInt8Array serialized_pit_msg) {
+    teensy::registers::invalidate_token();
     return teensy::pit::update_registers(serialized_pit_msg);
   }
   int8_t update_pit_timer_config(uint32_t index,
                                  UInt8Array serialized_config) {
+    teensy::registers::invalidate_token();
     return teensy::pit::update_timer_config(index, serialized_config);
   }
   int8_t update_sim_SCGC6(UInt8Array serialized_scgc6) {
+    teensy::registers::invalidate_token();
     return teensy::sim::update_SCGC6(serialized_scgc6);
   }
   int8_t update_sim_SCGC7(UInt8Array serialized_scgc7) {
+    teensy::registers::invalidate_token();
     return teensy::sim::update_SCGC7(serialized_scgc7);
   }
+  /** Apply ordered list of typed register operations (see
+   * `teensy::registers::OpType` for the encoding) as a single transaction.
+   *
+   * All operations are validated first; nothing is written unless every
+   * operation is valid.  The operations are then applied in order with
+   * interrupts disabled.
+   *
+   * \return Number of operations parsed, index of first invalid operation
+   * (equal to the number of operations if all were applied), and `DMA_ES`
+   * after the transaction.
+   *
+   * \see teensy::registers::token */
+  UInt32Array apply_register_ops(UInt8Array ops) {
+    const teensy::registers::TransactionResult transaction =
+      teensy::registers::apply_transaction(ops);
+    UInt32Array result = UInt32Array_init(3, (uint32_t *)get_buffer().data);
+    result.data[0] = transaction.op_count;
+    result.data[1] = transaction.failed_index;
+    result.data[2] = transaction.dma_es;
+    return result;
+  }
 
   // ##########################################################################
   // # Teensy library mutator methods
@@ -521,6 +1963,7 @@ public:
     /*!
      * \param num can be 0, 4, 8, 16 or 32.
      */
+    teensy::registers::invalidate_token();
     adc_->setAveraging(num, adc_num);
   }
   void setConversionSpeed(uint8_t speed, int8_t adc_num) {
@@ -542,6 +1985,7 @@ public:
      * but if F_BUS<F_ADCK, you can't use ADC_VERY_HIGH_SPEED for sampling speed.
      *
      */
+    teensy::registers::invalidate_token();
     adc_->setConversionSpeed(speed, adc_num);
   }
   void setReference(uint8_t type, int8_t adc_num) {
@@ -551,6 +1995,7 @@ public:
      *
      *  It recalibrates at the end.
      */
+    teensy::registers::invalidate_token();
     adc_->setReference(type, adc_num);
   }
   void setResolution(uint8_t bits, int8_t adc_num) {
@@ -564,6 +2009,7 @@ public:
      *
      *  Whenever you change the resolution, change also the comparison values (if you use them).
      */
+    teensy::registers::invalidate_token();
     adc_->setResolution(bits, adc_num);
   }
   void setSamplingSpeed(uint8_t speed, int8_t adc_num) {
@@ -577,6 +2023,7 @@ public:
      * ADC_HIGH_SPEED (or ADC_HIGH_SPEED_16BITS) adds +6 ADCK.
      * ADC_VERY_HIGH_SPEED is the highest possible sampling speed (0 ADCK added).
      */
+    teensy::registers::invalidate_token();
     adc_->setSamplingSpeed(speed, adc_num);
   }
   void disableCompare(int8_t adc_num) {
@@ -13,6 +13,12 @@
 #define I2C_PACKET_SIZE   PACKET_SIZE
 #endif  // #ifndef I2C_PACKET_SIZE
 
+/* Maximum size of each `STREAM` packet payload (stream chunk header plus
+ * data), leaving room in the packet buffer for packet framing. */
+#ifndef STREAM_CHUNK_SIZE
+#define STREAM_CHUNK_SIZE   (PACKET_SIZE - 16)
+#endif  // #ifndef STREAM_CHUNK_SIZE
+
 
 #endif  // #ifndef ___RPC_BUFFER__H___
 
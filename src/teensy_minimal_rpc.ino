@@ -18,6 +18,14 @@
 
 teensy_minimal_rpc::Node node_obj;
 teensy_minimal_rpc::CommandProcessor<teensy_minimal_rpc::Node> command_processor(node_obj);
+// Record duration and size of each command (see `rpc_profiler_enable`).
+teensy_minimal_rpc::ProfiledCommandProcessor<teensy_minimal_rpc::CommandProcessor<teensy_minimal_rpc::Node> >
+  profiled_command_processor(command_processor, node_obj.rpc_profiler_);
+
+namespace teensy_minimal_rpc {
+// DMA channel interrupt handlers, one per channel (see `attach_dma_interrupt`).
+const isr_t * const dma_isr_vectors = DmaIsrTable<Node, node_obj>::vectors;
+}  // namespace teensy_minimal_rpc
 
 // when the measurement finishes, this will be called
 // first: see which pin finished and then save the measurement into the correct buffer
@@ -26,7 +34,15 @@ void adc0_isr() {
   //ADC0_RA; // clear interrupt
 }
 
-void serialEvent() { node_obj.serial_handler_.receiver()(Serial.available()); }
+void adc1_isr() {
+  node_obj.on_adc1_done();
+}
+
+void serialEvent() {
+  const int available = Serial.available();
+  node_obj.rpc_profiler_.record_rx(available);
+  node_obj.serial_handler_.receiver()(available);
+}
 
 
 void setup() {
@@ -40,89 +56,8 @@ void loop() {
    * completed packet, pass the complete packet to the command-processor to
    * process the request. */
   if (node_obj.serial_handler_.packet_ready()) {
-    node_obj.serial_handler_.process_packet(command_processor);
+    node_obj.serial_handler_.process_packet(profiled_command_processor);
   }
 #endif  // #ifndef DISABLE_SERIAL
   node_obj.loop();
 }
-
-void dma_ch0_isr(void) {
-  DMA_CINT = 0;
-  PDB0_SC = 0;  // Stop PDB timer.
-  node_obj.dma_channel_done_ = 0;
-}
-void dma_ch1_isr(void) {
-  DMA_CINT = 1;
-  PDB0_SC = 0;  // Stop PDB timer.
-  node_obj.dma_channel_done_ = 1;
-}
-void dma_ch2_isr(void) {
-  DMA_CINT = 2;
-  PDB0_SC = 0;  // Stop PDB timer.
-  node_obj.dma_channel_done_ = 2;
-}
-void dma_ch3_isr(void) {
-  DMA_CINT = 3;
-  PDB0_SC = 0;  // Stop PDB timer.
-  node_obj.dma_channel_done_ = 3;
-}
-void dma_ch4_isr(void) {
-  DMA_CINT = 4;
-  PDB0_SC = 0;  // Stop PDB timer.
-  node_obj.dma_channel_done_ = 4;
-}
-void dma_ch5_isr(void) {
-  DMA_CINT = 5;
-  PDB0_SC = 0;  // Stop PDB timer.
-  node_obj.dma_channel_done_ = 5;
-}
-void dma_ch6_isr(void) {
-  DMA_CINT = 6;
-  PDB0_SC = 0;  // Stop PDB timer.
-  node_obj.dma_channel_done_ = 6;
-}
-void dma_ch7_isr(void) {
-  DMA_CINT = 7;
-  PDB0_SC = 0;  // Stop PDB timer.
-  node_obj.dma_channel_done_ = 7;
-}
-void dma_ch8_isr(void) {
-  DMA_CINT = 8;
-  PDB0_SC = 0;  // Stop PDB timer.
-  node_obj.dma_channel_done_ = 8;
-}
-void dma_ch9_isr(void) {
-  DMA_CINT = 9;
-  PDB0_SC = 0;  // Stop PDB timer.
-  node_obj.dma_channel_done_ = 9;
-}
-void dma_ch10_isr(void) {
-  DMA_CINT = 10;
-  PDB0_SC = 0;  // Stop PDB timer.
-  node_obj.dma_channel_done_ = 10;
-}
-void dma_ch11_isr(void) {
-  DMA_CINT = 11;
-  PDB0_SC = 0;  // Stop PDB timer.
-  node_obj.dma_channel_done_ = 11;
-}
-void dma_ch12_isr(void) {
-  DMA_CINT = 12;
-  PDB0_SC = 0;  // Stop PDB timer.
-  node_obj.dma_channel_done_ = 12;
-}
-void dma_ch13_isr(void) {
-  DMA_CINT = 13;
-  PDB0_SC = 0;  // Stop PDB timer.
-  node_obj.dma_channel_done_ = 13;
-}
-void dma_ch14_isr(void) {
-  DMA_CINT = 14;
-  PDB0_SC = 0;  // Stop PDB timer.
-  node_obj.dma_channel_done_ = 14;
-}
-void dma_ch15_isr(void) {
-  DMA_CINT = 15;
-  PDB0_SC = 0;  // Stop PDB timer.
-  node_obj.dma_channel_done_ = 15;
-}
@@ -14,8 +14,9 @@ import arduino_helpers.hardware.teensy.pdb as pdb
 import numpy as np
 import pandas as pd
 import six
-import teensy_minimal_rpc.DMA as DMA
-import teensy_minimal_rpc.SIM as SIM
+
+from .registers import OP_TCD, RegisterTransaction, tcd_record
+from .stream import unpack_samples
 
 
 def get_adc_configs(F_BUS=48e6, ADC_CLK=22e6):
@@ -90,6 +91,27 @@ TCD_RECORD_DTYPE = [('SADDR', 'uint32'),
                     ('DLASTSGA', 'uint32'),
                     ('CSR', 'uint16'),
                     ('BITER', 'uint16')]
+# DMA channel interrupt actions (see `DmaIsrAction` in
+# `TeensyMinimalRpc/DmaIsrTable.h`).
+DMA_ISR_STOP_PDB = 0x01
+DMA_ISR_CHAIN = 0x02
+DMA_ISR_PUSH_EVENT = 0x04
+DMA_ISR_PING_PONG = 0x08
+# Register bits written by `AdcSampler` (see `RegisterTransaction`).
+SIM_SCGC6_PDB = 1 << 22  # PDB clock gate
+ADC_CFG2_MUXSEL = 1 << 4  # Select `b` ADC channels
+ADC_SC2_DMAEN = 1 << 2  # DMA request on conversion complete
+ADC_CFG1_ADICLK = 0x3 << 0
+ADC_CFG1_ADLSMP = 1 << 4
+ADC_CFG1_ADIV = 0x3 << 5
+ADC_CFG2_ADLSTS = 0x3 << 0
+ADC_CFG2_ADHSC = 1 << 2
+ADC_CFG2_ADACKEN = 1 << 3
+ADC_PGA_PGAG = 0xF << 16
+ADC_PGA_PGAEN = 1 << 23
+# `SSIZE`/`DSIZE` encoding of transfer control descriptor `ATTR` register.
+TCD_SIZE_16_BIT = 1
+TCD_SIZE_32_BIT = 2
 
 class AdcSampler(object):
     '''
@@ -110,9 +132,42 @@ class AdcSampler(object):
         List of identifiers of DMA channels to use (default=``[0, 1, 2]``).
     adc_number : int
         Identifier of ADC to use (default=:data:`teensy.ADC_0`)
+    continuous : bool, optional
+        If ``True``, split the sample buffer into two halves (i.e., a
+        ping-pong buffer) for gap-free streaming using
+        :meth:`start_continuous_read` (default=``False``).
+
+        .. note::
+            :attr:`sample_count` must be even in continuous mode.
+    pack_bits : int, optional
+        Bits per sample of streamed results (8, 10, 12, or 16, i.e., not
+        packed; default=16).  Samples are packed on the device (see
+        ``stream_packing_configure()``), so must fit in ``pack_bits`` bits
+        (i.e., ADC resolution of at most ``pack_bits``).
     '''
     def __init__(self, proxy, channels, sample_count,
-                 dma_channels=None, adc_number=teensy.ADC_0):
+                 dma_channels=None, adc_number=teensy.ADC_0,
+                 continuous=False, pack_bits=16):
+        self._init_params(proxy, channels, sample_count, dma_channels,
+                          adc_number, continuous, pack_bits)
+
+        self.allocate_device_arrays()
+        self.reset()
+
+        # Apply all register writes in a single packet (see
+        # `RegisterTransaction`).
+        transaction = RegisterTransaction()
+        # Enable PDB clock (DMA and ADC clocks should already be enabled).
+        transaction.sim(6, SIM_SCGC6_PDB, mask=SIM_SCGC6_PDB)
+        self.configure_adc(transaction)
+        self.configure_dma(transaction)
+        self.proxy().apply_register_transaction(transaction)
+        self.assert_no_dma_error()
+        self._sample_rate_hz = None
+        self._pdb_config = None
+
+    def _init_params(self, proxy, channels, sample_count, dma_channels,
+                     adc_number, continuous, pack_bits=16):
         # Use weak reference to prevent zombie `proxy` staying alive even after
         # deleting the original `proxy` reference.
         self.proxy = weakref.ref(proxy)
@@ -128,22 +183,21 @@ class AdcSampler(object):
                                             'adc_conversion'])
         self.dma_channels = dma_channels
         self.adc_number = adc_number
+        if continuous and (sample_count & 0x1):
+            raise ValueError('Sample count must be even in continuous mode.')
+        self.continuous = continuous
+        if pack_bits not in (8, 10, 12, 16):
+            raise ValueError('Packed sample size must be 8, 10, 12, or 16 '
+                             'bits.')
+        self.pack_bits = pack_bits
 
         # Map Teensy analog channel labels to channels in
         # `ADC_SC1x` format.
         self.channel_sc1as = np.array(adc.SC1A_PINS[channels].tolist(),
                                       dtype='uint32')
-
-        # Enable PDB clock (DMA and ADC clocks should already be enabled).
-        self.proxy().update_sim_SCGC6(SIM.R_SCGC6(PDB=True))
-
-        self.allocate_device_arrays()
-        self.reset()
-
-        self.configure_adc()
-        self.configure_dma()
-        self._sample_rate_hz = None
-        self._pdb_config = None
+        # Layout of each block of samples array (see `_unpack_samples`).
+        self.scan_width = len(self.channels)
+        self.channel_stride = self.block_sample_count
 
     @property
     def sample_rate_hz(self):
@@ -155,6 +209,24 @@ class AdcSampler(object):
             self._sample_rate_hz = value
             self.pdb_config = self.configure_timer(self._sample_rate_hz)
 
+    @property
+    def block_sample_count(self):
+        '''
+        Number of samples per channel in each contiguous block of the device
+        samples array (i.e., half of :attr:`sample_count` in continuous mode).
+        '''
+        return (self.sample_count // 2 if self.continuous
+                else self.sample_count)
+
+    @property
+    def samples_size(self):
+        '''
+        Size of device samples array in bytes (see :meth:`_unpack_samples`).
+        '''
+        block_count = 2 if self.continuous else 1
+        return (np.dtype('uint16').itemsize * block_count * self.scan_width *
+                self.channel_stride)
+
     @property
     def pdb_config(self):
         return self._pdb_config
@@ -163,28 +235,25 @@ class AdcSampler(object):
     def pdb_config(self, value):
         self._pdb_config = np.uint32(value)
 
-    def configure_dma(self):
-        self.configure_dma_channel_adc_conversion_mux()
-        self.assert_no_dma_error()
-
-        self.configure_dma_channel_scatter()
-        self.assert_no_dma_error()
-
-        self.configure_dma_channel_adc_channel_configs()
-        self.assert_no_dma_error()
-
-        self.configure_dma_channel_adc_conversion()
-        self.assert_no_dma_error()
+    def configure_dma(self, transaction):
+        '''
+        Add DMA channel configuration to register ``transaction``.
 
-        self.configure_dma_channel_adc_channel_configs_mux()
-        self.assert_no_dma_error()
+        The scatter descriptor chain is written to device memory right away
+        (see :meth:`configure_dma_channel_scatter`).
+        '''
+        self.configure_dma_channel_adc_conversion_mux(transaction)
+        self.configure_dma_channel_scatter(transaction)
+        self.configure_dma_channel_adc_channel_configs(transaction)
+        self.configure_dma_channel_adc_conversion(transaction)
+        self.configure_dma_channel_adc_channel_configs_mux(transaction)
 
     def assert_no_dma_error(self):
-        df_dma_registers = self.proxy().DMA_registers()
-        df_errors = df_dma_registers.loc[(df_dma_registers.full_name == 'ERR')
-                                         & (df_dma_registers.value > 0)]
-        if df_errors.shape[0] > 0:
-            raise IOError('One or more DMA errors occurred.\n%s' % df_errors)
+        # Raw register snapshot, i.e., no decoding on the device.
+        error_info = self.proxy().dma_error_info()
+        if error_info['ERR'] > 0:
+            raise IOError('One or more DMA errors occurred.\n%s' %
+                          error_info)
 
     def allocate_device_arrays(self):
         '''
@@ -264,7 +333,7 @@ class AdcSampler(object):
         self.proxy().mem_fill_uint8(self.allocs.samples, 0, self.sample_count *
                                     self.N)
 
-    def configure_dma_channel_adc_channel_configs(self):
+    def configure_dma_channel_adc_channel_configs(self, transaction):
         '''
         Configure DMA channel ``adc_channel_configs`` to copy SC1A
         configurations from :attr:`channel_sc1as`, one at a time, to the
@@ -281,28 +350,20 @@ class AdcSampler(object):
 
         .. _K20P64M72SF1RM: https://www.pjrc.com/teensy/K20P64M72SF1RM.pdf
         '''
-        sca1_tcd_msg = \
-            DMA.TCD(CITER_ELINKNO=
-                    DMA.R_TCD_ITER_ELINKNO(ELINK=False,
-                                           ITER=self.channel_sc1as.size),
-                    BITER_ELINKNO=
-                    DMA.R_TCD_ITER_ELINKNO(ELINK=False,
-                                           ITER=self.channel_sc1as.size),
-                    ATTR=DMA.R_TCD_ATTR(SSIZE=DMA.R_TCD_ATTR._32_BIT,
-                                        DSIZE=DMA.R_TCD_ATTR._32_BIT),
-                    NBYTES_MLNO=4,  # `SDA1` register is 4 bytes (32-bit)
-                    SADDR=int(self.allocs.sc1as),
-                    SOFF=4,
-                    SLAST=-self.channel_sc1as.size * 4,
-                    DADDR=int(adc.ADC0_SC1A),
-                    DOFF=0,
-                    DLASTSGA=0,
-                    CSR=DMA.R_TCD_CSR(START=0, DONE=False))
-
-        self.proxy().update_dma_TCD(self.dma_channels.adc_channel_configs,
-                                    sca1_tcd_msg)
-
-    def configure_dma_channel_adc_channel_configs_mux(self):
+        sca1_tcd = tcd_record(ITER=self.channel_sc1as.size,
+                              SSIZE=TCD_SIZE_32_BIT, DSIZE=TCD_SIZE_32_BIT,
+                              # `SDA1` register is 4 bytes (32-bit)
+                              NBYTES=4,
+                              SADDR=int(self.allocs.sc1as),
+                              SOFF=4,
+                              SLAST=-self.channel_sc1as.size * 4,
+                              DADDR=int(adc.ADC0_SC1A),
+                              DOFF=0,
+                              DLASTSGA=0)
+
+        transaction.tcd(self.dma_channels.adc_channel_configs, sca1_tcd)
+
+    def configure_dma_channel_adc_channel_configs_mux(self, transaction):
         '''
         Configure DMA channel ``adc_channel_configs`` to trigger based on
         programmable delay block timer.
@@ -322,18 +383,15 @@ class AdcSampler(object):
         '''
         # Configure DMA channel `i` enable to use MUX triggering from
         # programmable delay block.
-        self.proxy().update_dma_mux_chcfg(self.dma_channels.adc_channel_configs,
-                                          DMA.MUX_CHCFG(SOURCE=
-                                                        dma.DMAMUX_SOURCE_PDB,
-                                                        TRIG=False, ENBL=True))
+        transaction.mux(self.dma_channels.adc_channel_configs,
+                        dma.DMAMUX_SOURCE_PDB, enable=True, trigger=False)
 
         # Set enable request for DMA channel `i`.
         #
         # [1]: https://www.pjrc.com/teensy/K20P64M72SF1RM.pdf
-        self.proxy().update_dma_registers(
-            DMA.Registers(SERQ=int(self.dma_channels.adc_channel_configs)))
+        transaction.enable_dma_request(self.dma_channels.adc_channel_configs)
 
-    def configure_dma_channel_adc_conversion_mux(self):
+    def configure_dma_channel_adc_conversion_mux(self, transaction):
         '''
         Set mux source for DMA channel ``adc_conversion`` to ADC0 and enable
         DMA for ADC0.
@@ -348,20 +406,20 @@ class AdcSampler(object):
 
         .. _K20P64M72SF1RM: https://www.pjrc.com/teensy/K20P64M72SF1RM.pdf
         '''
-        self.proxy().update_dma_mux_chcfg(
-            self.dma_channels.adc_conversion,
-            DMA.MUX_CHCFG(
-                # Route ADC0 as DMA channel source.
-                SOURCE=dma.DMAMUX_SOURCE_ADC0,
-                TRIG=False,# Disable periodic trigger.
-                # Enable the DMAMUX configuration for channel.
-                ENBL=True))
+        transaction.mux(self.dma_channels.adc_conversion,
+                        # Route ADC0 as DMA channel source.
+                        dma.DMAMUX_SOURCE_ADC0,
+                        # Enable the DMAMUX configuration for channel.
+                        enable=True,
+                        # Disable periodic trigger.
+                        trigger=False)
         # Update ADC0_SC2 to enable DMA and assert the ADC DMA request during
         # an ADC conversion complete event noted when any of the `SC1n[COCO]`
         # (i.e., conversion complete) flags is asserted.
-        self.proxy().enableDMA(teensy.ADC_0)
+        transaction.adc(teensy.ADC_0, 'SC2', ADC_SC2_DMAEN,
+                        mask=ADC_SC2_DMAEN)
 
-    def configure_dma_channel_adc_conversion(self):
+    def configure_dma_channel_adc_conversion(self, transaction):
         '''
         Configure DMA channel ``adc_conversion`` to:
 
@@ -399,40 +457,30 @@ class AdcSampler(object):
         # See `CITER` field section **TCD Current Minor Loop Link, Major Loop
         # Count (Channel Linking Disabled) (`DMA_TCDn_CITER_ELINKNO`)
         # (21.3.27/423)
-        tcd_msg = DMA.TCD(
-            CITER_ELINKYES=
-            DMA.R_TCD_ITER_ELINKYES(ELINK=True,
-                                    LINKCH=1,
-                                    ITER=self.channel_sc1as.size),
-            BITER_ELINKYES=
-            DMA.R_TCD_ITER_ELINKYES(ELINK=True,
-                                    LINKCH=1,
-                                    ITER=self.channel_sc1as.size),
-            ATTR=DMA.R_TCD_ATTR(SSIZE=DMA.R_TCD_ATTR._16_BIT,
-                                DSIZE=DMA.R_TCD_ATTR._16_BIT),
-            NBYTES_MLNO=2,  # sizeof(uint16)
-            SADDR=adc.ADC0_RA,
-            SOFF=0,
-            SLAST=0,
-            DADDR=int(self.allocs.scan_result),
-            DOFF=2,
-            DLASTSGA=-self.N,
-            CSR=DMA.R_TCD_CSR(START=0, DONE=False,
-                              # Start `scatter` DMA channel
-                              # after completion of major loop.
-                              MAJORELINK=True,
-                              MAJORLINKCH=
-                              int(self.dma_channels.scatter)))
-
-        self.proxy().update_dma_TCD(self.dma_channels.adc_conversion, tcd_msg)
+        tcd = tcd_record(ITER=self.channel_sc1as.size,
+                         ELINK=True,
+                         LINKCH=1,
+                         SSIZE=TCD_SIZE_16_BIT, DSIZE=TCD_SIZE_16_BIT,
+                         NBYTES=2,  # sizeof(uint16)
+                         SADDR=adc.ADC0_RA,
+                         SOFF=0,
+                         SLAST=0,
+                         DADDR=int(self.allocs.scan_result),
+                         DOFF=2,
+                         DLASTSGA=-self.N,
+                         # Start `scatter` DMA channel after completion of
+                         # major loop.
+                         MAJORELINK=True,
+                         MAJORLINKCH=int(self.dma_channels.scatter))
+
+        transaction.tcd(self.dma_channels.adc_conversion, tcd)
 
         # DMA request input signals and this enable request flag
         # must be asserted before a channel’s hardware service
         # request is accepted (21.3.3/394).
-        self.proxy().update_dma_registers(
-            DMA.Registers(SERQ=int(self.dma_channels.adc_conversion)))
+        transaction.enable_dma_request(self.dma_channels.adc_conversion)
 
-    def configure_dma_channel_scatter(self):
+    def configure_dma_channel_scatter(self, transaction):
         '''
         Configure a Transfer Control Descriptor structure for *each scan* of
         the analog input channels, copy TCD structures to device, and attach
@@ -448,6 +496,12 @@ class AdcSampler(object):
         to the scatters the results from the scan to the next index position in
         the samples array of each analog input channel.
 
+        In continuous mode (see :attr:`continuous`), the samples array is
+        split into two halves, each holding ``sample_count / 2`` consecutive
+        samples for each channel, and a major loop interrupt is triggered each
+        time a half is filled.  Each half is therefore contiguous in device
+        memory and can be streamed to the host as a single block.
+
         See also
         --------
         :meth:`allocate_device_arrays`
@@ -456,56 +510,52 @@ class AdcSampler(object):
 
         :meth:`configure_dma_channel_adc_conversion`
         '''
-        # Create Transfer Control Descriptor configuration for first chunk, encoded
-        # as a Protocol Buffer message.
-        tcd0_msg = DMA.TCD(CITER_ELINKNO=DMA.R_TCD_ITER_ELINKNO(ITER=1),
-                           BITER_ELINKNO=DMA.R_TCD_ITER_ELINKNO(ITER=1),
-                           ATTR=DMA.R_TCD_ATTR(SSIZE=DMA.R_TCD_ATTR._16_BIT,
-                                               DSIZE=DMA.R_TCD_ATTR._16_BIT),
-                           # N=analog input channels * sizeof(uint16_t)
-                           NBYTES_MLNO=self.N,
-                           SADDR=int(self.allocs.scan_result),
-                           SOFF=2,
-                           SLAST=-self.N,
-                           DADDR=int(self.allocs.samples),
-                           DOFF=2 * self.sample_count,
-                           DLASTSGA=int(self.tcd_addrs[1]),
-                           CSR=DMA.R_TCD_CSR(START=0, DONE=False, ESG=True))
-
-        # Convert Protocol Buffer encoded TCD to bytes structure (see
-        # `TCD_RECORD_DTYPE`).
-        tcd0 = self.proxy().tcd_msg_to_struct(tcd0_msg)
-
-        # Create binary TCD struct for each TCD protobuf message and copy to
-        # device memory.
-        for i in range(self.sample_count):
-            tcd_i = tcd0.copy()
-            # Copy from `scan_result` array.
-            tcd_i['SADDR'] = self.allocs.scan_result
-            # Perform strided copy to next available `samples` location for
-            # each analog input channel.
-            tcd_i['DADDR'] = self.allocs.samples + 2 * i
-            # After copying is finished, load Transfer Control Descriptor for
-            # next sample scan.
-            tcd_i['DLASTSGA'] = self.tcd_addrs[(i + 1)
-                                               % len(self.tcd_addrs)]
-            tcd_i['CSR'] |= (1 << 4)
-            if i == (self.sample_count - 1):
-                # Last sample, so trigger major loop interrupt
-                tcd_i['CSR'] |= (1 << 1)  # Set `INTMAJOR` (21.3.29/426)
-            # Copy TCD for sample number `i` to device.
-            self.proxy().mem_cpy_host_to_device(self.tcd_addrs[i],
-                                                tcd_i.tostring())
+        # Number of samples per channel in each contiguous block of the
+        # samples array.
+        block_samples = self.block_sample_count
+
+        # Create Transfer Control Descriptor for first chunk (encoded on the
+        # host, see `TCD_DTYPE`).
+        tcd0 = tcd_record(ITER=1,
+                          SSIZE=TCD_SIZE_16_BIT, DSIZE=TCD_SIZE_16_BIT,
+                          # N=analog input channels * sizeof(uint16_t)
+                          NBYTES=self.N,
+                          SADDR=int(self.allocs.scan_result),
+                          SOFF=2,
+                          SLAST=-self.N,
+                          DADDR=int(self.allocs.samples),
+                          DOFF=2 * block_samples,
+                          DLASTSGA=int(self.tcd_addrs[1]),
+                          ESG=True)
+
+        # Create binary TCD struct for each scan.  TCDs are contiguous in
+        # device memory (see `allocate_device_arrays`), so copy them to the
+        # device in a single pipelined bulk write.
+        tcds = np.repeat(tcd0.ravel(), self.sample_count)
+        block_i, sample_i = divmod(np.arange(self.sample_count),
+                                   block_samples)
+        # Copy from `scan_result` array.
+        tcds['SADDR'] = self.allocs.scan_result
+        # Perform strided copy to next available `samples` location for each
+        # analog input channel (within the current block).
+        tcds['DADDR'] = (self.allocs.samples + block_i * block_samples *
+                         self.N + 2 * sample_i)
+        # After copying is finished, load Transfer Control Descriptor for next
+        # sample scan.
+        tcds['DLASTSGA'] = np.roll(self.tcd_addrs, -1)
+        tcds['CSR'] |= (1 << 4)
+        # Last sample of each block, so trigger major loop interrupt.
+        tcds['CSR'][sample_i == (block_samples - 1)] |= (1 << 1)  # `INTMAJOR`
+        self.proxy().mem_write_bulk(self.tcd_addrs[0], tcds.view('uint8'))
+        self.tcd0 = tcd0
 
         # Load initial TCD in scatter chain to DMA channel chosen to handle
         # scattering.
-        self.proxy().mem_cpy_host_to_device(self.hw_tcd_addrs
-                                            [self.dma_channels.scatter],
-                                            tcd0.tostring())
+        transaction.tcd(self.dma_channels.scatter, tcd0)
         # Attach interrupt handler to scatter DMA channel.
         self.proxy().attach_dma_interrupt(self.dma_channels.scatter)
 
-    def configure_adc(self):
+    def configure_adc(self, transaction):
         '''
         Select ``b`` input for ADC MUX.
 
@@ -527,11 +577,8 @@ class AdcSampler(object):
 
         .. _K20P64M72SF1RM: https://www.pjrc.com/teensy/K20P64M72SF1RM.pdf
         '''
-        import teensy_minimal_rpc.ADC as ADC
-
-        self.proxy().update_adc_registers(
-            self.adc_number,
-            ADC.Registers(CFG2=ADC.R_CFG2(MUXSEL=ADC.R_CFG2.B)))
+        transaction.adc(self.adc_number, 'CFG2', ADC_CFG2_MUXSEL,
+                        mask=ADC_CFG2_MUXSEL)
 
     def configure_timer(self, sample_rate_hz):
         '''
@@ -584,6 +631,20 @@ class AdcSampler(object):
                       | pdb.PDB_SC_LDOK)  # Load all new values
         return PDB_CONFIG
 
+    def configure_stream_packing(self):
+        '''
+        Select the stream encoding of this sampler (see :attr:`pack_bits`) on
+        the device, since the device packs every acquisition block the same
+        way.
+        '''
+        block_size = self.samples_size // (2 if self.continuous else 1)
+        result = self.proxy().stream_packing_configure(self.pack_bits,
+                                                       block_size)
+        if result != 0:
+            raise IOError(ADC_SAMPLER_ERRORS.get(result, 'Error configuring '
+                                                 'stream packing (%d).' %
+                                                 result))
+
     def start_read(self, sample_rate_hz=None, stream_id=0):
         '''
         **TODO** Throw exception if previous read has not completed yet.
@@ -640,11 +701,17 @@ class AdcSampler(object):
         .. _K20P64M72SF1RM: https://www.pjrc.com/teensy/K20P64M72SF1RM.pdf
         '''
         self.proxy().attach_dma_interrupt(self.dma_channels.scatter)
+        # Stop PDB timer once samples array is full.
+        self.proxy().set_dma_isr_actions(self.dma_channels.scatter,
+                                         DMA_ISR_STOP_PDB |
+                                         DMA_ISR_PUSH_EVENT, 0)
         if sample_rate_hz is None and self.sample_rate_hz is None:
             raise ValueError('No cached sampling rate available.  Must specify'
                              ' `sample_rate_hz` (can be omitted on subsequent '
                              'calls).')
         self.sample_rate_hz = sample_rate_hz
+        self.invalidate_tcd_shadow()
+        self.configure_stream_packing()
 
         # Copy configured PDB register state to device hardware register.
         result = self.proxy().start_dma_adc(self.pdb_config,
@@ -655,6 +722,102 @@ class AdcSampler(object):
             raise RuntimeError('Previous DMA ADC operation in progress.')
         return self
 
+    def start_continuous_read(self, sample_rate_hz=None, stream_id=0):
+        '''
+        Start gap-free sampling at the specified sampling rate.
+
+        Sampling continues until :meth:`stop_read` is called.  Each time one
+        half of the device samples array is filled, the device streams the
+        half as a ``STREAM`` packet while the other half is being filled.
+        Use :meth:`get_results_async` to collect the streamed blocks.
+
+        If the host falls behind, the device drops blocks rather than
+        streaming overwritten data.  The number of dropped samples (summed
+        over all channels, i.e., divide by the number of channels for the
+        count per channel) is available through the ``dma_overrun_count()``
+        RPC.
+
+        Parameters
+        ----------
+        sample_rate_hz : int, optional
+            Sample rate in Hz.
+
+            If not specified, use ``sample_rate_hz`` setting from previous call.
+        stream_id : int, optional
+            Stream identifier.
+
+        Returns
+        -------
+        AdcSampler
+            Returns reference to ``self`` to enable method call chaining.
+        '''
+        if not self.continuous:
+            raise RuntimeError('Sampler was not configured for continuous '
+                               'mode (see `continuous` argument).')
+        self.proxy().attach_dma_interrupt(self.dma_channels.scatter)
+        # Keep PDB timer running and stream each half as it is filled.
+        self.proxy().set_dma_isr_actions(self.dma_channels.scatter,
+                                         DMA_ISR_PING_PONG |
+                                         DMA_ISR_PUSH_EVENT, 0)
+        if sample_rate_hz is None and self.sample_rate_hz is None:
+            raise ValueError('No cached sampling rate available.  Must specify'
+                             ' `sample_rate_hz` (can be omitted on subsequent '
+                             'calls).')
+        if sample_rate_hz is not None:
+            self.sample_rate_hz = sample_rate_hz
+        self.invalidate_tcd_shadow()
+        self.configure_stream_packing()
+
+        result = self.proxy().start_dma_adc_continuous(self.pdb_config,
+                                                       self.allocs.samples,
+                                                       self.sample_count *
+                                                       self.N, stream_id)
+        if not result:
+            raise RuntimeError('Previous DMA ADC operation in progress.')
+        return self
+
+    def stop_read(self):
+        '''
+        Stop sampling started by :meth:`start_continuous_read`.
+
+        The scatter DMA channel is reloaded with the first Transfer Control
+        Descriptor in the chain, so the next read starts at the beginning of
+        the samples array.
+        '''
+        self.proxy().stop_dma_adc()
+        self.proxy().mem_cpy_host_to_device(self.hw_tcd_addrs
+                                            [self.dma_channels.scatter],
+                                            self.tcd0.tostring())
+
+    def invalidate_tcd_shadow(self):
+        '''
+        Forget shadowed transfer control descriptors of the DMA channels of
+        this sampler, since DMA transfers update them (see
+        :class:`teensy_minimal_rpc.registers.RegisterShadow`).
+        '''
+        for channel_i in self.dma_channels:
+            self.proxy().register_shadow.invalidate(OP_TCD, int(channel_i))
+
+    def _unpack_samples(self, data):
+        '''
+        Parameters
+        ----------
+        data : numpy.ndarray
+            Raw ``uint16`` samples, arranged as one or more contiguous blocks.
+            Each block holds :attr:`scan_width` arrays of
+            :attr:`channel_stride` samples, where the first
+            :attr:`block_sample_count` samples of the first ``len(channels)``
+            arrays are valid.
+
+        Returns
+        -------
+        numpy.ndarray
+            Samples arranged as one row per sample and one column per channel.
+        '''
+        data = data.reshape(-1, self.scan_width, self.channel_stride)
+        data = data[:, :len(self.channels), :self.block_sample_count]
+        return np.concatenate(data, axis=1).T
+
     def get_results(self):
         '''
         Returns
@@ -670,15 +833,22 @@ class AdcSampler(object):
             **TODO** Provide mechanism to poll status of previously started
             read.
         '''
-        data = self.proxy().mem_cpy_device_to_host(self.allocs.samples,
-                                                   self.sample_count * self.N)
-        df_adc_results = pd.DataFrame(data.view('uint16')
-                                      .reshape(-1, self.sample_count).T,
+        # Read whole samples array with a single request (streamed in
+        # chunks).
+        data = self.proxy().mem_read_stream(int(self.allocs.samples),
+                                            self.samples_size)
+        df_adc_results = pd.DataFrame(self._unpack_samples(data
+                                                           .view('uint16')),
                                       columns=self.channels)
         return df_adc_results
 
     def get_results_async(self, timeout_s=None):
         '''
+        Parameters
+        ----------
+        timeout_s : float, optional
+            Maximum time to wait for a streamed result.
+
         Returns
         -------
         pandas.DataFrame
@@ -686,37 +856,37 @@ class AdcSampler(object):
             input channel, indexed by:
 
              - ADC DMA stream identifier (i.e., ``stream_id``).
-             - Measurement timestamp.
+             - Measurement timestamp, based on the device time each block
+               was completed (see ``sync_device_clock()`` proxy method).
 
         Notes
         -----
-            **Does not guarantee result is ready!**
+            Blocks until at least one complete block has been reassembled
+            from the device stream (or until ``timeout_s`` elapses).
         '''
-        stream_queue = self.proxy()._packet_watcher.queues.stream
         frames = []
 
-        start_time = dt.datetime.now()
-        while stream_queue.qsize() < 1:
-            if (timeout_s is not None and (timeout_s <
-                                           (dt.datetime.now() -
-                                            start_time).total_seconds())):
-                raise IOError('Timed out waiting for streamed result.')
-
-        # At least one packet is available in the ADC stream queue.
-        packet_count = stream_queue.qsize()
-        for i in range(packet_count):
-            datetime_i, packet_i = stream_queue.get_nowait()
+        proxy = self.proxy()
+        # Reassemble blocks from chunked stream packets.
+        for datetime_i, stream_id_i, block_i, timestamp_i in \
+                proxy.read_stream_blocks(timeout_s=timeout_s):
+            samples_i = self._unpack_samples(unpack_samples(block_i,
+                                                            self.pack_bits))
+            if timestamp_i:
+                # Device time of last sample in block (captured by DMA
+                # completion interrupt).
+                end_i = proxy.device_time_to_datetime(timestamp_i)
+                datetime_i = end_i - dt.timedelta(seconds=
+                                                  (samples_i.shape[0] - 1) /
+                                                  self.sample_rate_hz)
             datetimes_i = [datetime_i + dt.timedelta(seconds=t_j)
-                           for t_j in np.arange(self.sample_count) *
+                           for t_j in np.arange(samples_i.shape[0]) *
                            1. / self.sample_rate_hz]
-            df_adc_results_i = pd.DataFrame(np.fromstring(packet_i.data(),
-                                                          dtype='uint16')
-                                            .reshape(-1, self.sample_count).T,
-                                            columns=self.channels,
+            df_adc_results_i = pd.DataFrame(samples_i, columns=self.channels,
                                             index=datetimes_i)
             df_adc_results_i.index.name = 'timestamp'
             # Mark the frame with the corresponding stream identifier.
-            df_adc_results_i.insert(0, 'stream_id', packet_i.iuid)
+            df_adc_results_i.insert(0, 'stream_id', stream_id_i)
             frames.append(df_adc_results_i)
         return (pd.concat(frames).set_index('stream_id', append=True)
                 .reorder_levels(['stream_id', 0]))
@@ -726,6 +896,271 @@ class AdcSampler(object):
         self.allocs[['sc1as', 'tcds']].map(self.proxy().mem_aligned_free)
 
 
+# Error codes returned by `adc_sampler_configure()` RPC.
+ADC_SAMPLER_ERRORS = {-1: 'Invalid sampler arguments.',
+                      -2: 'Sample rate out of range.',
+                      -3: 'Device memory allocation failed.',
+                      -4: 'Continuous DMA ADC operation in progress.'}
+
+
+class DeviceAdcSampler(AdcSampler):
+    '''
+    Same as :class:`AdcSampler`, but the ADC, programmable delay block, and
+    DMA channels are configured by the device (see ``adc_sampler_configure()``
+    RPC) using a **single RPC**, rather than one RPC per register and Transfer
+    Control Descriptor.
+
+    Parameters
+    ----------
+    proxy : teensy_minimal_rpc.proxy.Proxy
+    channels : list
+        List of labels of analog channels to measure (e.g., ``['A0', 'A3',
+        'A1']``).
+    sample_count : int
+        Number of samples to measure from each channel during each read
+        operation.
+    sample_rate_hz : int
+        Sample rate in Hz.
+    dma_channels : list,optional
+        List of identifiers of DMA channels to use (default=``[0, 1, 2]``).
+    adc_number : int
+        Identifier of ADC to use (default=:data:`teensy.ADC_0`)
+    continuous : bool, optional
+        If ``True``, split the sample buffer into two halves (i.e., a
+        ping-pong buffer) for gap-free streaming using
+        :meth:`start_continuous_read` (default=``False``).
+    pack_bits : int, optional
+        Bits per sample of streamed results (see :class:`AdcSampler`).
+
+    Notes
+    -----
+        The device holds a single sampler configuration, so creating a new
+        :class:`DeviceAdcSampler` replaces any previous one.
+    '''
+    def __init__(self, proxy, channels, sample_count, sample_rate_hz,
+                 dma_channels=None, adc_number=teensy.ADC_0,
+                 continuous=False, pack_bits=16):
+        self._init_params(proxy, channels, sample_count, dma_channels,
+                          adc_number, continuous, pack_bits)
+        # Calculate total number of bytes for single scan of ADC channels.
+        self.N = np.dtype('uint16').itemsize * self.channel_sc1as.size
+
+        dma_channels = np.array([self.dma_channels.scatter,
+                                 self.dma_channels.adc_channel_configs,
+                                 self.dma_channels.adc_conversion],
+                                dtype='uint8')
+        result = self.proxy().adc_sampler_configure(self.channel_sc1as
+                                                    .astype('uint8'),
+                                                    sample_count,
+                                                    sample_rate_hz,
+                                                    adc_number, dma_channels,
+                                                    continuous)
+        if result != 0:
+            raise IOError(ADC_SAMPLER_ERRORS.get(result, 'Error configuring '
+                                                 'ADC sampler (%d).' % result))
+        self._sample_rate_hz = sample_rate_hz
+        self.allocs = pd.Series({'samples':
+                                 self.proxy().adc_sampler_samples_addr()})
+        # The device de-interleaves scans using a single DMA transfer control
+        # descriptor per block, which may pad the scan width and the distance
+        # between channel arrays.
+        self.scan_width = self.proxy().adc_sampler_scan_width()
+        self.channel_stride = self.proxy().adc_sampler_channel_stride()
+
+    @property
+    def sample_rate_hz(self):
+        return self._sample_rate_hz
+
+    @sample_rate_hz.setter
+    def sample_rate_hz(self, value):
+        if self.sample_rate_hz != value:
+            result = self.proxy().adc_sampler_set_sample_rate(value)
+            if result != 0:
+                raise IOError(ADC_SAMPLER_ERRORS.get(result, 'Error setting '
+                                                     'sample rate (%d).' %
+                                                     result))
+            self._sample_rate_hz = value
+
+    def start_read(self, sample_rate_hz=None, stream_id=0):
+        '''
+        Trigger start of ADC sampling.
+
+        Parameters
+        ----------
+        sample_rate_hz : int, optional
+            Sample rate in Hz.
+
+            If not specified, use current sample rate.
+        stream_id : int, optional
+            Stream identifier.
+
+        Returns
+        -------
+        DeviceAdcSampler
+            Returns reference to ``self`` to enable method call chaining.
+        '''
+        if sample_rate_hz is not None:
+            self.sample_rate_hz = sample_rate_hz
+        self.configure_stream_packing()
+        if not self.proxy().adc_sampler_start(stream_id):
+            raise RuntimeError('Previous DMA ADC operation in progress.')
+        return self
+
+    def start_continuous_read(self, sample_rate_hz=None, stream_id=0):
+        '''
+        Start gap-free sampling (see :meth:`AdcSampler.start_continuous_read`).
+        '''
+        if not self.continuous:
+            raise RuntimeError('Sampler was not configured for continuous '
+                               'mode (see `continuous` argument).')
+        return self.start_read(sample_rate_hz=sample_rate_hz,
+                               stream_id=stream_id)
+
+    def stop_read(self):
+        self.proxy().adc_sampler_stop()
+
+    def __del__(self):
+        proxy = self.proxy()
+        if proxy is not None:
+            proxy.adc_sampler_free()
+
+
+class DualAdcSampler(AdcSampler):
+    '''
+    Sample pairs of analog input channels **simultaneously** using ADC0 and
+    ADC1 (see ``dual_adc_sampler_configure()`` RPC).
+
+    Both ADCs are triggered by the programmable delay block at the same
+    instant, so each pair of channels is sampled at the same time (e.g., for
+    phase measurements), and the aggregate conversion rate is doubled.
+
+    Parameters
+    ----------
+    proxy : teensy_minimal_rpc.proxy.Proxy
+    adc0_channels : list
+        List of labels of analog channels to measure using ADC0 (e.g.,
+        ``['A0', 'A1']``).
+    adc1_sc1as : list
+        ``ADC1_SC1A`` channel number to measure using ADC1, one for each
+        channel in :data:`adc0_channels` (see **ADC1 Channel Assignment**
+        section in `K20P64M72SF1RM`_ manual).
+    sample_count : int
+        Number of samples to measure from each channel during each read
+        operation.
+    sample_rate_hz : int
+        Sample rate in Hz (per channel pair).
+    dma_channels : list,optional
+        List of identifiers of DMA channels to use (default=``[0, 1, 2,
+        3]``).
+    continuous : bool, optional
+        If ``True``, split the sample buffer into two halves for gap-free
+        streaming using :meth:`start_continuous_read` (default=``False``).
+    pack_bits : int, optional
+        Bits per sample of streamed results (see :class:`AdcSampler`).
+
+    .. _K20P64M72SF1RM: https://www.pjrc.com/teensy/K20P64M72SF1RM.pdf
+    '''
+    def __init__(self, proxy, adc0_channels, adc1_sc1as, sample_count,
+                 sample_rate_hz, dma_channels=None, continuous=False,
+                 pack_bits=16):
+        if dma_channels is None:
+            dma_channels = pd.Series([0, 1, 2, 3],
+                                     index=['adc0_conversion',
+                                            'adc1_conversion',
+                                            'adc0_channel_configs',
+                                            'adc1_channel_configs'])
+        self._init_params(proxy, adc0_channels, sample_count, dma_channels,
+                          None, continuous, pack_bits)
+        self.adc1_sc1as = np.array(adc1_sc1as, dtype='uint8')
+        if self.adc1_sc1as.size != self.channel_sc1as.size:
+            raise ValueError('One ADC1 channel is required for each ADC0 '
+                             'channel.')
+        # Label ADC1 columns by channel number.
+        self.channels = (np.column_stack([self.channels,
+                                          ['ADC1_%d' % c
+                                           for c in self.adc1_sc1as]])
+                         .ravel().tolist())
+        # Calculate total number of bytes for single scan of ADC channels.
+        self.N = np.dtype('uint16').itemsize * len(self.channels)
+        self._sample_rate_hz = None
+        self.sample_rate_hz = sample_rate_hz
+        self.allocs = pd.Series({'samples':
+                                 self.proxy().dual_adc_sampler_samples_addr()})
+
+    @property
+    def sample_rate_hz(self):
+        return self._sample_rate_hz
+
+    @sample_rate_hz.setter
+    def sample_rate_hz(self, value):
+        if self.sample_rate_hz != value:
+            dma_channels = np.array([self.dma_channels.adc0_conversion,
+                                     self.dma_channels.adc1_conversion,
+                                     self.dma_channels.adc0_channel_configs,
+                                     self.dma_channels.adc1_channel_configs],
+                                    dtype='uint8')
+            proxy = self.proxy()
+            result = proxy.dual_adc_sampler_configure(self.channel_sc1as
+                                                      .astype('uint8'),
+                                                      self.adc1_sc1as,
+                                                      self.sample_count,
+                                                      value, dma_channels,
+                                                      self.continuous)
+            if result != 0:
+                raise IOError(ADC_SAMPLER_ERRORS.get(result, 'Error '
+                                                     'configuring dual ADC '
+                                                     'sampler (%d).' %
+                                                     result))
+            self._sample_rate_hz = value
+
+    @property
+    def samples_size(self):
+        return self.sample_count * self.N
+
+    def _unpack_samples(self, data):
+        '''
+        Parameters
+        ----------
+        data : numpy.ndarray
+            Raw ``uint16`` samples, one interleaved row of ADC0/ADC1 results
+            for each sample.
+
+        Returns
+        -------
+        numpy.ndarray
+            Samples arranged as one row per sample and one column per channel
+            (ADC0 and ADC1 channels of each pair in consecutive columns).
+        '''
+        return data.reshape(-1, len(self.channels))
+
+    def start_read(self, sample_rate_hz=None, stream_id=0):
+        '''
+        Trigger start of simultaneous ADC0/ADC1 sampling (see
+        :meth:`DeviceAdcSampler.start_read`).
+        '''
+        if sample_rate_hz is not None:
+            self.sample_rate_hz = sample_rate_hz
+        self.configure_stream_packing()
+        if not self.proxy().dual_adc_sampler_start(stream_id):
+            raise RuntimeError('Previous DMA ADC operation in progress.')
+        return self
+
+    def start_continuous_read(self, sample_rate_hz=None, stream_id=0):
+        if not self.continuous:
+            raise RuntimeError('Sampler was not configured for continuous '
+                               'mode (see `continuous` argument).')
+        return self.start_read(sample_rate_hz=sample_rate_hz,
+                               stream_id=stream_id)
+
+    def stop_read(self):
+        self.proxy().dual_adc_sampler_stop()
+
+    def __del__(self):
+        proxy = self.proxy()
+        if proxy is not None:
+            proxy.dual_adc_sampler_free()
+
+
 class AdcDmaMixin(object):
     '''
     This mixin class implements DMA-enabled analog-to-digital converter (ADC)
@@ -897,6 +1332,29 @@ class AdcDmaMixin(object):
         self.mem_cpy_host_to_device(HW_TCDS_ADDR, tcd_struct.tostring())
         return TCD.FromString(self.read_dma_TCD(0).tostring())
 
+    def adc_library_call(self, name, adc_num, value):
+        '''
+        Call Teensy ADC library setter ``name`` (e.g., ``'setResolution'``)
+        with ``value`` for ADC ``adc_num``, unless the same value was set
+        since the register shadow was last discarded (see
+        :attr:`register_shadow`).
+
+        The library modifies ADC registers (e.g., during calibration), so
+        the device clears the register transaction token when the setter is
+        called, and the register shadow is discarded.  Library calls (i.e.,
+        the last value set with each setter) are kept, so repeated calls are
+        skipped again once the next transaction has applied a new token.
+        '''
+        shadow = self.register_shadow
+        key = (name, adc_num)
+        if shadow.token is not None and shadow.calls.get(key) == value:
+            return
+        getattr(self, name)(value, adc_num)
+        calls = dict(shadow.calls)
+        shadow.invalidate()
+        calls[key] = value
+        shadow.calls = calls
+
     def analog_reads_config(self, adc_channels, sample_count,
                             resolution=None, average_count=1,
                             sampling_rate_hz=None, differential=False,
@@ -921,8 +1379,9 @@ class AdcDmaMixin(object):
                *must* be used when operating in differential (as opposed to
                singled-ended) mode.
 
-         - :meth:`update_adc_registers` (C++)
-             * Apply ADC ``CFG*`` register settings.
+         - :meth:`apply_register_transaction`
+             * Apply ADC ``CFG*`` register settings (skipping registers
+               that already hold them).
 
                ADC ``CFG*`` register settings are determined by:
 
@@ -993,10 +1452,6 @@ class AdcDmaMixin(object):
             method may be called to fetch results from a previously
             initiated read operation.
         '''
-        # XXX Import here, since importing at top of file seems to cause a
-        # cyclic import error when importing `__init__`.
-        import teensy_minimal_rpc.ADC as ADC
-
         # Select ADC settings to achieve minimum conversion rate for
         # specified resolution, mode (i.e., single-ended or differential),
         # and number of samples to average per conversion (i.e., average
@@ -1052,17 +1507,10 @@ class AdcDmaMixin(object):
         if resolution is None:
             resolution = int(adc_settings['Bit-width'])
 
-        # Set the reference voltage based on whether or not differential is
-        # selected.
-        if differential:
-            # On the Teensy 3.2 architecture, the 1.2V reference voltage
-            # *must* be used when operating in differential (as opposed to
-            # singled-ended) mode.
-            self.setReference(teensy.ADC_REF_1V2, adc_num)
-            reference_V = 1.2
-        else:
-            self.setReference(teensy.ADC_REF_3V3, adc_num)
-            reference_V = 3.3
+        # On the Teensy 3.2 architecture, the 1.2V reference voltage *must* be
+        # used when operating in differential (as opposed to singled-ended)
+        # mode.
+        reference_V = 1.2 if differential else 3.3
 
         adc_settings['reference_V'] = reference_V
         adc_settings['resolution'] = resolution
@@ -1072,36 +1520,39 @@ class AdcDmaMixin(object):
         assert(gain_power >= 0 and gain_power < 8)
         adc_settings['gain_power'] = int(gain_power)
 
-        # Construct a Protocol Buffer message according to the selected ADC
-        # configuration settings.
-        adc_registers = \
-            ADC.Registers(CFG2=
-                          ADC.R_CFG2(MUXSEL=ADC.R_CFG2.B,
-                                     ADACKEN=
-                                     int(adc_settings['CFG2[ADACKEN]']),
-                                     ADLSTS=
-                                     int(adc_settings['CFG2[ADLSTS]']),
-                                     ADHSC=
-                                     int(adc_settings['CFG2[ADHSC]'])),
-                          CFG1=
-                          ADC.R_CFG1(ADLSMP=
-                                     int(adc_settings['CFG1[ADLSMP]']),
-                                     ADICLK=
-                                     int(adc_settings['CFG1[ADICLK]']),
-                                     ADIV=
-                                     int(adc_settings['CFG1[ADIV]'])))
+        # Write the selected ADC configuration settings in a single register
+        # transaction, skipping registers that already hold them.
+        transaction = RegisterTransaction()
+        transaction.adc(adc_num, 'CFG1',
+                        (int(adc_settings['CFG1[ADLSMP]']) << 4) |
+                        (int(adc_settings['CFG1[ADIV]']) << 5) |
+                        int(adc_settings['CFG1[ADICLK]']),
+                        mask=ADC_CFG1_ADLSMP | ADC_CFG1_ADIV |
+                        ADC_CFG1_ADICLK)
+        transaction.adc(adc_num, 'CFG2',
+                        ADC_CFG2_MUXSEL |
+                        (int(adc_settings['CFG2[ADACKEN]']) << 3) |
+                        (int(adc_settings['CFG2[ADHSC]']) << 2) |
+                        int(adc_settings['CFG2[ADLSTS]']),
+                        mask=ADC_CFG2_MUXSEL | ADC_CFG2_ADACKEN |
+                        ADC_CFG2_ADHSC | ADC_CFG2_ADLSTS)
         if enabled_programmable_gain:
-            adc_registers.PGA.PGAG = adc_settings.gain_power
-            adc_registers.PGA.PGAEN = True
-
-        # Apply ADC `CFG*` register settings.
-        self.update_adc_registers(adc_num, adc_registers)
-
-        # Apply non-`CFG*` ADC settings using Teensy ADC library API.
-        # We use the Teensy API here because it handles calibration, etc.
-        # automatically.
-        self.setAveraging(average_count, adc_num)
-        self.setResolution(resolution, adc_num)
+            transaction.adc(adc_num, 'PGA',
+                            ADC_PGA_PGAEN | (adc_settings.gain_power << 16),
+                            mask=ADC_PGA_PGAEN | ADC_PGA_PGAG)
+        # **N.B.,** Applied before the Teensy ADC library calls below, since
+        # the transaction discards the shadow (including the library calls)
+        # if the device was reset.
+        self.apply_register_transaction(transaction)
+
+        # Apply reference and non-`CFG*` ADC settings using Teensy ADC library
+        # API.  We use the Teensy API here because it handles calibration,
+        # etc. automatically.
+        self.adc_library_call('setReference', adc_num,
+                              teensy.ADC_REF_1V2 if differential
+                              else teensy.ADC_REF_3V3)
+        self.adc_library_call('setAveraging', adc_num, average_count)
+        self.adc_library_call('setResolution', adc_num, resolution)
 
         if sampling_rate_hz is None:
             # By default, use a sampling rate that is 90% of the maximum
@@ -1191,13 +1642,7 @@ class AdcDmaMixin(object):
                                      gain_power=gain_power,
                                      adc_num=adc_num)
         adc_sampler.start_read(sample_rate_hz=sample_rate_hz)
-        start_time = dt.datetime.now()
-        while self._packet_watcher.queues.stream.qsize() < 1:
-            if (timeout_s is not None and (timeout_s <
-                                           (dt.datetime.now() -
-                                            start_time).total_seconds())):
-                raise IOError('Timed out waiting for streamed result.')
-        df_adc_results = adc_sampler.get_results_async()
+        df_adc_results = adc_sampler.get_results_async(timeout_s=timeout_s)
         return (sample_rate_hz, adc_settings) + \
             format_adc_results(df_adc_results, adc_settings)
 
@@ -0,0 +1,377 @@
+'''
+Host-side helpers for on-device profiling (see ``IsrProfiler`` and
+``RpcProfiler`` in ``TeensyMinimalRpc/IsrProfiler.h`` and
+``TeensyMinimalRpc/RpcProfiler.h``).
+'''
+from __future__ import absolute_import
+from __future__ import division
+
+import time
+import zlib
+
+import numpy as np
+import pandas as pd
+
+from .stream import decode_rice_block
+
+
+#: Header of ``profile_stats()`` table (see ``LoopProfile``).
+LOOP_PROFILE_DTYPE = np.dtype([('elapsed_cycles', '<u8'),
+                               ('loop_total_cycles', '<u8'),
+                               ('loop_count', '<u4'),
+                               ('loop_max_cycles', '<u4'),
+                               ('rx_bytes', '<u4'),
+                               ('tx_bytes', '<u4'),
+                               ('stream_bytes', '<u4'),
+                               ('command_count', '<u2'),
+                               ('dropped_commands', '<u2')])
+#: Record of ``profile_stats()`` table (see ``CommandProfile``).
+COMMAND_PROFILE_DTYPE = np.dtype([('command', '<u2'),
+                                  ('reserved', '<u2'),
+                                  ('count', '<u4'),
+                                  ('total_cycles', '<u8'),
+                                  ('max_cycles', '<u4'),
+                                  ('request_bytes', '<u4'),
+                                  ('response_bytes', '<u4')])
+
+
+def parse_profile_stats(data):
+    '''
+    Parameters
+    ----------
+    data : str or numpy.ndarray
+        Table returned by ``profile_stats()`` RPC.
+
+    Returns
+    -------
+    loop : numpy.void
+        Main loop and serial statistics (see :data:`LOOP_PROFILE_DTYPE`).
+    commands : numpy.ndarray
+        Per-command statistics (see :data:`COMMAND_PROFILE_DTYPE`).
+    '''
+    data = np.asarray(data, dtype='uint8').tostring()
+    header_size = LOOP_PROFILE_DTYPE.itemsize
+    loop = np.fromstring(data[:header_size], dtype=LOOP_PROFILE_DTYPE)[0]
+    commands = np.fromstring(data[header_size:header_size +
+                                  loop['command_count'] *
+                                  COMMAND_PROFILE_DTYPE.itemsize],
+                             dtype=COMMAND_PROFILE_DTYPE)
+    return loop, commands
+
+
+def log2_bucket_edges(bucket_count=32):
+    '''
+    Parameters
+    ----------
+    bucket_count : int, optional
+        Number of log2 histogram buckets.
+
+    Returns
+    -------
+    numpy.ndarray
+        Lower bound (in cycles, inclusive) of each bucket, i.e., ``0`` for
+        bucket 0 and ``2 ** (b - 1)`` for bucket ``b``.
+    '''
+    edges = np.zeros(bucket_count, dtype='uint64')
+    edges[1:] = 2 ** np.arange(bucket_count - 1, dtype='uint64')
+    return edges
+
+
+class ProfileMixin(object):
+    '''
+    This mixin class adds helpers to read on-device interrupt handler timing
+    histograms.
+    '''
+    def isr_labels(self):
+        '''
+        Returns
+        -------
+        list
+            Label of each profiled interrupt handler, in device index order.
+        '''
+        count = self.isr_profiler_size()
+        return (['dma_ch%d' % i for i in range(count - 2)] +
+                ['adc0', 'adc1'])
+
+    def isr_histograms(self, nonzero=True):
+        '''
+        Read interrupt handler entry interval and duration histograms.
+
+        Parameters
+        ----------
+        nonzero : bool, optional
+            If ``True``, only include handlers that have been recorded at
+            least once.
+
+        Returns
+        -------
+        pandas.DataFrame
+            Table indexed by ``isr`` and ``bucket_cycles`` (lower bound of
+            log2 bucket, in CPU cycles), with ``interval`` and ``duration``
+            counts, plus ``interval_us`` and ``duration_us`` (bucket lower
+            bound in microseconds).
+
+        See also
+        --------
+        isr_stats
+        '''
+        f_cpu = float(self.cpu_frequency())
+        frames = []
+        for index, label in enumerate(self.isr_labels()):
+            count, max_duration = self.isr_profile_stats(index)
+            if nonzero and count == 0:
+                continue
+            interval = np.asarray(self.isr_interval_histogram(index))
+            duration = np.asarray(self.isr_duration_histogram(index))
+            edges = log2_bucket_edges(len(interval))
+            frames.append(pd.DataFrame({'isr': label,
+                                        'bucket_cycles': edges,
+                                        'interval': interval,
+                                        'duration': duration,
+                                        'interval_us': edges * 1e6 / f_cpu,
+                                        'duration_us': edges * 1e6 /
+                                        f_cpu}))
+        if not frames:
+            return pd.DataFrame(columns=['interval', 'duration',
+                                         'interval_us', 'duration_us'])
+        return (pd.concat(frames).set_index(['isr', 'bucket_cycles'])
+                [['interval', 'duration', 'interval_us', 'duration_us']])
+
+    def isr_stats(self):
+        '''
+        Returns
+        -------
+        pandas.DataFrame
+            Table indexed by ``isr``, with number of recorded entries
+            (``count``) and maximum duration (``max_duration_cycles``,
+            ``max_duration_us``) of each interrupt handler.
+        '''
+        f_cpu = float(self.cpu_frequency())
+        labels = self.isr_labels()
+        stats = np.array([self.isr_profile_stats(i)
+                          for i in range(len(labels))], dtype='uint32')
+        df_stats = pd.DataFrame(stats, index=pd.Index(labels, name='isr'),
+                                columns=['count', 'max_duration_cycles'])
+        df_stats['max_duration_us'] = (df_stats['max_duration_cycles'] * 1e6
+                                       / f_cpu)
+        return df_stats
+
+    def rpc_profile(self):
+        '''
+        Read main loop, serial, and per-command RPC statistics (see
+        ``rpc_profiler_enable()``).
+
+        Returns
+        -------
+        loop : pandas.Series
+            Main loop iteration statistics, serial byte counts, and
+            corresponding rates (``rx_bytes_per_s``, ``tx_bytes_per_s``,
+            ``stream_bytes_per_s``) since the last ``rpc_profiler_reset()``.
+        commands : pandas.DataFrame
+            Table indexed by ``command`` code, sorted by descending
+            ``total_us``.
+        '''
+        f_cpu = float(self.cpu_frequency())
+        loop, commands = parse_profile_stats(self.profile_stats())
+        loop = pd.Series(dict(zip(loop.dtype.names, map(int, loop))))
+        elapsed_s = loop['elapsed_cycles'] / f_cpu
+        for name in ('rx_bytes', 'tx_bytes', 'stream_bytes'):
+            loop[name + '_per_s'] = (loop[name] / elapsed_s if elapsed_s > 0
+                                     else np.nan)
+        if loop['loop_count'] > 1:
+            loop['loop_mean_us'] = (loop['loop_total_cycles'] * 1e6 / f_cpu /
+                                    (loop['loop_count'] - 1))
+        loop['loop_max_us'] = loop['loop_max_cycles'] * 1e6 / f_cpu
+
+        df_commands = (pd.DataFrame(commands)
+                       .drop('reserved', axis=1).set_index('command'))
+        df_commands['total_us'] = df_commands['total_cycles'] * 1e6 / f_cpu
+        df_commands['max_us'] = df_commands['max_cycles'] * 1e6 / f_cpu
+        df_commands['mean_us'] = (df_commands['total_us'] /
+                                  df_commands['count'])
+        return loop, df_commands.sort_values('total_us', ascending=False)
+
+    def memory_arena_info(self):
+        '''
+        Returns
+        -------
+        pandas.Series
+            Device memory arena statistics (see ``MemoryArenaStats`` in
+            ``TeensyMinimalRpc/MemoryArena.h``), in bytes, plus
+            ``fragmentation``, i.e., the fraction of the carved part of the
+            arena that is free (i.e., split into free blocks, which are not
+            merged until ``reset_arena()``) or spent on pool block overhead.
+        '''
+        info = pd.Series(self.memory_arena_stats(),
+                         index=['capacity', 'in_use_bytes',
+                                'high_water_bytes', 'bump_bytes',
+                                'free_list_bytes', 'overhead_bytes',
+                                'allocation_count', 'failed_count'])
+        info['fragmentation'] = ((info['free_list_bytes'] +
+                                  info['overhead_bytes']) / info['bump_bytes']
+                                 if info['bump_bytes'] > 0 else 0.)
+        return info
+
+    def crc_benchmark_info(self, size=4096):
+        '''
+        Compare CRC-32 computation on the device in software, with the CRC
+        module fed by the CPU, and with the CRC module fed by DMA (see
+        ``crc_benchmark()``).
+
+        Parameters
+        ----------
+        size : int, optional
+            Number of bytes of random data to compute CRC of.
+
+        Returns
+        -------
+        pandas.DataFrame
+            Table indexed by ``method``, with ``crc``, ``cycles``, ``us``,
+            ``bytes_per_s``, and ``match`` (i.e., ``crc`` is the same as
+            ``zlib.crc32``) columns.
+        '''
+        data = np.random.randint(256, size=size).astype('uint8')
+        address = self.mem_alloc(size)
+        try:
+            self.mem_write_bulk(address, data)
+            results = np.asarray(self.crc_benchmark(address, size),
+                                 dtype='uint32').reshape(-1, 2)
+        finally:
+            self.mem_free(address)
+        f_cpu = float(self.cpu_frequency())
+        df_crc = pd.DataFrame(results, columns=['crc', 'cycles'],
+                              index=pd.Index(['software', 'crc_cpu',
+                                              'crc_dma'], name='method'))
+        # Zero cycles: DMA memory engine not available.
+        df_crc['us'] = (df_crc['cycles'] * 1e6 / f_cpu).where(df_crc['cycles']
+                                                              > 0)
+        df_crc['bytes_per_s'] = size / (df_crc['us'] * 1e-6)
+        df_crc['match'] = df_crc['crc'] == (zlib.crc32(data.tostring()) &
+                                            0xFFFFFFFF)
+        return df_crc
+
+    def rms_benchmark_info(self, sizes=None, signed=False):
+        '''
+        Time on-device RMS computation with the scalar ``float`` loops, the
+        portable single-pass kernel, and the Cortex-M4 ``SMLALD`` single-pass
+        kernel (see ``rms_benchmark()``).
+
+        Parameters
+        ----------
+        sizes : list, optional
+            Block sizes (in samples) to time.  By default, powers of two from
+            16 to 8192.
+        signed : bool, optional
+            If ``True``, time ``int16`` samples.  Otherwise, time ``uint16``
+            samples.
+
+        Returns
+        -------
+        pandas.DataFrame
+            Table indexed by ``size``, ``variant``, and ``function`` (i.e.,
+            ``mean_sub_rms`` or ``rms``), with ``result``, ``cycles``,
+            ``cycles_per_sample``, and ``error`` (i.e., relative to
+            ``numpy``) columns.
+        '''
+        if sizes is None:
+            sizes = 2 ** np.arange(4, 14)
+        dtype = 'int16' if signed else 'uint16'
+        info = np.iinfo(dtype)
+        frames = []
+        for size in sizes:
+            data = np.random.randint(info.min, info.max + 1,
+                                     size=size).astype(dtype)
+            address = self.mem_alloc(data.nbytes)
+            try:
+                self.mem_write_bulk(address, data.view('uint8'))
+                results = np.asarray(self.rms_benchmark(address, size,
+                                                        signed),
+                                     dtype='uint32').reshape(-1, 2)
+            finally:
+                self.mem_free(address)
+            index = pd.MultiIndex.from_product([[size], ['float', 'portable',
+                                                         'smlald'],
+                                                ['mean_sub_rms', 'rms']],
+                                               names=['size', 'variant',
+                                                      'function'])
+            df_i = pd.DataFrame({'result': results[:, 0].view('float32'),
+                                 'cycles': results[:, 1]}, index=index,
+                                columns=['result', 'cycles'])
+            data = data.astype(float)
+            expected = np.tile([np.sqrt(np.mean((data - data.mean()) ** 2)),
+                                np.sqrt(np.mean(data ** 2))], 3)
+            df_i['error'] = (df_i['result'] - expected).abs() / expected
+            frames.append(df_i)
+        df_rms = pd.concat(frames)
+        # Zero cycles: `SMLALD` not available.
+        df_rms['cycles'] = df_rms['cycles'].where(df_rms['cycles'] > 0)
+        df_rms['error'] = df_rms['error'].where(df_rms['cycles'] > 0)
+        df_rms['cycles_per_sample'] = (df_rms['cycles'] /
+                                       df_rms.index.get_level_values('size'))
+        return df_rms
+
+    def rice_benchmark_info(self, samples=None, partition_sizes=None):
+        '''
+        Time on-device Rice coding of a block (see ``rice_benchmark()``)
+        against host decoding of the coded block (see
+        :func:`teensy_minimal_rpc.stream.decode_rice_block`).
+
+        Rice coding is left disabled afterwards.
+
+        Parameters
+        ----------
+        samples : numpy.ndarray, optional
+            ``uint16`` samples, one row per channel.  By default, a noisy
+            sine wave of 4096 samples.
+        partition_sizes : list, optional
+            Partition sizes to time.  By default, powers of two from 16 to
+            256.
+
+        Returns
+        -------
+        pandas.DataFrame
+            Table indexed by ``partition_size``, with ``coded`` (i.e., not
+            sent raw), ``ratio`` (i.e., coded size relative to raw size),
+            ``device_cycles``, ``device_samples_per_s``, ``host_s``,
+            ``host_samples_per_s``, and ``match`` (i.e., decoded samples are
+            the same as ``samples``) columns.
+        '''
+        if samples is None:
+            t = np.arange(4096)
+            samples = (0x8000 + 0x4000 * np.sin(2 * np.pi * t / 512.) +
+                       np.random.randint(-16, 16, size=t.size))
+        samples = np.atleast_2d(samples).astype('uint16')
+        channel_count, sample_count = samples.shape
+        if partition_sizes is None:
+            partition_sizes = 2 ** np.arange(4, 9)
+        f_cpu = float(self.cpu_frequency())
+        rows = []
+        address = self.mem_alloc(samples.nbytes)
+        try:
+            self.mem_write_bulk(address, samples.ravel().view('uint8'))
+            for partition_size in partition_sizes:
+                # Channel-major layout.
+                if self.rice_coding_configure(channel_count, sample_count,
+                                              sample_count, 1,
+                                              partition_size) != 0:
+                    raise ValueError('Failed to configure Rice coding.')
+                raw_size, coded_size, cycles, coded_address = \
+                    self.rice_benchmark(address, samples.nbytes)
+                block = self.mem_read_stream(coded_address,
+                                             coded_size).tostring()
+                start = time.time()
+                header, decoded = decode_rice_block(block)
+                host_s = time.time() - start
+                rows.append([partition_size, bool(header['coded']),
+                             coded_size / raw_size, cycles,
+                             samples.size * f_cpu / cycles, host_s,
+                             samples.size / host_s,
+                             (decoded == samples).all()])
+        finally:
+            self.rice_coding_free()
+            self.mem_free(address)
+        return pd.DataFrame(rows, columns=['partition_size', 'coded', 'ratio',
+                                           'device_cycles',
+                                           'device_samples_per_s', 'host_s',
+                                           'host_samples_per_s', 'match'])\
+            .set_index('partition_size')
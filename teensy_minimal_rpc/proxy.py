@@ -15,6 +15,9 @@ try:
     import arduino_helpers.hardware.teensy as teensy
 
     from .adc_sampler import AdcDmaMixin
+    from .profile import ProfileMixin
+    from .registers import RegistersMixin
+    from .stream import StreamMixin
     from .node import (Proxy as _Proxy, I2cProxy as _I2cProxy,
                        SerialProxy as _SerialProxy)
     from .config import Config
@@ -62,7 +65,8 @@ try:
             return State
 
 
-    class ProxyMixin(ConfigMixin, StateMixin, AdcDmaMixin):
+    class ProxyMixin(ConfigMixin, StateMixin, AdcDmaMixin, StreamMixin,
+                     ProfileMixin, RegistersMixin):
         '''
         Mixin class to add convenience wrappers around methods of the generated
         `node.Proxy` class.
@@ -73,6 +77,7 @@ try:
 
         def __init__(self, *args, **kwargs):
             super(ProxyMixin, self).__init__(*args, **kwargs)
+            self.init_stream()
             self.init_dma()
             logger.debug('Initialized DMA')
 
@@ -0,0 +1,566 @@
+'''
+Host-side decoding of raw register snapshots (see
+``read_dma_registers_raw()``, ``read_dma_TCDs_raw()``,
+``read_adc_registers_raw()``, and ``read_pit_registers_raw()`` RPCs).
+
+Each snapshot is a copy of the register block as-is, decoded with the numpy
+structured dtypes below.  Bit fields are extracted (vectorized) with
+:func:`decode_fields`.
+
+Register writes may be batched in a :class:`RegisterTransaction`, applied by
+the device in a single packet (see
+:meth:`RegistersMixin.apply_register_transaction`).  Writes of values the
+device already holds are skipped using a :class:`RegisterShadow`.
+'''
+from __future__ import absolute_import
+from __future__ import division
+import random
+import struct
+
+import numpy as np
+import pandas as pd
+
+
+#: Transfer control descriptor (see ``DMABaseClass::TCD_t``).
+TCD_DTYPE = np.dtype([('SADDR', '<u4'), ('SOFF', '<i2'), ('ATTR', '<u2'),
+                      ('NBYTES', '<u4'), ('SLAST', '<i4'), ('DADDR', '<u4'),
+                      ('DOFF', '<i2'), ('CITER', '<u2'), ('DLASTSGA', '<i4'),
+                      ('CSR', '<u2'), ('BITER', '<u2')])
+#: DMA controller and DMA mux registers (see ``RegistersSnapshot`` in
+#: ``TeensyMinimalRpc/DMA.h``).
+DMA_REGISTERS_DTYPE = np.dtype([('CR', '<u4'), ('ES', '<u4'), ('ERQ', '<u4'),
+                                ('EEI', '<u4'), ('INT', '<u4'),
+                                ('ERR', '<u4'), ('HRS', '<u4'),
+                                ('DCHPRI', 'u1', 16),
+                                ('MUX_CHCFG', 'u1', 16)])
+#: ADC register file (see ``AdcRegister_t`` in ``TeensyMinimalRpc/ADC.h``).
+#: **N.B.,** ``RA`` and ``RB`` are always 0.
+ADC_REGISTERS_DTYPE = np.dtype([(name, '<u4') for name in
+                                ('SC1A', 'SC1B', 'CFG1', 'CFG2', 'RA', 'RB',
+                                 'CV1', 'CV2', 'SC2', 'SC3', 'OFS', 'PG',
+                                 'MG', 'CLPD', 'CLPS', 'CLP4', 'CLP3',
+                                 'CLP2', 'CLP1', 'CLP0', 'PGA', 'CLMD',
+                                 'CLMS', 'CLM4', 'CLM3', 'CLM2', 'CLM1',
+                                 'CLM0')])
+#: PIT registers.
+PIT_REGISTERS_DTYPE = np.dtype([('MCR', '<u4'),
+                                ('TIMERS', [('LDVAL', '<u4'),
+                                            ('CVAL', '<u4'),
+                                            ('TCTRL', '<u4'),
+                                            ('TFLG', '<u4')], 4)])
+
+#: Bit fields, i.e., ``name: (register, shift, width)``.
+TCD_FIELDS = {'DSIZE': ('ATTR', 0, 3), 'DMOD': ('ATTR', 3, 5),
+              'SSIZE': ('ATTR', 8, 3), 'SMOD': ('ATTR', 11, 5),
+              'START': ('CSR', 0, 1), 'INTMAJOR': ('CSR', 1, 1),
+              'INTHALF': ('CSR', 2, 1), 'DREQ': ('CSR', 3, 1),
+              'ESG': ('CSR', 4, 1), 'MAJORELINK': ('CSR', 5, 1),
+              'ACTIVE': ('CSR', 6, 1), 'DONE': ('CSR', 7, 1),
+              'MAJORLINKCH': ('CSR', 8, 4), 'BWC': ('CSR', 14, 2),
+              'ELINK': ('CITER', 15, 1)}
+DMA_CR_FIELDS = {'EDBG': ('CR', 1, 1), 'ERCA': ('CR', 2, 1),
+                 'HOE': ('CR', 4, 1), 'HALT': ('CR', 5, 1),
+                 'CLM': ('CR', 6, 1), 'EMLM': ('CR', 7, 1),
+                 'ECX': ('CR', 16, 1), 'CX': ('CR', 17, 1)}
+DMA_ES_FIELDS = {'DBE': ('ES', 0, 1), 'SBE': ('ES', 1, 1),
+                 'SGE': ('ES', 2, 1), 'NCE': ('ES', 3, 1),
+                 'DOE': ('ES', 4, 1), 'DAE': ('ES', 5, 1),
+                 'SOE': ('ES', 6, 1), 'SAE': ('ES', 7, 1),
+                 'ERRCHN': ('ES', 8, 4), 'CPE': ('ES', 14, 1),
+                 'ECX': ('ES', 16, 1), 'VLD': ('ES', 31, 1)}
+
+#: Register transaction operation types (see ``teensy::registers::OpType``).
+OP_TCD, OP_MUX, OP_DMA, OP_ADC, OP_PIT, OP_SIM, OP_POKE, OP_TOKEN = range(1, 9)
+#: Mask selecting all bits, i.e., write value as-is.
+FULL_MASK = 0xFFFFFFFF
+#: Byte offset of each writable DMA controller register from ``DMA_CR``.
+DMA_REGISTER_OFFSETS = {'CR': 0x00, 'ERQ': 0x0C, 'EEI': 0x14, 'CEEI': 0x18,
+                        'SEEI': 0x19, 'CERQ': 0x1A, 'SERQ': 0x1B,
+                        'CDNE': 0x1C, 'SSRT': 0x1D, 'CERR': 0x1E,
+                        'CINT': 0x1F, 'INT': 0x24, 'ERR': 0x2C}
+#: ``OP_DMA`` index of ``DCHPRI`` of channel 0.
+DMA_DCHPRI_INDEX = 0x100
+#: ``DMAMUX_CHCFGn`` fields.
+MUX_CHCFG_TRIG = 1 << 6
+MUX_CHCFG_ENBL = 1 << 7
+PIT_TIMER_REGISTERS = ('LDVAL', 'CVAL', 'TCTRL', 'TFLG')
+#: ADC registers holding status or command bits (e.g., ``SC1A`` starts a
+#: conversion, ``SC3[CAL]`` self-clears), which are never shadowed.
+ADC_UNSHADOWED = ('SC1A', 'SC1B', 'RA', 'RB', 'SC3')
+
+
+def decode_fields(records, fields):
+    '''
+    Parameters
+    ----------
+    records : numpy.ndarray or numpy.void
+        Register snapshot(s).
+    fields : dict
+        Bit fields to decode, i.e., ``name: (register, shift, width)``.
+
+    Returns
+    -------
+    pandas.DataFrame
+        Value of each bit field (columns) in each record (rows).
+    '''
+    records = np.atleast_1d(records)
+    return pd.DataFrame(dict((name, (records[register].astype('uint32') >>
+                                     shift) & ((1 << width) - 1))
+                             for name, (register, shift, width)
+                             in fields.items()),
+                        columns=sorted(fields))
+
+
+def tcds_frame(tcds):
+    '''
+    Parameters
+    ----------
+    tcds : numpy.ndarray(dtype=TCD_DTYPE)
+        Transfer control descriptors, indexed by DMA channel.
+
+    Returns
+    -------
+    pandas.DataFrame
+        Raw register values and decoded bit fields of each descriptor,
+        indexed by ``channel``.  ``CITER`` and ``BITER`` hold the iteration
+        counts (i.e., without the minor loop link fields).
+    '''
+    df_tcds = pd.DataFrame(tcds)
+    df_fields = decode_fields(tcds, TCD_FIELDS)
+    iteration_mask = np.where(df_fields['ELINK'], 0x1FF, 0x7FFF)
+    df_fields['LINKCH'] = np.where(df_fields['ELINK'],
+                                   (tcds['CITER'] >> 9) & 0xF, 0)
+    df_tcds['CITER'] &= iteration_mask
+    df_tcds['BITER'] &= iteration_mask
+    df_tcds = df_tcds.join(df_fields)
+    df_tcds.index.name = 'channel'
+    return df_tcds
+
+
+def tcd_record(ITER=1, ELINK=False, LINKCH=0, **values):
+    '''
+    Parameters
+    ----------
+    ITER : int, optional
+        Major loop iteration count (i.e., both ``CITER`` and ``BITER``).
+    ELINK : bool, optional
+        If ``True``, link to channel ``LINKCH`` after each minor loop.
+    LINKCH : int, optional
+        Minor loop link channel.
+    **values
+        Raw register values (e.g., ``SADDR``, ``NBYTES``) and/or bit fields
+        from :data:`TCD_FIELDS` (e.g., ``SSIZE``, ``ESG``).
+
+    Returns
+    -------
+    numpy.ndarray(shape=(1, ), dtype=TCD_DTYPE)
+        Transfer control descriptor, encoded on the host (i.e., without a
+        round trip through the device).
+    '''
+    tcd = np.zeros(1, dtype=TCD_DTYPE)
+    if ELINK:
+        iterations = (1 << 15) | ((LINKCH & 0xF) << 9) | (ITER & 0x1FF)
+    else:
+        iterations = ITER & 0x7FFF
+    # `CITER` must initially be set to the same value as `BITER`.
+    tcd['CITER'] = iterations
+    tcd['BITER'] = iterations
+    for name, value in values.items():
+        if name in TCD_FIELDS:
+            register, shift, width = TCD_FIELDS[name]
+            tcd[register] |= (int(value) & ((1 << width) - 1)) << shift
+        else:
+            tcd[name] = value
+    return tcd
+
+
+class RegisterTransaction(object):
+    '''
+    Ordered list of typed register operations, applied by the device in a
+    single packet, with interrupts disabled (see
+    :meth:`RegistersMixin.apply_register_transaction`).
+
+    Register writes take an optional ``mask``; only the masked bits are
+    modified (read-modify-write) unless ``mask`` is :data:`FULL_MASK`.
+    Write-only and write-1-to-clear registers (e.g., ``SERQ``, ``INT``,
+    ``TFLG``) require a full mask.
+
+    Each method returns the transaction, so calls may be chained.
+
+    See also
+    --------
+    ``teensy::registers::OpType`` for the encoding.
+    '''
+    def __init__(self):
+        #: Operations, i.e., ``(op_type, target, index, payload)``.
+        self.ops = []
+
+    def __len__(self):
+        return len(self.ops)
+
+    def _append(self, op_type, target, index, payload):
+        self.ops.append((op_type, target, index, payload))
+        return self
+
+    def _register(self, op_type, target, index, value, mask):
+        return self._append(op_type, target, index,
+                            struct.pack('<II', mask & FULL_MASK,
+                                        value & FULL_MASK))
+
+    def tcd(self, channel, tcd):
+        '''
+        Load transfer control descriptor of DMA channel ``channel``.
+
+        Parameters
+        ----------
+        channel : int
+            DMA channel.
+        tcd : numpy.ndarray(dtype=TCD_DTYPE)
+            Descriptor, e.g., from :func:`tcd_record`.
+        '''
+        return self._append(OP_TCD, channel, 0,
+                            np.asarray(tcd, dtype=TCD_DTYPE).ravel()[:1]
+                            .tostring())
+
+    def mux(self, channel, source, enable=True, trigger=False):
+        '''
+        Route DMA request ``source`` to DMA channel ``channel``.
+        '''
+        value = ((source & 0x3F) | (MUX_CHCFG_TRIG if trigger else 0) |
+                 (MUX_CHCFG_ENBL if enable else 0))
+        return self._register(OP_MUX, channel, 0, value, FULL_MASK)
+
+    def dma(self, name, value, mask=FULL_MASK):
+        '''
+        Write DMA controller register ``name`` (see
+        :data:`DMA_REGISTER_OFFSETS`).
+        '''
+        return self._register(OP_DMA, 0, DMA_REGISTER_OFFSETS[name], value,
+                              mask)
+
+    def dma_priority(self, channel, value, mask=FULL_MASK):
+        '''
+        Write ``DCHPRI`` register of DMA channel ``channel``.
+        '''
+        return self._register(OP_DMA, 0, DMA_DCHPRI_INDEX + channel, value,
+                              mask)
+
+    def enable_dma_request(self, channel):
+        '''
+        Set enable request flag of DMA channel ``channel`` (i.e., ``SERQ``).
+        '''
+        return self.dma('SERQ', channel)
+
+    def adc(self, adc_num, name, value, mask=FULL_MASK):
+        '''
+        Write register ``name`` (see :data:`ADC_REGISTERS_DTYPE`) of ADC
+        ``adc_num``.
+        '''
+        return self._register(OP_ADC, adc_num,
+                              ADC_REGISTERS_DTYPE.names.index(name), value,
+                              mask)
+
+    def pit(self, name, value, mask=FULL_MASK, timer=None):
+        '''
+        Write ``PIT_MCR`` (``name='MCR'``) or register ``name`` of timer
+        ``timer`` (see :data:`PIT_TIMER_REGISTERS`).
+        '''
+        if name == 'MCR':
+            index = 0
+        else:
+            index = 1 + 4 * timer + PIT_TIMER_REGISTERS.index(name)
+        return self._register(OP_PIT, 0, index, value, mask)
+
+    def sim(self, scgc, value, mask=FULL_MASK):
+        '''
+        Write System Clock Gating Control register ``SIM_SCGC<scgc>`` (4 to
+        7), e.g., ``sim(6, 1 << 22, mask=1 << 22)`` to enable PDB clock.
+        '''
+        return self._register(OP_SIM, 0, scgc, value, mask)
+
+    def poke(self, address, value, mask=FULL_MASK):
+        '''
+        Write 32-bit word at (word-aligned) ``address``.
+        '''
+        return self._append(OP_POKE, 0, 0,
+                            struct.pack('<III', address, mask & FULL_MASK,
+                                        value & FULL_MASK))
+
+    def token(self, expected, new):
+        '''
+        Set device transaction token to ``new``, if the current token is
+        ``expected`` (or unconditionally if ``expected`` is ``None``).  See
+        :class:`RegisterShadow`.
+
+        A transaction may hold at most one token operation.
+        '''
+        return self._append(OP_TOKEN, 0 if expected is None else 1, 0,
+                            struct.pack('<II', expected or 0, new))
+
+    def tostring(self):
+        return b''.join(struct.pack('<BBH', op_type, target, index) + payload
+                        for op_type, target, index, payload in self.ops)
+
+
+class RegisterShadow(object):
+    '''
+    Host copy of register values written by register transactions, used to
+    skip writes of values the device already holds.
+
+    Each shadowed register tracks the value of the bits written so far (a
+    masked write only makes the masked bits known).  Commands and registers
+    with bits modified by hardware (e.g., ``SERQ``, ``ERQ``, ``SC1A``,
+    ``TFLG``) and pokes are never shadowed, i.e., always written.
+
+    Every filtered transaction starts with an ``OP_TOKEN`` operation, which
+    is only valid if the device token matches the token of the last
+    transaction.  The device token is cleared on reset and whenever
+    registers are written by other RPCs (e.g., ``update_adc_registers``,
+    ``adc_sampler_configure``, ``setResolution``, ``mem_cpy_host_to_device``,
+    or a transaction applied with ``shadow=False``), in which case the
+    shadow must be discarded (see
+    :meth:`RegistersMixin.apply_register_transaction`).
+
+    .. note::
+        DMA transfers update the transfer control descriptor of the active
+        channel, so descriptors must be invalidated before starting a
+        transfer on the channel (see :meth:`invalidate`).
+    '''
+    def __init__(self):
+        self.token = None  # Unknown device state.
+        #: Register values, i.e., ``key: (value, known_mask)`` (``key:
+        #: payload`` for transfer control descriptors).
+        self.values = {}
+        #: Results of other (e.g., Teensy ADC library) calls, cleared with
+        #: the register values.
+        self.calls = {}
+
+    def invalidate(self, op_type=None, target=None):
+        '''
+        Forget shadowed values (all values, or only values of operations of
+        type ``op_type`` and, optionally, ``target``).
+        '''
+        if op_type is None:
+            self.token = None
+            self.values.clear()
+            self.calls.clear()
+            return
+        for key in [key for key in self.values if key[0] == op_type and
+                    target in (None, key[1])]:
+            del self.values[key]
+
+    @staticmethod
+    def shadowed(op_type, target, index):
+        if op_type in (OP_TCD, OP_MUX, OP_SIM):
+            return True
+        elif op_type == OP_DMA:
+            return (index >= DMA_DCHPRI_INDEX or
+                    index == DMA_REGISTER_OFFSETS['EEI'])
+        elif op_type == OP_ADC:
+            return ADC_REGISTERS_DTYPE.names[index] not in ADC_UNSHADOWED
+        elif op_type == OP_PIT:
+            # `MCR`, `LDVAL`, and `TCTRL`.
+            return index == 0 or (index - 1) % 4 in (0, 2)
+        return False
+
+    def filter(self, transaction):
+        '''
+        Parameters
+        ----------
+        transaction : RegisterTransaction
+
+        Returns
+        -------
+        filtered : RegisterTransaction
+            Operations of ``transaction`` that change the shadowed register
+            state (or are not shadowed), preceded by an ``OP_TOKEN``
+            operation.
+        values : dict
+            Shadow register values after ``filtered`` is applied (see
+            :meth:`commit`).
+        '''
+        values = dict(self.values)
+        filtered = RegisterTransaction()
+        new_token = random.randint(1, FULL_MASK)
+        filtered.token(self.token, new_token)
+        for op in transaction.ops:
+            op_type, target, index, payload = op
+            key = (op_type, target, index)
+            if not self.shadowed(*key):
+                filtered.ops.append(op)
+            elif op_type == OP_TCD:
+                if values.get(key) != payload:
+                    values[key] = payload
+                    filtered.ops.append(op)
+            else:
+                mask, value = struct.unpack('<II', payload)
+                known_value, known_mask = values.get(key, (0, 0))
+                if (known_mask & mask != mask or
+                        (known_value ^ value) & mask):
+                    values[key] = ((known_value & ~mask) | (value & mask),
+                                   known_mask | mask)
+                    filtered.ops.append(op)
+        filtered.new_token = new_token
+        return filtered, values
+
+    def commit(self, filtered, values):
+        '''
+        Record state after ``filtered`` (see :meth:`filter`) was applied.
+        '''
+        self.token = filtered.new_token
+        self.values = values
+
+
+class RegistersMixin(object):
+    '''
+    This mixin class adds helpers to read and decode raw register snapshots,
+    and to apply register transactions.
+    '''
+    @property
+    def register_shadow(self):
+        '''
+        :class:`RegisterShadow` of this device (see
+        :meth:`apply_register_transaction`).
+        '''
+        if getattr(self, '_register_shadow', None) is None:
+            self._register_shadow = RegisterShadow()
+        return self._register_shadow
+    def dma_registers_raw(self):
+        '''
+        Returns
+        -------
+        numpy.void
+            DMA controller and DMA mux registers (see
+            :data:`DMA_REGISTERS_DTYPE`).
+        '''
+        data = np.asarray(self.read_dma_registers_raw(), dtype='uint8')
+        return data.view(DMA_REGISTERS_DTYPE)[0]
+
+    def dma_tcds_raw(self):
+        '''
+        Returns
+        -------
+        numpy.ndarray(dtype=TCD_DTYPE)
+            Transfer control descriptor of each DMA channel.
+        '''
+        channel_count = self.dma_channel_count()
+        # Read as many descriptors as fit in a response packet at a time.
+        batch_size = max(1, (self.max_serial_payload_size() - 16) //
+                         TCD_DTYPE.itemsize)
+        data = [np.asarray(self.read_dma_TCDs_raw(first_i, batch_size),
+                           dtype='uint8')
+                for first_i in range(0, channel_count, batch_size)]
+        return np.concatenate(data).view(TCD_DTYPE)
+
+    def adc_registers_raw(self, adc_num):
+        '''
+        Returns
+        -------
+        numpy.void
+            Registers of ADC ``adc_num`` (see :data:`ADC_REGISTERS_DTYPE`).
+        '''
+        data = np.asarray(self.read_adc_registers_raw(adc_num),
+                          dtype='uint8')
+        return data.view(ADC_REGISTERS_DTYPE)[0]
+
+    def pit_registers_raw(self):
+        '''
+        Returns
+        -------
+        numpy.void
+            PIT module and timer registers (see
+            :data:`PIT_REGISTERS_DTYPE`).
+        '''
+        data = np.asarray(self.read_pit_registers_raw(), dtype='uint8')
+        return data.view(PIT_REGISTERS_DTYPE)[0]
+
+    def dma_tcds_info(self):
+        '''
+        Returns
+        -------
+        pandas.DataFrame
+            Decoded transfer control descriptor of each DMA channel (see
+            :func:`tcds_frame`).
+        '''
+        return tcds_frame(self.dma_tcds_raw())
+
+    def dma_error_info(self):
+        '''
+        Returns
+        -------
+        pandas.Series
+            DMA error status fields (see :data:`DMA_ES_FIELDS`) and ``ERR``
+            (bit mask of channels with an error).
+        '''
+        registers = self.dma_registers_raw()
+        info = decode_fields(registers, DMA_ES_FIELDS).iloc[0]
+        info['ERR'] = registers['ERR']
+        return info
+
+    def apply_register_transaction(self, transaction, shadow=True):
+        '''
+        Apply register operations in a single packet.
+
+        The device validates every operation first and writes nothing if any
+        operation is invalid; the operations are then applied in order with
+        interrupts disabled.
+
+        Parameters
+        ----------
+        transaction : RegisterTransaction
+        shadow : bool, optional
+            If ``True``, skip writes of values the device already holds (see
+            :attr:`register_shadow`).  If the device registers were written
+            by other means since the last transaction (e.g., after a device
+            reset), the shadow is discarded and the whole transaction is
+            applied.
+
+        Returns
+        -------
+        int
+            Number of operations of ``transaction`` written (i.e., not
+            skipped).
+
+        Raises
+        ------
+        ValueError
+            If an operation is invalid (nothing is written).
+        IOError
+            If a DMA error is flagged after the transaction.
+        '''
+        if not shadow:
+            # The device clears its token, so the shadow is out of date.
+            self.register_shadow.invalidate()
+            return self._apply_register_ops(transaction)
+
+        register_shadow = self.register_shadow
+        filtered, values = register_shadow.filter(transaction)
+        try:
+            op_count = self._apply_register_ops(filtered)
+        except ValueError:
+            if register_shadow.token is None:
+                raise
+            # Token mismatch (or invalid operation), so device registers may
+            # differ from the shadow.  Retry without skipping any write.
+            register_shadow.invalidate()
+            filtered, values = register_shadow.filter(transaction)
+            op_count = self._apply_register_ops(filtered)
+        register_shadow.commit(filtered, values)
+        # Do not count token operation.
+        return op_count - 1
+
+    def _apply_register_ops(self, transaction):
+        data = np.frombuffer(transaction.tostring(), dtype='uint8')
+        if data.size > self.max_serial_payload_size() - 16:
+            raise ValueError('Transaction of %d bytes does not fit in a '
+                             'single packet.' % data.size)
+        op_count, failed_index, dma_es = self.apply_register_ops(data)
+        if failed_index != op_count or op_count != len(transaction):
+            raise ValueError('Invalid register operation %d (nothing was '
+                             'written).' % failed_index)
+        if dma_es & (1 << 31):  # `VLD`
+            raise IOError('DMA error after register transaction.\n%s' %
+                          decode_fields(np.array([dma_es],
+                                                 dtype=[('ES', '<u4')]),
+                                        DMA_ES_FIELDS).iloc[0])
+        return op_count
@@ -0,0 +1,864 @@
+'''
+Host-side reassembly of chunked ``STREAM`` packets.
+
+Each ``STREAM`` packet sent by the device carries one chunk of a block (e.g.,
+a buffer of ADC samples), prefixed with a header (see ``StreamChunkHeader`` in
+``TeensyMinimalRpc/StreamChunker.h``)::
+
+    uint32 sequence    # Chunk sequence number (increments for every chunk).
+    uint32 offset      # Byte offset of chunk payload within block.
+    uint32 block_size  # Total number of bytes in block.
+    uint64 timestamp   # Block completion time (device CPU cycles).
+    uint32 crc         # CRC-32 of chunk payload (same as ``zlib.crc32``).
+'''
+from __future__ import absolute_import
+from __future__ import division
+import datetime as dt
+import logging
+import time
+import zlib
+
+import numpy as np
+
+logger = logging.getLogger(__name__)
+
+
+STREAM_CHUNK_HEADER_DTYPE = np.dtype([('sequence', '<u4'), ('offset', '<u4'),
+                                      ('block_size', '<u4'),
+                                      ('timestamp', '<u8'),
+                                      ('crc', '<u4')])
+#: Header of block statistics record (see ``BlockStatisticsHeader`` in
+#: ``TeensyMinimalRpc/BlockStatistics.h``).
+BLOCK_STATISTICS_HEADER_DTYPE = np.dtype([('timestamp', '<u8'),
+                                          ('block_index', '<u4'),
+                                          ('channel_count', '<u2'),
+                                          ('sample_count', '<u2')])
+#: Per-channel entry of block statistics record (see ``ChannelStatistics``).
+CHANNEL_STATISTICS_DTYPE = np.dtype([('mean', '<f4'), ('variance', '<f4'),
+                                     ('rms', '<f4'), ('min', '<u2'),
+                                     ('max', '<u2'), ('peak_to_peak', '<u2')])
+#: Header of Rice coded block (see ``RiceBlockHeader`` in
+#: ``TeensyMinimalRpc/RiceCodec.h``).
+RICE_BLOCK_HEADER_DTYPE = np.dtype([('channel_count', '<u2'),
+                                    ('sample_count', '<u2'),
+                                    ('partition_size', '<u2'),
+                                    ('coded', 'u1'), ('reserved', 'u1')])
+#: Rice coding constants (see ``TeensyMinimalRpc/RiceCodec.h``).
+RICE_PARAMETER_BITS = 5
+RICE_ESCAPE_QUOTIENT = 16
+RICE_RESIDUAL_BITS = 17
+#: Header of triggered capture window (see ``TriggerCaptureHeader`` in
+#: ``TeensyMinimalRpc/TriggeredCapture.h``).
+TRIGGER_CAPTURE_HEADER_DTYPE = np.dtype([('timestamp', '<u8'),
+                                         ('trigger_sample', '<u4'),
+                                         ('frozen_sample', '<u4'),
+                                         ('capture_index', '<u4'),
+                                         ('missed_count', '<u4'),
+                                         ('pre_count', '<u2'),
+                                         ('post_count', '<u2')])
+#: Trigger conditions of ``trigger_configure()`` (see ``TriggerMode``).
+TRIGGER_MODES = {'level_above': 0, 'level_below': 1, 'rising': 2,
+                 'falling': 3}
+#: Default stream identifier of bulk memory reads (see
+#: :meth:`StreamMixin.mem_read_stream`).
+BULK_STREAM_ID = 0xFFFF
+
+
+def parse_stream_chunk(data):
+    '''
+    Parameters
+    ----------
+    data : str
+        Payload of ``STREAM`` packet.
+
+    Returns
+    -------
+    header : numpy.void
+        Chunk header record (see :data:`STREAM_CHUNK_HEADER_DTYPE`).
+    payload : str
+        Chunk payload.
+    '''
+    header_size = STREAM_CHUNK_HEADER_DTYPE.itemsize
+    if len(data) < header_size:
+        raise ValueError('Stream chunk is shorter than header (%d < %d bytes).'
+                         % (len(data), header_size))
+    header = np.fromstring(data[:header_size],
+                           dtype=STREAM_CHUNK_HEADER_DTYPE)[0]
+    return header, data[header_size:]
+
+
+def check_stream_chunk_crc(header, payload):
+    '''
+    Returns
+    -------
+    bool
+        ``True`` if CRC-32 of ``payload`` matches chunk header.
+    '''
+    return (zlib.crc32(payload) & 0xFFFFFFFF) == int(header['crc'])
+
+
+def parse_block_statistics(block):
+    '''
+    Parameters
+    ----------
+    block : str
+        Reassembled block streamed while block statistics are enabled (see
+        ``block_statistics_configure()``).
+
+    Returns
+    -------
+    header : numpy.void
+        Record header (see :data:`BLOCK_STATISTICS_HEADER_DTYPE`).
+    channels : numpy.ndarray
+        One record per channel (see :data:`CHANNEL_STATISTICS_DTYPE`).
+    '''
+    header_size = BLOCK_STATISTICS_HEADER_DTYPE.itemsize
+    if len(block) < header_size:
+        raise ValueError('Block is shorter than statistics header (%d < %d '
+                         'bytes).' % (len(block), header_size))
+    header = np.fromstring(block[:header_size],
+                           dtype=BLOCK_STATISTICS_HEADER_DTYPE)[0]
+    size = header_size + (int(header['channel_count']) *
+                          CHANNEL_STATISTICS_DTYPE.itemsize)
+    if len(block) != size:
+        raise ValueError('Unexpected statistics record size (%d != %d bytes).'
+                         % (len(block), size))
+    channels = np.fromstring(block[header_size:],
+                             dtype=CHANNEL_STATISTICS_DTYPE)
+    return header, channels
+
+
+def parse_trigger_capture(block):
+    '''
+    Parameters
+    ----------
+    block : str
+        Reassembled window streamed by a triggered capture (see
+        ``triggered_sampler_start()``).
+
+    Returns
+    -------
+    header : numpy.void
+        Window header (see :data:`TRIGGER_CAPTURE_HEADER_DTYPE`).
+    samples : numpy.ndarray
+        ``pre_count + post_count`` samples (``uint16``); sample ``pre_count``
+        is the trigger sample.
+    '''
+    header_size = TRIGGER_CAPTURE_HEADER_DTYPE.itemsize
+    if len(block) < header_size:
+        raise ValueError('Block is shorter than trigger capture header (%d < '
+                         '%d bytes).' % (len(block), header_size))
+    header = np.fromstring(block[:header_size],
+                           dtype=TRIGGER_CAPTURE_HEADER_DTYPE)[0]
+    size = header_size + 2 * (int(header['pre_count']) +
+                              int(header['post_count']))
+    if len(block) != size:
+        raise ValueError('Unexpected trigger capture size (%d != %d bytes).'
+                         % (len(block), size))
+    samples = np.fromstring(block[header_size:], dtype='<u2')
+    return header, samples
+
+
+def unpack_samples(data, bits=16):
+    '''
+    Unpack samples streamed with ``stream_packing_configure(bits, ...)`` (see
+    ``SamplePacker`` in ``TeensyMinimalRpc/SamplePacker.h``).
+
+    Parameters
+    ----------
+    data : str
+        Packed block, i.e., a little-endian bit stream of ``bits`` bits per
+        sample.
+    bits : int, optional
+        Bits per sample (8, 10, 12, or 16, i.e., not packed).
+
+    Returns
+    -------
+    numpy.ndarray
+        ``uint16`` samples.
+    '''
+    if bits == 16:
+        return np.fromstring(data, dtype='<u2')
+    data = np.fromstring(data, dtype='uint8')
+    if bits == 8:
+        return data.astype('uint16')
+    # Smallest whole number of bytes holding a whole number of samples (e.g.,
+    # 3 bytes per 2 samples at 12 bits).
+    group_bytes = {10: 5, 12: 3}[bits]
+    group_samples = 8 * group_bytes // bits
+    # Trailing partial byte holds less than one sample.
+    sample_count = 8 * data.size // bits
+    padded = np.zeros(-(-data.size // group_bytes) * group_bytes,
+                      dtype='uint64')
+    padded[:data.size] = data
+    groups = padded.reshape(-1, group_bytes)
+    # Combine bytes of each group into a single little-endian integer.
+    byte_shifts = 8 * np.arange(group_bytes, dtype='uint64')
+    stream = (groups << byte_shifts).sum(axis=1)
+    shifts = bits * np.arange(group_samples, dtype='uint64')
+    samples = (stream[:, None] >> shifts) & np.uint64((1 << bits) - 1)
+    return samples.ravel()[:sample_count].astype('uint16')
+
+
+def _rice_successors(code_ends, unescaped, k):
+    '''
+    Returns the start of the code following a code with Rice parameter ``k``
+    starting at each stream bit (see :func:`decode_rice_block`).
+    '''
+    successors = code_ends.copy()
+    np.add(successors, k, out=successors, where=unescaped)
+    return np.minimum(successors, code_ends.size - 1, out=successors)
+
+
+def _compose(successors, counts):
+    '''
+    Returns ``successors`` applied each of ``counts`` times (by repeated
+    squaring, shared between counts).
+    '''
+    results = [None] * len(counts)
+    counts = list(counts)
+    while any(counts):
+        for i, count in enumerate(counts):
+            if count & 1:
+                results[i] = (successors if results[i] is None
+                              else successors.take(results[i]))
+            counts[i] = count >> 1
+        if any(counts):
+            successors = successors.take(successors)
+    return results
+
+
+def decode_rice_block(block):
+    '''
+    Decode block streamed with ``rice_coding_configure(...)`` (see
+    ``RiceEncoder`` in ``TeensyMinimalRpc/RiceCodec.h``).
+
+    Bit fields are read from a table of the 32 stream bits starting at each
+    bit position, and the end of each unary quotient from a table of the next
+    ``0`` bit at or after each position.  Partition headers are then found
+    with a table of partition ends for each Rice parameter (see
+    :func:`_compose`), and the codes of all partitions are decoded together
+    with ``numpy``, so Python only loops over partitions and over code
+    offsets within a partition.
+
+    Parameters
+    ----------
+    block : str
+        Reassembled coded block, starting with a ``RiceBlockHeader``.
+
+    Returns
+    -------
+    header : numpy.void
+        Block header (see :data:`RICE_BLOCK_HEADER_DTYPE`).
+    samples : numpy.ndarray
+        ``uint16`` samples, one row per channel.
+    '''
+    header_size = RICE_BLOCK_HEADER_DTYPE.itemsize
+    if len(block) < header_size:
+        raise ValueError('Block is shorter than Rice header (%d < %d bytes).'
+                         % (len(block), header_size))
+    header = np.fromstring(block[:header_size],
+                           dtype=RICE_BLOCK_HEADER_DTYPE)[0]
+    channel_count = int(header['channel_count'])
+    sample_count = int(header['sample_count'])
+    partition_size = int(header['partition_size'])
+    payload = np.fromstring(block[header_size:], dtype='uint8')
+
+    if not header['coded']:
+        if payload.size != 2 * channel_count * sample_count:
+            raise ValueError('Unexpected raw block size (%d != %d bytes).' %
+                             (payload.size, 2 * channel_count *
+                              sample_count))
+        return header, payload.view('<u2').reshape(channel_count,
+                                                   sample_count)
+    if partition_size == 0:
+        raise ValueError('Invalid Rice partition size.')
+
+    # Stream bit `b` is bit `b % 8` of byte `b / 8` (see `unpack_samples`).
+    # Pad so fields read past the end of the payload are zero.
+    padded = np.zeros(payload.size + 8, dtype='uint64')
+    padded[:payload.size] = payload
+    byte_words = np.zeros(payload.size + 4, dtype='uint64')
+    for i in range(5):
+        byte_words |= padded[i:i + byte_words.size] << np.uint64(8 * i)
+    positions = np.arange(8 * byte_words.size, dtype='uint64')
+    fields = ((byte_words[positions >> np.uint64(3)] >>
+               (positions & np.uint64(7))) &
+              np.uint64(0xFFFFFFFF)).astype('int64')
+    bit_count = 8 * payload.size
+    # Positions past the end of the payload do not hold a terminating `0`.
+    sink = fields.size
+    positions = np.arange(sink + 1, dtype='int32')
+    zeros = np.flatnonzero((fields[:bit_count] & 1) == 0)
+    next_zero = np.full(sink + 1, sink, dtype='int32')
+    next_zero[zeros] = zeros
+    next_zero = np.minimum.accumulate(next_zero[::-1])[::-1]
+    # A code starting at each stream bit ends at `code_ends` (plus its Rice
+    # parameter, unless escaped).  Codes running past the end of the table
+    # end (and stay) at `sink`.
+    escaped = next_zero - positions >= RICE_ESCAPE_QUOTIENT
+    code_ends = np.minimum(np.where(escaped, positions +
+                                    RICE_ESCAPE_QUOTIENT +
+                                    RICE_RESIDUAL_BITS, next_zero + 1),
+                           sink)
+    unescaped = ~escaped
+
+    # Walk partition headers: the end of a partition only depends on its
+    # start, its Rice parameter and its length.
+    lengths = sorted(set(min(sample_count - 1 - i, partition_size)
+                         for i in range(0, sample_count - 1,
+                                        partition_size)))
+    partition_ends = {}
+    first = np.empty(channel_count, dtype='int64')
+    starts = []
+    parameters = []
+    counts = []
+    position = 0
+    for c in range(channel_count):
+        first[c] = fields[position] & 0xFFFF
+        position += 16
+        for i in range(0, sample_count - 1, partition_size):
+            count = min(sample_count - 1 - i, partition_size)
+            k = int(fields[position]) & ((1 << RICE_PARAMETER_BITS) - 1)
+            position += RICE_PARAMETER_BITS
+            if k not in partition_ends:
+                partition_ends[k] = dict(zip(lengths, _compose(
+                    _rice_successors(code_ends, unescaped, k), lengths)))
+            starts.append(position)
+            parameters.append(k)
+            counts.append(count)
+            position = int(partition_ends[k][count][position])
+            if position > bit_count:
+                raise ValueError('Rice coded block is truncated.')
+    if position > bit_count:
+        raise ValueError('Rice coded block is truncated.')
+
+    residuals = np.empty((channel_count, sample_count - 1), dtype='int64')
+    if starts:
+        # Find the start of each code, for all partitions together.
+        parameters = np.array(parameters)
+        counts = np.array(counts)
+        codes = np.empty((len(starts), counts.max()), dtype='int32')
+        codes[:, 0] = starts
+        for j in range(1, codes.shape[1]):
+            previous = codes[:, j - 1]
+            codes[:, j] = np.minimum(code_ends[previous] +
+                                     parameters * unescaped[previous], sink)
+        valid = np.arange(codes.shape[1]) < counts[:, None]
+        k = np.broadcast_to(parameters[:, None], codes.shape)[valid]
+        codes = codes[valid]
+
+        ones = (next_zero[codes] - codes).astype('int64')
+        escaped = escaped[codes]
+        remainders = fields[np.minimum(np.where(escaped,
+                                                codes + RICE_ESCAPE_QUOTIENT,
+                                                next_zero[codes] + 1),
+                                       fields.size - 1)]
+        residuals[:] = np.where(escaped,
+                                remainders & ((1 << RICE_RESIDUAL_BITS) - 1),
+                                (ones << k) | (remainders & ((1 << k) - 1)))\
+            .reshape(channel_count, sample_count - 1)
+
+    # Undo zig-zag mapping, then first-order prediction.
+    differences = (residuals >> 1) ^ -(residuals & 1)
+    samples = np.empty((channel_count, sample_count), dtype='int64')
+    samples[:, 0] = first
+    samples[:, 1:] = differences
+    return header, np.cumsum(samples, axis=1).astype('uint16')
+
+
+class _RequestEncoded(Exception):
+    '''
+    Raised in place of sending a request packet (see
+    :meth:`StreamMixin._encode_request`).
+    '''
+    def __init__(self, packet):
+        super(_RequestEncoded, self).__init__()
+        self.packet = packet
+
+
+class StreamReassembler(object):
+    '''
+    Reassemble blocks from chunked ``STREAM`` packets.
+
+    Incomplete blocks (i.e., a chunk was lost or corrupted, or the device
+    dropped the rest of a block that was overwritten before it was completely
+    sent) are discarded.
+
+    Attributes
+    ----------
+    chunk_count : int
+        Number of chunks received.
+    lost_chunk_count : int
+        Number of chunks missing from the sequence numbers received.
+    dropped_block_count : int
+        Number of incomplete blocks discarded.
+    crc_error_count : int
+        Number of chunks discarded because of a CRC mismatch.
+    '''
+    def __init__(self):
+        self.blocks = {}
+        self.next_sequence = None
+        self.chunk_count = 0
+        self.lost_chunk_count = 0
+        self.dropped_block_count = 0
+        self.crc_error_count = 0
+
+    def check_sequence(self, header):
+        '''
+        Count chunks missing between the previous chunk and chunk ``header``.
+        '''
+        self.chunk_count += 1
+        if self.next_sequence is not None and header['sequence'] != \
+                self.next_sequence:
+            lost_count = (int(header['sequence']) - self.next_sequence) & \
+                0xFFFFFFFF
+            logger.warning('Lost %d stream chunk(s) (expected sequence %d, '
+                           'got %d).', lost_count, self.next_sequence,
+                           header['sequence'])
+            self.lost_chunk_count += lost_count
+        self.next_sequence = (int(header['sequence']) + 1) & 0xFFFFFFFF
+
+    def check_crc(self, header, payload):
+        '''
+        Returns
+        -------
+        bool
+            ``True`` if CRC of chunk ``payload`` is valid.
+        '''
+        if check_stream_chunk_crc(header, payload):
+            return True
+        logger.warning('Stream chunk %d CRC mismatch.', header['sequence'])
+        self.crc_error_count += 1
+        return False
+
+    def push(self, datetime, stream_id, data):
+        '''
+        Parameters
+        ----------
+        datetime : datetime.datetime
+            Time the chunk was received.
+        stream_id : int
+            Stream identifier (i.e., ``iuid`` of ``STREAM`` packet).
+        data : str
+            Payload of ``STREAM`` packet.
+
+        Returns
+        -------
+        tuple or None
+            ``(datetime, stream_id, block, timestamp)`` if the chunk completes
+            a block, where ``datetime`` is the time the *first* chunk of the
+            block was received and ``timestamp`` is the device time the block
+            was completed (in CPU cycles).  Otherwise, ``None``.
+        '''
+        header, payload = parse_stream_chunk(data)
+        self.check_sequence(header)
+
+        block = self.blocks.get(stream_id)
+        if not self.check_crc(header, payload):
+            if block is not None:
+                del self.blocks[stream_id]
+                self.dropped_block_count += 1
+            return None
+        elif header['offset'] == 0:
+            if block is not None:
+                self.dropped_block_count += 1
+            block = {'datetime': datetime, 'size': int(header['block_size']),
+                     'timestamp': int(header['timestamp']), 'chunks': []}
+            self.blocks[stream_id] = block
+        elif block is None or header['offset'] != \
+                sum(map(len, block['chunks'])):
+            # Missing start (or middle) of block.
+            if block is not None:
+                del self.blocks[stream_id]
+                self.dropped_block_count += 1
+            return None
+
+        block['chunks'].append(payload)
+        if sum(map(len, block['chunks'])) < block['size']:
+            return None
+        del self.blocks[stream_id]
+        return (block['datetime'], stream_id, b''.join(block['chunks']),
+                block['timestamp'])
+
+
+class StreamMixin(object):
+    '''
+    This mixin class adds reassembly of chunked ``STREAM`` packets,
+    credit-based stream flow control, and bulk memory transfers.
+
+    By default, the device sends stream chunks as fast as it can.  Call
+    :meth:`enable_stream_flow_control` to limit the number of chunks in flight
+    to a fixed window; credits are then granted back to the device as chunks
+    are consumed by :meth:`read_stream_blocks`.
+    '''
+    def init_stream(self):
+        self.stream_reassembler = StreamReassembler()
+        self.stream_window = None
+        self.device_clock = None
+        # Blocks of other streams received during a bulk memory read.
+        self.stream_backlog = []
+
+    def sync_device_clock(self, sample_count=16):
+        '''
+        Estimate offset between host clock and device CPU cycle counter (i.e.,
+        the time base of stream block timestamps).
+
+        The device cycle counter is read ``sample_count`` times, and the
+        reading with the shortest round trip is used, assuming the counter
+        was read half-way through the round trip.  The error is therefore
+        bounded by half of the shortest round trip time.
+
+        Parameters
+        ----------
+        sample_count : int, optional
+            Number of device time readings.
+
+        Returns
+        -------
+        float
+            Host time (seconds since epoch) corresponding to device cycle 0.
+        '''
+        f_cpu = float(self.cpu_frequency())
+        best = None
+        for i in range(sample_count):
+            start = time.time()
+            cycles_low, cycles_high = self.cycle_count()
+            end = time.time()
+            cycles = (int(cycles_high) << 32) | int(cycles_low)
+            round_trip_s = end - start
+            if best is None or round_trip_s < best['round_trip_s']:
+                best = {'offset_s': 0.5 * (start + end) - cycles / f_cpu,
+                        'round_trip_s': round_trip_s}
+        best['f_cpu'] = f_cpu
+        self.device_clock = best
+        return best['offset_s']
+
+    def device_clock_offset(self):
+        '''
+        Returns
+        -------
+        float
+            Host time (seconds since epoch) corresponding to device cycle 0
+            (see :meth:`sync_device_clock`).
+        '''
+        if self.device_clock is None:
+            self.sync_device_clock()
+        return self.device_clock['offset_s']
+
+    def device_time_to_datetime(self, cycles):
+        '''
+        Parameters
+        ----------
+        cycles : int
+            Device time in CPU cycles (e.g., stream block timestamp).
+
+        Returns
+        -------
+        datetime.datetime
+            Corresponding host time.
+        '''
+        offset_s = self.device_clock_offset()
+        return dt.datetime.fromtimestamp(offset_s + cycles /
+                                         self.device_clock['f_cpu'])
+
+    def enable_stream_flow_control(self, window=16):
+        '''
+        Parameters
+        ----------
+        window : int, optional
+            Maximum number of stream chunks the device may send before the
+            host consumes them.
+        '''
+        self.stream_window = window
+        self.grant_stream_credits(window)
+
+    def disable_stream_flow_control(self):
+        self.stream_window = None
+        super(StreamMixin, self).disable_stream_flow_control()
+
+    def read_stream_blocks(self, timeout_s=None, block_count=1):
+        '''
+        Read chunks from the stream packet queue until at least
+        ``block_count`` blocks have been reassembled (or until no more
+        chunks are queued, once ``block_count`` is reached).
+
+        Parameters
+        ----------
+        timeout_s : float, optional
+            Maximum time to wait for blocks.
+        block_count : int, optional
+            Minimum number of blocks to return.
+
+        Returns
+        -------
+        list
+            List of ``(datetime, stream_id, block, timestamp)`` tuples (see
+            :meth:`StreamReassembler.push`).
+        '''
+        stream_queue = self._packet_watcher.queues.stream
+        blocks = self.stream_backlog
+        self.stream_backlog = []
+        chunk_count = 0
+
+        start_time = dt.datetime.now()
+        while len(blocks) < block_count or stream_queue.qsize() > 0:
+            if stream_queue.qsize() < 1:
+                if (timeout_s is not None and
+                    (timeout_s < (dt.datetime.now() -
+                                  start_time).total_seconds())):
+                    raise IOError('Timed out waiting for streamed result.')
+                continue
+            datetime_i, packet_i = stream_queue.get_nowait()
+            chunk_count += 1
+            block_i = self.stream_reassembler.push(datetime_i, packet_i.iuid,
+                                                   packet_i.data())
+            if block_i is not None:
+                blocks.append(block_i)
+            chunk_count = self._return_stream_credits(chunk_count)
+        self._return_stream_credits(chunk_count, force=True)
+        return blocks
+
+    def _return_stream_credits(self, chunk_count, force=False):
+        '''
+        Return credits for consumed chunks (if flow control is enabled) once
+        half of the window has been consumed (or if ``force`` is ``True``).
+
+        Returns
+        -------
+        int
+            Number of consumed chunks not returned yet.
+        '''
+        if self.stream_window is None or chunk_count == 0:
+            return 0
+        elif force or chunk_count >= self.stream_window // 2:
+            self.grant_stream_credits(chunk_count)
+            return 0
+        return chunk_count
+
+    def mem_read_stream(self, address, size, out=None,
+                        stream_id=BULK_STREAM_ID, timeout_s=5., retries=3):
+        '''
+        Read device memory as a pipelined series of chunked ``STREAM`` packets
+        (see ``mem_stream_device_to_host()`` RPC).
+
+        Unlike ``mem_cpy_device_to_host()``, the size of the range is not
+        limited by the packet size and only one request is sent for the
+        whole range.  Chunks are copied directly to ``out`` as they arrive.
+        Chunks that are lost or fail the CRC check are read again (up to
+        ``retries`` times).
+
+        Parameters
+        ----------
+        address : int
+            Device memory address.
+        size : int
+            Number of bytes to read.
+        out : numpy.ndarray, optional
+            Contiguous array of at least ``size`` bytes to read into.  If not
+            specified, a ``uint8`` array is allocated.
+        stream_id : int, optional
+            Stream identifier of chunks.
+        timeout_s : float, optional
+            Maximum time to wait for each chunk.
+        retries : int, optional
+            Maximum number of times to read missing ranges again.
+
+        Returns
+        -------
+        numpy.ndarray
+            ``out``.
+        '''
+        if out is None:
+            out = np.empty(size, dtype='uint8')
+        buffer_ = out.reshape(-1).view('uint8')
+        if buffer_.size < size:
+            raise ValueError('Output array is smaller than %d bytes.' % size)
+
+        missing = [(0, size)] if size > 0 else []
+        for i in range(retries + 1):
+            if not missing:
+                break
+            elif i > 0:
+                logger.info('Reading %d missing range(s) again.',
+                            len(missing))
+            missing = [range_j for offset, length in missing
+                       for range_j in
+                       self._mem_read_stream_range(address, offset, length,
+                                                   buffer_, stream_id,
+                                                   timeout_s)]
+        if missing:
+            raise IOError('Failed to read %d range(s) of device memory: %s' %
+                          (len(missing), missing))
+        return out
+
+    def _mem_read_stream_range(self, address, offset, size, buffer_,
+                               stream_id, timeout_s):
+        '''
+        Read ``size`` bytes at ``address + offset`` into ``buffer_[offset:]``.
+
+        Returns
+        -------
+        list
+            ``(offset, size)`` ranges not received intact.
+        '''
+        if self.mem_stream_device_to_host(address + offset, size,
+                                          stream_id) != 0:
+            raise IOError('Device is busy streaming.')
+        stream_queue = self._packet_watcher.queues.stream
+        received = []
+        chunk_count = 0
+
+        start_time = dt.datetime.now()
+        while True:
+            if stream_queue.qsize() < 1:
+                if (timeout_s < (dt.datetime.now() -
+                                 start_time).total_seconds()):
+                    logger.warning('Timed out waiting for bulk read chunk.')
+                    break
+                continue
+            datetime_i, packet_i = stream_queue.get_nowait()
+            chunk_count += 1
+            if packet_i.iuid != stream_id:
+                # Chunk of another stream, e.g., ADC samples.
+                block_i = self.stream_reassembler.push(datetime_i,
+                                                       packet_i.iuid,
+                                                       packet_i.data())
+                if block_i is not None:
+                    self.stream_backlog.append(block_i)
+            else:
+                header, payload = parse_stream_chunk(packet_i.data())
+                self.stream_reassembler.check_sequence(header)
+                chunk_offset = int(header['offset'])
+                end = chunk_offset + len(payload)
+                if header['block_size'] == size and end <= size and \
+                        self.stream_reassembler.check_crc(header, payload):
+                    buffer_[offset + chunk_offset:offset + end] = \
+                        np.frombuffer(payload, dtype='uint8')
+                    received.append((chunk_offset, len(payload)))
+                if end >= size:
+                    # Last chunk of range.
+                    break
+                start_time = dt.datetime.now()
+            chunk_count = self._return_stream_credits(chunk_count)
+        self._return_stream_credits(chunk_count, force=True)
+
+        # Find gaps between chunks received intact.
+        missing = []
+        position = 0
+        for chunk_offset, length in sorted(received):
+            if chunk_offset > position:
+                missing.append((offset + position, chunk_offset - position))
+            position = max(position, chunk_offset + length)
+        if position < size:
+            missing.append((offset + position, size - position))
+        return missing
+
+    def mem_write_bulk(self, address, data, window=8, chunk_size=None,
+                       timeout_s=5.):
+        '''
+        Write ``data`` to device memory at ``address`` as a pipelined series
+        of numbered chunks, checked with a single acknowledgment (see
+        ``mem_write_bulk_begin()``, ``mem_write_bulk_chunk()`` and
+        ``mem_write_bulk_end()`` RPCs).
+
+        Up to ``window`` chunk requests are sent before waiting for the
+        reply to the oldest one.  Once all chunks are sent, the CRC-32 of the
+        whole region computed by the device is compared to the CRC-32 of
+        ``data``.
+
+        **N.B.,** Pipelining requires a proxy with a ``serial_thread`` to
+        write request packets to (e.g., ``SerialProxy``).  Otherwise, each
+        chunk request waits for its reply.
+
+        Parameters
+        ----------
+        address : int
+            Device memory address.
+        data : numpy.ndarray or str
+            Data to write.
+        window : int, optional
+            Maximum number of chunk requests in flight.
+        chunk_size : int, optional
+            Number of bytes per chunk (default: largest chunk that fits in a
+            request packet).
+        timeout_s : float, optional
+            Maximum time to wait for each chunk reply.
+
+        Raises
+        ------
+        IOError
+            If the device rejected a chunk or the CRC of the region written
+            does not match.
+        '''
+        if isinstance(data, bytes):
+            data = np.frombuffer(data, dtype='uint8')
+        data = np.ascontiguousarray(data).reshape(-1).view('uint8')
+        if chunk_size is None:
+            # Leave room for command code, sequence, offset and array length.
+            chunk_size = self.max_serial_payload_size() - 16
+
+        self.mem_write_bulk_begin(address, data.size)
+        chunks = [(i, offset, data[offset:offset + chunk_size])
+                  for i, offset in enumerate(range(0, data.size,
+                                                   chunk_size))]
+        self._pipeline_requests('mem_write_bulk_chunk', chunks, window,
+                                timeout_s)
+        crc, received_bytes, error_count = self.mem_write_bulk_end()
+        expected_crc = zlib.crc32(data.tostring()) & 0xFFFFFFFF
+        if error_count or received_bytes != data.size or crc != expected_crc:
+            raise IOError('Bulk write failed (%d/%d bytes written, %d chunk(s)'
+                          ' rejected, CRC 0x%08x, expected 0x%08x).' %
+                          (received_bytes, data.size, error_count, crc,
+                           expected_crc))
+
+    def _encode_request(self, method_name, *args):
+        '''
+        Encode the request packet of command ``method_name(*args)`` without
+        sending it.
+
+        The generated proxy method is called on a bare instance of the proxy
+        class (i.e., without a serial connection), whose ``_send_command``
+        returns the encoded packet.  The proxy itself is not modified, so
+        other threads may keep sending commands through it.
+
+        Returns
+        -------
+        nadamq.NadaMq.cPacket
+            Request packet.
+        '''
+        encoder = object.__new__(type(self))
+
+        def send_command(packet, *args_, **kwargs):
+            raise _RequestEncoded(packet)
+
+        encoder._send_command = send_command
+        try:
+            getattr(encoder, method_name)(*args)
+        except _RequestEncoded as exception:
+            return exception.packet
+        raise RuntimeError('`%s` did not send a request.' % method_name)
+
+    def _pipeline_requests(self, method_name, args_list, window, timeout_s):
+        '''
+        Call command ``method_name(*args)`` for each item of ``args_list``,
+        with up to ``window`` requests in flight.  Replies are discarded.
+        '''
+        serial_thread = getattr(self, 'serial_thread', None)
+        if serial_thread is None or window < 2:
+            method = getattr(self, method_name)
+            for args in args_list:
+                method(*args)
+            return
+
+        data_queue = self._packet_watcher.queues.data
+        in_flight = 0
+        for args in args_list:
+            packet = self._encode_request(method_name, *args)
+            if in_flight >= window:
+                data_queue.get(timeout=timeout_s)
+                in_flight -= 1
+            serial_thread.write(packet.tostring())
+            in_flight += 1
+        for i in range(in_flight):
+            data_queue.get(timeout=timeout_s)
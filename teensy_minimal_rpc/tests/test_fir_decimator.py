@@ -0,0 +1,67 @@
+from __future__ import absolute_import
+from nose.tools import with_setup
+import numpy as np
+import teensy_minimal_rpc as tr
+
+
+def setup_func():
+    global proxy
+    proxy = tr.SerialProxy()
+
+
+def teardown_func():
+    global proxy
+    proxy.fir_decimator_free()
+    del proxy
+
+
+def reference_decimate(coefficients, factor, samples):
+    '''
+    Q15 reference of on-device FIR decimator (see ``FirDecimator``), for the
+    samples of a single channel, starting from silence.
+    '''
+    x = samples.astype('int64') - 0x8000
+    y = np.convolve(x, coefficients.astype('int64'))[:len(x)][::factor]
+    y = np.clip((y + (1 << 14)) >> 15, -0x8000, 0x7FFF)
+    return (y + 0x8000).astype('uint16')
+
+
+@with_setup(setup_func, teardown_func)
+def test_fir_decimate():
+    for tap_count_i in (1, 7, 32, 255):
+        for factor_i in (2, 3, 64):
+            yield check_fir_decimate, tap_count_i, factor_i
+
+
+def check_fir_decimate(tap_count, factor, channel_count=3, block_count=3):
+    '''
+    Compare teensy FIR decimation of consecutive blocks of interleaved
+    channels vs numpy reference.
+    '''
+    sample_count = 2 * factor
+    coefficients = np.random.randint(-4000, 4000,
+                                     size=tap_count).astype('int16')
+    samples = np.random.randint(0, 1 << 16, size=(block_count * sample_count,
+                                                  channel_count))
+    samples = samples.astype('uint16')
+
+    assert(proxy.fir_decimator_configure(coefficients.view('uint16'), factor,
+                                         channel_count, sample_count, 1,
+                                         channel_count) == 0)
+    data_addr = proxy.mem_alloc(sample_count * channel_count * 2)
+    try:
+        output = []
+        for i in range(block_count):
+            block = samples[i * sample_count:(i + 1) * sample_count]
+            proxy.mem_write_bulk(data_addr, block.ravel())
+            output.append(np.asarray(proxy.fir_decimate(data_addr,
+                                                        block.nbytes),
+                                     dtype='uint16')
+                          .reshape(channel_count, -1))
+    finally:
+        proxy.mem_free(data_addr)
+    output = np.concatenate(output, axis=1)
+
+    for c in range(channel_count):
+        expected = reference_decimate(coefficients, factor, samples[:, c])
+        assert((output[c] == expected).all())
@@ -2,6 +2,7 @@ from __future__ import absolute_import
 import nose.tools as nt
 import numpy as np
 import teensy_minimal_rpc as tr
+from teensy_minimal_rpc.registers import RegisterTransaction
 from six.moves import range
 
 
@@ -68,6 +69,31 @@ def check_mem_copy(N):
         proxy.mem_free(data_addr)
 
 
+@nt.with_setup(setup_func, teardown_func)
+def test_mem_write_bulk():
+    '''
+    Test pipelined bulk writes to device memory, for sizes that do not fill
+    the last chunk and for unaligned addresses.
+    '''
+    for N_i in (1, 31, 1024, 3001):
+        for offset_i in (0, 1):
+            for window_i in (1, 8):
+                yield check_mem_write_bulk, N_i, offset_i, window_i
+
+
+def check_mem_write_bulk(N, offset, window):
+    data_addr = proxy.mem_alloc(N + 1)
+    try:
+        data = np.random.randint(256, size=N).astype('uint8')
+        # Raises `IOError` if the CRC of the region written does not match.
+        proxy.mem_write_bulk(data_addr + offset, data, window=window,
+                             chunk_size=64)
+        device_data = proxy.mem_cpy_device_to_host(data_addr + offset, N)
+        np.testing.assert_array_equal(data, device_data)
+    finally:
+        proxy.mem_free(data_addr)
+
+
 @nt.with_setup(setup_func, teardown_func)
 def test_mem_fill():
     for value_i in (np.uint8(123), np.uint16(1234), np.uint32(876543),
@@ -97,6 +123,81 @@ def check_mem_fill(value):
         proxy.mem_free(data_addr)
 
 
+@nt.with_setup(setup_func, teardown_func)
+def test_mem_cpy_dma():
+    '''
+    Test copying between device buffers with the DMA memory engine, for
+    aligned and unaligned buffers.
+    '''
+    for offset_i in (0, 1, 2):
+        for wait_i in (True, False):
+            yield check_mem_cpy_dma, 4000 + offset_i, offset_i, wait_i
+
+
+def check_mem_cpy_dma(size, offset, wait):
+    source_addr = proxy.mem_alloc(size + 4)
+    destination_addr = proxy.mem_alloc(size + 4)
+    try:
+        data = np.random.randint(256, size=size).astype('uint8')
+        proxy.mem_write_bulk(source_addr + offset, data)
+        nt.eq_(proxy.mem_cpy_dma(destination_addr + offset,
+                                 source_addr + offset, size, wait), 0)
+        while proxy.dma_memory_busy():
+            pass
+        device_data = proxy.mem_read_stream(destination_addr + offset, size)
+        np.testing.assert_array_equal(data, device_data)
+    finally:
+        proxy.mem_free(source_addr)
+        proxy.mem_free(destination_addr)
+
+
+@nt.with_setup(setup_func, teardown_func)
+def test_register_transaction():
+    '''
+    Test masked writes in a register transaction, and that nothing is written
+    if any operation is invalid.
+    '''
+    address = proxy.mem_aligned_alloc(4, 8)
+    try:
+        proxy.mem_cpy_host_to_device(address, np.array([0x12345678, 0],
+                                                       dtype='<u4')
+                                     .view('uint8'))
+        transaction = (RegisterTransaction()
+                       .poke(address, 0xAB00, mask=0xFF00)
+                       .poke(address + 4, 0xCAFEBABE))
+        nt.eq_(proxy.apply_register_transaction(transaction), 2)
+        device_data = (np.asarray(proxy.mem_cpy_device_to_host(address, 8),
+                                  dtype='uint8').view('<u4'))
+        np.testing.assert_array_equal(device_data, [0x1234AB78, 0xCAFEBABE])
+
+        # Unaligned poke is invalid, so first operation is not applied.
+        transaction = (RegisterTransaction().poke(address + 4, 0)
+                       .poke(address + 1, 0))
+        nt.assert_raises(ValueError, proxy.apply_register_transaction,
+                         transaction)
+        device_data = (np.asarray(proxy.mem_cpy_device_to_host(address + 4,
+                                                               4),
+                                  dtype='uint8').view('<u4'))
+        nt.eq_(device_data[0], 0xCAFEBABE)
+    finally:
+        proxy.mem_aligned_free(address)
+
+
+@nt.with_setup(setup_func, teardown_func)
+def test_register_shadow():
+    '''
+    Test that unchanged shadowed register writes are skipped, and that the
+    shadow is discarded after registers are written by another RPC.
+    '''
+    # Enable PDB clock.
+    transaction = RegisterTransaction().sim(6, 1 << 22, mask=1 << 22)
+    proxy.apply_register_transaction(transaction)
+    nt.eq_(proxy.apply_register_transaction(transaction), 0)
+    # Device token is invalidated by other register writes.
+    proxy.reset_dma_TCD(0)
+    nt.eq_(proxy.apply_register_transaction(transaction), 1)
+
+
 @nt.with_setup(setup_func, teardown_func)
 def test_str_echo():
     '''
@@ -0,0 +1,57 @@
+from __future__ import absolute_import
+from nose.tools import with_setup
+import numpy as np
+import teensy_minimal_rpc as tr
+from teensy_minimal_rpc.stream import decode_rice_block
+
+
+def setup_func():
+    global proxy
+    proxy = tr.SerialProxy()
+
+
+def teardown_func():
+    global proxy
+    proxy.rice_coding_free()
+    del proxy
+
+
+@with_setup(setup_func, teardown_func)
+def test_rice_round_trip():
+    for signal_i in ('sine', 'constant', 'random'):
+        for partition_size_i in (1, 16, 256):
+            yield check_rice_round_trip, signal_i, partition_size_i
+
+
+def check_rice_round_trip(signal, partition_size, channel_count=3,
+                          sample_count=1000):
+    '''
+    Decode block of interleaved channels coded on the teensy, and check the
+    samples of each channel are the same.
+    '''
+    t = np.arange(sample_count * channel_count).reshape(-1, channel_count)
+    if signal == 'sine':
+        samples = (0x8000 + 0x4000 * np.sin(t / 100.) +
+                   np.random.randint(-16, 16, size=t.shape))
+    elif signal == 'constant':
+        samples = np.full(t.shape, 0x1234)
+    else:
+        samples = np.random.randint(0, 1 << 16, size=t.shape)
+    samples = samples.astype('uint16')
+
+    assert(proxy.rice_coding_configure(channel_count, sample_count, 1,
+                                       channel_count, partition_size) == 0)
+    data_addr = proxy.mem_alloc(samples.nbytes)
+    try:
+        proxy.mem_write_bulk(data_addr, samples.ravel().view('uint8'))
+        raw_size, coded_size, cycles, coded_addr = \
+            proxy.rice_benchmark(data_addr, samples.nbytes)
+        block = proxy.mem_read_stream(coded_addr, coded_size).tostring()
+    finally:
+        proxy.mem_free(data_addr)
+
+    assert(raw_size == samples.nbytes)
+    header, decoded = decode_rice_block(block)
+    # Random samples do not compress, so are sent raw.
+    assert(bool(header['coded']) == (signal != 'random'))
+    assert((decoded == samples.T).all())
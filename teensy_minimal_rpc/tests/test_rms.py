@@ -56,3 +56,22 @@ def check_rms(N, auto_mean):
         assert(np.isclose(py_rms, teensy_rms))
     finally:
         proxy.mem_free(data_addr)
+
+
+@with_setup(setup_func, teardown_func)
+def test_rms_benchmark():
+    for signed_i in (True, False):
+        yield check_rms_benchmark, signed_i
+
+
+def check_rms_benchmark(signed):
+    '''
+    Compare each teensy root mean square variant (``float`` loops, portable
+    and ``SMLALD`` single-pass kernels) vs numpy calculation.
+    '''
+    df_rms = proxy.rms_benchmark_info(sizes=(16, 17, 1024, 8 * 1024),
+                                      signed=signed)
+    error = df_rms['error'].dropna()
+    single_pass = error.index.get_level_values('variant') != 'float'
+    assert((error[single_pass] < 1e-5).all())
+    assert((error[~single_pass] < 1e-3).all())
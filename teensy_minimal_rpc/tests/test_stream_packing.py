@@ -0,0 +1,30 @@
+from __future__ import absolute_import
+import numpy as np
+from teensy_minimal_rpc.stream import unpack_samples
+
+
+def reference_pack(samples, bits):
+    '''
+    Pack samples into little-endian bit stream (see ``SamplePacker``).
+    '''
+    stream_bits = ((samples[:, None].astype('uint32') >> np.arange(bits)) &
+                   1).astype('uint8').ravel()
+    stream_bits = np.concatenate([stream_bits,
+                                  np.zeros(-stream_bits.size % 8,
+                                           dtype='uint8')])
+    return (stream_bits.reshape(-1, 8) << np.arange(8)).sum(axis=1)\
+        .astype('uint8').tostring()
+
+
+def test_unpack_samples():
+    for bits_i in (8, 10, 12, 16):
+        for count_i in (0, 1, 2, 3, 5, 1000):
+            yield check_unpack_samples, bits_i, count_i
+
+
+def check_unpack_samples(bits, count):
+    samples = np.random.randint(0, 1 << bits, size=count).astype('uint16')
+    data = (samples.tostring() if bits == 16
+            else reference_pack(samples, bits))
+    assert(len(data) == -(-count * bits // 8))
+    assert((unpack_samples(data, bits) == samples).all())
@@ -0,0 +1,77 @@
+from __future__ import absolute_import
+from nose.tools import with_setup
+import arduino_helpers.hardware.teensy.adc as adc
+import teensy_minimal_rpc as tr
+from teensy_minimal_rpc.stream import TRIGGER_MODES, parse_trigger_capture
+
+
+COMPARE_NONE = 0xFF
+
+
+def setup_func():
+    global proxy
+    proxy = tr.SerialProxy()
+
+
+def teardown_func():
+    global proxy
+    proxy.triggered_sampler_free()
+    del proxy
+
+
+def configure(pre_count, post_count, auto_rearm, ring_sample_count=1024):
+    assert(proxy.triggered_sampler_configure(int(adc.SC1A_PINS['A0']),
+                                             COMPARE_NONE, ring_sample_count,
+                                             10000, 0) == 0)
+    # Any sample is at or above level 0, i.e., trigger fires as soon as it is
+    # accepted.
+    return proxy.trigger_configure(TRIGGER_MODES['level_above'], 0, 0,
+                                   pre_count, post_count, 0, auto_rearm)
+
+
+@with_setup(setup_func, teardown_func)
+def test_trigger_window_too_large():
+    assert(configure(400, 113, True) == -1)
+    assert(configure(400, 112, True) == 0)
+
+
+@with_setup(setup_func, teardown_func)
+def test_triggered_capture():
+    for pre_count_i in (0, 100):
+        for auto_rearm_i in (True, False):
+            yield check_triggered_capture, pre_count_i, 200, auto_rearm_i
+
+
+def check_triggered_capture(pre_count, post_count, auto_rearm,
+                            block_count=3):
+    '''
+    Check header and size of each window streamed by a software triggered
+    capture.
+    '''
+    assert(configure(pre_count, post_count, auto_rearm) == 0)
+    assert(proxy.triggered_sampler_start(1))
+    try:
+        blocks = proxy.read_stream_blocks(timeout_s=5,
+                                          block_count=(block_count if
+                                                       auto_rearm else 1))
+    finally:
+        proxy.triggered_sampler_stop()
+
+    previous_index = -1
+    for datetime_i, stream_id_i, block_i, timestamp_i in blocks:
+        assert(stream_id_i == 1)
+        header, samples = parse_trigger_capture(block_i)
+        assert(header['pre_count'] == pre_count)
+        assert(header['post_count'] == post_count)
+        assert(samples.size == pre_count + post_count)
+        assert(header['capture_index'] > previous_index)
+        previous_index = header['capture_index']
+        # Triggers are accepted once the pre-trigger history is available,
+        # and again once each window is complete.
+        assert((header['trigger_sample'] - pre_count) % post_count == 0)
+        assert(header['frozen_sample'] >= header['trigger_sample'] +
+               post_count)
+    capture_count, missed_count, running = proxy.trigger_stats()
+    assert(not running)
+    if not auto_rearm:
+        assert(len(blocks) == 1 and capture_count == 1)